@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////
+// fragmentShader.glsl
+// ============
+// color the mesh fragments with Phong lighting
+//
+// The camera, lights and materials are read from std140 uniform blocks
+// that are uploaded only when they change, bound to their binding points
+// by the scene manager.  Instanced meshes take their
+// color and material index from the instance attributes, other meshes from
+// the objectColor and materialIndex uniforms.  Textures are layers of the
+// texture array bound to objectTexture.
+///////////////////////////////////////////////////////////////////////////////
+#version 330 core
+
+// vec4 members keep the std140 layout simple, only xyz is used
+struct Material
+{
+	vec4 ambientColor;
+	vec4 diffuseColor;
+	vec4 specularColor;
+	float ambientStrength;
+	float shininess;
+};
+
+struct LightSource
+{
+	vec4 position;
+	vec4 ambientColor;
+	vec4 diffuseColor;
+	vec4 specularColor;
+	float focalStrength;
+	float specularIntensity;
+};
+
+#define TOTAL_LIGHTS 4
+#define TOTAL_MATERIALS 16
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+in vec4 fragmentInstanceColor;
+flat in uint fragmentInstanceMaterial;
+flat in int fragmentTextureLayer;
+
+out vec4 outFragmentColor;
+
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+layout (std140) uniform LightBlock
+{
+	LightSource lightSources[TOTAL_LIGHTS];
+};
+
+layout (std140) uniform MaterialBlock
+{
+	Material materials[TOTAL_MATERIALS];
+};
+
+uniform bool bUseInstancing = false;
+uniform bool bUseTexture = false;
+uniform bool bUseLighting = false;
+uniform vec4 objectColor = vec4(1.0f);
+uniform int materialIndex = 0;
+uniform sampler2DArray objectTexture;
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+
+/***********************************************************
+ *  CalcLightSource()
+ *
+ *  Returns the Phong lighting of one light source.
+ ***********************************************************/
+vec3 CalcLightSource(LightSource light, Material surface, vec3 lightNormal, vec3 viewDirection)
+{
+	vec3 ambient = light.ambientColor.xyz * surface.ambientColor.xyz * surface.ambientStrength;
+
+	vec3 lightDirection = normalize(light.position.xyz - fragmentPosition);
+	float impact = max(dot(lightNormal, lightDirection), 0.0f);
+	vec3 diffuse = impact * light.diffuseColor.xyz * surface.diffuseColor.xyz;
+
+	vec3 reflectDirection = reflect(-lightDirection, lightNormal);
+	float specularComponent = pow(max(dot(viewDirection, reflectDirection), 0.0f), light.focalStrength);
+	vec3 specular = light.specularIntensity * specularComponent * light.specularColor.xyz * surface.specularColor.xyz;
+
+	return(ambient + diffuse + specular);
+}
+
+void main()
+{
+	vec4 baseColor = bUseInstancing ? fragmentInstanceColor : objectColor;
+	int surfaceIndex = bUseInstancing ? int(fragmentInstanceMaterial) : materialIndex;
+	Material surface = materials[clamp(surfaceIndex, 0, TOTAL_MATERIALS - 1)];
+
+	if (bUseTexture)
+	{
+		baseColor = texture(objectTexture, vec3(fragmentTextureCoordinate * UVscale, float(fragmentTextureLayer)));
+	}
+
+	if (bUseLighting)
+	{
+		vec3 lightNormal = normalize(fragmentVertexNormal);
+		vec3 viewDirection = normalize(viewPosition.xyz - fragmentPosition);
+		vec3 phongResult = vec3(0.0f);
+
+		for (int i = 0; i < TOTAL_LIGHTS; i++)
+		{
+			phongResult += CalcLightSource(lightSources[i], surface, lightNormal, viewDirection);
+		}
+
+		outFragmentColor = vec4(phongResult * baseColor.xyz, baseColor.w);
+	}
+	else
+	{
+		outFragmentColor = baseColor;
+	}
+}
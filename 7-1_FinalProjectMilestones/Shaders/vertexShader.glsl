@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexShader.glsl
+// ============
+// transform the mesh vertices into the 3D scene
+//
+// Meshes drawn one at a time use the model and textureLayer uniforms.
+// Instanced meshes read their model matrix, color, material index and
+// texture layer from per-instance attributes instead, so that many copies of
+// a mesh need only one draw call.  The
+// camera matrices come from the CameraBlock uniform buffer, whose binding
+// point is assigned by the scene manager so OpenGL 3.3 is enough.
+//
+// With bPackedVertices the position is quantized within the bounding box of
+// its mesh, which is read from the meshBoxes buffer texture, and the normal
+// is octahedral encoded in x and y.
+///////////////////////////////////////////////////////////////////////////////
+#version 330 core
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+// per-instance attributes, locations 3 to 6 hold the model matrix columns
+layout (location = 3) in mat4 inInstanceModel;
+layout (location = 7) in vec4 inInstanceColor;
+layout (location = 8) in uint inInstanceMaterial;
+layout (location = 9) in uint inInstanceTextureLayer;
+// mesh box of a packed vertex
+layout (location = 10) in uint inVertexMeshBox;
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+out vec4 fragmentInstanceColor;
+flat out uint fragmentInstanceMaterial;
+flat out int fragmentTextureLayer;
+
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+uniform bool bUseInstancing = false;
+uniform mat4 model;
+uniform int textureLayer = 0;
+uniform bool bPackedVertices = false;
+// minimum corner and size of every mesh, two texels each
+uniform samplerBuffer meshBoxes;
+
+/***********************************************************
+ *  DecodeNormal()
+ *
+ *  Returns the unit normal of an octahedral encoded one,
+ *  unfolding the lower half from the corners.
+ ***********************************************************/
+vec3 DecodeNormal(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+	if (normal.z < 0.0f)
+	{
+		vec2 signs = vec2((normal.x >= 0.0f) ? 1.0f : -1.0f, (normal.y >= 0.0f) ? 1.0f : -1.0f);
+		normal.xy = (1.0f - abs(normal.yx)) * signs;
+	}
+	return(normalize(normal));
+}
+
+void main()
+{
+	mat4 objectModel = bUseInstancing ? inInstanceModel : model;
+
+	vec3 vertexPosition = inVertexPosition;
+	vec3 vertexNormal = inVertexNormal;
+	if (bPackedVertices)
+	{
+		int box = int(inVertexMeshBox) * 2;
+		vertexPosition = texelFetch(meshBoxes, box).xyz + inVertexPosition * texelFetch(meshBoxes, box + 1).xyz;
+		vertexNormal = DecodeNormal(inVertexNormal.xy);
+	}
+
+	// vertex position and normal in world space for the lighting
+	fragmentPosition = vec3(objectModel * vec4(vertexPosition, 1.0f));
+	fragmentVertexNormal = mat3(transpose(inverse(objectModel))) * vertexNormal;
+	fragmentTextureCoordinate = inTextureCoordinate;
+	fragmentInstanceColor = inInstanceColor;
+	fragmentInstanceMaterial = inInstanceMaterial;
+	fragmentTextureLayer = bUseInstancing ? int(inInstanceTextureLayer) : textureLayer;
+
+	gl_Position = projection * view * vec4(fragmentPosition, 1.0f);
+}
@@ -0,0 +1,414 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.cpp
+// ============
+// skip the scene objects that are outside of the camera view
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FRUSTUM_CULLER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+// MSVC emits the intrinsics of any instruction set
+#define FRUSTUM_CULLER_SSE2
+#define FRUSTUM_CULLER_AVX
+#else
+#define FRUSTUM_CULLER_SSE2 __attribute__((target("sse2")))
+#define FRUSTUM_CULLER_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+// declaration of global variables
+namespace
+{
+	// boxes tested by one pass of the widest vector loop
+	const uint32_t g_BoxGroupSize = 8;
+
+	// -1 until a path is chosen, then the path in use
+	int g_Path = -1;
+
+	/***********************************************************
+	 *  CULL_PLANE
+	 *
+	 *  Frustum plane with the absolute values of its normal,
+	 *  which scale the half size of a box into its reach
+	 *  towards the plane.
+	 ***********************************************************/
+	struct CULL_PLANE
+	{
+		float normal[3];
+		float distance;
+		float absNormal[3];
+	};
+
+	/***********************************************************
+	 *  PrepareCullPlanes()
+	 *
+	 *  Fills the cull planes of a frustum.
+	 ***********************************************************/
+	void PrepareCullPlanes(const FRUSTUM& frustum, CULL_PLANE* pPlanes)
+	{
+		for (int plane = 0; plane < 6; plane++)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				pPlanes[plane].normal[axis] = frustum.planes[plane][axis];
+				pPlanes[plane].absNormal[axis] = std::fabs(frustum.planes[plane][axis]);
+			}
+			pPlanes[plane].distance = frustum.planes[plane].w;
+		}
+	}
+
+	/***********************************************************
+	 *  CULL_INPUT
+	 *
+	 *  Box arrays and the visibility output of one cull.
+	 ***********************************************************/
+	struct CULL_INPUT
+	{
+		const float* pCenterX;
+		const float* pCenterY;
+		const float* pCenterZ;
+		const float* pExtentX;
+		const float* pExtentY;
+		const float* pExtentZ;
+		uint8_t* pVisible;
+		uint32_t count;
+	};
+
+	/***********************************************************
+	 *  Scalar culling
+	 *
+	 *  A box is outside when its center is further behind a
+	 *  plane than the box reaches towards it.
+	 ***********************************************************/
+	uint32_t CullScalar(const CULL_INPUT& input, const CULL_PLANE* pPlanes)
+	{
+		uint32_t visibleCount = 0;
+		for (uint32_t i = 0; i < input.count; i++)
+		{
+			bool bOutside = false;
+			for (int plane = 0; (plane < 6) && (bOutside == false); plane++)
+			{
+				const CULL_PLANE& p = pPlanes[plane];
+				float distance = p.normal[0] * input.pCenterX[i] + p.normal[1] * input.pCenterY[i] +
+					p.normal[2] * input.pCenterZ[i] + p.distance;
+				float reach = p.absNormal[0] * input.pExtentX[i] + p.absNormal[1] * input.pExtentY[i] +
+					p.absNormal[2] * input.pExtentZ[i];
+				bOutside = (distance + reach < 0.0f);
+			}
+			input.pVisible[i] = bOutside ? 0 : 1;
+			visibleCount += bOutside ? 0 : 1;
+		}
+		return(visibleCount);
+	}
+
+#ifdef FRUSTUM_CULLER_X86
+	/***********************************************************
+	 *  SSE2 culling, 4 boxes at a time
+	 ***********************************************************/
+	FRUSTUM_CULLER_SSE2 uint32_t CullSSE2(const CULL_INPUT& input, const CULL_PLANE* pPlanes)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		uint32_t visibleCount = 0;
+		for (uint32_t i = 0; i < input.count; i += 4)
+		{
+			__m128 centerX = _mm_loadu_ps(input.pCenterX + i);
+			__m128 centerY = _mm_loadu_ps(input.pCenterY + i);
+			__m128 centerZ = _mm_loadu_ps(input.pCenterZ + i);
+			__m128 extentX = _mm_loadu_ps(input.pExtentX + i);
+			__m128 extentY = _mm_loadu_ps(input.pExtentY + i);
+			__m128 extentZ = _mm_loadu_ps(input.pExtentZ + i);
+
+			__m128 outside = zero;
+			for (int plane = 0; plane < 6; plane++)
+			{
+				const CULL_PLANE& p = pPlanes[plane];
+				__m128 distance = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.normal[0]), centerX), _mm_mul_ps(_mm_set1_ps(p.normal[1]), centerY)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.normal[2]), centerZ), _mm_set1_ps(p.distance)));
+				__m128 reach = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.absNormal[0]), extentX), _mm_mul_ps(_mm_set1_ps(p.absNormal[1]), extentY)),
+					_mm_mul_ps(_mm_set1_ps(p.absNormal[2]), extentZ));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), zero));
+			}
+
+			int outsideMask = _mm_movemask_ps(outside);
+			uint32_t laneCount = std::min(input.count - i, 4u);
+			for (uint32_t lane = 0; lane < laneCount; lane++)
+			{
+				uint8_t bVisible = ((outsideMask >> lane) & 1) ? 0 : 1;
+				input.pVisible[i + lane] = bVisible;
+				visibleCount += bVisible;
+			}
+		}
+		return(visibleCount);
+	}
+
+	/***********************************************************
+	 *  AVX culling, 8 boxes at a time
+	 ***********************************************************/
+	FRUSTUM_CULLER_AVX uint32_t CullAVX(const CULL_INPUT& input, const CULL_PLANE* pPlanes)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		uint32_t visibleCount = 0;
+		for (uint32_t i = 0; i < input.count; i += 8)
+		{
+			__m256 centerX = _mm256_loadu_ps(input.pCenterX + i);
+			__m256 centerY = _mm256_loadu_ps(input.pCenterY + i);
+			__m256 centerZ = _mm256_loadu_ps(input.pCenterZ + i);
+			__m256 extentX = _mm256_loadu_ps(input.pExtentX + i);
+			__m256 extentY = _mm256_loadu_ps(input.pExtentY + i);
+			__m256 extentZ = _mm256_loadu_ps(input.pExtentZ + i);
+
+			__m256 outside = zero;
+			for (int plane = 0; plane < 6; plane++)
+			{
+				const CULL_PLANE& p = pPlanes[plane];
+				__m256 distance = _mm256_add_ps(
+					_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.normal[0]), centerX), _mm256_mul_ps(_mm256_set1_ps(p.normal[1]), centerY)),
+					_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.normal[2]), centerZ), _mm256_set1_ps(p.distance)));
+				__m256 reach = _mm256_add_ps(
+					_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.absNormal[0]), extentX), _mm256_mul_ps(_mm256_set1_ps(p.absNormal[1]), extentY)),
+					_mm256_mul_ps(_mm256_set1_ps(p.absNormal[2]), extentZ));
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_LT_OQ));
+			}
+
+			int outsideMask = _mm256_movemask_ps(outside);
+			uint32_t laneCount = std::min(input.count - i, 8u);
+			for (uint32_t lane = 0; lane < laneCount; lane++)
+			{
+				uint8_t bVisible = ((outsideMask >> lane) & 1) ? 0 : 1;
+				input.pVisible[i + lane] = bVisible;
+				visibleCount += bVisible;
+			}
+		}
+		return(visibleCount);
+	}
+#endif
+}
+
+/***********************************************************
+ *  FrustumCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrustumCuller::FrustumCuller()
+{
+	m_count = 0;
+}
+
+/***********************************************************
+ *  ~FrustumCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrustumCuller::~FrustumCuller()
+{
+}
+
+/***********************************************************
+ *  ExtractPlanes()
+ *
+ *  This method is used for taking the six frustum planes
+ *  out of the rows of a view-projection matrix, which gives
+ *  them in world space.  The planes are normalized so that
+ *  the boxes can be compared against them in world units.
+ ***********************************************************/
+void FrustumCuller::ExtractPlanes(const glm::mat4& viewProjection, FRUSTUM& frustum)
+{
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+	{
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+	}
+
+	// left, right, bottom, top, near and far
+	frustum.planes[0] = rows[3] + rows[0];
+	frustum.planes[1] = rows[3] - rows[0];
+	frustum.planes[2] = rows[3] + rows[1];
+	frustum.planes[3] = rows[3] - rows[1];
+	frustum.planes[4] = rows[3] + rows[2];
+	frustum.planes[5] = rows[3] - rows[2];
+
+	for (int plane = 0; plane < 6; plane++)
+	{
+		float length = glm::length(glm::vec3(frustum.planes[plane]));
+		if (length > 0.0f)
+		{
+			frustum.planes[plane] /= length;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetPath()
+ *
+ *  This method is used for getting the instruction set the
+ *  culling runs with.  It starts with the fastest one the
+ *  image kernels found.  AVX2 is the detected level, the
+ *  culling itself only needs AVX.
+ ***********************************************************/
+IMAGE_KERNEL_PATH FrustumCuller::GetPath()
+{
+	if (g_Path < 0)
+	{
+		g_Path = (int)ImageKernels::GetBestPath();
+	}
+
+	return((IMAGE_KERNEL_PATH)g_Path);
+}
+
+/***********************************************************
+ *  SetPath()
+ *
+ *  This method is used for running the culling with another
+ *  instruction set, limited to the fastest one.
+ ***********************************************************/
+void FrustumCuller::SetPath(IMAGE_KERNEL_PATH path)
+{
+	g_Path = (int)std::min(path, ImageKernels::GetBestPath());
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for changing the number of boxes.
+ *  The arrays are padded with empty boxes to a multiple of
+ *  the vector width.
+ ***********************************************************/
+void FrustumCuller::Resize(uint32_t count)
+{
+	size_t paddedCount = ((size_t)count + g_BoxGroupSize - 1) / g_BoxGroupSize * g_BoxGroupSize;
+
+	m_centerX.resize(paddedCount, 0.0f);
+	m_centerY.resize(paddedCount, 0.0f);
+	m_centerZ.resize(paddedCount, 0.0f);
+	m_extentX.resize(paddedCount, 0.0f);
+	m_extentY.resize(paddedCount, 0.0f);
+	m_extentZ.resize(paddedCount, 0.0f);
+	m_visible.resize(paddedCount, 1);
+	m_count = count;
+}
+
+/***********************************************************
+ *  SetBounds()
+ *
+ *  This method is used for transforming the box of a mesh
+ *  into world space.  The center is transformed as a point,
+ *  and the half size along each world axis is the sum of
+ *  the half sizes scaled by the absolute matrix entries, so
+ *  the new box holds the rotated one.
+ ***********************************************************/
+void FrustumCuller::SetBounds(uint32_t index, const MESH_BOUNDS& meshBounds, const glm::mat4& world)
+{
+	glm::vec4 center = world * glm::vec4(meshBounds.center[0], meshBounds.center[1], meshBounds.center[2], 1.0f);
+
+	m_centerX[index] = center.x;
+	m_centerY[index] = center.y;
+	m_centerZ[index] = center.z;
+	m_extentX[index] = std::fabs(world[0][0]) * meshBounds.extents[0] +
+		std::fabs(world[1][0]) * meshBounds.extents[1] + std::fabs(world[2][0]) * meshBounds.extents[2];
+	m_extentY[index] = std::fabs(world[0][1]) * meshBounds.extents[0] +
+		std::fabs(world[1][1]) * meshBounds.extents[1] + std::fabs(world[2][1]) * meshBounds.extents[2];
+	m_extentZ[index] = std::fabs(world[0][2]) * meshBounds.extents[0] +
+		std::fabs(world[1][2]) * meshBounds.extents[1] + std::fabs(world[2][2]) * meshBounds.extents[2];
+}
+
+/***********************************************************
+ *  SetWorldBounds()
+ *
+ *  This method is used for setting a box that is already in
+ *  world space, such as the box of a static batch.
+ ***********************************************************/
+void FrustumCuller::SetWorldBounds(uint32_t index, const MESH_BOUNDS& worldBounds)
+{
+	m_centerX[index] = worldBounds.center[0];
+	m_centerY[index] = worldBounds.center[1];
+	m_centerZ[index] = worldBounds.center[2];
+	m_extentX[index] = worldBounds.extents[0];
+	m_extentY[index] = worldBounds.extents[1];
+	m_extentZ[index] = worldBounds.extents[2];
+}
+
+/***********************************************************
+ *  GetWorldBounds()
+ *
+ *  This method is used for reading back the world space box
+ *  of an object.
+ ***********************************************************/
+void FrustumCuller::GetWorldBounds(uint32_t index, MESH_BOUNDS& worldBounds) const
+{
+	worldBounds.center[0] = m_centerX[index];
+	worldBounds.center[1] = m_centerY[index];
+	worldBounds.center[2] = m_centerZ[index];
+	worldBounds.extents[0] = m_extentX[index];
+	worldBounds.extents[1] = m_extentY[index];
+	worldBounds.extents[2] = m_extentZ[index];
+	worldBounds.radius = std::sqrt(
+		m_extentX[index] * m_extentX[index] +
+		m_extentY[index] * m_extentY[index] +
+		m_extentZ[index] * m_extentZ[index]);
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for marking the boxes that are at
+ *  least partly inside the frustum.  Boxes that are close
+ *  to a corner of the frustum can be kept although they are
+ *  outside, which only costs a draw.
+ ***********************************************************/
+uint32_t FrustumCuller::Cull(const FRUSTUM& frustum)
+{
+	CULL_PLANE planes[6];
+	PrepareCullPlanes(frustum, planes);
+
+	CULL_INPUT input;
+	input.pCenterX = m_centerX.data();
+	input.pCenterY = m_centerY.data();
+	input.pCenterZ = m_centerZ.data();
+	input.pExtentX = m_extentX.data();
+	input.pExtentY = m_extentY.data();
+	input.pExtentZ = m_extentZ.data();
+	input.pVisible = m_visible.data();
+	input.count = m_count;
+
+#ifdef FRUSTUM_CULLER_X86
+	switch (GetPath())
+	{
+	case IMAGE_KERNEL_AVX2:
+		return(CullAVX(input, planes));
+	case IMAGE_KERNEL_SSE2:
+		return(CullSSE2(input, planes));
+	default:
+		break;
+	}
+#endif
+
+	return(CullScalar(input, planes));
+}
+
+/***********************************************************
+ *  SetAllVisible()
+ *
+ *  This method is used for marking every box visible.
+ ***********************************************************/
+void FrustumCuller::SetAllVisible()
+{
+	std::fill(m_visible.begin(), m_visible.end(), (uint8_t)1);
+}
+
+/***********************************************************
+ *  SetNoneVisible()
+ *
+ *  This method is used for marking every box hidden.
+ ***********************************************************/
+void FrustumCuller::SetNoneVisible()
+{
+	std::fill(m_visible.begin(), m_visible.end(), (uint8_t)0);
+}
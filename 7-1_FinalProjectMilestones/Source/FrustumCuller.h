@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.h
+// ============
+// skip the scene objects that are outside of the camera view
+//
+// Every object has an axis aligned box in world space, made by transforming
+// the box of its mesh by its world matrix.  The six planes of the view
+// frustum are taken from the view-projection matrix, and the boxes are
+// tested against them 4 at a time with SSE2 or 8 at a time with AVX.  The
+// instruction set is picked the same way as for the image kernels.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ImageKernels.h"
+#include "MeshGeometry.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  FRUSTUM
+ *
+ *  Planes of the view frustum, with their normals pointing
+ *  inside and normalized, so a point p is inside a plane
+ *  when dot(plane.xyz, p) + plane.w >= 0.
+ ***********************************************************/
+struct FRUSTUM
+{
+	glm::vec4 planes[6];
+};
+
+/***********************************************************
+ *  FrustumCuller
+ *
+ *  This class contains the world space boxes of the scene
+ *  objects and their visibility in the last culled view.
+ ***********************************************************/
+class FrustumCuller
+{
+public:
+	// constructor
+	FrustumCuller();
+	// destructor
+	~FrustumCuller();
+
+	// planes of the view frustum of a view-projection matrix
+	static void ExtractPlanes(const glm::mat4& viewProjection, FRUSTUM& frustum);
+
+	// instruction set the culling runs with, limited to the
+	// fastest one the processor supports
+	static IMAGE_KERNEL_PATH GetPath();
+	static void SetPath(IMAGE_KERNEL_PATH path);
+
+	// change the number of boxes, keeping the existing ones -
+	// new boxes are empty at the origin
+	void Resize(uint32_t count);
+	uint32_t GetCount() const { return(m_count); }
+
+	// set the box of an object from the box of its mesh and
+	// its world matrix, or from a box already in world space
+	void SetBounds(uint32_t index, const MESH_BOUNDS& meshBounds, const glm::mat4& world);
+	void SetWorldBounds(uint32_t index, const MESH_BOUNDS& worldBounds);
+	void GetWorldBounds(uint32_t index, MESH_BOUNDS& worldBounds) const;
+
+	// test every box against the frustum and return how many
+	// are at least partly inside
+	uint32_t Cull(const FRUSTUM& frustum);
+	// count every box as visible, for drawing without culling
+	void SetAllVisible();
+	// mark boxes found visible by another test, such as the
+	// scene hierarchy
+	void SetNoneVisible();
+	void SetVisible(uint32_t index, bool bVisible) { m_visible[index] = bVisible ? 1 : 0; }
+	bool IsVisible(uint32_t index) const { return(m_visible[index] != 0); }
+
+private:
+	// boxes as separate center and half size arrays, padded
+	// to a multiple of 8 so the vector loops need no tail
+	std::vector<float> m_centerX;
+	std::vector<float> m_centerY;
+	std::vector<float> m_centerZ;
+	std::vector<float> m_extentX;
+	std::vector<float> m_extentY;
+	std::vector<float> m_extentZ;
+	// 1 for every box inside the frustum
+	std::vector<uint8_t> m_visible;
+	uint32_t m_count;
+};
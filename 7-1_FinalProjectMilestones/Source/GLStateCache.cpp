@@ -0,0 +1,468 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.cpp
+// ============
+// skip OpenGL state changes that would not change anything
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLStateCache.h"
+
+#include <cstring>
+#include <vector>
+
+uint32_t GLStateCache::s_issuedCalls = 0;
+uint32_t GLStateCache::s_elidedCalls = 0;
+
+// declaration of global variables
+namespace
+{
+	// shadowed names and enums start out unknown, so the
+	// first call always reaches OpenGL
+	const GLuint g_UnknownValue = 0xFFFFFFFF;
+
+	// texture units and targets whose bindings are shadowed,
+	// others are always sent
+	const GLuint g_MaxTrackedUnits = 32;
+	const GLenum g_TrackedTargets[] = { GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY };
+	const int g_TrackedTargetCount = sizeof(g_TrackedTargets) / sizeof(g_TrackedTargets[0]);
+
+	// capabilities whose enable state is shadowed
+	const GLenum g_TrackedCapabilities[] = { GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_SCISSOR_TEST, GL_STENCIL_TEST };
+	const int g_TrackedCapabilityCount = sizeof(g_TrackedCapabilities) / sizeof(g_TrackedCapabilities[0]);
+
+	// uniforms up to a 4x4 matrix at locations below the limit
+	// are shadowed, others are always sent
+	const GLint g_MaxTrackedUniforms = 1024;
+	const size_t g_MaxUniformSize = 64;
+
+	/***********************************************************
+	 *  UNIFORM_SHADOW
+	 *
+	 *  Last value set to one uniform location.
+	 ***********************************************************/
+	struct UNIFORM_SHADOW
+	{
+		bool bKnown;
+		unsigned char value[g_MaxUniformSize];
+	};
+
+	GLuint g_program = g_UnknownValue;
+	GLuint g_activeUnit = g_UnknownValue;
+	GLuint g_textures[g_MaxTrackedUnits][g_TrackedTargetCount];
+	GLuint g_vertexArray = g_UnknownValue;
+	// -1 unknown, 0 disabled, 1 enabled
+	int g_capabilities[g_TrackedCapabilityCount];
+	GLenum g_blendSource = g_UnknownValue;
+	GLenum g_blendDestination = g_UnknownValue;
+	GLenum g_depthFunction = g_UnknownValue;
+	int g_depthMask = -1;
+	bool g_bClearColorKnown = false;
+	GLfloat g_clearColor[4];
+	std::vector<UNIFORM_SHADOW> g_uniforms;
+
+	/***********************************************************
+	 *  ResetShadow()
+	 *
+	 *  Marks every shadowed value unknown.
+	 ***********************************************************/
+	void ResetShadow()
+	{
+		g_program = g_UnknownValue;
+		g_activeUnit = g_UnknownValue;
+		for (GLuint unit = 0; unit < g_MaxTrackedUnits; unit++)
+		{
+			for (int target = 0; target < g_TrackedTargetCount; target++)
+			{
+				g_textures[unit][target] = g_UnknownValue;
+			}
+		}
+		g_vertexArray = g_UnknownValue;
+		for (int capability = 0; capability < g_TrackedCapabilityCount; capability++)
+		{
+			g_capabilities[capability] = -1;
+		}
+		g_blendSource = g_UnknownValue;
+		g_blendDestination = g_UnknownValue;
+		g_depthFunction = g_UnknownValue;
+		g_depthMask = -1;
+		g_bClearColorKnown = false;
+		g_uniforms.clear();
+	}
+
+	// the shadow starts out unknown before the first call
+	struct SHADOW_INITIALIZER
+	{
+		SHADOW_INITIALIZER() { ResetShadow(); }
+	} g_ShadowInitializer;
+
+	/***********************************************************
+	 *  FindTarget()
+	 *
+	 *  Returns the shadow index of a texture target, or -1.
+	 ***********************************************************/
+	int FindTarget(GLenum target)
+	{
+		for (int index = 0; index < g_TrackedTargetCount; index++)
+		{
+			if (g_TrackedTargets[index] == target)
+				return(index);
+		}
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  FindCapability()
+	 *
+	 *  Returns the shadow index of a capability, or -1.
+	 ***********************************************************/
+	int FindCapability(GLenum capability)
+	{
+		for (int index = 0; index < g_TrackedCapabilityCount; index++)
+		{
+			if (g_TrackedCapabilities[index] == capability)
+				return(index);
+		}
+		return(-1);
+	}
+}
+
+/***********************************************************
+ *  Issue()
+ *
+ *  This method is used for counting a setter as sent to
+ *  OpenGL or dropped.
+ ***********************************************************/
+bool GLStateCache::Issue(bool bChanged)
+{
+	if (bChanged)
+	{
+		s_issuedCalls++;
+	}
+	else
+	{
+		s_elidedCalls++;
+	}
+
+	return(bChanged);
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This method is used for making a shader program current.
+ *  The shadowed uniform values belong to the previous
+ *  program, so they are forgotten.
+ ***********************************************************/
+void GLStateCache::UseProgram(GLuint program)
+{
+	if (Issue(g_program != program))
+	{
+		glUseProgram(program);
+		g_program = program;
+		g_uniforms.clear();
+	}
+}
+
+/***********************************************************
+ *  ActiveTexture()
+ *
+ *  This method is used for making a texture unit active.
+ ***********************************************************/
+void GLStateCache::ActiveTexture(GLuint unit)
+{
+	if (Issue(g_activeUnit != unit))
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		g_activeUnit = unit;
+	}
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for binding a texture to the active
+ *  texture unit.
+ ***********************************************************/
+void GLStateCache::BindTexture(GLenum target, GLuint texture)
+{
+	int targetIndex = FindTarget(target);
+	if ((targetIndex < 0) || (g_activeUnit >= g_MaxTrackedUnits))
+	{
+		Issue(true);
+		glBindTexture(target, texture);
+		return;
+	}
+
+	if (Issue(g_textures[g_activeUnit][targetIndex] != texture))
+	{
+		glBindTexture(target, texture);
+		g_textures[g_activeUnit][targetIndex] = texture;
+	}
+}
+
+/***********************************************************
+ *  BindTextureUnit()
+ *
+ *  This method is used for binding a texture to the given
+ *  texture unit.  The unit is only made active when the
+ *  binding changes.
+ ***********************************************************/
+void GLStateCache::BindTextureUnit(GLuint unit, GLenum target, GLuint texture)
+{
+	int targetIndex = FindTarget(target);
+	if ((targetIndex >= 0) && (unit < g_MaxTrackedUnits) &&
+		(g_textures[unit][targetIndex] == texture))
+	{
+		Issue(false);
+		return;
+	}
+
+	ActiveTexture(unit);
+	BindTexture(target, texture);
+}
+
+/***********************************************************
+ *  DeleteTextures()
+ *
+ *  This method is used for deleting textures.  OpenGL binds
+ *  0 wherever a deleted texture was bound.
+ ***********************************************************/
+void GLStateCache::DeleteTextures(GLsizei count, const GLuint* pTextures)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (GLuint unit = 0; unit < g_MaxTrackedUnits; unit++)
+		{
+			for (int target = 0; target < g_TrackedTargetCount; target++)
+			{
+				if (g_textures[unit][target] == pTextures[i])
+				{
+					g_textures[unit][target] = 0;
+				}
+			}
+		}
+	}
+	glDeleteTextures(count, pTextures);
+}
+
+/***********************************************************
+ *  BindVertexArray()
+ *
+ *  This method is used for binding a vertex array.
+ ***********************************************************/
+void GLStateCache::BindVertexArray(GLuint vertexArray)
+{
+	if (Issue(g_vertexArray != vertexArray))
+	{
+		glBindVertexArray(vertexArray);
+		g_vertexArray = vertexArray;
+	}
+}
+
+/***********************************************************
+ *  DeleteVertexArrays()
+ *
+ *  This method is used for deleting vertex arrays.  OpenGL
+ *  binds 0 when the bound one is deleted.
+ ***********************************************************/
+void GLStateCache::DeleteVertexArrays(GLsizei count, const GLuint* pVertexArrays)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (g_vertexArray == pVertexArrays[i])
+		{
+			g_vertexArray = 0;
+		}
+	}
+	glDeleteVertexArrays(count, pVertexArrays);
+}
+
+/***********************************************************
+ *  InvalidateVertexArray()
+ *
+ *  This method is used for forgetting the bound vertex array
+ *  after code outside of this class bound another one.
+ ***********************************************************/
+void GLStateCache::InvalidateVertexArray()
+{
+	g_vertexArray = g_UnknownValue;
+}
+
+/***********************************************************
+ *  SetCapability()
+ *
+ *  This method is used for enabling or disabling an OpenGL
+ *  capability.
+ ***********************************************************/
+void GLStateCache::SetCapability(GLenum capability, bool bEnabled)
+{
+	int capabilityIndex = FindCapability(capability);
+	int state = bEnabled ? 1 : 0;
+	if (Issue((capabilityIndex < 0) || (g_capabilities[capabilityIndex] != state)))
+	{
+		if (bEnabled)
+		{
+			glEnable(capability);
+		}
+		else
+		{
+			glDisable(capability);
+		}
+		if (capabilityIndex >= 0)
+		{
+			g_capabilities[capabilityIndex] = state;
+		}
+	}
+}
+
+/***********************************************************
+ *  Enable()
+ *
+ *  This method is used for enabling an OpenGL capability.
+ ***********************************************************/
+void GLStateCache::Enable(GLenum capability)
+{
+	SetCapability(capability, true);
+}
+
+/***********************************************************
+ *  Disable()
+ *
+ *  This method is used for disabling an OpenGL capability.
+ ***********************************************************/
+void GLStateCache::Disable(GLenum capability)
+{
+	SetCapability(capability, false);
+}
+
+/***********************************************************
+ *  BlendFunc()
+ *
+ *  This method is used for setting the blend factors.
+ ***********************************************************/
+void GLStateCache::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	if (Issue((g_blendSource != sourceFactor) || (g_blendDestination != destinationFactor)))
+	{
+		glBlendFunc(sourceFactor, destinationFactor);
+		g_blendSource = sourceFactor;
+		g_blendDestination = destinationFactor;
+	}
+}
+
+/***********************************************************
+ *  DepthFunc()
+ *
+ *  This method is used for setting the depth comparison.
+ ***********************************************************/
+void GLStateCache::DepthFunc(GLenum function)
+{
+	if (Issue(g_depthFunction != function))
+	{
+		glDepthFunc(function);
+		g_depthFunction = function;
+	}
+}
+
+/***********************************************************
+ *  DepthMask()
+ *
+ *  This method is used for enabling or disabling writes to
+ *  the depth buffer.
+ ***********************************************************/
+void GLStateCache::DepthMask(GLboolean bWrite)
+{
+	int state = (bWrite == GL_TRUE) ? 1 : 0;
+	if (Issue(g_depthMask != state))
+	{
+		glDepthMask(bWrite);
+		g_depthMask = state;
+	}
+}
+
+/***********************************************************
+ *  ClearColor()
+ *
+ *  This method is used for setting the color the color
+ *  buffer is cleared to.
+ ***********************************************************/
+void GLStateCache::ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+	GLfloat color[4] = { red, green, blue, alpha };
+	if (Issue((g_bClearColorKnown == false) || (memcmp(g_clearColor, color, sizeof(color)) != 0)))
+	{
+		glClearColor(red, green, blue, alpha);
+		memcpy(g_clearColor, color, sizeof(color));
+		g_bClearColorKnown = true;
+	}
+}
+
+/***********************************************************
+ *  UniformChanged()
+ *
+ *  This method is used for comparing a uniform value with
+ *  the last one set to the same location of the program in
+ *  use.  The values are compared bit for bit.
+ ***********************************************************/
+bool GLStateCache::UniformChanged(GLint location, const void* pValue, size_t size)
+{
+	if ((location < 0) || (location >= g_MaxTrackedUniforms) || (size > g_MaxUniformSize))
+	{
+		return(Issue(true));
+	}
+
+	if ((size_t)location >= g_uniforms.size())
+	{
+		UNIFORM_SHADOW unknown;
+		unknown.bKnown = false;
+		g_uniforms.resize((size_t)location + 1, unknown);
+	}
+
+	UNIFORM_SHADOW& shadow = g_uniforms[location];
+	if (shadow.bKnown && (memcmp(shadow.value, pValue, size) == 0))
+	{
+		return(Issue(false));
+	}
+
+	memcpy(shadow.value, pValue, size);
+	shadow.bKnown = true;
+	return(Issue(true));
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for forgetting all of the shadowed
+ *  state, so the next call of every setter reaches OpenGL.
+ ***********************************************************/
+void GLStateCache::Invalidate()
+{
+	ResetShadow();
+}
+
+/***********************************************************
+ *  TakeIssuedCalls()
+ *
+ *  This method is used for reading the number of calls sent
+ *  to OpenGL since the last call and starting the count
+ *  again.
+ ***********************************************************/
+uint32_t GLStateCache::TakeIssuedCalls()
+{
+	uint32_t calls = s_issuedCalls;
+	s_issuedCalls = 0;
+	return(calls);
+}
+
+/***********************************************************
+ *  TakeElidedCalls()
+ *
+ *  This method is used for reading the number of calls that
+ *  were dropped since the last call and starting the count
+ *  again.
+ ***********************************************************/
+uint32_t GLStateCache::TakeElidedCalls()
+{
+	uint32_t calls = s_elidedCalls;
+	s_elidedCalls = 0;
+	return(calls);
+}
@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.h
+// ============
+// skip OpenGL state changes that would not change anything
+//
+// The bound program, textures and vertex array, the enabled capabilities,
+// the blend, depth and clear state and the uniform values of the program in
+// use are shadowed here.  A call that sets the value OpenGL already has is
+// dropped and counted instead of being sent to the driver.
+//
+// The shadow is only right while every change to the tracked state goes
+// through this class.  Code that changes it behind its back, such as the
+// basic shape meshes binding their own vertex arrays, has to invalidate the
+// part it touched.  All calls have to come from the thread of the context.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  GLStateCache
+ *
+ *  This class contains the shadowed OpenGL state and the
+ *  setters that only call OpenGL when a value changes.
+ ***********************************************************/
+class GLStateCache
+{
+public:
+	// program in use
+	static void UseProgram(GLuint program);
+
+	// texture bound to the active unit, or to a given unit
+	static void BindTexture(GLenum target, GLuint texture);
+	static void BindTextureUnit(GLuint unit, GLenum target, GLuint texture);
+	// delete textures and forget where they were bound
+	static void DeleteTextures(GLsizei count, const GLuint* pTextures);
+
+	// vertex array in use
+	static void BindVertexArray(GLuint vertexArray);
+	static void DeleteVertexArrays(GLsizei count, const GLuint* pVertexArrays);
+	// the vertex array was bound without this class
+	static void InvalidateVertexArray();
+
+	// fixed function state
+	static void Enable(GLenum capability);
+	static void Disable(GLenum capability);
+	static void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+	static void DepthFunc(GLenum function);
+	static void DepthMask(GLboolean bWrite);
+	static void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+	// whether a uniform of the program in use has to be set
+	// to the given value, which is remembered when it does
+	static bool UniformChanged(GLint location, const void* pValue, size_t size);
+
+	// forget all of the shadowed state
+	static void Invalidate();
+
+	// number of calls sent and dropped since the last call,
+	// starting the counts again
+	static uint32_t TakeIssuedCalls();
+	static uint32_t TakeElidedCalls();
+
+private:
+	// count a setter that was sent or dropped, true when the
+	// call has to be sent
+	static bool Issue(bool bChanged);
+	// shadowed enable state of a capability
+	static void SetCapability(GLenum capability, bool bEnabled);
+	// make a texture unit active
+	static void ActiveTexture(GLuint unit);
+
+	static uint32_t s_issuedCalls;
+	static uint32_t s_elidedCalls;
+};
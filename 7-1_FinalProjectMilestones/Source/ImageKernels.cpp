@@ -0,0 +1,743 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagekernels.cpp
+// ============
+// vectorized pixel conversions for the texture load path
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ImageKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define IMAGE_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC emits the intrinsics of any instruction set
+#define IMAGE_KERNELS_SSE2
+#define IMAGE_KERNELS_AVX2
+#else
+#define IMAGE_KERNELS_SSE2 __attribute__((target("sse2")))
+#define IMAGE_KERNELS_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// declaration of global variables
+namespace
+{
+	// bytes per RGBA pixel
+	const int g_PixelSize = 4;
+	// entries of the linear to sRGB table
+	const int g_SRGBTableSize = 4096;
+
+	/***********************************************************
+	 *  DetectBestPath()
+	 *
+	 *  Returns the fastest path the processor and the operating
+	 *  system support.
+	 ***********************************************************/
+	IMAGE_KERNEL_PATH DetectBestPath()
+	{
+#if defined(IMAGE_KERNELS_X86) && defined(_MSC_VER)
+		int info[4] = { 0 };
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		bool bSSE2 = (info[3] & (1 << 26)) != 0;
+		bool bOSXSave = (info[2] & (1 << 27)) != 0;
+		bool bAVX = (info[2] & (1 << 28)) != 0;
+		if (bOSXSave && bAVX && (maxLeaf >= 7) && ((_xgetbv(0) & 6) == 6))
+		{
+			__cpuidex(info, 7, 0);
+			if ((info[1] & (1 << 5)) != 0)
+				return(IMAGE_KERNEL_AVX2);
+		}
+		return(bSSE2 ? IMAGE_KERNEL_SSE2 : IMAGE_KERNEL_SCALAR);
+#elif defined(IMAGE_KERNELS_X86)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return(IMAGE_KERNEL_AVX2);
+		return(__builtin_cpu_supports("sse2") ? IMAGE_KERNEL_SSE2 : IMAGE_KERNEL_SCALAR);
+#else
+		return(IMAGE_KERNEL_SCALAR);
+#endif
+	}
+
+	const IMAGE_KERNEL_PATH g_BestPath = DetectBestPath();
+	IMAGE_KERNEL_PATH g_Path = g_BestPath;
+
+	/***********************************************************
+	 *  SRGB_TABLES
+	 *
+	 *  Lookup tables of the sRGB transfer function, built once
+	 *  on first use.
+	 ***********************************************************/
+	struct SRGB_TABLES
+	{
+		float toLinear[256];
+		unsigned char toSRGB[g_SRGBTableSize];
+
+		SRGB_TABLES()
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				float value = (float)i / 255.0f;
+				toLinear[i] = (value <= 0.04045f) ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+			}
+			for (int i = 0; i < g_SRGBTableSize; i++)
+			{
+				float value = (float)i / (float)(g_SRGBTableSize - 1);
+				float srgb = (value <= 0.0031308f) ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+				toSRGB[i] = (unsigned char)(srgb * 255.0f + 0.5f);
+			}
+		}
+	};
+
+	const SRGB_TABLES& GetSRGBTables()
+	{
+		static const SRGB_TABLES tables;
+		return(tables);
+	}
+
+	/***********************************************************
+	 *  Scalar kernels
+	 ***********************************************************/
+	void FlipRowsScalar(unsigned char* pTop, unsigned char* pBottom, size_t rowBytes)
+	{
+		std::swap_ranges(pTop, pTop + rowBytes, pBottom);
+	}
+
+	void ExpandRGBScalar(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+	{
+		for (size_t i = 0; i < pixelCount; i++)
+		{
+			pDestination[i * 4 + 0] = pSource[i * 3 + 0];
+			pDestination[i * 4 + 1] = pSource[i * 3 + 1];
+			pDestination[i * 4 + 2] = pSource[i * 3 + 2];
+			pDestination[i * 4 + 3] = 255;
+		}
+	}
+
+	void ExpandGrayScalar(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+	{
+		for (size_t i = 0; i < pixelCount; i++)
+		{
+			pDestination[i * 4 + 0] = pSource[i];
+			pDestination[i * 4 + 1] = pSource[i];
+			pDestination[i * 4 + 2] = pSource[i];
+			pDestination[i * 4 + 3] = 255;
+		}
+	}
+
+	void ExpandGrayAlphaScalar(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+	{
+		for (size_t i = 0; i < pixelCount; i++)
+		{
+			pDestination[i * 4 + 0] = pSource[i * 2];
+			pDestination[i * 4 + 1] = pSource[i * 2];
+			pDestination[i * 4 + 2] = pSource[i * 2];
+			pDestination[i * 4 + 3] = pSource[i * 2 + 1];
+		}
+	}
+
+	void SRGBToLinearScalar(const unsigned char* pSource, float* pDestination, size_t count)
+	{
+		const float* pTable = GetSRGBTables().toLinear;
+		for (size_t i = 0; i < count; i++)
+		{
+			pDestination[i] = pTable[pSource[i]];
+		}
+	}
+
+	void LinearToSRGBScalar(const float* pSource, unsigned char* pDestination, size_t count)
+	{
+		const unsigned char* pTable = GetSRGBTables().toSRGB;
+		for (size_t i = 0; i < count; i++)
+		{
+			// written so that NaN lands on 0
+			float value = (pSource[i] > 0.0f) ? std::min(pSource[i], 1.0f) : 0.0f;
+			pDestination[i] = pTable[(int)(value * (float)(g_SRGBTableSize - 1) + 0.5f)];
+		}
+	}
+
+	// one output row from x onwards, rows already clamped
+	void DownsampleRowScalar(
+		const unsigned char* pRow0,
+		const unsigned char* pRow1,
+		int width,
+		unsigned char* pOut,
+		int x,
+		int levelWidth)
+	{
+		for (; x < levelWidth; x++)
+		{
+			int column0 = (x * 2 < width) ? x * 2 : width - 1;
+			int column1 = (x * 2 + 1 < width) ? x * 2 + 1 : width - 1;
+
+			const unsigned char* p00 = pRow0 + (size_t)column0 * g_PixelSize;
+			const unsigned char* p10 = pRow0 + (size_t)column1 * g_PixelSize;
+			const unsigned char* p01 = pRow1 + (size_t)column0 * g_PixelSize;
+			const unsigned char* p11 = pRow1 + (size_t)column1 * g_PixelSize;
+			unsigned char* pPixel = pOut + (size_t)x * g_PixelSize;
+
+			for (int channel = 0; channel < g_PixelSize; channel++)
+			{
+				pPixel[channel] = (unsigned char)((p00[channel] + p10[channel] + p01[channel] + p11[channel] + 2) / 4);
+			}
+		}
+	}
+
+#ifdef IMAGE_KERNELS_X86
+	/***********************************************************
+	 *  SSE2 kernels
+	 ***********************************************************/
+	IMAGE_KERNELS_SSE2
+	void FlipRowsSSE2(unsigned char* pTop, unsigned char* pBottom, size_t rowBytes)
+	{
+		size_t i = 0;
+		for (; i + 16 <= rowBytes; i += 16)
+		{
+			__m128i top = _mm_loadu_si128((const __m128i*)(pTop + i));
+			__m128i bottom = _mm_loadu_si128((const __m128i*)(pBottom + i));
+			_mm_storeu_si128((__m128i*)(pTop + i), bottom);
+			_mm_storeu_si128((__m128i*)(pBottom + i), top);
+		}
+		FlipRowsScalar(pTop + i, pBottom + i, rowBytes - i);
+	}
+
+	// SSE2 has no byte shuffle, so four pixels are gathered with
+	// 32 bit loads that read one byte past each pixel
+	IMAGE_KERNELS_SSE2
+	void ExpandRGBSSE2(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+	{
+		const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+		const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+		size_t i = 0;
+		for (; i + 5 <= pixelCount; i += 4)
+		{
+			int32_t p[4];
+			memcpy(p, pSource + i * 3, 4);
+			memcpy(p + 1, pSource + i * 3 + 3, 4);
+			memcpy(p + 2, pSource + i * 3 + 6, 4);
+			memcpy(p + 3, pSource + i * 3 + 9, 4);
+			__m128i pixels = _mm_set_epi32(p[3], p[2], p[1], p[0]);
+			pixels = _mm_or_si128(_mm_and_si128(pixels, rgbMask), alpha);
+			_mm_storeu_si128((__m128i*)(pDestination + i * 4), pixels);
+		}
+		ExpandRGBScalar(pSource + i * 3, pDestination + i * 4, pixelCount - i);
+	}
+
+	IMAGE_KERNELS_SSE2
+	void ExpandGraySSE2(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+	{
+		const __m128i alpha = _mm_set1_epi8((char)0xFF);
+
+		size_t i = 0;
+		for (; i + 16 <= pixelCount; i += 16)
+		{
+			__m128i gray = _mm_loadu_si128((const __m128i*)(pSource + i));
+			__m128i grayGrayLow = _mm_unpacklo_epi8(gray, gray);
+			__m128i grayGrayHigh = _mm_unpackhi_epi8(gray, gray);
+			__m128i grayAlphaLow = _mm_unpacklo_epi8(gray, alpha);
+			__m128i grayAlphaHigh = _mm_unpackhi_epi8(gray, alpha);
+
+			__m128i* pOut = (__m128i*)(pDestination + i * 4);
+			_mm_storeu_si128(pOut + 0, _mm_unpacklo_epi16(grayGrayLow, grayAlphaLow));
+			_mm_storeu_si128(pOut + 1, _mm_unpackhi_epi16(grayGrayLow, grayAlphaLow));
+			_mm_storeu_si128(pOut + 2, _mm_unpacklo_epi16(grayGrayHigh, grayAlphaHigh));
+			_mm_storeu_si128(pOut + 3, _mm_unpackhi_epi16(grayGrayHigh, grayAlphaHigh));
+		}
+		ExpandGrayScalar(pSource + i, pDestination + i * 4, pixelCount - i);
+	}
+
+	IMAGE_KERNELS_SSE2
+	void ExpandGrayAlphaSSE2(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+	{
+		const __m128i grayMask = _mm_set1_epi16(0x00FF);
+
+		size_t i = 0;
+		for (; i + 8 <= pixelCount; i += 8)
+		{
+			__m128i grayAlpha = _mm_loadu_si128((const __m128i*)(pSource + i * 2));
+			__m128i gray = _mm_and_si128(grayAlpha, grayMask);
+			__m128i grayGray = _mm_or_si128(gray, _mm_slli_epi16(gray, 8));
+
+			__m128i* pOut = (__m128i*)(pDestination + i * 4);
+			_mm_storeu_si128(pOut + 0, _mm_unpacklo_epi16(grayGray, grayAlpha));
+			_mm_storeu_si128(pOut + 1, _mm_unpackhi_epi16(grayGray, grayAlpha));
+		}
+		ExpandGrayAlphaScalar(pSource + i * 2, pDestination + i * 4, pixelCount - i);
+	}
+
+	// the table lookups stay scalar, SSE2 has no gather
+	IMAGE_KERNELS_SSE2
+	void LinearToSRGBSSE2(const float* pSource, unsigned char* pDestination, size_t count)
+	{
+		const unsigned char* pTable = GetSRGBTables().toSRGB;
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps((float)(g_SRGBTableSize - 1));
+		const __m128 half = _mm_set1_ps(0.5f);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			// max() with zero first so that NaN lands on 0; adding
+			// a half and truncating rounds like the scalar path,
+			// where _mm_cvtps_epi32 would round half to even
+			__m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSource + i), zero), one);
+			int32_t index[4];
+			_mm_storeu_si128((__m128i*)index, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half)));
+
+			pDestination[i + 0] = pTable[index[0]];
+			pDestination[i + 1] = pTable[index[1]];
+			pDestination[i + 2] = pTable[index[2]];
+			pDestination[i + 3] = pTable[index[3]];
+		}
+		LinearToSRGBScalar(pSource + i, pDestination + i, count - i);
+	}
+
+	// two output pixels from four input pixels of each row
+	IMAGE_KERNELS_SSE2
+	int DownsampleRowSSE2(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pOut, int levelWidth)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i rounding = _mm_set1_epi16(2);
+
+		int x = 0;
+		for (; x + 2 <= levelWidth; x += 2)
+		{
+			__m128i row0 = _mm_loadu_si128((const __m128i*)(pRow0 + (size_t)x * 2 * g_PixelSize));
+			__m128i row1 = _mm_loadu_si128((const __m128i*)(pRow1 + (size_t)x * 2 * g_PixelSize));
+
+			// pixels 0 and 1, and 2 and 3, as 16 bit column sums
+			__m128i sumLow = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+			__m128i sumHigh = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+			__m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(sumLow, sumHigh), _mm_unpackhi_epi64(sumLow, sumHigh));
+			sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+
+			_mm_storel_epi64((__m128i*)(pOut + (size_t)x * g_PixelSize), _mm_packus_epi16(sum, sum));
+		}
+		return(x);
+	}
+
+	/***********************************************************
+	 *  AVX2 kernels
+	 ***********************************************************/
+	IMAGE_KERNELS_AVX2
+	void FlipRowsAVX2(unsigned char* pTop, unsigned char* pBottom, size_t rowBytes)
+	{
+		size_t i = 0;
+		for (; i + 32 <= rowBytes; i += 32)
+		{
+			__m256i top = _mm256_loadu_si256((const __m256i*)(pTop + i));
+			__m256i bottom = _mm256_loadu_si256((const __m256i*)(pBottom + i));
+			_mm256_storeu_si256((__m256i*)(pTop + i), bottom);
+			_mm256_storeu_si256((__m256i*)(pBottom + i), top);
+		}
+		FlipRowsScalar(pTop + i, pBottom + i, rowBytes - i);
+	}
+
+	// eight pixels per step from a 32 byte load, so the loop
+	// stops while at least 32 source bytes are left
+	IMAGE_KERNELS_AVX2
+	void ExpandRGBAVX2(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+	{
+		// bytes 0-15 to the low lane and bytes 12-27 to the high lane
+		const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+		const __m256i shuffle = _mm256_setr_epi8(
+			0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+			0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+
+		size_t i = 0;
+		for (; i + 11 <= pixelCount; i += 8)
+		{
+			__m256i source = _mm256_loadu_si256((const __m256i*)(pSource + i * 3));
+			__m256i pixels = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(source, lanes), shuffle);
+			_mm256_storeu_si256((__m256i*)(pDestination + i * 4), _mm256_or_si256(pixels, alpha));
+		}
+		ExpandRGBSSE2(pSource + i * 3, pDestination + i * 4, pixelCount - i);
+	}
+
+	IMAGE_KERNELS_AVX2
+	void ExpandGrayAVX2(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+	{
+		const __m256i alpha = _mm256_set1_epi8((char)0xFF);
+
+		size_t i = 0;
+		for (; i + 32 <= pixelCount; i += 32)
+		{
+			// unpacking works within the lanes, so pixels 0-7 and 16-23
+			// go to the low lane and pixels 8-15 and 24-31 to the high
+			__m256i gray = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)(pSource + i)), 0xD8);
+			__m256i grayGrayLow = _mm256_unpacklo_epi8(gray, gray);
+			__m256i grayGrayHigh = _mm256_unpackhi_epi8(gray, gray);
+			__m256i grayAlphaLow = _mm256_unpacklo_epi8(gray, alpha);
+			__m256i grayAlphaHigh = _mm256_unpackhi_epi8(gray, alpha);
+
+			__m256i pixels0 = _mm256_unpacklo_epi16(grayGrayLow, grayAlphaLow);
+			__m256i pixels1 = _mm256_unpackhi_epi16(grayGrayLow, grayAlphaLow);
+			__m256i pixels2 = _mm256_unpacklo_epi16(grayGrayHigh, grayAlphaHigh);
+			__m256i pixels3 = _mm256_unpackhi_epi16(grayGrayHigh, grayAlphaHigh);
+
+			__m256i* pOut = (__m256i*)(pDestination + i * 4);
+			_mm256_storeu_si256(pOut + 0, _mm256_permute2x128_si256(pixels0, pixels1, 0x20));
+			_mm256_storeu_si256(pOut + 1, _mm256_permute2x128_si256(pixels0, pixels1, 0x31));
+			_mm256_storeu_si256(pOut + 2, _mm256_permute2x128_si256(pixels2, pixels3, 0x20));
+			_mm256_storeu_si256(pOut + 3, _mm256_permute2x128_si256(pixels2, pixels3, 0x31));
+		}
+		ExpandGraySSE2(pSource + i, pDestination + i * 4, pixelCount - i);
+	}
+
+	IMAGE_KERNELS_AVX2
+	void ExpandGrayAlphaAVX2(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+	{
+		const __m256i grayMask = _mm256_set1_epi16(0x00FF);
+
+		size_t i = 0;
+		for (; i + 16 <= pixelCount; i += 16)
+		{
+			// pixels 0-3 and 8-11 to the low lane, 4-7 and 12-15 to the high
+			__m256i grayAlpha = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)(pSource + i * 2)), 0xD8);
+			__m256i gray = _mm256_and_si256(grayAlpha, grayMask);
+			__m256i grayGray = _mm256_or_si256(gray, _mm256_slli_epi16(gray, 8));
+
+			__m256i* pOut = (__m256i*)(pDestination + i * 4);
+			_mm256_storeu_si256(pOut + 0, _mm256_unpacklo_epi16(grayGray, grayAlpha));
+			_mm256_storeu_si256(pOut + 1, _mm256_unpackhi_epi16(grayGray, grayAlpha));
+		}
+		ExpandGrayAlphaSSE2(pSource + i * 2, pDestination + i * 4, pixelCount - i);
+	}
+
+	IMAGE_KERNELS_AVX2
+	void SRGBToLinearAVX2(const unsigned char* pSource, float* pDestination, size_t count)
+	{
+		const float* pTable = GetSRGBTables().toLinear;
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(pSource + i)));
+			_mm256_storeu_ps(pDestination + i, _mm256_i32gather_ps(pTable, index, 4));
+		}
+		SRGBToLinearScalar(pSource + i, pDestination + i, count - i);
+	}
+
+	IMAGE_KERNELS_AVX2
+	void LinearToSRGBAVX2(const float* pSource, unsigned char* pDestination, size_t count)
+	{
+		const unsigned char* pTable = GetSRGBTables().toSRGB;
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 scale = _mm256_set1_ps((float)(g_SRGBTableSize - 1));
+		const __m256 half = _mm256_set1_ps(0.5f);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 value = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(pSource + i), zero), one);
+			int32_t index[8];
+			_mm256_storeu_si256((__m256i*)index, _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, scale), half)));
+
+			for (int j = 0; j < 8; j++)
+			{
+				pDestination[i + j] = pTable[index[j]];
+			}
+		}
+		LinearToSRGBSSE2(pSource + i, pDestination + i, count - i);
+	}
+
+	// four output pixels from eight input pixels of each row
+	IMAGE_KERNELS_AVX2
+	int DownsampleRowAVX2(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pOut, int levelWidth)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i rounding = _mm256_set1_epi16(2);
+
+		int x = 0;
+		for (; x + 4 <= levelWidth; x += 4)
+		{
+			__m256i row0 = _mm256_loadu_si256((const __m256i*)(pRow0 + (size_t)x * 2 * g_PixelSize));
+			__m256i row1 = _mm256_loadu_si256((const __m256i*)(pRow1 + (size_t)x * 2 * g_PixelSize));
+
+			// per lane the same sums as the SSE2 version
+			__m256i sumLow = _mm256_add_epi16(_mm256_unpacklo_epi8(row0, zero), _mm256_unpacklo_epi8(row1, zero));
+			__m256i sumHigh = _mm256_add_epi16(_mm256_unpackhi_epi8(row0, zero), _mm256_unpackhi_epi8(row1, zero));
+			__m256i sum = _mm256_add_epi16(_mm256_unpacklo_epi64(sumLow, sumHigh), _mm256_unpackhi_epi64(sumLow, sumHigh));
+			sum = _mm256_srli_epi16(_mm256_add_epi16(sum, rounding), 2);
+
+			// the packed pixels are in the low half of each lane
+			__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(sum, sum), 0x08);
+			_mm_storeu_si128((__m128i*)(pOut + (size_t)x * g_PixelSize), _mm256_castsi256_si128(packed));
+		}
+		return(x + DownsampleRowSSE2(pRow0 + (size_t)x * 2 * g_PixelSize, pRow1 + (size_t)x * 2 * g_PixelSize,
+			pOut + (size_t)x * g_PixelSize, levelWidth - x));
+	}
+#endif
+}
+
+/***********************************************************
+ *  GetBestPath()
+ *
+ *  This method is used for getting the fastest path of the
+ *  processor.
+ ***********************************************************/
+IMAGE_KERNEL_PATH ImageKernels::GetBestPath()
+{
+	return(g_BestPath);
+}
+
+/***********************************************************
+ *  GetPath()
+ *
+ *  This method is used for getting the path in use.
+ ***********************************************************/
+IMAGE_KERNEL_PATH ImageKernels::GetPath()
+{
+	return(g_Path);
+}
+
+/***********************************************************
+ *  SetPath()
+ *
+ *  This method is used for switching the path of all of the
+ *  kernels.  It is not meant to be called while images are
+ *  being decoded.
+ ***********************************************************/
+void ImageKernels::SetPath(IMAGE_KERNEL_PATH path)
+{
+	g_Path = (path < g_BestPath) ? path : g_BestPath;
+}
+
+/***********************************************************
+ *  GetPathName()
+ *
+ *  This method is used for getting the name of a path.
+ ***********************************************************/
+const char* ImageKernels::GetPathName(IMAGE_KERNEL_PATH path)
+{
+	switch (path)
+	{
+	case IMAGE_KERNEL_AVX2:
+		return("avx2");
+	case IMAGE_KERNEL_SSE2:
+		return("sse2");
+	default:
+		return("scalar");
+	}
+}
+
+/***********************************************************
+ *  FlipRows()
+ *
+ *  This method is used for turning an image upside down by
+ *  swapping its rows from the outside in.
+ ***********************************************************/
+void ImageKernels::FlipRows(unsigned char* pPixels, size_t rowBytes, int rowCount)
+{
+	for (int row = 0; row < rowCount / 2; row++)
+	{
+		unsigned char* pTop = pPixels + (size_t)row * rowBytes;
+		unsigned char* pBottom = pPixels + (size_t)(rowCount - 1 - row) * rowBytes;
+
+#ifdef IMAGE_KERNELS_X86
+		if (g_Path == IMAGE_KERNEL_AVX2)
+		{
+			FlipRowsAVX2(pTop, pBottom, rowBytes);
+			continue;
+		}
+		if (g_Path == IMAGE_KERNEL_SSE2)
+		{
+			FlipRowsSSE2(pTop, pBottom, rowBytes);
+			continue;
+		}
+#endif
+		FlipRowsScalar(pTop, pBottom, rowBytes);
+	}
+}
+
+/***********************************************************
+ *  ConvertToRGBA()
+ *
+ *  This method is used for expanding decoded pixels of any
+ *  channel count stb_image returns to RGBA.
+ ***********************************************************/
+bool ImageKernels::ConvertToRGBA(const unsigned char* pSource, int channels, unsigned char* pDestination, size_t pixelCount)
+{
+	switch (channels)
+	{
+	case 1:
+		ExpandGrayToRGBA(pSource, pDestination, pixelCount);
+		return(true);
+	case 2:
+		ExpandGrayAlphaToRGBA(pSource, pDestination, pixelCount);
+		return(true);
+	case 3:
+		ExpandRGBToRGBA(pSource, pDestination, pixelCount);
+		return(true);
+	case 4:
+		memcpy(pDestination, pSource, pixelCount * g_PixelSize);
+		return(true);
+	default:
+		return(false);
+	}
+}
+
+/***********************************************************
+ *  ExpandRGBToRGBA()
+ *
+ *  This method is used for adding an opaque alpha channel to
+ *  RGB pixels.
+ ***********************************************************/
+void ImageKernels::ExpandRGBToRGBA(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+{
+#ifdef IMAGE_KERNELS_X86
+	if (g_Path == IMAGE_KERNEL_AVX2)
+	{
+		ExpandRGBAVX2(pSource, pDestination, pixelCount);
+		return;
+	}
+	if (g_Path == IMAGE_KERNEL_SSE2)
+	{
+		ExpandRGBSSE2(pSource, pDestination, pixelCount);
+		return;
+	}
+#endif
+	ExpandRGBScalar(pSource, pDestination, pixelCount);
+}
+
+/***********************************************************
+ *  ExpandGrayToRGBA()
+ *
+ *  This method is used for turning grayscale pixels into
+ *  opaque RGBA pixels.
+ ***********************************************************/
+void ImageKernels::ExpandGrayToRGBA(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+{
+#ifdef IMAGE_KERNELS_X86
+	if (g_Path == IMAGE_KERNEL_AVX2)
+	{
+		ExpandGrayAVX2(pSource, pDestination, pixelCount);
+		return;
+	}
+	if (g_Path == IMAGE_KERNEL_SSE2)
+	{
+		ExpandGraySSE2(pSource, pDestination, pixelCount);
+		return;
+	}
+#endif
+	ExpandGrayScalar(pSource, pDestination, pixelCount);
+}
+
+/***********************************************************
+ *  ExpandGrayAlphaToRGBA()
+ *
+ *  This method is used for turning grayscale pixels with an
+ *  alpha channel into RGBA pixels.
+ ***********************************************************/
+void ImageKernels::ExpandGrayAlphaToRGBA(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount)
+{
+#ifdef IMAGE_KERNELS_X86
+	if (g_Path == IMAGE_KERNEL_AVX2)
+	{
+		ExpandGrayAlphaAVX2(pSource, pDestination, pixelCount);
+		return;
+	}
+	if (g_Path == IMAGE_KERNEL_SSE2)
+	{
+		ExpandGrayAlphaSSE2(pSource, pDestination, pixelCount);
+		return;
+	}
+#endif
+	ExpandGrayAlphaScalar(pSource, pDestination, pixelCount);
+}
+
+/***********************************************************
+ *  SRGBToLinear()
+ *
+ *  This method is used for decoding 8 bit sRGB values into
+ *  linear values with a lookup table.  Only AVX2 can gather
+ *  from the table, SSE2 runs the scalar loop.
+ ***********************************************************/
+void ImageKernels::SRGBToLinear(const unsigned char* pSource, float* pDestination, size_t count)
+{
+#ifdef IMAGE_KERNELS_X86
+	if (g_Path == IMAGE_KERNEL_AVX2)
+	{
+		SRGBToLinearAVX2(pSource, pDestination, count);
+		return;
+	}
+#endif
+	SRGBToLinearScalar(pSource, pDestination, count);
+}
+
+/***********************************************************
+ *  LinearToSRGB()
+ *
+ *  This method is used for encoding linear values into 8 bit
+ *  sRGB.  The values are clamped and scaled into a lookup
+ *  table fine enough to be off by at most one step.
+ ***********************************************************/
+void ImageKernels::LinearToSRGB(const float* pSource, unsigned char* pDestination, size_t count)
+{
+#ifdef IMAGE_KERNELS_X86
+	if (g_Path == IMAGE_KERNEL_AVX2)
+	{
+		LinearToSRGBAVX2(pSource, pDestination, count);
+		return;
+	}
+	if (g_Path == IMAGE_KERNEL_SSE2)
+	{
+		LinearToSRGBSSE2(pSource, pDestination, count);
+		return;
+	}
+#endif
+	LinearToSRGBScalar(pSource, pDestination, count);
+}
+
+/***********************************************************
+ *  DownsampleBox()
+ *
+ *  This method is used for making the next mip level of RGBA
+ *  pixels by averaging each 2x2 block.  A side that is
+ *  already 1 pixel stays 1 pixel, which the scalar loop
+ *  handles along with the pixels left over by the vector
+ *  loops.
+ ***********************************************************/
+void ImageKernels::DownsampleBox(const unsigned char* pPixels, int width, int height, unsigned char* pLevel)
+{
+	int levelWidth = (width > 1) ? width / 2 : 1;
+	int levelHeight = (height > 1) ? height / 2 : 1;
+	size_t rowBytes = (size_t)width * g_PixelSize;
+
+	for (int y = 0; y < levelHeight; y++)
+	{
+		int row0 = (y * 2 < height) ? y * 2 : height - 1;
+		int row1 = (y * 2 + 1 < height) ? y * 2 + 1 : height - 1;
+		const unsigned char* pRow0 = pPixels + (size_t)row0 * rowBytes;
+		const unsigned char* pRow1 = pPixels + (size_t)row1 * rowBytes;
+		unsigned char* pOut = pLevel + (size_t)y * levelWidth * g_PixelSize;
+
+		int x = 0;
+#ifdef IMAGE_KERNELS_X86
+		if (width > 1)
+		{
+			if (g_Path == IMAGE_KERNEL_AVX2)
+			{
+				x = DownsampleRowAVX2(pRow0, pRow1, pOut, levelWidth);
+			}
+			else if (g_Path == IMAGE_KERNEL_SSE2)
+			{
+				x = DownsampleRowSSE2(pRow0, pRow1, pOut, levelWidth);
+			}
+		}
+#endif
+		DownsampleRowScalar(pRow0, pRow1, width, pOut, x, levelWidth);
+	}
+}
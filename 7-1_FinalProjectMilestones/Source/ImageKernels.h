@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagekernels.h
+// ============
+// vectorized pixel conversions for the texture load path
+//
+// Every kernel has a scalar version and SSE2 and AVX2 versions on x86.  The
+// fastest path the processor supports is picked once at startup, and the
+// benchmarks can force a slower path to compare them.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  IMAGE_KERNEL_PATH
+ *
+ *  Instruction set the kernels run with.
+ ***********************************************************/
+enum IMAGE_KERNEL_PATH
+{
+	IMAGE_KERNEL_SCALAR = 0,
+	IMAGE_KERNEL_SSE2,
+	IMAGE_KERNEL_AVX2
+};
+
+/***********************************************************
+ *  ImageKernels
+ *
+ *  This class contains the conversions applied to decoded
+ *  images before they are uploaded.
+ ***********************************************************/
+class ImageKernels
+{
+public:
+	// fastest path of the processor, and the path in use
+	static IMAGE_KERNEL_PATH GetBestPath();
+	static IMAGE_KERNEL_PATH GetPath();
+	// use another path, limited to the fastest one
+	static void SetPath(IMAGE_KERNEL_PATH path);
+	static const char* GetPathName(IMAGE_KERNEL_PATH path);
+
+	// turn the rows of an image upside down in place
+	static void FlipRows(unsigned char* pPixels, size_t rowBytes, int rowCount);
+
+	// expand 1, 2, 3 or 4 channel pixels to RGBA, false for
+	// any other channel count
+	static bool ConvertToRGBA(const unsigned char* pSource, int channels, unsigned char* pDestination, size_t pixelCount);
+	static void ExpandRGBToRGBA(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount);
+	static void ExpandGrayToRGBA(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount);
+	static void ExpandGrayAlphaToRGBA(const unsigned char* pSource, unsigned char* pDestination, size_t pixelCount);
+
+	// convert between 8 bit sRGB and linear 0 to 1 values
+	static void SRGBToLinear(const unsigned char* pSource, float* pDestination, size_t count);
+	static void LinearToSRGB(const float* pSource, unsigned char* pDestination, size_t count);
+
+	// average 2x2 blocks of RGBA pixels into the next mip level,
+	// which is half the size with a side of at least 1 pixel
+	static void DownsampleBox(const unsigned char* pPixels, int width, int height, unsigned char* pLevel);
+};
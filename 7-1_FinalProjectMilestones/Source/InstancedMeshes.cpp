@@ -0,0 +1,772 @@
+///////////////////////////////////////////////////////////////////////////////
+// instancedmeshes.cpp
+// ============
+// draw many copies of the basic 3D shapes with one draw call
+///////////////////////////////////////////////////////////////////////////////
+
+#include "InstancedMeshes.h"
+#include "GLStateCache.h"
+
+#include <cstddef>
+
+// declaration of global variables
+namespace
+{
+	// vertex attribute locations, matching the vertex shader
+	const GLuint ATTRIBUTE_POSITION = 0;
+	const GLuint ATTRIBUTE_NORMAL = 1;
+	const GLuint ATTRIBUTE_TEXCOORD = 2;
+	const GLuint ATTRIBUTE_INSTANCE_MODEL = 3;	// uses locations 3 to 6
+	const GLuint ATTRIBUTE_INSTANCE_COLOR = 7;
+	const GLuint ATTRIBUTE_INSTANCE_MATERIAL = 8;
+	const GLuint ATTRIBUTE_INSTANCE_TEXTURE_LAYER = 9;
+	const GLuint ATTRIBUTE_MESH_BOX = 10;
+
+	// texture unit of the mesh boxes, above the texture arrays
+	const GLuint g_MeshBoxUnit = 31;
+
+	// starting sizes of the shared buffers, they double when full
+	const uint32_t g_InitialVertexCapacity = 8192;
+	const uint32_t g_InitialIndexCapacity = 32768;
+
+	/***********************************************************
+	 *  GetIndexType()
+	 *
+	 *  Returns the OpenGL type of indices of the given size.
+	 ***********************************************************/
+	GLenum GetIndexType(uint32_t indexSize)
+	{
+		return((indexSize == sizeof(uint16_t)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+	}
+}
+
+/***********************************************************
+ *  InstancedMeshes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+InstancedMeshes::InstancedMeshes()
+{
+	MESH_RANGE emptyRange = { 0, 0, 0, 0, 0, sizeof(uint32_t) };
+	m_meshes.assign(SCENE_MESH_COUNT, emptyRange);
+	m_vao = 0;
+	m_bPackedVertices = false;
+	m_vertexBuffer = 0;
+	m_vertexCount = 0;
+	m_vertexCapacity = 0;
+	m_indexBuffer = 0;
+	m_indexBytes = 0;
+	m_indexByteCapacity = 0;
+	m_meshBoxBuffer = 0;
+	m_meshBoxTexture = 0;
+	m_instanceBuffer = 0;
+	m_instanceCapacity = 0;
+	m_indirectBuffer = 0;
+	m_indirectCapacity = 0;
+	m_bMultiDrawIndirect = false;
+}
+
+/***********************************************************
+ *  ~InstancedMeshes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+InstancedMeshes::~InstancedMeshes()
+{
+	if (m_vao != 0)
+	{
+		GLuint buffers[4] = { m_vertexBuffer, m_indexBuffer, m_instanceBuffer, m_indirectBuffer };
+
+		GLStateCache::DeleteVertexArrays(1, &m_vao);
+		glDeleteBuffers(4, buffers);
+	}
+	if (m_meshBoxTexture != 0)
+	{
+		glDeleteTextures(1, &m_meshBoxTexture);
+		glDeleteBuffers(1, &m_meshBoxBuffer);
+	}
+}
+
+/***********************************************************
+ *  SetPackedVertices()
+ *
+ *  This method is used for choosing the packed vertex
+ *  layout.  Once the buffers exist the layout stays.
+ ***********************************************************/
+void InstancedMeshes::SetPackedVertices(bool bPacked)
+{
+	if (m_vao == 0)
+	{
+		m_bPackedVertices = bPacked;
+	}
+}
+
+/***********************************************************
+ *  GetMeshBoxUnit()
+ *
+ *  This method is used for getting the texture unit the
+ *  meshBoxes sampler of the vertex shader is set to.
+ ***********************************************************/
+GLuint InstancedMeshes::GetMeshBoxUnit()
+{
+	return(g_MeshBoxUnit);
+}
+
+/***********************************************************
+ *  GetVertexSize()
+ *
+ *  This method is used for getting the bytes of a vertex in
+ *  the layout of the shared buffer.
+ ***********************************************************/
+uint32_t InstancedMeshes::GetVertexSize() const
+{
+	return(m_bPackedVertices ? (uint32_t)sizeof(PACKED_VERTEX) : (uint32_t)sizeof(MESH_VERTEX));
+}
+
+/***********************************************************
+ *  LoadPlaneMesh()
+ *
+ *  This method is used for loading the plane mesh.
+ ***********************************************************/
+void InstancedMeshes::LoadPlaneMesh()
+{
+	MESH_DATA meshData;
+	MeshGeometry::GeneratePlane(meshData);
+	ReplaceMesh(SCENE_MESH_PLANE, meshData);
+}
+
+/***********************************************************
+ *  LoadBoxMesh()
+ *
+ *  This method is used for loading the box mesh.
+ ***********************************************************/
+void InstancedMeshes::LoadBoxMesh()
+{
+	MESH_DATA meshData;
+	MeshGeometry::GenerateBox(meshData);
+	ReplaceMesh(SCENE_MESH_BOX, meshData);
+}
+
+/***********************************************************
+ *  LoadCylinderMesh()
+ *
+ *  This method is used for loading the cylinder mesh.
+ ***********************************************************/
+void InstancedMeshes::LoadCylinderMesh()
+{
+	MESH_DATA meshData;
+	MeshGeometry::GenerateCylinder(meshData);
+	ReplaceMesh(SCENE_MESH_CYLINDER, meshData);
+}
+
+/***********************************************************
+ *  LoadTorusMesh()
+ *
+ *  This method is used for loading the torus mesh.
+ ***********************************************************/
+void InstancedMeshes::LoadTorusMesh()
+{
+	MESH_DATA meshData;
+	MeshGeometry::GenerateTorus(meshData);
+	ReplaceMesh(SCENE_MESH_TORUS, meshData);
+}
+
+/***********************************************************
+ *  DrawPlaneMeshInstanced()
+ *
+ *  This method is used for drawing one plane per instance.
+ ***********************************************************/
+void InstancedMeshes::DrawPlaneMeshInstanced(const INSTANCE_DATA* pInstances, uint32_t instanceCount)
+{
+	UploadInstances(pInstances, instanceCount);
+	DrawMeshInstances(SCENE_MESH_PLANE, 0, instanceCount);
+}
+
+/***********************************************************
+ *  DrawBoxMeshInstanced()
+ *
+ *  This method is used for drawing one box per instance.
+ ***********************************************************/
+void InstancedMeshes::DrawBoxMeshInstanced(const INSTANCE_DATA* pInstances, uint32_t instanceCount)
+{
+	UploadInstances(pInstances, instanceCount);
+	DrawMeshInstances(SCENE_MESH_BOX, 0, instanceCount);
+}
+
+/***********************************************************
+ *  DrawCylinderMeshInstanced()
+ *
+ *  This method is used for drawing one cylinder per
+ *  instance.
+ ***********************************************************/
+void InstancedMeshes::DrawCylinderMeshInstanced(const INSTANCE_DATA* pInstances, uint32_t instanceCount)
+{
+	UploadInstances(pInstances, instanceCount);
+	DrawMeshInstances(SCENE_MESH_CYLINDER, 0, instanceCount);
+}
+
+/***********************************************************
+ *  DrawTorusMeshInstanced()
+ *
+ *  This method is used for drawing one torus per instance.
+ ***********************************************************/
+void InstancedMeshes::DrawTorusMeshInstanced(const INSTANCE_DATA* pInstances, uint32_t instanceCount)
+{
+	UploadInstances(pInstances, instanceCount);
+	DrawMeshInstances(SCENE_MESH_TORUS, 0, instanceCount);
+}
+
+/***********************************************************
+ *  UploadInstances()
+ *
+ *  This method is used for copying the per-instance data
+ *  into the shared instance buffer.  The buffer is orphaned
+ *  on every upload so the driver never has to wait for the
+ *  previous frame's draws to finish reading it.
+ ***********************************************************/
+void InstancedMeshes::UploadInstances(const INSTANCE_DATA* pInstances, uint32_t instanceCount)
+{
+	if (m_instanceBuffer == 0)
+	{
+		return;
+	}
+
+	if (instanceCount > m_instanceCapacity)
+	{
+		m_instanceCapacity = instanceCount;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_instanceCapacity * sizeof(INSTANCE_DATA), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)instanceCount * sizeof(INSTANCE_DATA), pInstances);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/***********************************************************
+ *  DrawMeshInstances()
+ *
+ *  This method is used for drawing a range of the uploaded
+ *  instances with one instanced draw call.  Without base
+ *  instance draws the instance attributes are pointed at
+ *  the first instance of the range instead.
+ ***********************************************************/
+void InstancedMeshes::DrawMeshInstances(uint32_t meshType, uint32_t firstInstance, uint32_t instanceCount)
+{
+	if ((meshType >= m_meshes.size()) || (m_meshes[meshType].indexCount == 0) || (instanceCount == 0))
+	{
+		return;
+	}
+
+	const MESH_RANGE& range = m_meshes[meshType];
+
+	GLStateCache::BindVertexArray(m_vao);
+	if (m_bMultiDrawIndirect == true)
+	{
+		glDrawElementsInstancedBaseVertexBaseInstance(
+			GL_TRIANGLES, range.indexCount, GetIndexType(range.indexSize),
+			(void*)((size_t)range.firstIndex * range.indexSize),
+			instanceCount, range.baseVertex, firstInstance);
+	}
+	else
+	{
+		BindInstanceAttributes(firstInstance);
+		glDrawElementsInstancedBaseVertex(
+			GL_TRIANGLES, range.indexCount, GetIndexType(range.indexSize),
+			(void*)((size_t)range.firstIndex * range.indexSize),
+			instanceCount, range.baseVertex);
+	}
+}
+
+/***********************************************************
+ *  ClearIndirectDraws()
+ *
+ *  This method is used for removing the indirect draw
+ *  commands of the previous frame.
+ ***********************************************************/
+void InstancedMeshes::ClearIndirectDraws()
+{
+	m_indirectCommands.clear();
+	m_indirectIndexSizes.clear();
+}
+
+/***********************************************************
+ *  AddIndirectDraw()
+ *
+ *  This method is used for adding an instanced draw of a
+ *  range of the uploaded instances to the indirect commands.
+ *  The index of the command is returned.
+ ***********************************************************/
+uint32_t InstancedMeshes::AddIndirectDraw(uint32_t meshType, uint32_t firstInstance, uint32_t instanceCount)
+{
+	DRAW_INDIRECT_COMMAND command = { 0, 0, 0, 0, 0 };
+	uint32_t indexSize = sizeof(uint32_t);
+
+	if (meshType < m_meshes.size())
+	{
+		command.count = m_meshes[meshType].indexCount;
+		command.instanceCount = instanceCount;
+		command.firstIndex = m_meshes[meshType].firstIndex;
+		command.baseVertex = (int32_t)m_meshes[meshType].baseVertex;
+		command.baseInstance = firstInstance;
+		indexSize = m_meshes[meshType].indexSize;
+	}
+
+	m_indirectCommands.push_back(command);
+	m_indirectIndexSizes.push_back((uint8_t)indexSize);
+	return((uint32_t)m_indirectCommands.size() - 1);
+}
+
+/***********************************************************
+ *  UploadIndirectDraws()
+ *
+ *  This method is used for copying the indirect commands of
+ *  the frame into the indirect buffer.
+ ***********************************************************/
+void InstancedMeshes::UploadIndirectDraws()
+{
+	if ((m_bMultiDrawIndirect == false) || (m_indirectCommands.empty()))
+	{
+		return;
+	}
+
+	uint32_t commandCount = (uint32_t)m_indirectCommands.size();
+	if (commandCount > m_indirectCapacity)
+	{
+		m_indirectCapacity = commandCount;
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)m_indirectCapacity * sizeof(DRAW_INDIRECT_COMMAND), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, (GLsizeiptr)commandCount * sizeof(DRAW_INDIRECT_COMMAND), m_indirectCommands.data());
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+/***********************************************************
+ *  DrawIndirect()
+ *
+ *  This method is used for drawing a range of the uploaded
+ *  indirect commands with one glMultiDrawElementsIndirect
+ *  call.  Each command's base instance selects its instances,
+ *  so the shader needs no draw ID.  A multi-draw takes one
+ *  index type, so the range is split where packed meshes
+ *  with 16-bit and 32-bit indices meet.  Without multi-draw
+ *  support the commands are drawn one at a time.  Returns
+ *  the number of draw calls made.
+ ***********************************************************/
+uint32_t InstancedMeshes::DrawIndirect(uint32_t firstCommand, uint32_t commandCount)
+{
+	uint32_t drawCalls = 0;
+
+	if ((commandCount == 0) || (firstCommand + commandCount > m_indirectCommands.size()))
+	{
+		return(drawCalls);
+	}
+
+	GLStateCache::BindVertexArray(m_vao);
+	if (m_bMultiDrawIndirect == true)
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+		uint32_t endCommand = firstCommand + commandCount;
+		uint32_t runStart = firstCommand;
+		while (runStart < endCommand)
+		{
+			uint32_t runEnd = runStart + 1;
+			while ((runEnd < endCommand) && (m_indirectIndexSizes[runEnd] == m_indirectIndexSizes[runStart]))
+			{
+				runEnd++;
+			}
+			glMultiDrawElementsIndirect(
+				GL_TRIANGLES, GetIndexType(m_indirectIndexSizes[runStart]),
+				(void*)((size_t)runStart * sizeof(DRAW_INDIRECT_COMMAND)),
+				runEnd - runStart, 0);
+			drawCalls++;
+			runStart = runEnd;
+		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+	else
+	{
+		for (uint32_t i = firstCommand; i < firstCommand + commandCount; i++)
+		{
+			const DRAW_INDIRECT_COMMAND& command = m_indirectCommands[i];
+
+			uint32_t indexSize = m_indirectIndexSizes[i];
+
+			BindInstanceAttributes(command.baseInstance);
+			glDrawElementsInstancedBaseVertex(
+				GL_TRIANGLES, command.count, GetIndexType(indexSize),
+				(void*)((size_t)command.firstIndex * indexSize),
+				command.instanceCount, command.baseVertex);
+			drawCalls++;
+		}
+	}
+
+	return(drawCalls);
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for adding a mesh after the basic
+ *  shapes.  The returned mesh type is used for drawing it.
+ ***********************************************************/
+uint32_t InstancedMeshes::AddMesh(const MESH_DATA& meshData)
+{
+	return(AddMesh(meshData.vertices.data(), (uint32_t)meshData.vertices.size(),
+		meshData.indices.data(), (uint32_t)meshData.indices.size()));
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for adding a mesh from vertices and
+ *  indices that are not held in a mesh, like a mapped mesh
+ *  cache.
+ ***********************************************************/
+uint32_t InstancedMeshes::AddMesh(const MESH_VERTEX* pVertices, uint32_t vertexCount, const uint32_t* pIndices, uint32_t indexCount)
+{
+	MESH_RANGE emptyRange = { 0, 0, 0, 0, 0, sizeof(uint32_t) };
+	uint32_t meshType = (uint32_t)m_meshes.size();
+
+	m_meshes.push_back(emptyRange);
+	UploadMesh(meshType, pVertices, vertexCount, pIndices, indexCount);
+	return(meshType);
+}
+
+/***********************************************************
+ *  ReplaceMesh()
+ *
+ *  This method is used for replacing the vertex and index
+ *  data of a mesh.
+ ***********************************************************/
+void InstancedMeshes::ReplaceMesh(uint32_t meshType, const MESH_DATA& meshData)
+{
+	ReplaceMesh(meshType, meshData.vertices.data(), (uint32_t)meshData.vertices.size(),
+		meshData.indices.data(), (uint32_t)meshData.indices.size());
+}
+
+/***********************************************************
+ *  ReplaceMesh()
+ *
+ *  This method is used for replacing the data of a mesh
+ *  with vertices and indices that are not held in a mesh.
+ ***********************************************************/
+void InstancedMeshes::ReplaceMesh(uint32_t meshType, const MESH_VERTEX* pVertices, uint32_t vertexCount, const uint32_t* pIndices, uint32_t indexCount)
+{
+	if (meshType < m_meshes.size())
+	{
+		UploadMesh(meshType, pVertices, vertexCount, pIndices, indexCount);
+	}
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing a mesh once, positioned
+ *  by the model matrix uniform instead of an instance.  The
+ *  vertex array stays bound, so drawing the next mesh from
+ *  the shared buffers does not bind it again.
+ ***********************************************************/
+void InstancedMeshes::DrawMesh(uint32_t meshType)
+{
+	if ((meshType >= m_meshes.size()) || (m_meshes[meshType].indexCount == 0))
+	{
+		return;
+	}
+
+	const MESH_RANGE& range = m_meshes[meshType];
+
+	GLStateCache::BindVertexArray(m_vao);
+	glDrawElementsBaseVertex(
+		GL_TRIANGLES, range.indexCount, GetIndexType(range.indexSize),
+		(void*)((size_t)range.firstIndex * range.indexSize),
+		range.baseVertex);
+}
+
+/***********************************************************
+ *  CreateBuffers()
+ *
+ *  This method is used for creating the vertex array and the
+ *  shared vertex, index, instance and indirect buffers, and
+ *  for the packed layout the buffer texture of mesh boxes.
+ *  Nothing else uses its texture unit, so it stays bound.
+ ***********************************************************/
+void InstancedMeshes::CreateBuffers()
+{
+	m_bMultiDrawIndirect = (GLEW_VERSION_4_3 == GL_TRUE) ||
+		((GLEW_ARB_multi_draw_indirect == GL_TRUE) && (GLEW_ARB_base_instance == GL_TRUE));
+
+	glGenVertexArrays(1, &m_vao);
+	GLStateCache::BindVertexArray(m_vao);
+
+	m_vertexCapacity = g_InitialVertexCapacity;
+	glGenBuffers(1, &m_vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_vertexCapacity * GetVertexSize(), NULL, GL_STATIC_DRAW);
+
+	m_indexByteCapacity = g_InitialIndexCapacity * sizeof(uint32_t);
+	glGenBuffers(1, &m_indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)m_indexByteCapacity, NULL, GL_STATIC_DRAW);
+
+	// per-vertex attributes
+	glEnableVertexAttribArray(ATTRIBUTE_POSITION);
+	glEnableVertexAttribArray(ATTRIBUTE_NORMAL);
+	glEnableVertexAttribArray(ATTRIBUTE_TEXCOORD);
+	if (m_bPackedVertices == true)
+	{
+		glEnableVertexAttribArray(ATTRIBUTE_MESH_BOX);
+	}
+	BindVertexAttributes();
+
+	// start with one zeroed instance so the enabled instance
+	// attributes are valid before the first upload
+	INSTANCE_DATA emptyInstance = INSTANCE_DATA();
+	m_instanceCapacity = 1;
+	glGenBuffers(1, &m_instanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(INSTANCE_DATA), &emptyInstance, GL_STREAM_DRAW);
+
+	// per-instance attributes advance once per drawn copy
+	for (GLuint column = 0; column < 4; column++)
+	{
+		glEnableVertexAttribArray(ATTRIBUTE_INSTANCE_MODEL + column);
+		glVertexAttribDivisor(ATTRIBUTE_INSTANCE_MODEL + column, 1);
+	}
+	glEnableVertexAttribArray(ATTRIBUTE_INSTANCE_COLOR);
+	glVertexAttribDivisor(ATTRIBUTE_INSTANCE_COLOR, 1);
+	glEnableVertexAttribArray(ATTRIBUTE_INSTANCE_MATERIAL);
+	glVertexAttribDivisor(ATTRIBUTE_INSTANCE_MATERIAL, 1);
+	glEnableVertexAttribArray(ATTRIBUTE_INSTANCE_TEXTURE_LAYER);
+	glVertexAttribDivisor(ATTRIBUTE_INSTANCE_TEXTURE_LAYER, 1);
+	BindInstanceAttributes(0);
+
+	glGenBuffers(1, &m_indirectBuffer);
+
+	GLStateCache::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (m_bPackedVertices == true)
+	{
+		glGenBuffers(1, &m_meshBoxBuffer);
+		glBindBuffer(GL_TEXTURE_BUFFER, m_meshBoxBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4) * 2, NULL, GL_STATIC_DRAW);
+		glGenTextures(1, &m_meshBoxTexture);
+		GLStateCache::BindTextureUnit(g_MeshBoxUnit, GL_TEXTURE_BUFFER, m_meshBoxTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_meshBoxBuffer);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	}
+}
+
+/***********************************************************
+ *  BindVertexAttributes()
+ *
+ *  This method is used for pointing the per-vertex
+ *  attributes at the vertex buffer in its layout.  The
+ *  packed position is read twice, as three normalized
+ *  values and as the integer mesh box after them.  The
+ *  packed normal leaves z at 0 for the shader to rebuild.
+ ***********************************************************/
+void InstancedMeshes::BindVertexAttributes()
+{
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	if (m_bPackedVertices == true)
+	{
+		glVertexAttribPointer(ATTRIBUTE_POSITION, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PACKED_VERTEX), (void*)offsetof(PACKED_VERTEX, position));
+		glVertexAttribIPointer(ATTRIBUTE_MESH_BOX, 1, GL_UNSIGNED_SHORT, sizeof(PACKED_VERTEX), (void*)offsetof(PACKED_VERTEX, meshBox));
+		glVertexAttribPointer(ATTRIBUTE_NORMAL, 2, GL_SHORT, GL_TRUE, sizeof(PACKED_VERTEX), (void*)offsetof(PACKED_VERTEX, normal));
+		glVertexAttribPointer(ATTRIBUTE_TEXCOORD, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PACKED_VERTEX), (void*)offsetof(PACKED_VERTEX, uv));
+	}
+	else
+	{
+		glVertexAttribPointer(ATTRIBUTE_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)offsetof(MESH_VERTEX, position));
+		glVertexAttribPointer(ATTRIBUTE_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)offsetof(MESH_VERTEX, normal));
+		glVertexAttribPointer(ATTRIBUTE_TEXCOORD, 2, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)offsetof(MESH_VERTEX, uv));
+	}
+}
+
+/***********************************************************
+ *  GrowBuffer()
+ *
+ *  This method is used for replacing a shared buffer with a
+ *  larger one and copying the used part of it across on the
+ *  GPU.  The caller binds the new buffer to the vertex array.
+ ***********************************************************/
+void InstancedMeshes::GrowBuffer(GLenum target, GLuint& buffer, size_t usedBytes, size_t newBytes)
+{
+	GLuint newBuffer = 0;
+
+	glGenBuffers(1, &newBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newBytes, NULL, GL_STATIC_DRAW);
+	if (usedBytes > 0)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)usedBytes);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	glDeleteBuffers(1, &buffer);
+	buffer = newBuffer;
+	glBindBuffer(target, buffer);
+}
+
+/***********************************************************
+ *  UploadMesh()
+ *
+ *  This method is used for copying the vertex and index data
+ *  of a mesh into the shared buffers.  A mesh that fits in
+ *  its previous range is written in place, otherwise it gets
+ *  a new range at the end of the buffers.  Packed meshes are
+ *  quantized within their own bounds, and a new range of a
+ *  packed mesh with few enough vertices has 16-bit indices.
+ *  A range written in place keeps its index size.  Float
+ *  meshes are written straight from the given memory.
+ ***********************************************************/
+void InstancedMeshes::UploadMesh(uint32_t meshType, const MESH_VERTEX* pVertices, uint32_t vertexCount, const uint32_t* pIndices, uint32_t indexCount)
+{
+	if (m_vao == 0)
+	{
+		CreateBuffers();
+	}
+
+	MESH_RANGE& range = m_meshes[meshType];
+	uint32_t vertexSize = GetVertexSize();
+
+	GLStateCache::BindVertexArray(m_vao);
+
+	if ((vertexCount > range.vertexCapacity) || (indexCount > range.indexCapacity))
+	{
+		uint32_t indexSize = sizeof(uint32_t);
+		if ((m_bPackedVertices == true) && (vertexCount <= PackedVertices::MAX_SHORT_INDEX_VERTICES))
+		{
+			indexSize = sizeof(uint16_t);
+		}
+		// ranges start on a multiple of their index size
+		uint32_t firstByte = (m_indexBytes + indexSize - 1) / indexSize * indexSize;
+		uint32_t indexBytes = indexCount * indexSize;
+
+		if (m_vertexCount + vertexCount > m_vertexCapacity)
+		{
+			uint32_t newCapacity = m_vertexCapacity * 2;
+			while (newCapacity < m_vertexCount + vertexCount)
+				newCapacity *= 2;
+
+			GrowBuffer(GL_ARRAY_BUFFER, m_vertexBuffer,
+				(size_t)m_vertexCount * vertexSize, (size_t)newCapacity * vertexSize);
+			m_vertexCapacity = newCapacity;
+
+			// the per-vertex attributes read from the new buffer
+			BindVertexAttributes();
+		}
+		if (firstByte + indexBytes > m_indexByteCapacity)
+		{
+			uint32_t newCapacity = m_indexByteCapacity * 2;
+			while (newCapacity < firstByte + indexBytes)
+				newCapacity *= 2;
+
+			// binding the element buffer stores it in the vertex array
+			GrowBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer, (size_t)m_indexBytes, (size_t)newCapacity);
+			m_indexByteCapacity = newCapacity;
+		}
+
+		// the previous range is left unused
+		range.baseVertex = m_vertexCount;
+		range.vertexCapacity = vertexCount;
+		range.firstIndex = firstByte / indexSize;
+		range.indexCapacity = indexCount;
+		range.indexSize = indexSize;
+		m_vertexCount += vertexCount;
+		m_indexBytes = firstByte + indexBytes;
+	}
+	range.indexCount = indexCount;
+
+	// the indices stay relative to the mesh, the draws add its base vertex
+	const void* pVertexData = pVertices;
+	const void* pIndexData = pIndices;
+	std::vector<PACKED_VERTEX> packedVertices;
+	std::vector<uint16_t> packedIndices;
+	if (m_bPackedVertices == true)
+	{
+		MESH_BOUNDS bounds;
+		MeshGeometry::ComputeBounds(pVertices, vertexCount, bounds);
+		UploadMeshBox(meshType, bounds);
+
+		PackedVertices::PackVertices(pVertices, vertexCount, bounds, (uint16_t)meshType, packedVertices);
+		pVertexData = packedVertices.data();
+		if (range.indexSize == sizeof(uint16_t))
+		{
+			PackedVertices::PackIndices(pIndices, indexCount, packedIndices);
+			pIndexData = packedIndices.data();
+		}
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferSubData(GL_ARRAY_BUFFER,
+		(GLintptr)range.baseVertex * vertexSize,
+		(GLsizeiptr)vertexCount * vertexSize, pVertexData);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+		(GLintptr)range.firstIndex * range.indexSize,
+		(GLsizeiptr)indexCount * range.indexSize, pIndexData);
+
+	GLStateCache::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UploadMeshBox()
+ *
+ *  This method is used for storing the minimum corner and
+ *  size of a packed mesh in the mesh box buffer texture,
+ *  which is indexed by mesh type.  The buffer is replaced
+ *  whole, it holds two texels per mesh.
+ ***********************************************************/
+void InstancedMeshes::UploadMeshBox(uint32_t meshType, const MESH_BOUNDS& bounds)
+{
+	float minimum[3];
+	float size[3];
+	PackedVertices::GetBoxScale(bounds, minimum, size);
+
+	if (m_meshBoxes.size() < (meshType + 1) * 2)
+	{
+		m_meshBoxes.resize((meshType + 1) * 2, glm::vec4(0.0f));
+	}
+	m_meshBoxes[meshType * 2] = glm::vec4(minimum[0], minimum[1], minimum[2], 0.0f);
+	m_meshBoxes[meshType * 2 + 1] = glm::vec4(size[0], size[1], size[2], 0.0f);
+
+	glBindBuffer(GL_TEXTURE_BUFFER, m_meshBoxBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)(m_meshBoxes.size() * sizeof(glm::vec4)), m_meshBoxes.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  BindInstanceAttributes()
+ *
+ *  This method is used for pointing the per-instance
+ *  attributes of the vertex array at an instance in the
+ *  shared buffer.  Offsetting the pointers keeps the draws
+ *  working on OpenGL 3.3, which has no base instance draws.
+ ***********************************************************/
+void InstancedMeshes::BindInstanceAttributes(uint32_t firstInstance)
+{
+	size_t base = (size_t)firstInstance * sizeof(INSTANCE_DATA);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	for (GLuint column = 0; column < 4; column++)
+	{
+		glVertexAttribPointer(
+			ATTRIBUTE_INSTANCE_MODEL + column, 4, GL_FLOAT, GL_FALSE, sizeof(INSTANCE_DATA),
+			(void*)(base + offsetof(INSTANCE_DATA, model) + column * sizeof(glm::vec4)));
+	}
+	glVertexAttribPointer(
+		ATTRIBUTE_INSTANCE_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(INSTANCE_DATA),
+		(void*)(base + offsetof(INSTANCE_DATA, color)));
+	glVertexAttribIPointer(
+		ATTRIBUTE_INSTANCE_MATERIAL, 1, GL_UNSIGNED_INT, sizeof(INSTANCE_DATA),
+		(void*)(base + offsetof(INSTANCE_DATA, materialIndex)));
+	glVertexAttribIPointer(
+		ATTRIBUTE_INSTANCE_TEXTURE_LAYER, 1, GL_UNSIGNED_INT, sizeof(INSTANCE_DATA),
+		(void*)(base + offsetof(INSTANCE_DATA, textureLayer)));
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
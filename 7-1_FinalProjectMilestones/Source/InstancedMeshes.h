@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////
+// instancedmeshes.h
+// ============
+// draw many copies of the basic 3D shapes with one draw call
+//
+// The shapes are generated by MeshGeometry with the ShapeMeshes sizes and
+// every mesh reads its per-copy data from a shared instance buffer, so a
+// stack of identical primitives needs a single instanced draw.
+//
+// All of the meshes are suballocated from one vertex buffer and one index
+// buffer behind a single vertex array, so a list of instanced draws can be
+// submitted with one glMultiDrawElementsIndirect call.
+//
+// The vertices are either in the float layout of ShapeMeshes or packed by
+// PackedVertices.  Packed meshes small enough for 16-bit indices get them,
+// and the bounding box of every mesh is kept in a buffer texture that the
+// vertex shader reads to scale the quantized positions back.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshGeometry.h"
+#include "PackedVertices.h"
+#include "SceneFile.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  INSTANCE_DATA
+ *
+ *  Per-copy data read by the vertex shader - the model
+ *  matrix, the object color, the material index and the
+ *  layer of the texture array.
+ ***********************************************************/
+struct INSTANCE_DATA
+{
+	glm::mat4 model;
+	glm::vec4 color;
+	uint32_t materialIndex;
+	uint32_t textureLayer;
+	uint32_t reserved[2];
+};
+
+/***********************************************************
+ *  DRAW_INDIRECT_COMMAND
+ *
+ *  Layout of one glMultiDrawElementsIndirect command.
+ ***********************************************************/
+struct DRAW_INDIRECT_COMMAND
+{
+	uint32_t count;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t baseVertex;
+	uint32_t baseInstance;
+};
+
+/***********************************************************
+ *  InstancedMeshes
+ *
+ *  This class contains the instanced versions of the basic
+ *  shape meshes.
+ ***********************************************************/
+class InstancedMeshes
+{
+public:
+	// constructor
+	InstancedMeshes();
+	// destructor
+	~InstancedMeshes();
+
+	// use the packed vertex layout, which has to be chosen
+	// before the first mesh is loaded
+	void SetPackedVertices(bool bPacked);
+	bool IsPackedVertices() const { return(m_bPackedVertices); }
+	// texture unit of the mesh box buffer texture
+	static GLuint GetMeshBoxUnit();
+
+	// load the basic shapes into the shared buffers
+	void LoadPlaneMesh();
+	void LoadBoxMesh();
+	void LoadCylinderMesh();
+	void LoadTorusMesh();
+
+	// upload and draw one copy of a shape per instance
+	void DrawPlaneMeshInstanced(const INSTANCE_DATA* pInstances, uint32_t instanceCount);
+	void DrawBoxMeshInstanced(const INSTANCE_DATA* pInstances, uint32_t instanceCount);
+	void DrawCylinderMeshInstanced(const INSTANCE_DATA* pInstances, uint32_t instanceCount);
+	void DrawTorusMeshInstanced(const INSTANCE_DATA* pInstances, uint32_t instanceCount);
+
+	// upload the instances of a whole frame at once, then draw
+	// ranges of them with DrawMeshInstances()
+	void UploadInstances(const INSTANCE_DATA* pInstances, uint32_t instanceCount);
+	void DrawMeshInstances(uint32_t meshType, uint32_t firstInstance, uint32_t instanceCount);
+
+	// collect the instanced draws of a frame as indirect commands,
+	// upload them once and draw ranges of them
+	void ClearIndirectDraws();
+	uint32_t AddIndirectDraw(uint32_t meshType, uint32_t firstInstance, uint32_t instanceCount);
+	void UploadIndirectDraws();
+	uint32_t DrawIndirect(uint32_t firstCommand, uint32_t commandCount);
+	// whether DrawIndirect() issues multi-draw calls
+	bool IsMultiDrawIndirectSupported() const { return(m_bMultiDrawIndirect); }
+
+	// add a mesh after the basic shapes and return its mesh
+	// type, or replace the data of an added mesh
+	uint32_t AddMesh(const MESH_DATA& meshData);
+	void ReplaceMesh(uint32_t meshType, const MESH_DATA& meshData);
+	// the same from vertices and indices held elsewhere, which
+	// are uploaded without copying them first
+	uint32_t AddMesh(const MESH_VERTEX* pVertices, uint32_t vertexCount, const uint32_t* pIndices, uint32_t indexCount);
+	void ReplaceMesh(uint32_t meshType, const MESH_VERTEX* pVertices, uint32_t vertexCount, const uint32_t* pIndices, uint32_t indexCount);
+	// draw a mesh once with the model matrix uniform
+	void DrawMesh(uint32_t meshType);
+	// number of basic and added meshes
+	uint32_t GetMeshCount() const { return((uint32_t)m_meshes.size()); }
+	uint32_t GetTriangleCount(uint32_t meshType) const { return((meshType < m_meshes.size()) ? m_meshes[meshType].indexCount / 3 : 0); }
+	// size of a vertex and the bytes used in the shared buffers
+	uint32_t GetVertexSize() const;
+	uint64_t GetVertexBytes() const { return((uint64_t)m_vertexCount * GetVertexSize()); }
+	uint64_t GetIndexBytes() const { return(m_indexBytes); }
+	uint32_t GetVertexCount() const { return(m_vertexCount); }
+
+private:
+	// location of a mesh in the shared buffers, the first
+	// index counts in indices of the mesh's index size
+	struct MESH_RANGE
+	{
+		uint32_t baseVertex;
+		uint32_t vertexCapacity;
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		uint32_t indexCapacity;
+		uint32_t indexSize;
+	};
+
+	// one mesh per basic shape type, followed by the added meshes
+	std::vector<MESH_RANGE> m_meshes;
+	// vertex array over the shared buffers
+	GLuint m_vao;
+	// shared vertex and index buffers, filled from the start.
+	// The index buffer mixes index sizes so it counts bytes.
+	bool m_bPackedVertices;
+	GLuint m_vertexBuffer;
+	uint32_t m_vertexCount;
+	uint32_t m_vertexCapacity;
+	GLuint m_indexBuffer;
+	uint32_t m_indexBytes;
+	uint32_t m_indexByteCapacity;
+	// minimum corner and size of every mesh, two texels each,
+	// for the packed layout
+	GLuint m_meshBoxBuffer;
+	GLuint m_meshBoxTexture;
+	std::vector<glm::vec4> m_meshBoxes;
+	// per-instance data shared by all of the meshes
+	GLuint m_instanceBuffer;
+	uint32_t m_instanceCapacity;
+	// indirect draw commands of the current frame
+	GLuint m_indirectBuffer;
+	uint32_t m_indirectCapacity;
+	std::vector<DRAW_INDIRECT_COMMAND> m_indirectCommands;
+	std::vector<uint8_t> m_indirectIndexSizes;
+	// base instance draws and glMultiDrawElementsIndirect
+	// need OpenGL 4.3, the 3.3 context on macOS has neither
+	bool m_bMultiDrawIndirect;
+
+	// create the vertex array and the shared buffers
+	void CreateBuffers();
+	// point the per-vertex attributes at the vertex buffer
+	void BindVertexAttributes();
+	// grow a shared buffer, keeping its contents
+	void GrowBuffer(GLenum target, GLuint& buffer, size_t usedBytes, size_t newBytes);
+	// copy the data of a mesh into its range
+	void UploadMesh(uint32_t meshType, const MESH_VERTEX* pVertices, uint32_t vertexCount, const uint32_t* pIndices, uint32_t indexCount);
+	// store the bounding box of a packed mesh
+	void UploadMeshBox(uint32_t meshType, const MESH_BOUNDS& bounds);
+	// point the per-instance attributes at the given instance
+	void BindInstanceAttributes(uint32_t firstInstance);
+};
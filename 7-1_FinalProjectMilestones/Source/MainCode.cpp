@@ -1,177 +1,292 @@
-#include <iostream>         // error handling and output
-#include <cstdlib>          // EXIT_FAILURE
-
-#include <GL/glew.h>        // GLEW library
-#include "GLFW/glfw3.h"     // GLFW library
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include "SceneManager.h"
-#include "ViewManager.h"
-#include "ShapeMeshes.h"
-#include "ShaderManager.h"
-
-// Namespace for declaring global variables
-namespace
-{
-	// Macro for window title
-	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
-
-	// Main GLFW window
-	GLFWwindow* g_Window = nullptr;
-
-	// scene manager object for managing the 3D scene prepare and render
-	SceneManager* g_SceneManager = nullptr;
-	// shader manager object for dynamic interaction with the shader code
-	ShaderManager* g_ShaderManager = nullptr;
-	// view manager object for managing the 3D view setup and projection to 2D
-	ViewManager* g_ViewManager = nullptr;
-}
-
-// Function declarations - all functions that are called manually
-// need to be pre-declared at the beginning of the source code.
-bool InitializeGLFW();
-bool InitializeGLEW();
-
-
-/***********************************************************
- *  main(int, char*)
- *
- *  This function gets called after the application has been
- *  launched.
- ***********************************************************/
-int main(int argc, char* argv[])
-{
-	// if GLFW fails initialization, then terminate the application
-	if (InitializeGLFW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// try to create a new shader manager object
-	g_ShaderManager = new ShaderManager();
-	// try to create a new view manager object
-	g_ViewManager = new ViewManager(
-		g_ShaderManager);
-
-	// try to create the main display window
-	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
-
-	// if GLEW fails initialization, then terminate the application
-	if (InitializeGLEW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"../../Utilities/shaders/vertexShader.glsl",
-		"../../Utilities/shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
-
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
-
-	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
-	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
-
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
-
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
-
-
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
-
-		// query the latest GLFW events
-		glfwPollEvents();
-	}
-
-	// clear the allocated manager objects from memory
-	if (NULL != g_SceneManager)
-	{
-		delete g_SceneManager;
-		g_SceneManager = NULL;
-	}
-	if (NULL != g_ViewManager)
-	{
-		delete g_ViewManager;
-		g_ViewManager = NULL;
-	}
-	if (NULL != g_ShaderManager)
-	{
-		delete g_ShaderManager;
-		g_ShaderManager = NULL;
-	}
-
-	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
-}
-
-/***********************************************************
- *	InitializeGLFW()
- * 
- *  This function is used to initialize the GLFW library.   
- ***********************************************************/
-bool InitializeGLFW()
-{
-	// GLFW: initialize and configure library
-	// --------------------------------------
-	glfwInit();
-
-#ifdef __APPLE__
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#else
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#endif
-	// GLFW: end -------------------------------
-
-	return(true);
-}
-
-/***********************************************************
- *	InitializeGLEW()
- *
- *  This function is used to initialize the GLEW library.
- ***********************************************************/
-bool InitializeGLEW()
-{
-	// GLEW: initialize
-	// -----------------------------------------
-	GLenum GLEWInitResult = GLEW_OK;
-
-	// try to initialize the GLEW library
-	GLEWInitResult = glewInit();
-	if (GLEW_OK != GLEWInitResult)
-	{
-		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
-		return false;
-	}
-	// GLEW: end -------------------------------
-
-	// Displays a successful OpenGL initialization message
-	std::cout << "INFO: OpenGL Successfully Initialized\n";
-	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
-
-	return(true);
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <string>
+#include <chrono>
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ShapeMeshes.h"
+#include "ShaderManager.h"
+#include "SceneBenchmarks.h"
+#include "TextureCooker.h"
+#include "GLStateCache.h"
+
+// Namespace for declaring global variables
+namespace
+{
+	// Macro for window title
+	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
+
+	// Main GLFW window
+	GLFWwindow* g_Window = nullptr;
+
+	// scene manager object for managing the 3D scene prepare and render
+	SceneManager* g_SceneManager = nullptr;
+	// shader manager object for dynamic interaction with the shader code
+	ShaderManager* g_ShaderManager = nullptr;
+	// view manager object for managing the 3D view setup and projection to 2D
+	ViewManager* g_ViewManager = nullptr;
+}
+
+// Function declarations - all functions that are called manually
+// need to be pre-declared at the beginning of the source code.
+bool InitializeGLFW();
+bool InitializeGLEW();
+
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the application has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	// --benchmark <name> runs the benchmarks without opening the main window
+	if ((argc > 2) && (strcmp(argv[1], "--benchmark") == 0))
+	{
+		return(SceneBenchmarks::Run(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// --cook <image> ... writes the cooked texture file of every image
+	if ((argc > 2) && (strcmp(argv[1], "--cook") == 0))
+	{
+		bool bCooked = true;
+		for (int i = 2; i < argc; i++)
+		{
+			std::string cookedFilename = TextureCooker::GetCookedPath(argv[i]);
+			bCooked = TextureCooker::CookTexture(argv[i], cookedFilename.c_str()) && bCooked;
+		}
+		return(bCooked ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// the time until the first frame is shown is reported once
+	auto startupTime = std::chrono::steady_clock::now();
+	bool bFirstFrame = true;
+
+	// if GLFW fails initialization, then terminate the application
+	if (InitializeGLFW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// try to create a new shader manager object
+	g_ShaderManager = new ShaderManager();
+	// try to create a new view manager object
+	g_ViewManager = new ViewManager(
+		g_ShaderManager);
+
+	// try to create the main display window
+	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+
+	// if GLEW fails initialization, then terminate the application
+	if (InitializeGLEW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// load the shader code from the GLSL files - the project's own
+	// shaders add the per-instance attributes for instanced draws
+	g_ShaderManager->LoadShaders(
+		"Shaders/vertexShader.glsl",
+		"Shaders/fragmentShader.glsl");
+	g_ShaderManager->use();
+
+	// try to create a new scene manager object and prepare the 3D scene
+	g_SceneManager = new SceneManager(g_ShaderManager);
+
+	// optional command line arguments for selecting the scene file
+	//   --scene <file>      load the objects from the given text scene file
+	//   --synthetic <count> generate and load a scene with <count> objects
+	//   --no-sort           draw in scene file order instead of by state
+	//   --no-instancing     draw every object with its own draw call
+	//   --no-batching       do not merge the static objects into batches
+	//   --no-culling        draw the objects outside of the view as well
+	//   --no-occlusion      draw the objects hidden behind occluders as well
+	//   --no-lod            draw the curved shapes at full detail at any size
+	//   --packed-vertices   store the meshes with 16-byte vertices
+	//   --no-mesh-optimizer keep the generated meshes in their generated order
+	//   --no-mesh-cache     generate the meshes instead of loading MeshCache.bin
+	//   --texture-budget <MB> keep the texture arrays within the budget
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--no-sort") == 0)
+		{
+			g_SceneManager->SetRenderQueueSorting(false);
+		}
+		else if (strcmp(argv[i], "--no-instancing") == 0)
+		{
+			g_SceneManager->SetInstancing(false);
+		}
+		else if (strcmp(argv[i], "--no-batching") == 0)
+		{
+			g_SceneManager->SetStaticBatching(false);
+		}
+		else if (strcmp(argv[i], "--no-culling") == 0)
+		{
+			g_SceneManager->SetFrustumCulling(false);
+		}
+		else if (strcmp(argv[i], "--no-occlusion") == 0)
+		{
+			g_SceneManager->SetOcclusionCulling(false);
+		}
+		else if (strcmp(argv[i], "--no-lod") == 0)
+		{
+			g_SceneManager->SetLevelOfDetail(false);
+		}
+		else if (strcmp(argv[i], "--packed-vertices") == 0)
+		{
+			g_SceneManager->SetPackedVertices(true);
+		}
+		else if (strcmp(argv[i], "--no-mesh-optimizer") == 0)
+		{
+			g_SceneManager->SetMeshOptimization(false);
+		}
+		else if (strcmp(argv[i], "--no-mesh-cache") == 0)
+		{
+			g_SceneManager->SetMeshCache(false);
+		}
+		else if (i + 1 >= argc)
+		{
+			break;
+		}
+		else if (strcmp(argv[i], "--scene") == 0)
+		{
+			g_SceneManager->SetSceneFile(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--texture-budget") == 0)
+		{
+			g_SceneManager->SetTextureBudget((uint64_t)atoi(argv[++i]) * 1024 * 1024);
+		}
+		else if (strcmp(argv[i], "--synthetic") == 0)
+		{
+			std::string sceneFilename = std::string("Scenes/Synthetic") + argv[++i] + ".txt";
+			if (SceneFile::WriteSyntheticScene(sceneFilename.c_str(), (uint32_t)atoi(argv[i])))
+			{
+				g_SceneManager->SetSceneFile(sceneFilename.c_str());
+			}
+		}
+	}
+
+	g_SceneManager->PrepareScene();
+
+	// loop will keep running until the application is closed 
+	// or until an error has occurred
+	while (!glfwWindowShouldClose(g_Window))
+	{
+		// Enable z-depth
+		GLStateCache::Enable(GL_DEPTH_TEST);
+
+		// Clear the frame and z buffers
+		GLStateCache::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// convert from 3D object space to 2D view
+		g_ViewManager->PrepareSceneView();
+
+		// refresh the 3D scene
+		g_SceneManager->SetViewPosition(g_ViewManager->GetViewPosition());
+		g_SceneManager->SetViewProjection(
+			g_ViewManager->GetViewMatrix(), g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetViewportHeight());
+		g_SceneManager->RenderScene();
+
+
+		// Flips the the back buffer with the front buffer every frame.
+		glfwSwapBuffers(g_Window);
+
+		if (bFirstFrame == true)
+		{
+			std::cout << "INFO: startup to first frame: " << std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - startupTime).count() << " ms" << std::endl;
+			bFirstFrame = false;
+		}
+
+		// query the latest GLFW events
+		glfwPollEvents();
+	}
+
+	// clear the allocated manager objects from memory
+	if (NULL != g_SceneManager)
+	{
+		delete g_SceneManager;
+		g_SceneManager = NULL;
+	}
+	if (NULL != g_ViewManager)
+	{
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+	}
+	if (NULL != g_ShaderManager)
+	{
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+	}
+
+	// Terminates the program successfully
+	exit(EXIT_SUCCESS); 
+}
+
+/***********************************************************
+ *	InitializeGLFW()
+ * 
+ *  This function is used to initialize the GLFW library.   
+ ***********************************************************/
+bool InitializeGLFW()
+{
+	// GLFW: initialize and configure library
+	// --------------------------------------
+	glfwInit();
+
+#ifdef __APPLE__
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+	// GLFW: end -------------------------------
+
+	return(true);
+}
+
+/***********************************************************
+ *	InitializeGLEW()
+ *
+ *  This function is used to initialize the GLEW library.
+ ***********************************************************/
+bool InitializeGLEW()
+{
+	// GLEW: initialize
+	// -----------------------------------------
+	GLenum GLEWInitResult = GLEW_OK;
+
+	// try to initialize the GLEW library
+	GLEWInitResult = glewInit();
+	if (GLEW_OK != GLEWInitResult)
+	{
+		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		return false;
+	}
+	// GLEW: end -------------------------------
+
+	// Displays a successful OpenGL initialization message
+	std::cout << "INFO: OpenGL Successfully Initialized\n";
+	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
+
+	return(true);
 }
\ No newline at end of file
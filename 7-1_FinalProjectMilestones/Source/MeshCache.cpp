@@ -0,0 +1,331 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.cpp
+// ============
+// keep the generated and optimized meshes in a file between launches
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// first bytes of every mesh cache file
+	const unsigned char g_MeshCacheIdentifier[8] = { 'M', 'E', 'S', 'H', 'C', 'A', 'C', 'H' };
+	// version of the file layout; changes to the meshes
+	// themselves are caught by the revisions of the generator
+	// and the optimizer, which the header also carries
+	const uint32_t g_MeshCacheVersion = 2;
+	// written as 0x04030201 by a file of the same byte order
+	const uint32_t g_MeshCacheEndianness = 0x04030201;
+	// the vertices and indices of a mesh start on this many
+	// bytes, which the mapping keeps aligned in memory
+	const uint64_t g_MeshCacheAlignment = 16;
+
+	/***********************************************************
+	 *  MESH_CACHE_HEADER
+	 *
+	 *  Header of a mesh cache file.  The table of the meshes
+	 *  follows it, then their vertices and indices.
+	 ***********************************************************/
+	struct MESH_CACHE_HEADER
+	{
+		unsigned char identifier[8];
+		uint32_t version;
+		uint32_t endianness;
+		uint64_t paramsHash;
+		uint32_t meshCount;
+		uint32_t vertexSize;
+		uint32_t cacheSize;
+		uint32_t generatorRevision;
+		uint32_t optimizerRevision;
+		uint32_t reserved;
+	};
+
+	/***********************************************************
+	 *  AlignOffset()
+	 *
+	 *  Returns the offset rounded up to the data alignment.
+	 ***********************************************************/
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return((offset + g_MeshCacheAlignment - 1) / g_MeshCacheAlignment * g_MeshCacheAlignment);
+	}
+}
+
+/***********************************************************
+ *  MeshCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshCache::MeshCache()
+{
+	m_pData = NULL;
+	m_size = 0;
+}
+
+/***********************************************************
+ *  ~MeshCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshCache::~MeshCache()
+{
+	Close();
+}
+
+/***********************************************************
+ *  WriteCache()
+ *
+ *  This method is used for writing the meshes of a generator
+ *  into a cache file, in the order of their handles.  Every
+ *  requested mesh has to be generated.
+ ***********************************************************/
+bool MeshCache::WriteCache(const char* filename, const MeshGenerator& meshGenerator)
+{
+	uint32_t meshCount = meshGenerator.GetMeshCount();
+
+	MESH_CACHE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.identifier, g_MeshCacheIdentifier, sizeof(g_MeshCacheIdentifier));
+	header.version = g_MeshCacheVersion;
+	header.endianness = g_MeshCacheEndianness;
+	header.paramsHash = meshGenerator.GetParamsHash();
+	header.meshCount = meshCount;
+	header.vertexSize = sizeof(MESH_VERTEX);
+	header.cacheSize = MeshOptimizer::CACHE_SIZE;
+	header.generatorRevision = MeshGenerator::REVISION;
+	header.optimizerRevision = MeshOptimizer::REVISION;
+
+	// lay out the data of every mesh after the table
+	std::vector<MESH_CACHE_ENTRY> entries(meshCount);
+	uint64_t offset = sizeof(MESH_CACHE_HEADER) + (uint64_t)meshCount * sizeof(MESH_CACHE_ENTRY);
+	for (uint32_t handle = 0; handle < meshCount; handle++)
+	{
+		if (meshGenerator.IsGenerated(handle) == false)
+		{
+			return(false);
+		}
+
+		const MESH_DATA& mesh = meshGenerator.GetMesh(handle);
+		MESH_CACHE_ENTRY& entry = entries[handle];
+		memset(&entry, 0, sizeof(entry));
+		entry.params = meshGenerator.GetParams(handle);
+		entry.vertexCount = (uint32_t)mesh.vertices.size();
+		entry.indexCount = (uint32_t)mesh.indices.size();
+		entry.stats = meshGenerator.GetOptimizeStats(handle);
+
+		entry.vertexOffset = AlignOffset(offset);
+		offset = entry.vertexOffset + (uint64_t)entry.vertexCount * sizeof(MESH_VERTEX);
+		entry.indexOffset = AlignOffset(offset);
+		offset = entry.indexOffset + (uint64_t)entry.indexCount * sizeof(uint32_t);
+	}
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "Could not write mesh cache:" << filename << std::endl;
+		return(false);
+	}
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)entries.data(), (std::streamsize)(entries.size() * sizeof(MESH_CACHE_ENTRY)));
+
+	const char padding[g_MeshCacheAlignment] = { 0 };
+	offset = sizeof(MESH_CACHE_HEADER) + (uint64_t)meshCount * sizeof(MESH_CACHE_ENTRY);
+	for (uint32_t handle = 0; handle < meshCount; handle++)
+	{
+		const MESH_DATA& mesh = meshGenerator.GetMesh(handle);
+		const MESH_CACHE_ENTRY& entry = entries[handle];
+
+		file.write(padding, (std::streamsize)(entry.vertexOffset - offset));
+		file.write((const char*)mesh.vertices.data(), (std::streamsize)(mesh.vertices.size() * sizeof(MESH_VERTEX)));
+		offset = entry.vertexOffset + (uint64_t)entry.vertexCount * sizeof(MESH_VERTEX);
+
+		file.write(padding, (std::streamsize)(entry.indexOffset - offset));
+		file.write((const char*)mesh.indices.data(), (std::streamsize)(mesh.indices.size() * sizeof(uint32_t)));
+		offset = entry.indexOffset + (uint64_t)entry.indexCount * sizeof(uint32_t);
+	}
+
+	if (!file)
+	{
+		std::cout << "Could not write mesh cache:" << filename << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a mesh cache file into
+ *  memory.  The file is only accepted when its version,
+ *  revisions, vertex layout and parameter hash match the
+ *  generator, its table repeats the parameters of every
+ *  handle, the data of every mesh fits in the file and every
+ *  index refers to a vertex of its mesh.
+ ***********************************************************/
+bool MeshCache::Open(const char* filename, const MeshGenerator& meshGenerator)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return(false);
+	}
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart >= (LONGLONG)sizeof(MESH_CACHE_HEADER)))
+	{
+		// the view keeps the file mapped once the handles are closed
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping != NULL)
+		{
+			m_pData = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			m_size = (m_pData != NULL) ? (size_t)fileSize.QuadPart : 0;
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#else
+	int file = open(filename, O_RDONLY);
+	if (file < 0)
+	{
+		return(false);
+	}
+	struct stat status;
+	if ((fstat(file, &status) == 0) && (status.st_size >= (off_t)sizeof(MESH_CACHE_HEADER)))
+	{
+		void* pMapped = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (pMapped != MAP_FAILED)
+		{
+			m_pData = (const unsigned char*)pMapped;
+			m_size = (size_t)status.st_size;
+		}
+	}
+	close(file);
+#endif
+
+	if (NULL == m_pData)
+	{
+		return(false);
+	}
+
+	uint32_t meshCount = meshGenerator.GetMeshCount();
+	MESH_CACHE_HEADER header;
+	memcpy(&header, m_pData, sizeof(header));
+	if ((memcmp(header.identifier, g_MeshCacheIdentifier, sizeof(g_MeshCacheIdentifier)) != 0) ||
+		(header.endianness != g_MeshCacheEndianness) ||
+		(header.version != g_MeshCacheVersion) ||
+		(header.vertexSize != sizeof(MESH_VERTEX)) ||
+		(header.cacheSize != MeshOptimizer::CACHE_SIZE) ||
+		(header.generatorRevision != MeshGenerator::REVISION) ||
+		(header.optimizerRevision != MeshOptimizer::REVISION) ||
+		(header.meshCount != meshCount) ||
+		(header.paramsHash != meshGenerator.GetParamsHash()) ||
+		(sizeof(MESH_CACHE_HEADER) + (uint64_t)meshCount * sizeof(MESH_CACHE_ENTRY) > m_size))
+	{
+		std::cout << "INFO: mesh cache is out of date:" << filename << std::endl;
+		Close();
+		return(false);
+	}
+
+	m_entries.resize(meshCount);
+	memcpy(m_entries.data(), m_pData + sizeof(MESH_CACHE_HEADER), meshCount * sizeof(MESH_CACHE_ENTRY));
+	for (uint32_t handle = 0; handle < meshCount; handle++)
+	{
+		const MESH_CACHE_ENTRY& entry = m_entries[handle];
+		if (!(entry.params == meshGenerator.GetParams(handle)) ||
+			(entry.vertexOffset % g_MeshCacheAlignment != 0) ||
+			(entry.indexOffset % g_MeshCacheAlignment != 0) ||
+			(entry.vertexOffset + (uint64_t)entry.vertexCount * sizeof(MESH_VERTEX) > m_size) ||
+			(entry.indexOffset + (uint64_t)entry.indexCount * sizeof(uint32_t) > m_size))
+		{
+			std::cout << "Mesh cache is damaged:" << filename << std::endl;
+			Close();
+			return(false);
+		}
+
+		// an index past the vertices would make the draw read
+		// outside of the vertex buffer
+		const uint32_t* pIndices = (const uint32_t*)(m_pData + entry.indexOffset);
+		for (uint32_t i = 0; i < entry.indexCount; i++)
+		{
+			if (pIndices[i] >= entry.vertexCount)
+			{
+				std::cout << "Mesh cache is damaged:" << filename << std::endl;
+				Close();
+				return(false);
+			}
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the cache file.
+ ***********************************************************/
+void MeshCache::Close()
+{
+	if (m_pData != NULL)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_pData);
+#else
+		munmap((void*)m_pData, m_size);
+#endif
+	}
+	m_pData = NULL;
+	m_size = 0;
+	m_entries.clear();
+}
+
+/***********************************************************
+ *  GetVertices()
+ *
+ *  This method is used for getting the vertices of a mesh
+ *  and their count.
+ ***********************************************************/
+const MESH_VERTEX* MeshCache::GetVertices(uint32_t handle, uint32_t& vertexCount) const
+{
+	const MESH_CACHE_ENTRY& entry = m_entries[handle];
+	vertexCount = entry.vertexCount;
+
+	return((const MESH_VERTEX*)(m_pData + entry.vertexOffset));
+}
+
+/***********************************************************
+ *  GetIndices()
+ *
+ *  This method is used for getting the indices of a mesh
+ *  and their count.
+ ***********************************************************/
+const uint32_t* MeshCache::GetIndices(uint32_t handle, uint32_t& indexCount) const
+{
+	const MESH_CACHE_ENTRY& entry = m_entries[handle];
+	indexCount = entry.indexCount;
+
+	return((const uint32_t*)(m_pData + entry.indexOffset));
+}
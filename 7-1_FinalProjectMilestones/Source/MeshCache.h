@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.h
+// ============
+// keep the generated and optimized meshes in a file between launches
+//
+// The cache file holds a header, a table with the parameters, location and
+// optimizer results of every mesh, then the vertices and indices of the
+// meshes as the generator left them.  The header carries a format version
+// and a hash over the parameters of every requested mesh, so a cache is
+// only used for exactly the meshes it was written for.  At run time the
+// file is mapped into memory and the meshes are uploaded straight from it,
+// so the shapes are neither generated nor optimized again.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshGenerator.h"
+#include "MeshOptimizer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MESH_CACHE_ENTRY
+ *
+ *  Table entry of a cached mesh - its parameters, the size
+ *  and file offset of its vertices and indices, and what
+ *  the optimizer reported for it.
+ ***********************************************************/
+struct MESH_CACHE_ENTRY
+{
+	MESH_PARAMS params;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	MESH_OPTIMIZE_STATS stats;
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+};
+
+/***********************************************************
+ *  MeshCache
+ *
+ *  This class contains a mesh cache file mapped into memory
+ *  and the location of each of its meshes.
+ ***********************************************************/
+class MeshCache
+{
+public:
+	// constructor
+	MeshCache();
+	// destructor
+	~MeshCache();
+
+	// write every generated mesh of the generator, by handle
+	static bool WriteCache(const char* filename, const MeshGenerator& meshGenerator);
+
+	// map a cache file and check it holds the meshes of the
+	// generator's requests
+	bool Open(const char* filename, const MeshGenerator& meshGenerator);
+	// unmap the file
+	void Close();
+
+	// vertices and indices of a mesh, which point into the
+	// mapped file
+	const MESH_VERTEX* GetVertices(uint32_t handle, uint32_t& vertexCount) const;
+	const uint32_t* GetIndices(uint32_t handle, uint32_t& indexCount) const;
+	const MESH_OPTIMIZE_STATS& GetOptimizeStats(uint32_t handle) const { return(m_entries[handle].stats); }
+
+	// access the mapped file
+	uint32_t GetMeshCount() const { return((uint32_t)m_entries.size()); }
+	size_t GetSize() const { return(m_size); }
+
+private:
+	// mapped file contents
+	const unsigned char* m_pData;
+	size_t m_size;
+	// table of the meshes in the file
+	std::vector<MESH_CACHE_ENTRY> m_entries;
+};
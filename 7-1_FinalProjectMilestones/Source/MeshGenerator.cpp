@@ -0,0 +1,338 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.cpp
+// ============
+// generate the primitive shapes from their tessellation parameters
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshGenerator.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// fewest segments that still enclose a volume
+	const uint32_t g_MinSegments = 3;
+	// most segments or rings of a mesh, which keeps the vertex
+	// count of a sphere within the 32-bit indices many times
+	const uint32_t g_MaxSegments = 1024;
+	// starting value of the FNV-1a hashes
+	const uint64_t g_HashBasis = 0xCBF29CE484222325ull;
+
+	/***********************************************************
+	 *  ClampCount()
+	 *
+	 *  Returns the count limited to the allowed range.
+	 ***********************************************************/
+	uint32_t ClampCount(uint32_t count, uint32_t minCount)
+	{
+		if (count < minCount)
+			return(minCount);
+		if (count > g_MaxSegments)
+			return(g_MaxSegments);
+		return(count);
+	}
+
+	/***********************************************************
+	 *  HashFields()
+	 *
+	 *  Returns the hash continued with FNV-1a over the fields.
+	 ***********************************************************/
+	uint64_t HashFields(uint64_t hash, const uint32_t* pFields, uint32_t fieldCount)
+	{
+		for (uint32_t i = 0; i < fieldCount; i++)
+		{
+			hash ^= pFields[i];
+			hash *= 0x100000001B3ull;
+		}
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  HashParams()
+	 *
+	 *  Returns the hash continued over the parameters.  The
+	 *  negative zero radius hashes as zero since the two
+	 *  compare equal.
+	 ***********************************************************/
+	uint64_t HashParams(uint64_t hash, const MESH_PARAMS& params)
+	{
+		uint32_t radiusBits = 0;
+		float radius = (params.radius == 0.0f) ? 0.0f : params.radius;
+		memcpy(&radiusBits, &radius, sizeof(radiusBits));
+
+		const uint32_t fields[] = { params.shape, params.segments, params.rings, radiusBits, params.bCaps };
+		return(HashFields(hash, fields, sizeof(fields) / sizeof(fields[0])));
+	}
+}
+
+/***********************************************************
+ *  MeshGenerator()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshGenerator::MeshGenerator()
+	: m_bOptimize(true), m_requestCount(0), m_threadCount(0)
+{
+}
+
+/***********************************************************
+ *  ~MeshGenerator()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshGenerator::~MeshGenerator()
+{
+}
+
+/***********************************************************
+ *  GetDefaultParams()
+ *
+ *  This method is used for getting the parameters the
+ *  basic shapes are generated with by default.
+ ***********************************************************/
+MESH_PARAMS MeshGenerator::GetDefaultParams(uint32_t shape)
+{
+	MESH_PARAMS params;
+	params.shape = shape;
+	params.segments = 36;
+	params.rings = 1;
+	params.radius = 1.0f;
+	params.bCaps = 1;
+
+	if (shape == MESH_SHAPE_TORUS)
+	{
+		params.rings = 18;
+		params.radius = 0.1f;
+	}
+	else if (shape == MESH_SHAPE_SPHERE)
+	{
+		params.rings = 18;
+	}
+
+	return(Normalize(params));
+}
+
+/***********************************************************
+ *  Generate()
+ *
+ *  This method is used for generating the mesh of a set of
+ *  parameters.
+ ***********************************************************/
+void MeshGenerator::Generate(const MESH_PARAMS& params, MESH_DATA& mesh)
+{
+	switch (params.shape)
+	{
+	case MESH_SHAPE_PLANE:
+		MeshGeometry::GeneratePlane(mesh);
+		break;
+	case MESH_SHAPE_BOX:
+		MeshGeometry::GenerateBox(mesh);
+		break;
+	case MESH_SHAPE_CYLINDER:
+		MeshGeometry::GenerateCylinder(mesh, params.segments, params.rings, params.radius, params.bCaps != 0);
+		break;
+	case MESH_SHAPE_TORUS:
+		MeshGeometry::GenerateTorus(mesh, params.segments, params.rings, params.radius);
+		break;
+	case MESH_SHAPE_SPHERE:
+		MeshGeometry::GenerateSphere(mesh, params.segments, params.rings);
+		break;
+	default:
+		mesh.vertices.clear();
+		mesh.indices.clear();
+		break;
+	}
+}
+
+/***********************************************************
+ *  RequestMesh()
+ *
+ *  This method is used for getting the handle of a mesh.
+ *  Parameters seen before return their handle, new ones
+ *  get a handle whose mesh is generated later.
+ ***********************************************************/
+uint32_t MeshGenerator::RequestMesh(const MESH_PARAMS& params)
+{
+	m_requestCount++;
+
+	MESH_PARAMS key = Normalize(params);
+	std::unordered_map<MESH_PARAMS, uint32_t, MESH_PARAMS_HASH>::const_iterator found = m_handles.find(key);
+	if (found != m_handles.end())
+	{
+		return(found->second);
+	}
+
+	uint32_t handle = (uint32_t)m_params.size();
+	m_handles[key] = handle;
+	m_params.push_back(key);
+	m_meshes.push_back(MESH_DATA());
+	m_bGenerated.push_back(0);
+	m_stats.push_back(MESH_OPTIMIZE_STATS());
+	return(handle);
+}
+
+/***********************************************************
+ *  GenerateMeshes()
+ *
+ *  This method is used for generating the pending meshes.
+ *  The workers claim meshes with an atomic counter and each
+ *  one writes only the meshes it claimed.  The thread count
+ *  defaults as for the texture loader, and a single pending
+ *  mesh is generated on the calling thread.  Optimizing a
+ *  mesh costs more than generating it, so it runs on the
+ *  same worker.
+ ***********************************************************/
+uint32_t MeshGenerator::GenerateMeshes(uint32_t threadCount)
+{
+	std::vector<uint32_t> pending;
+	for (uint32_t handle = 0; handle < m_bGenerated.size(); handle++)
+	{
+		if (m_bGenerated[handle] == 0)
+		{
+			pending.push_back(handle);
+		}
+	}
+
+	if (threadCount == 0)
+	{
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+	}
+	if (threadCount > pending.size())
+	{
+		threadCount = (uint32_t)pending.size();
+	}
+	m_threadCount = threadCount;
+
+	std::atomic<uint32_t> nextMesh(0);
+	auto generateMeshes = [this, &pending, &nextMesh]()
+	{
+		uint32_t index = nextMesh++;
+		while (index < (uint32_t)pending.size())
+		{
+			uint32_t handle = pending[index];
+			Generate(m_params[handle], m_meshes[handle]);
+			if (m_bOptimize)
+			{
+				MeshOptimizer::OptimizeMesh(m_meshes[handle], &m_stats[handle]);
+			}
+			else
+			{
+				float acmr = MeshOptimizer::SimulateACMR(m_meshes[handle].indices, (uint32_t)m_meshes[handle].vertices.size(), MeshOptimizer::CACHE_SIZE);
+				m_stats[handle].acmrBefore = acmr;
+				m_stats[handle].acmrAfter = acmr;
+				m_stats[handle].clusterCount = 1;
+			}
+			index = nextMesh++;
+		}
+	};
+
+	if (threadCount <= 1)
+	{
+		generateMeshes();
+	}
+	else
+	{
+		std::vector<std::thread> workers;
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			workers.push_back(std::thread(generateMeshes));
+		}
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	for (uint32_t handle : pending)
+	{
+		m_bGenerated[handle] = 1;
+	}
+
+	return((uint32_t)pending.size());
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for forgetting every mesh.
+ ***********************************************************/
+void MeshGenerator::Clear()
+{
+	m_handles.clear();
+	m_params.clear();
+	m_meshes.clear();
+	m_bGenerated.clear();
+	m_stats.clear();
+	m_requestCount = 0;
+	m_threadCount = 0;
+}
+
+/***********************************************************
+ *  Normalize()
+ *
+ *  This method is used for clamping the counts and clearing
+ *  what a shape ignores, so a box asked for with any number
+ *  of segments is the same box.
+ ***********************************************************/
+MESH_PARAMS MeshGenerator::Normalize(const MESH_PARAMS& params)
+{
+	MESH_PARAMS normalized;
+	memset(&normalized, 0, sizeof(normalized));
+	normalized.shape = params.shape;
+
+	switch (params.shape)
+	{
+	case MESH_SHAPE_CYLINDER:
+		normalized.segments = ClampCount(params.segments, g_MinSegments);
+		normalized.rings = ClampCount(params.rings, 1);
+		normalized.radius = (params.radius > 0.0f) ? params.radius : 0.0f;
+		normalized.bCaps = (params.bCaps != 0) ? 1 : 0;
+		break;
+	case MESH_SHAPE_TORUS:
+		normalized.segments = ClampCount(params.segments, g_MinSegments);
+		normalized.rings = ClampCount(params.rings, g_MinSegments);
+		normalized.radius = params.radius;
+		break;
+	case MESH_SHAPE_SPHERE:
+		normalized.segments = ClampCount(params.segments, g_MinSegments);
+		normalized.rings = ClampCount(params.rings, 2);
+		break;
+	default:
+		break;
+	}
+
+	return(normalized);
+}
+
+/***********************************************************
+ *  GetParamsHash()
+ *
+ *  This method is used for hashing the parameters of every
+ *  handle in order, after their count and the optimizer
+ *  setting.
+ ***********************************************************/
+uint64_t MeshGenerator::GetParamsHash() const
+{
+	const uint32_t fields[] = { (uint32_t)m_params.size(), m_bOptimize ? 1u : 0u };
+	uint64_t hash = HashFields(g_HashBasis, fields, sizeof(fields) / sizeof(fields[0]));
+	for (const MESH_PARAMS& params : m_params)
+	{
+		hash = HashParams(hash, params);
+	}
+	return(hash);
+}
+
+/***********************************************************
+ *  MESH_PARAMS_HASH
+ *
+ *  This method is used for hashing the parameters with
+ *  FNV-1a over the fields.
+ ***********************************************************/
+size_t MeshGenerator::MESH_PARAMS_HASH::operator()(const MESH_PARAMS& params) const
+{
+	return((size_t)HashParams(g_HashBasis, params));
+}
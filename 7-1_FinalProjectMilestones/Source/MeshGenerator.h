@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.h
+// ============
+// generate the primitive shapes from their tessellation parameters
+//
+// A mesh is requested by its shape and parameters and named by a handle.
+// Requesting the same parameters again returns the same handle, so every
+// variant is generated once however many levels or objects use it.  The
+// requested meshes are generated together on worker threads, since the
+// variants do not depend on each other, and each one is reordered by the
+// mesh optimizer as it is generated.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshGeometry.h"
+#include "MeshOptimizer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// shapes the generator can build, the first four matching
+// the basic shapes of the scene file
+enum MESH_SHAPE
+{
+	MESH_SHAPE_PLANE = 0,
+	MESH_SHAPE_BOX,
+	MESH_SHAPE_CYLINDER,
+	MESH_SHAPE_TORUS,
+	MESH_SHAPE_SPHERE,
+	MESH_SHAPE_COUNT
+};
+
+/***********************************************************
+ *  MESH_PARAMS
+ *
+ *  The shape and tessellation of a generated mesh.  The
+ *  segments go around the axis of a cylinder or sphere, or
+ *  around the ring of a torus.  The rings are the stacks of
+ *  a cylinder, the rings of a sphere from pole to pole, or
+ *  the segments around the tube of a torus.  The radius is
+ *  the top radius of a cylinder, 0 making a cone, or the
+ *  tube radius of a torus.
+ ***********************************************************/
+struct MESH_PARAMS
+{
+	uint32_t shape;
+	uint32_t segments;
+	uint32_t rings;
+	float radius;
+	uint32_t bCaps;
+
+	bool operator==(const MESH_PARAMS& other) const
+	{
+		return((shape == other.shape) && (segments == other.segments) && (rings == other.rings) &&
+			(radius == other.radius) && (bCaps == other.bCaps));
+	}
+};
+
+/***********************************************************
+ *  MeshGenerator
+ *
+ *  This class contains the generated meshes by their
+ *  parameters.
+ ***********************************************************/
+class MeshGenerator
+{
+public:
+	// raise whenever a shape is built differently from the same
+	// parameters, so the mesh cache files written before are
+	// built again
+	static const uint32_t REVISION = 1;
+
+	// constructor
+	MeshGenerator();
+	// destructor
+	~MeshGenerator();
+
+	// parameters of a shape as ShapeMeshes loads it
+	static MESH_PARAMS GetDefaultParams(uint32_t shape);
+	// generate a mesh right away, without the cache
+	static void Generate(const MESH_PARAMS& params, MESH_DATA& mesh);
+
+	// handle of the mesh of the given parameters.  A new mesh
+	// is generated by the next GenerateMeshes().
+	uint32_t RequestMesh(const MESH_PARAMS& params);
+	// generate every requested mesh that is not generated yet
+	// and return how many were, 0 threads picks the count
+	uint32_t GenerateMeshes(uint32_t threadCount = 0);
+
+	// access the meshes by handle
+	const MESH_DATA& GetMesh(uint32_t handle) const { return(m_meshes[handle]); }
+	const MESH_PARAMS& GetParams(uint32_t handle) const { return(m_params[handle]); }
+	bool IsGenerated(uint32_t handle) const { return(m_bGenerated[handle] != 0); }
+	const MESH_OPTIMIZE_STATS& GetOptimizeStats(uint32_t handle) const { return(m_stats[handle]); }
+
+	// whether the meshes generated next are optimized
+	void SetOptimizeMeshes(bool bOptimize) { m_bOptimize = bOptimize; }
+	bool IsOptimizeMeshes() const { return(m_bOptimize); }
+
+	// hash over the parameters of every handle in order and
+	// the optimizer setting, which names the meshes a mesh
+	// cache has to hold
+	uint64_t GetParamsHash() const;
+
+	// number of requests, of distinct meshes and of threads
+	// the last generation ran on
+	uint32_t GetRequestCount() const { return(m_requestCount); }
+	uint32_t GetMeshCount() const { return((uint32_t)m_params.size()); }
+	uint32_t GetThreadCount() const { return(m_threadCount); }
+
+	// forget every mesh
+	void Clear();
+
+private:
+	struct MESH_PARAMS_HASH
+	{
+		size_t operator()(const MESH_PARAMS& params) const;
+	};
+
+	// clear the parameters a shape does not use so they do
+	// not make distinct meshes
+	static MESH_PARAMS Normalize(const MESH_PARAMS& params);
+
+	// handle of every distinct set of parameters
+	std::unordered_map<MESH_PARAMS, uint32_t, MESH_PARAMS_HASH> m_handles;
+	// parameters, mesh and state of every handle
+	std::vector<MESH_PARAMS> m_params;
+	std::vector<MESH_DATA> m_meshes;
+	std::vector<uint8_t> m_bGenerated;
+	std::vector<MESH_OPTIMIZE_STATS> m_stats;
+	// whether generated meshes are optimized
+	bool m_bOptimize;
+	// number of requests and of threads last used
+	uint32_t m_requestCount;
+	uint32_t m_threadCount;
+};
@@ -0,0 +1,346 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgeometry.cpp
+// ============
+// generate the vertex and index data for the basic 3D shapes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshGeometry.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	const float g_Pi = 3.14159265f;
+
+	/***********************************************************
+	 *  AddVertex()
+	 *
+	 *  Appends a vertex and returns its index.
+	 ***********************************************************/
+	uint32_t AddVertex(
+		MESH_DATA& mesh,
+		float x, float y, float z,
+		float nx, float ny, float nz,
+		float u, float v)
+	{
+		MESH_VERTEX vertex = { { x, y, z }, { nx, ny, nz }, { u, v } };
+		mesh.vertices.push_back(vertex);
+		return((uint32_t)mesh.vertices.size() - 1);
+	}
+
+	/***********************************************************
+	 *  AddQuad()
+	 *
+	 *  Appends the two triangles of a counter-clockwise quad.
+	 ***********************************************************/
+	void AddQuad(MESH_DATA& mesh, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+	{
+		uint32_t quad[6] = { a, b, c, a, c, d };
+		mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+	}
+}
+
+/***********************************************************
+ *  GeneratePlane()
+ *
+ *  This method is used for generating a 2x2 plane in the XZ
+ *  plane facing up.
+ ***********************************************************/
+void MeshGeometry::GeneratePlane(MESH_DATA& mesh)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	uint32_t a = AddVertex(mesh, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f);
+	uint32_t b = AddVertex(mesh, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f);
+	uint32_t c = AddVertex(mesh, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f);
+	uint32_t d = AddVertex(mesh, -1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f);
+	AddQuad(mesh, a, b, c, d);
+}
+
+/***********************************************************
+ *  GenerateBox()
+ *
+ *  This method is used for generating a unit box centered on
+ *  the origin.  Every face has its own vertices so that the
+ *  normals and texture coordinates are per face.
+ ***********************************************************/
+void MeshGeometry::GenerateBox(MESH_DATA& mesh)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	// face normal, then the right and up directions across the face
+	const float faces[6][9] =
+	{
+		{  0.0f,  0.0f,  1.0f,   1.0f,  0.0f,  0.0f,   0.0f, 1.0f,  0.0f },
+		{  0.0f,  0.0f, -1.0f,  -1.0f,  0.0f,  0.0f,   0.0f, 1.0f,  0.0f },
+		{  1.0f,  0.0f,  0.0f,   0.0f,  0.0f, -1.0f,   0.0f, 1.0f,  0.0f },
+		{ -1.0f,  0.0f,  0.0f,   0.0f,  0.0f,  1.0f,   0.0f, 1.0f,  0.0f },
+		{  0.0f,  1.0f,  0.0f,   1.0f,  0.0f,  0.0f,   0.0f, 0.0f, -1.0f },
+		{  0.0f, -1.0f,  0.0f,   1.0f,  0.0f,  0.0f,   0.0f, 0.0f,  1.0f }
+	};
+
+	for (int face = 0; face < 6; face++)
+	{
+		const float* n = &faces[face][0];
+		const float* r = &faces[face][3];
+		const float* u = &faces[face][6];
+
+		uint32_t corners[4];
+		const float cornerSigns[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+		for (int corner = 0; corner < 4; corner++)
+		{
+			float sr = cornerSigns[corner][0] * 0.5f;
+			float su = cornerSigns[corner][1] * 0.5f;
+			corners[corner] = AddVertex(
+				mesh,
+				n[0] * 0.5f + r[0] * sr + u[0] * su,
+				n[1] * 0.5f + r[1] * sr + u[1] * su,
+				n[2] * 0.5f + r[2] * sr + u[2] * su,
+				n[0], n[1], n[2],
+				sr + 0.5f, su + 0.5f);
+		}
+		AddQuad(mesh, corners[0], corners[1], corners[2], corners[3]);
+	}
+}
+
+/***********************************************************
+ *  GenerateCylinder()
+ *
+ *  This method is used for generating a cylinder of radius
+ *  1 standing on the XZ plane with a height of 1.  The top
+ *  can be narrower, down to a cone, the side can be split
+ *  into stacks and the ends can be left open.
+ ***********************************************************/
+void MeshGeometry::GenerateCylinder(MESH_DATA& mesh, uint32_t sectors, uint32_t stacks, float topRadius, bool bCaps)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	// the side normals lean up as much as the side leans in
+	float slope = 1.0f - topRadius;
+	float normalScale = 1.0f / std::sqrt(1.0f + slope * slope);
+
+	// sides - the seam is duplicated so the texture wraps once
+	uint32_t sideStart = (uint32_t)mesh.vertices.size();
+	uint32_t columnVertices = stacks + 1;
+	for (uint32_t i = 0; i <= sectors; i++)
+	{
+		float angle = 2.0f * g_Pi * (float)i / (float)sectors;
+		float x = std::cos(angle);
+		float z = -std::sin(angle);
+		float u = (float)i / (float)sectors;
+
+		for (uint32_t stack = 0; stack <= stacks; stack++)
+		{
+			float y = (float)stack / (float)stacks;
+			float radius = 1.0f - slope * y;
+			AddVertex(mesh, x * radius, y, z * radius,
+				x * normalScale, slope * normalScale, z * normalScale, u, y);
+		}
+	}
+	for (uint32_t i = 0; i < sectors; i++)
+	{
+		for (uint32_t stack = 0; stack < stacks; stack++)
+		{
+			uint32_t bottom = sideStart + i * columnVertices + stack;
+			AddQuad(mesh, bottom, bottom + columnVertices, bottom + columnVertices + 1, bottom + 1);
+		}
+	}
+
+	if (bCaps == false)
+	{
+		return;
+	}
+
+	// top and bottom caps as triangle fans around a center vertex
+	for (int cap = 0; cap < 2; cap++)
+	{
+		float y = (cap == 0) ? 1.0f : 0.0f;
+		float ny = (cap == 0) ? 1.0f : -1.0f;
+		float radius = (cap == 0) ? topRadius : 1.0f;
+		if (radius <= 0.0f)
+			continue;
+
+		uint32_t center = AddVertex(mesh, 0.0f, y, 0.0f, 0.0f, ny, 0.0f, 0.5f, 0.5f);
+		uint32_t ringStart = (uint32_t)mesh.vertices.size();
+
+		for (uint32_t i = 0; i < sectors; i++)
+		{
+			float angle = 2.0f * g_Pi * (float)i / (float)sectors;
+			float x = std::cos(angle);
+			float z = -std::sin(angle);
+			AddVertex(mesh, x * radius, y, z * radius, 0.0f, ny, 0.0f, 0.5f + x * 0.5f, 0.5f - z * 0.5f);
+		}
+		for (uint32_t i = 0; i < sectors; i++)
+		{
+			uint32_t current = ringStart + i;
+			uint32_t next = ringStart + (i + 1) % sectors;
+			uint32_t triangle[3] = { center, current, next };
+			if (cap == 1)
+			{
+				triangle[1] = next;
+				triangle[2] = current;
+			}
+			mesh.indices.insert(mesh.indices.end(), triangle, triangle + 3);
+		}
+	}
+}
+
+/***********************************************************
+ *  GenerateTorus()
+ *
+ *  This method is used for generating a torus with a main
+ *  radius of 1 lying in the XY plane.
+ ***********************************************************/
+void MeshGeometry::GenerateTorus(MESH_DATA& mesh, uint32_t mainSegments, uint32_t tubeSegments, float tubeRadius)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	for (uint32_t i = 0; i <= mainSegments; i++)
+	{
+		float mainAngle = 2.0f * g_Pi * (float)i / (float)mainSegments;
+		float cosMain = std::cos(mainAngle);
+		float sinMain = std::sin(mainAngle);
+
+		for (uint32_t j = 0; j <= tubeSegments; j++)
+		{
+			float tubeAngle = 2.0f * g_Pi * (float)j / (float)tubeSegments;
+			float cosTube = std::cos(tubeAngle);
+			float sinTube = std::sin(tubeAngle);
+
+			float ringRadius = 1.0f + tubeRadius * cosTube;
+			AddVertex(
+				mesh,
+				ringRadius * cosMain, ringRadius * sinMain, tubeRadius * sinTube,
+				cosTube * cosMain, cosTube * sinMain, sinTube,
+				(float)i / (float)mainSegments, (float)j / (float)tubeSegments);
+		}
+	}
+
+	uint32_t ringVertices = tubeSegments + 1;
+	for (uint32_t i = 0; i < mainSegments; i++)
+	{
+		for (uint32_t j = 0; j < tubeSegments; j++)
+		{
+			uint32_t a = i * ringVertices + j;
+			uint32_t b = (i + 1) * ringVertices + j;
+			AddQuad(mesh, a, b, b + 1, a + 1);
+		}
+	}
+}
+
+/***********************************************************
+ *  GenerateSphere()
+ *
+ *  This method is used for generating a sphere of radius 1
+ *  around the origin, split into segments around the y axis
+ *  and rings from pole to pole.
+ ***********************************************************/
+void MeshGeometry::GenerateSphere(MESH_DATA& mesh, uint32_t segments, uint32_t rings)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	// every ring has its own seam vertex, and the poles are rings
+	// of vertices in the same place so each quad keeps its uv
+	for (uint32_t ring = 0; ring <= rings; ring++)
+	{
+		float ringAngle = g_Pi * (float)ring / (float)rings;
+		float y = std::cos(ringAngle);
+		float ringRadius = std::sin(ringAngle);
+
+		for (uint32_t i = 0; i <= segments; i++)
+		{
+			float angle = 2.0f * g_Pi * (float)i / (float)segments;
+			float x = std::cos(angle) * ringRadius;
+			float z = -std::sin(angle) * ringRadius;
+			AddVertex(mesh, x, y, z, x, y, z, (float)i / (float)segments, 1.0f - (float)ring / (float)rings);
+		}
+	}
+
+	uint32_t ringVertices = segments + 1;
+	for (uint32_t ring = 0; ring < rings; ring++)
+	{
+		for (uint32_t i = 0; i < segments; i++)
+		{
+			uint32_t top = ring * ringVertices + i;
+			uint32_t bottom = top + ringVertices;
+			// the quads touching a pole are triangles
+			if (ring > 0)
+			{
+				uint32_t triangle[3] = { top, bottom, top + 1 };
+				mesh.indices.insert(mesh.indices.end(), triangle, triangle + 3);
+			}
+			if (ring + 1 < rings)
+			{
+				uint32_t triangle[3] = { top + 1, bottom, bottom + 1 };
+				mesh.indices.insert(mesh.indices.end(), triangle, triangle + 3);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ComputeBounds()
+ *
+ *  This method is used for finding the box around the
+ *  vertices of a mesh, and the smallest sphere around them
+ *  that shares the center of the box.
+ ***********************************************************/
+void MeshGeometry::ComputeBounds(const MESH_DATA& mesh, MESH_BOUNDS& bounds)
+{
+	ComputeBounds(mesh.vertices.data(), (uint32_t)mesh.vertices.size(), bounds);
+}
+
+/***********************************************************
+ *  ComputeBounds()
+ *
+ *  This method is used for finding the bounds of vertices
+ *  that are not held in a mesh, like a mapped mesh cache.
+ ***********************************************************/
+void MeshGeometry::ComputeBounds(const MESH_VERTEX* pVertices, uint32_t vertexCount, MESH_BOUNDS& bounds)
+{
+	bounds = MESH_BOUNDS();
+	if (vertexCount == 0)
+	{
+		return;
+	}
+
+	float minimum[3];
+	float maximum[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		minimum[axis] = pVertices[0].position[axis];
+		maximum[axis] = pVertices[0].position[axis];
+	}
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		const MESH_VERTEX& vertex = pVertices[i];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			minimum[axis] = std::min(minimum[axis], vertex.position[axis]);
+			maximum[axis] = std::max(maximum[axis], vertex.position[axis]);
+		}
+	}
+	for (int axis = 0; axis < 3; axis++)
+	{
+		bounds.center[axis] = (minimum[axis] + maximum[axis]) * 0.5f;
+		bounds.extents[axis] = (maximum[axis] - minimum[axis]) * 0.5f;
+	}
+
+	float radiusSquared = 0.0f;
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		const MESH_VERTEX& vertex = pVertices[i];
+		float x = vertex.position[0] - bounds.center[0];
+		float y = vertex.position[1] - bounds.center[1];
+		float z = vertex.position[2] - bounds.center[2];
+		radiusSquared = std::max(radiusSquared, x * x + y * y + z * z);
+	}
+	bounds.radius = std::sqrt(radiusSquared);
+}
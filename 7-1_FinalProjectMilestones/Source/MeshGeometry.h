@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgeometry.h
+// ============
+// generate the vertex and index data for the basic 3D shapes
+//
+// The shapes use the same sizes and orientation as the ShapeMeshes
+// primitives: a 2x2 plane in XZ, a unit box centered on the origin, a
+// cylinder of radius 1 from y=0 to y=1 and a torus of radius 1 in XY.  The
+// sphere, which ShapeMeshes does not have, has radius 1 around the origin.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MESH_VERTEX
+ *
+ *  Vertex layout shared with ShapeMeshes - position,
+ *  normal and texture coordinate.
+ ***********************************************************/
+struct MESH_VERTEX
+{
+	float position[3];
+	float normal[3];
+	float uv[2];
+};
+
+/***********************************************************
+ *  MESH_DATA
+ *
+ *  Indexed triangle list for one shape.
+ ***********************************************************/
+struct MESH_DATA
+{
+	std::vector<MESH_VERTEX> vertices;
+	std::vector<uint32_t> indices;
+};
+
+/***********************************************************
+ *  MESH_BOUNDS
+ *
+ *  Axis aligned box around a mesh, as its center and half
+ *  size, and the sphere around the same center.
+ ***********************************************************/
+struct MESH_BOUNDS
+{
+	float center[3];
+	float extents[3];
+	float radius;
+};
+
+/***********************************************************
+ *  MeshGeometry
+ *
+ *  This class contains the generators for the basic shapes.
+ ***********************************************************/
+class MeshGeometry
+{
+public:
+	static void GeneratePlane(MESH_DATA& mesh);
+	static void GenerateBox(MESH_DATA& mesh);
+	// a top radius of 0 makes a cone, stacks split the side
+	static void GenerateCylinder(MESH_DATA& mesh, uint32_t sectors = 36, uint32_t stacks = 1, float topRadius = 1.0f, bool bCaps = true);
+	static void GenerateTorus(MESH_DATA& mesh, uint32_t mainSegments = 36, uint32_t tubeSegments = 18, float tubeRadius = 0.1f);
+	static void GenerateSphere(MESH_DATA& mesh, uint32_t segments = 36, uint32_t rings = 18);
+
+	// box and sphere around the vertices of a mesh
+	static void ComputeBounds(const MESH_DATA& mesh, MESH_BOUNDS& bounds);
+	static void ComputeBounds(const MESH_VERTEX* pVertices, uint32_t vertexCount, MESH_BOUNDS& bounds);
+};
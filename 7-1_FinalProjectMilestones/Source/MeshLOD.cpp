@@ -0,0 +1,191 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlod.cpp
+// ============
+// pick the tessellation of the curved shapes by their size on screen
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshLOD.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// declaration of global variables
+namespace
+{
+	// segments of the cylinder levels, the first one matching
+	// the ShapeMeshes cylinder
+	const uint32_t g_CylinderSectors[] = { 36, 18, 10, 6 };
+
+	// main and tube segments of the torus levels, the first
+	// one matching the ShapeMeshes torus
+	const uint32_t g_TorusSegments[][2] = { { 36, 18 }, { 24, 12 }, { 14, 8 }, { 8, 6 } };
+	const float g_TorusTubeRadius = 0.1f;
+
+	// distance in pixels a flat segment may stray from the curve
+	const float g_MaxErrorPixels = 1.0f;
+
+	// fraction below the size of a coarser level an object has
+	// to shrink to before it switches to that level
+	const float g_Hysteresis = 0.2f;
+
+	/***********************************************************
+	 *  GetMaxPixels()
+	 *
+	 *  Returns the projected diameter of the bounding sphere up
+	 *  to which a circle of the given fraction of the sphere
+	 *  radius, split into segments, stays within the error.
+	 *  The chord of a segment strays r * (1 - cos(pi / n))
+	 *  from the circle.
+	 ***********************************************************/
+	float GetMaxPixels(uint32_t segments, float radiusFraction)
+	{
+		float chordError = 1.0f - std::cos(3.14159265f / (float)segments);
+		return(2.0f * g_MaxErrorPixels / (chordError * radiusFraction));
+	}
+}
+
+/***********************************************************
+ *  MeshLOD()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshLOD::MeshLOD()
+{
+}
+
+/***********************************************************
+ *  ~MeshLOD()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshLOD::~MeshLOD()
+{
+}
+
+/***********************************************************
+ *  RequestLevels()
+ *
+ *  This method is used for requesting the tessellations of
+ *  a basic shape and setting the sizes they are used up to.
+ *  The plane and box have a single level.  The circles of
+ *  the cylinder and the ring of the torus are taken as large
+ *  as the bounding sphere, which errs on the detailed side.
+ *  The triangle counts are set once the meshes exist.
+ ***********************************************************/
+void MeshLOD::RequestLevels(uint32_t shape, MeshGenerator& meshGenerator, std::vector<uint32_t>& levelMeshes)
+{
+	m_levels[shape].clear();
+	levelMeshes.clear();
+
+	MESH_PARAMS params = MeshGenerator::GetDefaultParams(shape);
+	switch (shape)
+	{
+	case SCENE_MESH_PLANE:
+	case SCENE_MESH_BOX:
+		levelMeshes.push_back(meshGenerator.RequestMesh(params));
+		break;
+	case SCENE_MESH_CYLINDER:
+		for (uint32_t sectors : g_CylinderSectors)
+		{
+			params.segments = sectors;
+			levelMeshes.push_back(meshGenerator.RequestMesh(params));
+		}
+		break;
+	case SCENE_MESH_TORUS:
+		for (const uint32_t* pSegments : g_TorusSegments)
+		{
+			params.segments = pSegments[0];
+			params.rings = pSegments[1];
+			params.radius = g_TorusTubeRadius;
+			levelMeshes.push_back(meshGenerator.RequestMesh(params));
+		}
+		break;
+	default:
+		return;
+	}
+
+	for (size_t level = 0; level < levelMeshes.size(); level++)
+	{
+		LOD_LEVEL lodLevel;
+		lodLevel.meshType = shape;
+		lodLevel.triangleCount = 0;
+		lodLevel.maxPixels = std::numeric_limits<float>::max();
+		if (level > 0)
+		{
+			if (shape == SCENE_MESH_CYLINDER)
+			{
+				lodLevel.maxPixels = GetMaxPixels(g_CylinderSectors[level], 1.0f);
+			}
+			else
+			{
+				// the tube is a small circle of its own
+				lodLevel.maxPixels = std::min(
+					GetMaxPixels(g_TorusSegments[level][0], 1.0f),
+					GetMaxPixels(g_TorusSegments[level][1], g_TorusTubeRadius / (1.0f + g_TorusTubeRadius)));
+			}
+		}
+		m_levels[shape].push_back(lodLevel);
+	}
+}
+
+/***********************************************************
+ *  SetLevelMesh()
+ *
+ *  This method is used for setting the mesh type a level is
+ *  drawn with and the triangles it has.
+ ***********************************************************/
+void MeshLOD::SetLevelMesh(uint32_t shape, uint32_t level, uint32_t meshType, uint32_t triangleCount)
+{
+	if (level < m_levels[shape].size())
+	{
+		m_levels[shape][level].meshType = meshType;
+		m_levels[shape][level].triangleCount = triangleCount;
+	}
+}
+
+/***********************************************************
+ *  SelectLevel()
+ *
+ *  This method is used for picking the level of an object.
+ *  It gets finer as soon as its level is too coarse for its
+ *  size, and coarser only when it is well below the size of
+ *  the coarser level.
+ ***********************************************************/
+uint32_t MeshLOD::SelectLevel(uint32_t shape, float pixels, uint32_t currentLevel) const
+{
+	const std::vector<LOD_LEVEL>& levels = m_levels[shape];
+	if (levels.size() < 2)
+	{
+		return(0);
+	}
+
+	uint32_t level = std::min(currentLevel, (uint32_t)levels.size() - 1);
+	while ((level > 0) && (pixels > levels[level].maxPixels))
+	{
+		level--;
+	}
+	while ((level + 1 < levels.size()) && (pixels < levels[level + 1].maxPixels * (1.0f - g_Hysteresis)))
+	{
+		level++;
+	}
+
+	return(level);
+}
+
+/***********************************************************
+ *  GetProjectedSize()
+ *
+ *  This method is used for getting the height in pixels of
+ *  a sphere on the screen.  A camera inside the sphere sees
+ *  it as filling the screen.
+ ***********************************************************/
+float MeshLOD::GetProjectedSize(float radius, float distance, float projectionScale, int viewportHeight)
+{
+	if (distance <= radius)
+	{
+		return(std::numeric_limits<float>::max());
+	}
+
+	return(radius * projectionScale * (float)viewportHeight / distance);
+}
@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlod.h
+// ============
+// pick the tessellation of the curved shapes by their size on screen
+//
+// The cylinder and torus are tessellated at a few levels by the mesh
+// generator.  Each
+// level is used while the projected diameter of the bounding sphere of an
+// object is small enough that its flat segments stay within a pixel of the
+// true curve.  A shape only gets coarser once it is clearly below the size
+// of the next level, so an object near a threshold does not switch back and
+// forth from frame to frame.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshGenerator.h"
+#include "SceneFile.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  LOD_LEVEL
+ *
+ *  One tessellation of a shape, the mesh type it is drawn
+ *  with and the largest projected diameter in pixels it is
+ *  used at.
+ ***********************************************************/
+struct LOD_LEVEL
+{
+	uint32_t meshType;
+	uint32_t triangleCount;
+	float maxPixels;
+};
+
+/***********************************************************
+ *  MeshLOD
+ *
+ *  This class contains the tessellation levels of every
+ *  basic shape.
+ ***********************************************************/
+class MeshLOD
+{
+public:
+	// constructor
+	MeshLOD();
+	// destructor
+	~MeshLOD();
+
+	// request the meshes of the levels of a basic shape, most
+	// detailed first.  The first level is the mesh the shape
+	// is loaded with and keeps the shape as its mesh type.
+	void RequestLevels(uint32_t shape, MeshGenerator& meshGenerator, std::vector<uint32_t>& levelMeshes);
+	// set the mesh type a level was loaded as and its size
+	void SetLevelMesh(uint32_t shape, uint32_t level, uint32_t meshType, uint32_t triangleCount);
+
+	// access the levels
+	uint32_t GetLevelCount(uint32_t shape) const { return((uint32_t)m_levels[shape].size()); }
+	const LOD_LEVEL& GetLevel(uint32_t shape, uint32_t level) const { return(m_levels[shape][level]); }
+
+	// level for an object of the given projected diameter,
+	// starting from the level it was drawn with last
+	uint32_t SelectLevel(uint32_t shape, float pixels, uint32_t currentLevel) const;
+
+	// projected diameter in pixels of a sphere, for the scale
+	// of the projection matrix along y and the viewport height
+	static float GetProjectedSize(float radius, float distance, float projectionScale, int viewportHeight);
+
+private:
+	std::vector<LOD_LEVEL> m_levels[SCENE_MESH_COUNT];
+};
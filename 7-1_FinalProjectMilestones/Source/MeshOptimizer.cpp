@@ -0,0 +1,426 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// reorder the generated meshes for the vertex cache, overdraw and fetching
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// declaration of global variables
+namespace
+{
+	// how much worse than its whole cluster the start of a
+	// cluster may be on the simulated cache before it is split
+	// off as a cluster of its own
+	const float g_ClusterCacheRatio = 1.05f;
+	// fewest triangles of a cluster, smaller ones are merged
+	// into the cluster before them
+	const uint32_t g_MinClusterTriangles = 16;
+
+	// vertex that has not been through the cache yet
+	const uint32_t g_NeverCached = std::numeric_limits<uint32_t>::max();
+
+	/***********************************************************
+	 *  CountMisses()
+	 *
+	 *  Returns the cache misses of a range of triangles drawn
+	 *  through a FIFO cache that starts empty.  The stamps of
+	 *  the vertices are reset on the way out.
+	 ***********************************************************/
+	uint32_t CountMisses(const uint32_t* pIndices, uint32_t triangleCount, uint32_t cacheSize, std::vector<uint32_t>& stamps)
+	{
+		uint32_t misses = 0;
+		for (uint32_t i = 0; i < triangleCount * 3; i++)
+		{
+			uint32_t& stamp = stamps[pIndices[i]];
+			if ((stamp == g_NeverCached) || (misses - stamp > cacheSize))
+			{
+				stamp = misses;
+				misses++;
+			}
+		}
+		for (uint32_t i = 0; i < triangleCount * 3; i++)
+		{
+			stamps[pIndices[i]] = g_NeverCached;
+		}
+		return(misses);
+	}
+
+	/***********************************************************
+	 *  SkipDeadEnd()
+	 *
+	 *  Returns the vertex Tipsify continues from when the last
+	 *  fan has no neighbor with triangles left - the latest
+	 *  emitted vertex that still has some, or failing that the
+	 *  next one in input order.  -1 means every triangle is out.
+	 ***********************************************************/
+	int SkipDeadEnd(const std::vector<uint32_t>& liveCounts, std::vector<uint32_t>& deadEnds, uint32_t& cursor)
+	{
+		while (!deadEnds.empty())
+		{
+			uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveCounts[vertex] > 0)
+			{
+				return((int)vertex);
+			}
+		}
+		while (cursor < liveCounts.size())
+		{
+			if (liveCounts[cursor] > 0)
+			{
+				return((int)cursor);
+			}
+			cursor++;
+		}
+		return(-1);
+	}
+}
+
+/***********************************************************
+ *  OptimizeMesh()
+ *
+ *  This method is used for running the cache, overdraw and
+ *  fetch passes on a mesh in that order.  A mesh whose cache
+ *  order gains too little to pay for the cluster order, like
+ *  the strip of a cylinder side, keeps the cache order.
+ ***********************************************************/
+void MeshOptimizer::OptimizeMesh(MESH_DATA& mesh, MESH_OPTIMIZE_STATS* pStats)
+{
+	uint32_t vertexCount = (uint32_t)mesh.vertices.size();
+	float acmrBefore = SimulateACMR(mesh.indices, vertexCount, CACHE_SIZE);
+
+	std::vector<uint32_t> clusterStarts;
+	OptimizeVertexCache(mesh.indices, vertexCount, CACHE_SIZE, clusterStarts);
+
+	std::vector<uint32_t> clusterIndices(mesh.indices);
+	OptimizeOverdraw(mesh, clusterIndices, clusterStarts);
+	if (SimulateACMR(clusterIndices, vertexCount, CACHE_SIZE) <= acmrBefore)
+	{
+		mesh.indices.swap(clusterIndices);
+	}
+	else
+	{
+		clusterStarts.assign(1, 0);
+	}
+
+	OptimizeVertexFetch(mesh);
+
+	if (pStats != nullptr)
+	{
+		pStats->acmrBefore = acmrBefore;
+		pStats->acmrAfter = SimulateACMR(mesh.indices, (uint32_t)mesh.vertices.size(), CACHE_SIZE);
+		pStats->clusterCount = (uint32_t)clusterStarts.size();
+	}
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This method is used for reordering the triangles with
+ *  Tipsify.  It emits every remaining triangle around a
+ *  fanning vertex, then moves on to the vertex of that fan
+ *  which was cached longest ago and will still be cached
+ *  once its own triangles are emitted.  A fan with no such
+ *  vertex jumps elsewhere, which starts a cluster.  Clusters
+ *  are split further once their start does about as well on
+ *  a cold cache as the whole of them.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize, std::vector<uint32_t>& clusterStarts)
+{
+	uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+	clusterStarts.clear();
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// triangles of every vertex, packed one vertex after another
+	std::vector<uint32_t> liveCounts(vertexCount, 0);
+	for (uint32_t index : indices)
+	{
+		liveCounts[index]++;
+	}
+	std::vector<uint32_t> firstTriangles(vertexCount + 1, 0);
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		firstTriangles[vertex + 1] = firstTriangles[vertex] + liveCounts[vertex];
+	}
+	std::vector<uint32_t> adjacency(indices.size());
+	std::vector<uint32_t> fillCounts(firstTriangles.begin(), firstTriangles.end() - 1);
+	for (uint32_t i = 0; i < (uint32_t)indices.size(); i++)
+	{
+		adjacency[fillCounts[indices[i]]++] = i / 3;
+	}
+
+	std::vector<uint32_t> stamps(vertexCount, 0);
+	std::vector<uint8_t> bEmitted(triangleCount, 0);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+
+	// time starts past the cache size so no vertex is cached
+	uint32_t time = cacheSize + 1;
+	uint32_t cursor = 0;
+	int fanning = SkipDeadEnd(liveCounts, deadEnds, cursor);
+	bool bJumped = true;
+
+	while (fanning >= 0)
+	{
+		uint32_t emittedCount = (uint32_t)(output.size() / 3);
+		if ((bJumped == true) &&
+			(clusterStarts.empty() || (emittedCount - clusterStarts.back() >= g_MinClusterTriangles)))
+		{
+			clusterStarts.push_back(emittedCount);
+		}
+
+		candidates.clear();
+		for (uint32_t i = firstTriangles[fanning]; i < firstTriangles[fanning + 1]; i++)
+		{
+			uint32_t triangle = adjacency[i];
+			if (bEmitted[triangle] != 0)
+				continue;
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = indices[triangle * 3 + corner];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveCounts[vertex]--;
+				if (time - stamps[vertex] > cacheSize)
+				{
+					stamps[vertex] = time;
+					time++;
+				}
+			}
+			bEmitted[triangle] = 1;
+		}
+
+		// the oldest candidate that stays cached through its own
+		// fan, any candidate with triangles left otherwise
+		int nextVertex = -1;
+		int bestPriority = -1;
+		for (uint32_t vertex : candidates)
+		{
+			if (liveCounts[vertex] == 0)
+				continue;
+
+			int priority = 0;
+			if (time - stamps[vertex] + 2 * liveCounts[vertex] <= cacheSize)
+			{
+				priority = (int)(time - stamps[vertex]);
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				nextVertex = (int)vertex;
+			}
+		}
+
+		bJumped = (nextVertex < 0);
+		if (bJumped == true)
+		{
+			nextVertex = SkipDeadEnd(liveCounts, deadEnds, cursor);
+		}
+		fanning = nextVertex;
+	}
+
+	indices.swap(output);
+
+	// split the clusters where a cold cache costs little
+	std::vector<uint32_t> hardStarts;
+	hardStarts.swap(clusterStarts);
+	hardStarts.push_back(triangleCount);
+	std::vector<uint32_t> cacheStamps(vertexCount, g_NeverCached);
+
+	for (size_t cluster = 0; cluster + 1 < hardStarts.size(); cluster++)
+	{
+		uint32_t start = hardStarts[cluster];
+		uint32_t end = hardStarts[cluster + 1];
+		float clusterAcmr = (float)CountMisses(&indices[start * 3], end - start, cacheSize, cacheStamps) / (float)(end - start);
+		float splitAcmr = clusterAcmr * g_ClusterCacheRatio;
+
+		clusterStarts.push_back(start);
+		uint32_t misses = 0;
+		uint32_t subStart = start;
+		for (uint32_t triangle = start; triangle < end; triangle++)
+		{
+			for (int corner = 0; corner < 3; corner++)
+			{
+				uint32_t& stamp = cacheStamps[indices[triangle * 3 + corner]];
+				if ((stamp == g_NeverCached) || (misses - stamp > cacheSize))
+				{
+					stamp = misses;
+					misses++;
+				}
+			}
+
+			uint32_t subTriangles = triangle + 1 - subStart;
+			if ((subTriangles >= g_MinClusterTriangles) && (end - triangle - 1 >= g_MinClusterTriangles) &&
+				((float)misses <= splitAcmr * (float)subTriangles))
+			{
+				// the next cluster starts on a cold cache
+				for (uint32_t i = subStart * 3; i < (triangle + 1) * 3; i++)
+				{
+					cacheStamps[indices[i]] = g_NeverCached;
+				}
+				subStart = triangle + 1;
+				misses = 0;
+				clusterStarts.push_back(subStart);
+			}
+		}
+		for (uint32_t i = subStart * 3; i < end * 3; i++)
+		{
+			cacheStamps[indices[i]] = g_NeverCached;
+		}
+	}
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  This method is used for ordering the clusters by how far
+ *  out of the mesh they face.  A cluster whose area weighted
+ *  normal points away from the center of the mesh, measured
+ *  from its own center, is more likely to be in front of the
+ *  others from any view, so it is drawn first and lets the
+ *  depth test reject the fragments behind it.
+ ***********************************************************/
+void MeshOptimizer::OptimizeOverdraw(const MESH_DATA& mesh, std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusterStarts)
+{
+	uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+	uint32_t clusterCount = (uint32_t)clusterStarts.size();
+	if (clusterCount < 2)
+	{
+		return;
+	}
+
+	// area weighted center and normal of every cluster, from
+	// the cross products of the triangle edges
+	std::vector<float> clusterData(clusterCount * 7, 0.0f);
+	float meshCenter[3] = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+
+	for (uint32_t cluster = 0; cluster < clusterCount; cluster++)
+	{
+		uint32_t end = (cluster + 1 < clusterCount) ? clusterStarts[cluster + 1] : triangleCount;
+		float* pData = &clusterData[cluster * 7];
+
+		for (uint32_t triangle = clusterStarts[cluster]; triangle < end; triangle++)
+		{
+			const float* p0 = mesh.vertices[indices[triangle * 3]].position;
+			const float* p1 = mesh.vertices[indices[triangle * 3 + 1]].position;
+			const float* p2 = mesh.vertices[indices[triangle * 3 + 2]].position;
+
+			float edge1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float edge2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float normal[3] =
+			{
+				edge1[1] * edge2[2] - edge1[2] * edge2[1],
+				edge1[2] * edge2[0] - edge1[0] * edge2[2],
+				edge1[0] * edge2[1] - edge1[1] * edge2[0]
+			};
+			float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float center = (p0[axis] + p1[axis] + p2[axis]) / 3.0f;
+				pData[axis] += center * area;
+				pData[3 + axis] += normal[axis];
+				meshCenter[axis] += center * area;
+			}
+			pData[6] += area;
+			meshArea += area;
+		}
+	}
+
+	if (meshArea <= 0.0f)
+	{
+		return;
+	}
+	for (int axis = 0; axis < 3; axis++)
+	{
+		meshCenter[axis] /= meshArea;
+	}
+
+	std::vector<float> sortKeys(clusterCount, 0.0f);
+	for (uint32_t cluster = 0; cluster < clusterCount; cluster++)
+	{
+		const float* pData = &clusterData[cluster * 7];
+		float normalLength = std::sqrt(pData[3] * pData[3] + pData[4] * pData[4] + pData[5] * pData[5]);
+		if ((pData[6] <= 0.0f) || (normalLength <= 0.0f))
+			continue;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			sortKeys[cluster] += (pData[axis] / pData[6] - meshCenter[axis]) * pData[3 + axis] / normalLength;
+		}
+	}
+
+	std::vector<uint32_t> order(clusterCount);
+	for (uint32_t cluster = 0; cluster < clusterCount; cluster++)
+	{
+		order[cluster] = cluster;
+	}
+	std::stable_sort(order.begin(), order.end(),
+		[&sortKeys](uint32_t a, uint32_t b) { return(sortKeys[a] > sortKeys[b]); });
+
+	std::vector<uint32_t> sorted;
+	sorted.reserve(indices.size());
+	for (uint32_t cluster : order)
+	{
+		uint32_t end = (cluster + 1 < clusterCount) ? clusterStarts[cluster + 1] : triangleCount;
+		sorted.insert(sorted.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + end * 3);
+	}
+	indices.swap(sorted);
+}
+
+/***********************************************************
+ *  OptimizeVertexFetch()
+ *
+ *  This method is used for renumbering the vertices in the
+ *  order the triangles first use them.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexFetch(MESH_DATA& mesh)
+{
+	std::vector<uint32_t> remap(mesh.vertices.size(), g_NeverCached);
+	std::vector<MESH_VERTEX> vertices;
+	vertices.reserve(mesh.vertices.size());
+
+	for (uint32_t& index : mesh.indices)
+	{
+		if (remap[index] == g_NeverCached)
+		{
+			remap[index] = (uint32_t)vertices.size();
+			vertices.push_back(mesh.vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	mesh.vertices.swap(vertices);
+}
+
+/***********************************************************
+ *  SimulateACMR()
+ *
+ *  This method is used for drawing the triangles through a
+ *  FIFO cache of the given size and returning the misses
+ *  per triangle.
+ ***********************************************************/
+float MeshOptimizer::SimulateACMR(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+	uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+	if (triangleCount == 0)
+	{
+		return(0.0f);
+	}
+
+	std::vector<uint32_t> stamps(vertexCount, g_NeverCached);
+	return((float)CountMisses(indices.data(), triangleCount, cacheSize, stamps) / (float)triangleCount);
+}
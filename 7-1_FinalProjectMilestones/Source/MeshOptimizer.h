@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// reorder the generated meshes for the vertex cache, overdraw and fetching
+//
+// The triangles are ordered with Tipsify (Sander, Nehab and Barczak, "Fast
+// Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007),
+// which fans around recently used vertices so the post-transform cache
+// keeps hitting.  The result is split into clusters where the cache would
+// be cold anyway, and the clusters facing out of the mesh are drawn first
+// so they hide the ones behind them.  Finally the vertices are renumbered
+// in the order the triangles first use them, so the vertex fetch walks the
+// buffer forwards.
+//
+// The cache is measured by a FIFO cache simulator as the average cache miss
+// ratio (ACMR), the transformed vertices per triangle.  It ranges from 0.5
+// for an ideal large mesh to 3 for no reuse at all.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshGeometry.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MESH_OPTIMIZE_STATS
+ *
+ *  Average cache miss ratio of a mesh before and after it
+ *  was optimized, and the clusters it was drawn in.
+ ***********************************************************/
+struct MESH_OPTIMIZE_STATS
+{
+	float acmrBefore;
+	float acmrAfter;
+	uint32_t clusterCount;
+};
+
+/***********************************************************
+ *  MeshOptimizer
+ *
+ *  This class contains the mesh reordering passes and the
+ *  vertex cache simulator.
+ ***********************************************************/
+class MeshOptimizer
+{
+public:
+	// entries of the simulated cache the passes optimize for
+	static const uint32_t CACHE_SIZE = 16;
+	// raise whenever a pass orders a mesh differently, so the
+	// mesh cache files written before are built again
+	static const uint32_t REVISION = 1;
+
+	// run every pass on a mesh, and fill the stats when given
+	static void OptimizeMesh(MESH_DATA& mesh, MESH_OPTIMIZE_STATS* pStats = nullptr);
+
+	// reorder the triangles for the vertex cache and return
+	// where each overdraw cluster starts, in triangles
+	static void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize, std::vector<uint32_t>& clusterStarts);
+	// reorder the clusters so the outward facing ones come first
+	static void OptimizeOverdraw(const MESH_DATA& mesh, std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusterStarts);
+	// renumber the vertices in order of first use, dropping the
+	// vertices no triangle uses
+	static void OptimizeVertexFetch(MESH_DATA& mesh);
+
+	// transformed vertices per triangle through a FIFO cache
+	static float SimulateACMR(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize);
+};
@@ -0,0 +1,543 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.cpp
+// ============
+// skip the scene objects that are hidden behind large occluders
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define OCCLUSION_CULLER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+// MSVC emits the intrinsics of any instruction set
+#define OCCLUSION_CULLER_SSE2
+#define OCCLUSION_CULLER_AVX
+#else
+#define OCCLUSION_CULLER_SSE2 __attribute__((target("sse2")))
+#define OCCLUSION_CULLER_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+// declaration of global variables
+namespace
+{
+	// -1 until a path is chosen, then the path in use
+	int g_Path = -1;
+
+	// triangles of a box, by the corner indices of BoxCorner()
+	const int g_BoxTriangles[12][3] =
+	{
+		{ 0, 1, 3 }, { 0, 3, 2 },	// -x
+		{ 4, 6, 7 }, { 4, 7, 5 },	// +x
+		{ 0, 4, 5 }, { 0, 5, 1 },	// -y
+		{ 2, 3, 7 }, { 2, 7, 6 },	// +y
+		{ 0, 2, 6 }, { 0, 6, 4 },	// -z
+		{ 1, 5, 7 }, { 1, 7, 3 }	// +z
+	};
+
+	/***********************************************************
+	 *  BoxCorner()
+	 *
+	 *  Returns a corner of a box, bit 2 of the index selecting
+	 *  the x side, bit 1 the y side and bit 0 the z side.
+	 ***********************************************************/
+	glm::vec4 BoxCorner(const MESH_BOUNDS& bounds, int corner)
+	{
+		return(glm::vec4(
+			bounds.center[0] + ((corner & 4) ? bounds.extents[0] : -bounds.extents[0]),
+			bounds.center[1] + ((corner & 2) ? bounds.extents[1] : -bounds.extents[1]),
+			bounds.center[2] + ((corner & 1) ? bounds.extents[2] : -bounds.extents[2]),
+			1.0f));
+	}
+
+	/***********************************************************
+	 *  RASTER_TRIANGLE
+	 *
+	 *  Screen space triangle ready for filling.  Each edge
+	 *  function is a*x + b*y + c and is not negative inside,
+	 *  and the depth is an affine function of the screen
+	 *  position as well.
+	 ***********************************************************/
+	struct RASTER_TRIANGLE
+	{
+		float edgeA[3];
+		float edgeB[3];
+		float edgeC[3];
+		float depthA;
+		float depthB;
+		float depthC;
+		int minX;
+		int maxX;
+		int minY;
+		int maxY;
+	};
+
+	/***********************************************************
+	 *  SetupTriangle()
+	 *
+	 *  Fills the edge and depth functions of a triangle from
+	 *  its screen positions, with x and y in pixels and z the
+	 *  depth.  Returns false when the triangle has no area or
+	 *  covers no pixels of the buffer.
+	 ***********************************************************/
+	bool SetupTriangle(const glm::vec3* pVertices, RASTER_TRIANGLE& triangle)
+	{
+		for (int edge = 0; edge < 3; edge++)
+		{
+			// the edge opposite of each vertex
+			const glm::vec3& start = pVertices[(edge + 1) % 3];
+			const glm::vec3& end = pVertices[(edge + 2) % 3];
+			triangle.edgeA[edge] = start.y - end.y;
+			triangle.edgeB[edge] = end.x - start.x;
+			triangle.edgeC[edge] = start.x * end.y - start.y * end.x;
+		}
+
+		float area = triangle.edgeC[0] + triangle.edgeC[1] + triangle.edgeC[2];
+		if (std::fabs(area) < 1e-6f)
+		{
+			return(false);
+		}
+		if (area < 0.0f)
+		{
+			for (int edge = 0; edge < 3; edge++)
+			{
+				triangle.edgeA[edge] = -triangle.edgeA[edge];
+				triangle.edgeB[edge] = -triangle.edgeB[edge];
+				triangle.edgeC[edge] = -triangle.edgeC[edge];
+			}
+			area = -area;
+		}
+
+		// the edge functions divided by the area weight the depths
+		triangle.depthA = 0.0f;
+		triangle.depthB = 0.0f;
+		triangle.depthC = 0.0f;
+		for (int edge = 0; edge < 3; edge++)
+		{
+			triangle.depthA += triangle.edgeA[edge] * pVertices[edge].z / area;
+			triangle.depthB += triangle.edgeB[edge] * pVertices[edge].z / area;
+			triangle.depthC += triangle.edgeC[edge] * pVertices[edge].z / area;
+		}
+
+		float minX = std::min(pVertices[0].x, std::min(pVertices[1].x, pVertices[2].x));
+		float maxX = std::max(pVertices[0].x, std::max(pVertices[1].x, pVertices[2].x));
+		float minY = std::min(pVertices[0].y, std::min(pVertices[1].y, pVertices[2].y));
+		float maxY = std::max(pVertices[0].y, std::max(pVertices[1].y, pVertices[2].y));
+		if ((maxX < 0.0f) || (maxY < 0.0f) ||
+			(minX >= (float)OCCLUSION_BUFFER_WIDTH) || (minY >= (float)OCCLUSION_BUFFER_HEIGHT))
+		{
+			return(false);
+		}
+
+		triangle.minX = std::max(0, (int)std::floor(minX));
+		triangle.maxX = std::min((int)OCCLUSION_BUFFER_WIDTH - 1, (int)std::floor(maxX));
+		triangle.minY = std::max(0, (int)std::floor(minY));
+		triangle.maxY = std::min((int)OCCLUSION_BUFFER_HEIGHT - 1, (int)std::floor(maxY));
+		return(true);
+	}
+
+	/***********************************************************
+	 *  Scalar filling
+	 *
+	 *  Keeps the nearest depth of every pixel whose center is
+	 *  inside the triangle.
+	 ***********************************************************/
+	void FillScalar(const RASTER_TRIANGLE& triangle, float* pDepth)
+	{
+		for (int y = triangle.minY; y <= triangle.maxY; y++)
+		{
+			float centerY = (float)y + 0.5f;
+			float row[3];
+			for (int edge = 0; edge < 3; edge++)
+			{
+				row[edge] = triangle.edgeB[edge] * centerY + triangle.edgeC[edge];
+			}
+			float rowDepth = triangle.depthB * centerY + triangle.depthC;
+
+			float* pRow = pDepth + y * OCCLUSION_BUFFER_WIDTH;
+			for (int x = triangle.minX; x <= triangle.maxX; x++)
+			{
+				float centerX = (float)x + 0.5f;
+				if ((triangle.edgeA[0] * centerX + row[0] >= 0.0f) &&
+					(triangle.edgeA[1] * centerX + row[1] >= 0.0f) &&
+					(triangle.edgeA[2] * centerX + row[2] >= 0.0f))
+				{
+					pRow[x] = std::min(pRow[x], triangle.depthA * centerX + rowDepth);
+				}
+			}
+		}
+	}
+
+#ifdef OCCLUSION_CULLER_X86
+	/***********************************************************
+	 *  SSE2 filling, 4 pixels at a time
+	 ***********************************************************/
+	OCCLUSION_CULLER_SSE2 void FillSSE2(const RASTER_TRIANGLE& triangle, float* pDepth)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 centerOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 edgeA0 = _mm_set1_ps(triangle.edgeA[0]);
+		const __m128 edgeA1 = _mm_set1_ps(triangle.edgeA[1]);
+		const __m128 edgeA2 = _mm_set1_ps(triangle.edgeA[2]);
+		const __m128 depthA = _mm_set1_ps(triangle.depthA);
+
+		// the buffer width is a multiple of the vector width
+		int firstX = triangle.minX & ~3;
+		for (int y = triangle.minY; y <= triangle.maxY; y++)
+		{
+			float centerY = (float)y + 0.5f;
+			__m128 row0 = _mm_set1_ps(triangle.edgeB[0] * centerY + triangle.edgeC[0]);
+			__m128 row1 = _mm_set1_ps(triangle.edgeB[1] * centerY + triangle.edgeC[1]);
+			__m128 row2 = _mm_set1_ps(triangle.edgeB[2] * centerY + triangle.edgeC[2]);
+			__m128 rowDepth = _mm_set1_ps(triangle.depthB * centerY + triangle.depthC);
+
+			float* pRow = pDepth + y * OCCLUSION_BUFFER_WIDTH;
+			for (int x = firstX; x <= triangle.maxX; x += 4)
+			{
+				__m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), centerOffsets);
+				__m128 inside = _mm_and_ps(
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA0, centerX), row0), zero),
+					_mm_and_ps(
+						_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA1, centerX), row1), zero),
+						_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA2, centerX), row2), zero)));
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				__m128 stored = _mm_loadu_ps(pRow + x);
+				__m128 nearest = _mm_min_ps(stored, _mm_add_ps(_mm_mul_ps(depthA, centerX), rowDepth));
+				_mm_storeu_ps(pRow + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, stored)));
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  AVX filling, 8 pixels at a time
+	 ***********************************************************/
+	OCCLUSION_CULLER_AVX void FillAVX(const RASTER_TRIANGLE& triangle, float* pDepth)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 centerOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+		const __m256 edgeA0 = _mm256_set1_ps(triangle.edgeA[0]);
+		const __m256 edgeA1 = _mm256_set1_ps(triangle.edgeA[1]);
+		const __m256 edgeA2 = _mm256_set1_ps(triangle.edgeA[2]);
+		const __m256 depthA = _mm256_set1_ps(triangle.depthA);
+
+		int firstX = triangle.minX & ~7;
+		for (int y = triangle.minY; y <= triangle.maxY; y++)
+		{
+			float centerY = (float)y + 0.5f;
+			__m256 row0 = _mm256_set1_ps(triangle.edgeB[0] * centerY + triangle.edgeC[0]);
+			__m256 row1 = _mm256_set1_ps(triangle.edgeB[1] * centerY + triangle.edgeC[1]);
+			__m256 row2 = _mm256_set1_ps(triangle.edgeB[2] * centerY + triangle.edgeC[2]);
+			__m256 rowDepth = _mm256_set1_ps(triangle.depthB * centerY + triangle.depthC);
+
+			float* pRow = pDepth + y * OCCLUSION_BUFFER_WIDTH;
+			for (int x = firstX; x <= triangle.maxX; x += 8)
+			{
+				__m256 centerX = _mm256_add_ps(_mm256_set1_ps((float)x), centerOffsets);
+				__m256 inside = _mm256_and_ps(
+					_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(edgeA0, centerX), row0), zero, _CMP_GE_OQ),
+					_mm256_and_ps(
+						_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(edgeA1, centerX), row1), zero, _CMP_GE_OQ),
+						_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(edgeA2, centerX), row2), zero, _CMP_GE_OQ)));
+				if (_mm256_movemask_ps(inside) == 0)
+					continue;
+
+				__m256 stored = _mm256_loadu_ps(pRow + x);
+				__m256 nearest = _mm256_min_ps(stored, _mm256_add_ps(_mm256_mul_ps(depthA, centerX), rowDepth));
+				_mm256_storeu_ps(pRow + x, _mm256_blendv_ps(stored, nearest, inside));
+			}
+		}
+	}
+#endif
+}
+
+/***********************************************************
+ *  OcclusionCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OcclusionCuller::OcclusionCuller()
+{
+	m_viewProjection = glm::mat4(1.0f);
+	m_occluderTriangles = 0;
+
+	// halve the buffer down to a single texel
+	DEPTH_LEVEL level = { OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_HEIGHT };
+	while (true)
+	{
+		m_levelSizes.push_back(level);
+		m_levels.push_back(std::vector<float>((size_t)level.width * level.height, 1.0f));
+		if ((level.width == 1) && (level.height == 1))
+			break;
+
+		level.width = std::max(1u, level.width / 2);
+		level.height = std::max(1u, level.height / 2);
+	}
+}
+
+/***********************************************************
+ *  ~OcclusionCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+/***********************************************************
+ *  GetPath()
+ *
+ *  This method is used for getting the instruction set the
+ *  occluders are rasterized with.  It starts with the
+ *  fastest one the image kernels found.  AVX2 is the
+ *  detected level, the rasterizer itself only needs AVX.
+ ***********************************************************/
+IMAGE_KERNEL_PATH OcclusionCuller::GetPath()
+{
+	if (g_Path < 0)
+	{
+		g_Path = (int)ImageKernels::GetBestPath();
+	}
+
+	return((IMAGE_KERNEL_PATH)g_Path);
+}
+
+/***********************************************************
+ *  SetPath()
+ *
+ *  This method is used for rasterizing with another
+ *  instruction set, limited to the fastest one.
+ ***********************************************************/
+void OcclusionCuller::SetPath(IMAGE_KERNEL_PATH path)
+{
+	g_Path = (int)std::min(path, ImageKernels::GetBestPath());
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for clearing the depth buffer to the
+ *  far plane for a new view.
+ ***********************************************************/
+void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection)
+{
+	m_viewProjection = viewProjection;
+	m_occluderTriangles = 0;
+	std::fill(m_levels[0].begin(), m_levels[0].end(), 1.0f);
+}
+
+/***********************************************************
+ *  AddOccluder()
+ *
+ *  This method is used for rasterizing the 12 triangles of
+ *  the box of an occluder into the depth buffer.  A plane
+ *  has a flat box, whose sides have no area and are skipped.
+ ***********************************************************/
+void OcclusionCuller::AddOccluder(const MESH_BOUNDS& meshBounds, const glm::mat4& world)
+{
+	glm::mat4 worldViewProjection = m_viewProjection * world;
+
+	glm::vec4 corners[8];
+	for (int corner = 0; corner < 8; corner++)
+	{
+		corners[corner] = worldViewProjection * BoxCorner(meshBounds, corner);
+	}
+
+	for (int triangle = 0; triangle < 12; triangle++)
+	{
+		DrawTriangle(
+			corners[g_BoxTriangles[triangle][0]],
+			corners[g_BoxTriangles[triangle][1]],
+			corners[g_BoxTriangles[triangle][2]]);
+	}
+}
+
+/***********************************************************
+ *  DrawTriangle()
+ *
+ *  This method is used for cutting off the part of a clip
+ *  space triangle in front of the near plane, and for
+ *  filling what is left as one or two screen triangles.
+ ***********************************************************/
+void OcclusionCuller::DrawTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+	const glm::vec4 vertices[3] = { a, b, c };
+
+	// a point is in front of the near plane when z < -w
+	glm::vec4 clipped[4];
+	int clippedCount = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec4& current = vertices[i];
+		const glm::vec4& next = vertices[(i + 1) % 3];
+		float currentDistance = current.z + current.w;
+		float nextDistance = next.z + next.w;
+
+		if (currentDistance >= 0.0f)
+		{
+			clipped[clippedCount++] = current;
+		}
+		if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+		{
+			float t = currentDistance / (currentDistance - nextDistance);
+			clipped[clippedCount++] = current + (next - current) * t;
+		}
+	}
+
+	if (clippedCount < 3)
+	{
+		return;
+	}
+
+	// from clip space to pixels, and depth from 0 to 1
+	glm::vec3 screen[4];
+	for (int i = 0; i < clippedCount; i++)
+	{
+		float inverseW = 1.0f / clipped[i].w;
+		screen[i] = glm::vec3(
+			(clipped[i].x * inverseW * 0.5f + 0.5f) * OCCLUSION_BUFFER_WIDTH,
+			(clipped[i].y * inverseW * 0.5f + 0.5f) * OCCLUSION_BUFFER_HEIGHT,
+			clipped[i].z * inverseW * 0.5f + 0.5f);
+	}
+
+	IMAGE_KERNEL_PATH path = GetPath();
+	for (int i = 2; i < clippedCount; i++)
+	{
+		const glm::vec3 fan[3] = { screen[0], screen[i - 1], screen[i] };
+		RASTER_TRIANGLE triangle;
+		if (SetupTriangle(fan, triangle) == false)
+			continue;
+
+		m_occluderTriangles++;
+		switch (path)
+		{
+#ifdef OCCLUSION_CULLER_X86
+		case IMAGE_KERNEL_AVX2:
+			FillAVX(triangle, m_levels[0].data());
+			break;
+		case IMAGE_KERNEL_SSE2:
+			FillSSE2(triangle, m_levels[0].data());
+			break;
+#endif
+		default:
+			FillScalar(triangle, m_levels[0].data());
+			break;
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildPyramid()
+ *
+ *  This method is used for filling every level above the
+ *  depth buffer with the farthest depth of the 2x2 texels
+ *  below it.
+ ***********************************************************/
+void OcclusionCuller::BuildPyramid()
+{
+	for (size_t level = 1; level < m_levels.size(); level++)
+	{
+		const std::vector<float>& source = m_levels[level - 1];
+		const DEPTH_LEVEL& sourceSize = m_levelSizes[level - 1];
+		std::vector<float>& target = m_levels[level];
+		const DEPTH_LEVEL& targetSize = m_levelSizes[level];
+
+		for (uint32_t y = 0; y < targetSize.height; y++)
+		{
+			uint32_t y0 = std::min(y * 2, sourceSize.height - 1);
+			uint32_t y1 = std::min(y * 2 + 1, sourceSize.height - 1);
+			for (uint32_t x = 0; x < targetSize.width; x++)
+			{
+				uint32_t x0 = std::min(x * 2, sourceSize.width - 1);
+				uint32_t x1 = std::min(x * 2 + 1, sourceSize.width - 1);
+				target[y * targetSize.width + x] = std::max(
+					std::max(source[y0 * sourceSize.width + x0], source[y0 * sourceSize.width + x1]),
+					std::max(source[y1 * sourceSize.width + x0], source[y1 * sourceSize.width + x1]));
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  IsOccluded()
+ *
+ *  This method is used for testing whether a world space
+ *  box is hidden.  The nearest depth of its corners is
+ *  compared with the farthest occluder depth under its
+ *  screen rectangle, read from the level where the
+ *  rectangle spans at most 4x4 texels.  The rectangle is
+ *  grown by a pixel, since occluders cover every pixel
+ *  whose center they cover, and a box crossing the near
+ *  plane is never hidden.
+ ***********************************************************/
+bool OcclusionCuller::IsOccluded(const MESH_BOUNDS& worldBounds) const
+{
+	float minX = std::numeric_limits<float>::max();
+	float maxX = -std::numeric_limits<float>::max();
+	float minY = std::numeric_limits<float>::max();
+	float maxY = -std::numeric_limits<float>::max();
+	float nearestDepth = 1.0f;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec4 clip = m_viewProjection * BoxCorner(worldBounds, corner);
+		if (clip.z < -clip.w)
+		{
+			return(false);
+		}
+
+		float inverseW = 1.0f / clip.w;
+		float x = clip.x * inverseW;
+		float y = clip.y * inverseW;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		nearestDepth = std::min(nearestDepth, clip.z * inverseW * 0.5f + 0.5f);
+	}
+
+	// boxes off the screen are left to the frustum culling
+	if ((maxX < -1.0f) || (minX > 1.0f) || (maxY < -1.0f) || (minY > 1.0f))
+	{
+		return(false);
+	}
+
+	int x0 = std::max(0, (int)std::floor((minX * 0.5f + 0.5f) * OCCLUSION_BUFFER_WIDTH) - 1);
+	int x1 = std::min((int)OCCLUSION_BUFFER_WIDTH - 1, (int)std::floor((maxX * 0.5f + 0.5f) * OCCLUSION_BUFFER_WIDTH) + 1);
+	int y0 = std::max(0, (int)std::floor((minY * 0.5f + 0.5f) * OCCLUSION_BUFFER_HEIGHT) - 1);
+	int y1 = std::min((int)OCCLUSION_BUFFER_HEIGHT - 1, (int)std::floor((maxY * 0.5f + 0.5f) * OCCLUSION_BUFFER_HEIGHT) + 1);
+
+	size_t level = 0;
+	while (((x1 - x0 >= 4) || (y1 - y0 >= 4)) && (level + 1 < m_levels.size()))
+	{
+		x0 >>= 1;
+		x1 >>= 1;
+		y0 >>= 1;
+		y1 >>= 1;
+		level++;
+	}
+
+	// the last levels can be narrower than the shifted rectangle
+	const DEPTH_LEVEL& levelSize = m_levelSizes[level];
+	x1 = std::min(x1, (int)levelSize.width - 1);
+	y1 = std::min(y1, (int)levelSize.height - 1);
+
+	const std::vector<float>& depth = m_levels[level];
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+		{
+			if (depth[y * levelSize.width + x] >= nearestDepth)
+			{
+				return(false);
+			}
+		}
+	}
+
+	return(true);
+}
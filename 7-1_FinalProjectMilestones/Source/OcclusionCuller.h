@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.h
+// ============
+// skip the scene objects that are hidden behind large occluders
+//
+// The boxes of a few designated occluders, such as walls and table tops, are
+// rasterized on the CPU into a small depth buffer, 4 or 8 pixels at a time
+// with SSE2 or AVX.  The buffer is reduced into a pyramid that keeps the
+// farthest depth of every 2x2 block, so the box of an object is tested with
+// a handful of reads at the level where its screen rectangle is small.  An
+// object is hidden when it is farther away than every occluder depth under
+// its rectangle.  No GPU is involved.
+//
+// Only boxes and planes can be occluders, since their boxes are solid.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ImageKernels.h"
+#include "MeshGeometry.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// size of the occlusion depth buffer, the width a multiple of 8
+const uint32_t OCCLUSION_BUFFER_WIDTH = 256;
+const uint32_t OCCLUSION_BUFFER_HEIGHT = 128;
+
+/***********************************************************
+ *  OcclusionCuller
+ *
+ *  This class contains the occluder depth buffer of one view
+ *  and its pyramid.
+ ***********************************************************/
+class OcclusionCuller
+{
+public:
+	// constructor
+	OcclusionCuller();
+	// destructor
+	~OcclusionCuller();
+
+	// instruction set the occluders are rasterized with,
+	// limited to the fastest one the processor supports
+	static IMAGE_KERNEL_PATH GetPath();
+	static void SetPath(IMAGE_KERNEL_PATH path);
+
+	// clear the depth buffer for a new view
+	void BeginFrame(const glm::mat4& viewProjection);
+	// rasterize the box of an occluder mesh placed by its
+	// world matrix
+	void AddOccluder(const MESH_BOUNDS& meshBounds, const glm::mat4& world);
+	// reduce the depth buffer into the pyramid once all of
+	// the occluders are in
+	void BuildPyramid();
+
+	// whether a world space box is entirely behind the occluders
+	bool IsOccluded(const MESH_BOUNDS& worldBounds) const;
+
+	// depth buffer of the occluders, from 0 at the near plane
+	// to 1 at the far plane, and the triangles drawn into it
+	const float* GetDepthBuffer() const { return(m_levels[0].data()); }
+	uint32_t GetOccluderTriangles() const { return(m_occluderTriangles); }
+
+private:
+	/***********************************************************
+	 *  DEPTH_LEVEL
+	 *
+	 *  Size of one level of the depth pyramid.
+	 ***********************************************************/
+	struct DEPTH_LEVEL
+	{
+		uint32_t width;
+		uint32_t height;
+	};
+
+	glm::mat4 m_viewProjection;
+	// farthest depth of every texel, level 0 the depth buffer
+	std::vector<std::vector<float>> m_levels;
+	std::vector<DEPTH_LEVEL> m_levelSizes;
+	uint32_t m_occluderTriangles;
+
+	// clip a triangle against the near plane and rasterize it
+	void DrawTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+};
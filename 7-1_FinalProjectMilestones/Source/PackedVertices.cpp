@@ -0,0 +1,275 @@
+///////////////////////////////////////////////////////////////////////////////
+// packedvertices.cpp
+// ============
+// pack the mesh vertices into half of the float layout
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PackedVertices.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// largest value of a 16-bit unsigned and signed normalized value
+	const float g_UnormScale = 65535.0f;
+	const float g_SnormScale = 32767.0f;
+
+	/***********************************************************
+	 *  SignNotZero()
+	 *
+	 *  Returns 1 for positive values and zero, -1 otherwise.
+	 ***********************************************************/
+	float SignNotZero(float value)
+	{
+		return((value >= 0.0f) ? 1.0f : -1.0f);
+	}
+}
+
+/***********************************************************
+ *  PackVertices()
+ *
+ *  This method is used for packing the vertices of a mesh.
+ *  The positions are quantized within the bounding box, an
+ *  axis the box is flat along stores zero.
+ ***********************************************************/
+void PackedVertices::PackVertices(const MESH_VERTEX* pVertices, uint32_t vertexCount, const MESH_BOUNDS& bounds, uint16_t meshBox, std::vector<PACKED_VERTEX>& packed)
+{
+	float minimum[3];
+	float size[3];
+	GetBoxScale(bounds, minimum, size);
+
+	float quantize[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		quantize[axis] = (size[axis] > 0.0f) ? g_UnormScale / size[axis] : 0.0f;
+	}
+
+	packed.resize(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		const MESH_VERTEX& vertex = pVertices[i];
+		PACKED_VERTEX& packedVertex = packed[i];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float value = (vertex.position[axis] - minimum[axis]) * quantize[axis] + 0.5f;
+			packedVertex.position[axis] = (uint16_t)std::min(std::max(value, 0.0f), g_UnormScale);
+		}
+		packedVertex.meshBox = meshBox;
+		EncodeNormal(vertex.normal, packedVertex.normal);
+		packedVertex.uv[0] = FloatToHalf(vertex.uv[0]);
+		packedVertex.uv[1] = FloatToHalf(vertex.uv[1]);
+	}
+}
+
+/***********************************************************
+ *  UnpackVertex()
+ *
+ *  This method is used for unpacking a vertex the way the
+ *  vertex shader does.
+ ***********************************************************/
+void PackedVertices::UnpackVertex(const PACKED_VERTEX& packed, const MESH_BOUNDS& bounds, MESH_VERTEX& vertex)
+{
+	float minimum[3];
+	float size[3];
+	GetBoxScale(bounds, minimum, size);
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		vertex.position[axis] = minimum[axis] + (float)packed.position[axis] / g_UnormScale * size[axis];
+	}
+	DecodeNormal(packed.normal, vertex.normal);
+	vertex.uv[0] = HalfToFloat(packed.uv[0]);
+	vertex.uv[1] = HalfToFloat(packed.uv[1]);
+}
+
+/***********************************************************
+ *  PackIndices()
+ *
+ *  This method is used for narrowing the indices of a mesh
+ *  to 16 bits.  The mesh must have no more vertices than
+ *  MAX_SHORT_INDEX_VERTICES.
+ ***********************************************************/
+void PackedVertices::PackIndices(const uint32_t* pIndices, uint32_t indexCount, std::vector<uint16_t>& packed)
+{
+	packed.resize(indexCount);
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		packed[i] = (uint16_t)pIndices[i];
+	}
+}
+
+/***********************************************************
+ *  GetBoxScale()
+ *
+ *  This method is used for getting the minimum corner and
+ *  the size of the bounding box.
+ ***********************************************************/
+void PackedVertices::GetBoxScale(const MESH_BOUNDS& bounds, float minimum[3], float size[3])
+{
+	for (int axis = 0; axis < 3; axis++)
+	{
+		minimum[axis] = bounds.center[axis] - bounds.extents[axis];
+		size[axis] = bounds.extents[axis] * 2.0f;
+	}
+}
+
+/***********************************************************
+ *  EncodeNormal()
+ *
+ *  This method is used for projecting a unit normal onto
+ *  the octahedron |x| + |y| + |z| = 1 and unfolding the
+ *  lower half over the corners, which maps every direction
+ *  into the square from -1 to 1.
+ ***********************************************************/
+void PackedVertices::EncodeNormal(const float normal[3], int16_t encoded[2])
+{
+	float length = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+	if (length <= 0.0f)
+	{
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+
+	float x = normal[0] / length;
+	float y = normal[1] / length;
+	if (normal[2] < 0.0f)
+	{
+		float foldedX = (1.0f - std::fabs(y)) * SignNotZero(x);
+		float foldedY = (1.0f - std::fabs(x)) * SignNotZero(y);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	encoded[0] = (int16_t)std::lround(std::min(std::max(x, -1.0f), 1.0f) * g_SnormScale);
+	encoded[1] = (int16_t)std::lround(std::min(std::max(y, -1.0f), 1.0f) * g_SnormScale);
+}
+
+/***********************************************************
+ *  DecodeNormal()
+ *
+ *  This method is used for turning an octahedral normal
+ *  back into a unit vector, as the vertex shader does.
+ ***********************************************************/
+void PackedVertices::DecodeNormal(const int16_t encoded[2], float normal[3])
+{
+	float x = std::max((float)encoded[0] / g_SnormScale, -1.0f);
+	float y = std::max((float)encoded[1] / g_SnormScale, -1.0f);
+	float z = 1.0f - std::fabs(x) - std::fabs(y);
+	if (z < 0.0f)
+	{
+		float unfoldedX = (1.0f - std::fabs(y)) * SignNotZero(x);
+		float unfoldedY = (1.0f - std::fabs(x)) * SignNotZero(y);
+		x = unfoldedX;
+		y = unfoldedY;
+	}
+
+	float length = std::sqrt(x * x + y * y + z * z);
+	normal[0] = x / length;
+	normal[1] = y / length;
+	normal[2] = z / length;
+}
+
+/***********************************************************
+ *  FloatToHalf()
+ *
+ *  This method is used for converting a float to a half
+ *  float.  Values too large become infinity, values too
+ *  small for a normal half become denormals or zero.
+ ***********************************************************/
+uint16_t PackedVertices::FloatToHalf(float value)
+{
+	uint32_t bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+	int32_t exponent = (int32_t)((bits >> 23) & 0xFF);
+	uint32_t mantissa = bits & 0x7FFFFF;
+
+	// infinity and not a number
+	if (exponent == 0xFF)
+	{
+		return((uint16_t)(sign | 0x7C00 | ((mantissa != 0) ? 0x200 : 0)));
+	}
+
+	exponent = exponent - 127 + 15;
+	if (exponent >= 0x1F)
+	{
+		return((uint16_t)(sign | 0x7C00));
+	}
+
+	if (exponent <= 0)
+	{
+		// denormal, the implicit leading bit shifts in
+		if (exponent < -10)
+		{
+			return(sign);
+		}
+		mantissa |= 0x800000;
+		uint32_t shift = (uint32_t)(14 - exponent);
+		uint32_t half = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if ((remainder > halfway) || ((remainder == halfway) && ((half & 1) != 0)))
+		{
+			half++;
+		}
+		return((uint16_t)(sign | half));
+	}
+
+	// a carry out of the mantissa rounds up into the exponent,
+	// which gives infinity past the largest half
+	uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+	uint32_t remainder = mantissa & 0x1FFF;
+	if ((remainder > 0x1000) || ((remainder == 0x1000) && ((half & 1) != 0)))
+	{
+		half++;
+	}
+	return((uint16_t)(sign | half));
+}
+
+/***********************************************************
+ *  HalfToFloat()
+ *
+ *  This method is used for converting a half float to a
+ *  float, which is always exact.
+ ***********************************************************/
+float PackedVertices::HalfToFloat(uint16_t value)
+{
+	uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1F;
+	uint32_t mantissa = value & 0x3FF;
+	uint32_t bits = 0;
+
+	if (exponent == 0x1F)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else if (exponent != 0)
+	{
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+	else if (mantissa != 0)
+	{
+		// denormal, normalize it for the float exponent
+		exponent = 127 - 15 + 1;
+		while ((mantissa & 0x400) == 0)
+		{
+			mantissa <<= 1;
+			exponent--;
+		}
+		bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+	}
+	else
+	{
+		bits = sign;
+	}
+
+	float result = 0.0f;
+	memcpy(&result, &bits, sizeof(result));
+	return(result);
+}
@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+// packedvertices.h
+// ============
+// pack the mesh vertices into half of the float layout
+//
+// A packed vertex is 16 bytes instead of 32.  The position is quantized to
+// 16 bits per axis within the bounding box of its mesh, and carries the
+// index of that box so the vertex shader can scale it back.  The normal is
+// folded onto an octahedron and stored as two 16-bit signed normalized
+// values, and the texture coordinate as two half floats.  Meshes of up to
+// 65536 vertices also get 16-bit indices.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshGeometry.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  PACKED_VERTEX
+ *
+ *  Packed vertex layout - the quantized position and the
+ *  mesh box it is relative to, the octahedral normal and
+ *  the half float texture coordinate.
+ ***********************************************************/
+struct PACKED_VERTEX
+{
+	uint16_t position[3];
+	uint16_t meshBox;
+	int16_t normal[2];
+	uint16_t uv[2];
+};
+
+/***********************************************************
+ *  PackedVertices
+ *
+ *  This class contains the conversions between the float
+ *  and the packed vertex layouts.
+ ***********************************************************/
+class PackedVertices
+{
+public:
+	// largest vertex count a mesh can have for 16-bit indices
+	static const uint32_t MAX_SHORT_INDEX_VERTICES = 65536;
+
+	// pack the vertices of a mesh within its bounds
+	static void PackVertices(const MESH_VERTEX* pVertices, uint32_t vertexCount, const MESH_BOUNDS& bounds, uint16_t meshBox, std::vector<PACKED_VERTEX>& packed);
+	// unpack a vertex, for checking the precision
+	static void UnpackVertex(const PACKED_VERTEX& packed, const MESH_BOUNDS& bounds, MESH_VERTEX& vertex);
+	// narrow the indices of a mesh with few enough vertices
+	static void PackIndices(const uint32_t* pIndices, uint32_t indexCount, std::vector<uint16_t>& packed);
+
+	// corner and size of the box the positions are quantized
+	// in, as the vertex shader reads them
+	static void GetBoxScale(const MESH_BOUNDS& bounds, float minimum[3], float size[3]);
+
+	// octahedral normal encoding
+	static void EncodeNormal(const float normal[3], int16_t encoded[2]);
+	static void DecodeNormal(const int16_t encoded[2], float normal[3]);
+
+	// IEEE half float conversion, rounding to nearest even
+	static uint16_t FloatToHalf(float value);
+	static float HalfToFloat(uint16_t value);
+};
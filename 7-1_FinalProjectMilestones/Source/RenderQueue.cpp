@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.cpp
+// ============
+// collect and order the draw items of the 3D scene
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderQueue.h"
+
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// the sort runs over 8-bit digits of the 64-bit key
+	const int RADIX_BITS = 8;
+	const int RADIX_BUCKETS = 1 << RADIX_BITS;
+	const int RADIX_PASSES = 64 / RADIX_BITS;
+}
+
+/***********************************************************
+ *  RenderQueue()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderQueue::RenderQueue()
+{
+}
+
+/***********************************************************
+ *  ~RenderQueue()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RenderQueue::~RenderQueue()
+{
+}
+
+/***********************************************************
+ *  MakeSortKey()
+ *
+ *  This method is used for packing the draw state into a
+ *  sort key.  Fields are truncated to their bit widths.  The
+ *  depth must not be negative - the bits of a positive float
+ *  sort in the same order as its value.
+ ***********************************************************/
+uint64_t RenderQueue::MakeSortKey(
+	uint32_t pass,
+	uint32_t shader,
+	uint32_t texture,
+	uint32_t material,
+	uint32_t mesh,
+	float depth)
+{
+	uint32_t depthBits = 0;
+	if (depth > 0.0f)
+	{
+		memcpy(&depthBits, &depth, sizeof(depthBits));
+	}
+
+	// transparent draws are blended back to front
+	if (pass == RENDER_PASS_TRANSPARENT)
+	{
+		depthBits = ~depthBits;
+	}
+
+	return(((uint64_t)(pass & 0x3) << 62) |
+		((uint64_t)(shader & 0x3F) << 56) |
+		((uint64_t)(texture & 0xFF) << 48) |
+		((uint64_t)(material & 0xFF) << 40) |
+		((uint64_t)(mesh & 0xFF) << 32) |
+		(uint64_t)depthBits);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing the submitted items
+ *  while keeping their memory for the next frame.
+ ***********************************************************/
+void RenderQueue::Clear()
+{
+	m_items.clear();
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for adding a draw item.
+ ***********************************************************/
+void RenderQueue::Submit(uint64_t sortKey, uint32_t objectIndex, uint32_t itemType)
+{
+	RENDER_ITEM item;
+	item.sortKey = sortKey;
+	item.objectIndex = objectIndex;
+	item.itemType = itemType;
+
+	m_items.push_back(item);
+}
+
+/***********************************************************
+ *  Sort()
+ *
+ *  This method is used for ordering the items with a least
+ *  significant digit radix sort.  The histograms of all the
+ *  digits are gathered in one pass, and any digit that is
+ *  the same for every key is skipped, so keys that only
+ *  differ in a few fields only cost a few passes.  Items
+ *  with equal keys keep their submission order.
+ ***********************************************************/
+void RenderQueue::Sort()
+{
+	size_t itemCount = m_items.size();
+	if (itemCount < 2)
+	{
+		return;
+	}
+
+	uint32_t histograms[RADIX_PASSES][RADIX_BUCKETS];
+	memset(histograms, 0, sizeof(histograms));
+
+	for (size_t i = 0; i < itemCount; i++)
+	{
+		uint64_t key = m_items[i].sortKey;
+		for (int pass = 0; pass < RADIX_PASSES; pass++)
+		{
+			histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+		}
+	}
+
+	m_sortBuffer.resize(itemCount);
+	RENDER_ITEM* pSource = m_items.data();
+	RENDER_ITEM* pDestination = m_sortBuffer.data();
+
+	for (int pass = 0; pass < RADIX_PASSES; pass++)
+	{
+		uint32_t* histogram = histograms[pass];
+		int shift = pass * RADIX_BITS;
+
+		// every key has the same digit - nothing to reorder
+		if (histogram[(pSource[0].sortKey >> shift) & (RADIX_BUCKETS - 1)] == itemCount)
+			continue;
+
+		// convert the counts into starting offsets
+		uint32_t offset = 0;
+		for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++)
+		{
+			uint32_t count = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += count;
+		}
+
+		for (size_t i = 0; i < itemCount; i++)
+		{
+			uint32_t bucket = (uint32_t)((pSource[i].sortKey >> shift) & (RADIX_BUCKETS - 1));
+			pDestination[histogram[bucket]++] = pSource[i];
+		}
+
+		RENDER_ITEM* pSwap = pSource;
+		pSource = pDestination;
+		pDestination = pSwap;
+	}
+
+	// an odd number of passes leaves the result in the scratch buffer
+	if (pSource != m_items.data())
+	{
+		m_items.swap(m_sortBuffer);
+	}
+}
@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.h
+// ============
+// collect and order the draw items of the 3D scene
+//
+// Every draw is submitted with a 64-bit sort key.  Sorting the keys groups
+// draws that share a shader, texture, material and mesh, so the state only
+// has to be changed when the next item actually differs.
+//
+//   bits 62-63  pass      (opaque before transparent)
+//   bits 56-61  shader
+//   bits 48-55  texture array
+//   bits 40-47  material
+//   bits 32-39  mesh
+//   bits  0-31  depth     (front to back, back to front when transparent)
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// render passes, in the order they are drawn
+enum RENDER_PASS
+{
+	RENDER_PASS_OPAQUE = 0,
+	RENDER_PASS_TRANSPARENT = 1
+};
+
+// what the object index of a draw item refers to
+enum RENDER_ITEM_TYPE
+{
+	RENDER_ITEM_OBJECT = 0,			// a scene object
+	RENDER_ITEM_STATIC_BATCH = 1	// a merged batch of static objects
+};
+
+// value of a sort key field that is not used by the draw
+const uint32_t RENDER_KEY_UNUSED = 0xFF;
+
+// sort key bits that must match for items to share an instanced
+// draw - the pass, shader, texture and mesh, but not the material
+// or the depth, which are read per instance
+const uint64_t RENDER_KEY_INSTANCE_MASK = 0xFFFF00FF00000000ull;
+
+/***********************************************************
+ *  RENDER_ITEM
+ *
+ *  One draw in the render queue.
+ ***********************************************************/
+struct RENDER_ITEM
+{
+	uint64_t sortKey;
+	uint32_t objectIndex;
+	uint32_t itemType;
+};
+
+/***********************************************************
+ *  RENDER_STATS
+ *
+ *  Counters for the work done while drawing one frame.
+ ***********************************************************/
+struct RENDER_STATS
+{
+	uint32_t objects;
+	uint32_t batchedObjects;
+	uint32_t culledObjects;
+	uint32_t occludedObjects;
+	uint32_t occludedDraws;
+	uint32_t drawCalls;
+	uint64_t triangles;
+	uint32_t textureChanges;
+	uint32_t materialChanges;
+	uint32_t meshChanges;
+	uint64_t uniformBytes;
+	uint64_t textureBytes;
+	uint32_t stateCalls;
+	uint32_t elidedStateCalls;
+	double drawMilliseconds;
+};
+
+/***********************************************************
+ *  RenderQueue
+ *
+ *  This class contains the draw items of one frame and
+ *  sorts them by their keys.
+ ***********************************************************/
+class RenderQueue
+{
+public:
+	// constructor
+	RenderQueue();
+	// destructor
+	~RenderQueue();
+
+	// build the sort key for a draw
+	static uint64_t MakeSortKey(
+		uint32_t pass,
+		uint32_t shader,
+		uint32_t texture,
+		uint32_t material,
+		uint32_t mesh,
+		float depth);
+	// get the mesh field back out of a sort key
+	static uint32_t GetSortKeyMesh(uint64_t sortKey) { return((uint32_t)(sortKey >> 32) & 0xFF); }
+
+	// remove all of the submitted items
+	void Clear();
+	// add a draw item to the queue
+	void Submit(uint64_t sortKey, uint32_t objectIndex, uint32_t itemType = RENDER_ITEM_OBJECT);
+	// order the submitted items by their sort keys
+	void Sort();
+
+	// access the submitted items
+	const RENDER_ITEM* GetItems() const { return(m_items.data()); }
+	uint32_t GetItemCount() const { return((uint32_t)m_items.size()); }
+
+private:
+	// submitted draw items
+	std::vector<RENDER_ITEM> m_items;
+	// scratch buffer for the radix sort passes
+	std::vector<RENDER_ITEM> m_sortBuffer;
+};
@@ -0,0 +1,639 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebvh.cpp
+// ============
+// bounding volume hierarchy over the world bounds of the scene objects
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneBVH.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// declaration of global variables
+namespace
+{
+	// items a leaf holds at most when splitting does not pay
+	// off, and below which a node is never split
+	const uint32_t g_MaxLeafItems = 16;
+	const uint32_t g_MinSplitItems = 2;
+	// bins per axis for evaluating the split positions
+	const int g_SplitBins = 16;
+	// cost of visiting a node against testing an item box
+	const float g_TraversalCost = 1.0f;
+	// slot of an ID that is not in the tree
+	const uint32_t g_NoSlot = 0xFFFFFFFF;
+	// frustum planes that still have to be tested
+	const uint32_t g_AllPlanes = 0x3F;
+
+	/***********************************************************
+	 *  SurfaceArea()
+	 *
+	 *  Returns half of the surface area of a box, which is all
+	 *  the split heuristic needs.
+	 ***********************************************************/
+	float SurfaceArea(const float* pMinimum, const float* pMaximum)
+	{
+		float x = pMaximum[0] - pMinimum[0];
+		float y = pMaximum[1] - pMinimum[1];
+		float z = pMaximum[2] - pMinimum[2];
+		return(x * y + y * z + z * x);
+	}
+
+	/***********************************************************
+	 *  GrowBox()
+	 *
+	 *  Grows a box to hold another one.
+	 ***********************************************************/
+	void GrowBox(float* pMinimum, float* pMaximum, const float* pOtherMinimum, const float* pOtherMaximum)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			pMinimum[axis] = std::min(pMinimum[axis], pOtherMinimum[axis]);
+			pMaximum[axis] = std::max(pMaximum[axis], pOtherMaximum[axis]);
+		}
+	}
+
+	/***********************************************************
+	 *  EmptyBox()
+	 *
+	 *  Sets a box that any box grows it into.
+	 ***********************************************************/
+	void EmptyBox(float* pMinimum, float* pMaximum)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			pMinimum[axis] = std::numeric_limits<float>::max();
+			pMaximum[axis] = -std::numeric_limits<float>::max();
+		}
+	}
+
+	/***********************************************************
+	 *  TestPlanes()
+	 *
+	 *  Tests a box against the frustum planes in the mask.
+	 *  Returns false when the box is outside of one of them,
+	 *  and clears the planes the box is entirely inside of.
+	 ***********************************************************/
+	bool TestPlanes(const FRUSTUM& frustum, const float* pMinimum, const float* pMaximum, uint32_t& planeMask)
+	{
+		float center[3];
+		float extents[3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			center[axis] = (pMinimum[axis] + pMaximum[axis]) * 0.5f;
+			extents[axis] = (pMaximum[axis] - pMinimum[axis]) * 0.5f;
+		}
+
+		for (int plane = 0; plane < 6; plane++)
+		{
+			if ((planeMask & (1u << plane)) == 0)
+				continue;
+
+			const glm::vec4& p = frustum.planes[plane];
+			float distance = p.x * center[0] + p.y * center[1] + p.z * center[2] + p.w;
+			float reach = std::fabs(p.x) * extents[0] + std::fabs(p.y) * extents[1] + std::fabs(p.z) * extents[2];
+			if (distance + reach < 0.0f)
+			{
+				return(false);
+			}
+			if (distance - reach >= 0.0f)
+			{
+				planeMask &= ~(1u << plane);
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  IntersectBox()
+	 *
+	 *  Returns the distance at which a ray enters a box, or -1
+	 *  when it misses the box or enters it beyond maxDistance.
+	 *  The ray is given by its origin and the inverse of its
+	 *  direction.
+	 ***********************************************************/
+	float IntersectBox(const float* pMinimum, const float* pMaximum, const float* pOrigin, const float* pInverseDirection, float maxDistance)
+	{
+		float entry = 0.0f;
+		float exit = maxDistance;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float entrySlab = (pMinimum[axis] - pOrigin[axis]) * pInverseDirection[axis];
+			float exitSlab = (pMaximum[axis] - pOrigin[axis]) * pInverseDirection[axis];
+			if (entrySlab > exitSlab)
+			{
+				std::swap(entrySlab, exitSlab);
+			}
+			entry = std::max(entry, entrySlab);
+			exit = std::min(exit, exitSlab);
+			if (entry > exit)
+			{
+				return(-1.0f);
+			}
+		}
+
+		return(entry);
+	}
+}
+
+/***********************************************************
+ *  SceneBVH()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneBVH::SceneBVH()
+{
+}
+
+/***********************************************************
+ *  ~SceneBVH()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneBVH::~SceneBVH()
+{
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the tree over the item
+ *  boxes.  Nodes are split from the root down until their
+ *  items are not worth splitting any further.
+ ***********************************************************/
+void SceneBVH::Build(const std::vector<BVH_ITEM>& items)
+{
+	Clear();
+	if (items.empty())
+	{
+		return;
+	}
+
+	uint32_t maxID = 0;
+	m_items.resize(items.size());
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		BVH_BOX& box = m_items[i];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			box.minimum[axis] = items[i].bounds.center[axis] - items[i].bounds.extents[axis];
+			box.maximum[axis] = items[i].bounds.center[axis] + items[i].bounds.extents[axis];
+		}
+		box.id = items[i].id;
+		maxID = std::max(maxID, items[i].id);
+	}
+
+	// a binary tree with leaves of at least one item has at
+	// most twice as many nodes as items
+	m_nodes.reserve(items.size() * 2);
+
+	BVH_NODE root;
+	root.firstItem = 0;
+	root.itemCount = (uint32_t)m_items.size();
+	root.leftChild = 0;
+	root.parent = 0;
+	m_nodes.push_back(root);
+
+	std::vector<uint32_t> stack(1, 0);
+	while (stack.empty() == false)
+	{
+		uint32_t node = stack.back();
+		stack.pop_back();
+
+		FitNode(node);
+		if (SplitNode(node))
+		{
+			stack.push_back(m_nodes[node].leftChild);
+			stack.push_back(m_nodes[node].leftChild + 1);
+		}
+	}
+
+	// find the items and their leaves for the updates
+	m_idSlots.assign((size_t)maxID + 1, g_NoSlot);
+	m_slotLeaves.assign(m_items.size(), 0);
+	m_bDirtyLeaf.assign(m_nodes.size(), 0);
+	for (uint32_t node = 0; node < m_nodes.size(); node++)
+	{
+		if (m_nodes[node].leftChild != 0)
+			continue;
+
+		for (uint32_t slot = m_nodes[node].firstItem; slot < m_nodes[node].firstItem + m_nodes[node].itemCount; slot++)
+		{
+			m_slotLeaves[slot] = node;
+			m_idSlots[m_items[slot].id] = slot;
+		}
+	}
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every node and item.
+ ***********************************************************/
+void SceneBVH::Clear()
+{
+	m_nodes.clear();
+	m_items.clear();
+	m_idSlots.clear();
+	m_slotLeaves.clear();
+	m_dirtyLeaves.clear();
+	m_bDirtyLeaf.clear();
+}
+
+/***********************************************************
+ *  SplitNode()
+ *
+ *  This method is used for splitting the items of a node in
+ *  two.  The centroids of the items are sorted into bins
+ *  along each axis, and the split between two bins with the
+ *  lowest surface area cost is taken.  A node stays a leaf
+ *  when no split is cheaper than testing all of its items,
+ *  unless it holds too many of them.
+ ***********************************************************/
+bool SceneBVH::SplitNode(uint32_t node)
+{
+	uint32_t firstItem = m_nodes[node].firstItem;
+	uint32_t itemCount = m_nodes[node].itemCount;
+	if (itemCount < g_MinSplitItems)
+	{
+		return(false);
+	}
+
+	// bounds of the item centroids, which the bins divide
+	float centroidMinimum[3];
+	float centroidMaximum[3];
+	EmptyBox(centroidMinimum, centroidMaximum);
+	for (uint32_t slot = firstItem; slot < firstItem + itemCount; slot++)
+	{
+		float centroid[3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			centroid[axis] = (m_items[slot].minimum[axis] + m_items[slot].maximum[axis]) * 0.5f;
+		}
+		GrowBox(centroidMinimum, centroidMaximum, centroid, centroid);
+	}
+
+	float bestCost = std::numeric_limits<float>::max();
+	int bestAxis = -1;
+	int bestSplit = 0;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = centroidMaximum[axis] - centroidMinimum[axis];
+		if (extent <= 0.0f)
+			continue;
+
+		uint32_t binCounts[g_SplitBins] = { 0 };
+		float binMinimum[g_SplitBins][3];
+		float binMaximum[g_SplitBins][3];
+		for (int bin = 0; bin < g_SplitBins; bin++)
+		{
+			EmptyBox(binMinimum[bin], binMaximum[bin]);
+		}
+
+		float binScale = (float)g_SplitBins / extent;
+		for (uint32_t slot = firstItem; slot < firstItem + itemCount; slot++)
+		{
+			float centroid = (m_items[slot].minimum[axis] + m_items[slot].maximum[axis]) * 0.5f;
+			int bin = std::min((int)((centroid - centroidMinimum[axis]) * binScale), g_SplitBins - 1);
+			binCounts[bin]++;
+			GrowBox(binMinimum[bin], binMaximum[bin], m_items[slot].minimum, m_items[slot].maximum);
+		}
+
+		// area and count on the right of every split, then sweep
+		// from the left
+		float rightAreas[g_SplitBins];
+		uint32_t rightCounts[g_SplitBins];
+		float sweepMinimum[3];
+		float sweepMaximum[3];
+		EmptyBox(sweepMinimum, sweepMaximum);
+		uint32_t sweepCount = 0;
+		for (int bin = g_SplitBins - 1; bin > 0; bin--)
+		{
+			GrowBox(sweepMinimum, sweepMaximum, binMinimum[bin], binMaximum[bin]);
+			sweepCount += binCounts[bin];
+			rightAreas[bin] = (sweepCount > 0) ? SurfaceArea(sweepMinimum, sweepMaximum) : 0.0f;
+			rightCounts[bin] = sweepCount;
+		}
+
+		EmptyBox(sweepMinimum, sweepMaximum);
+		sweepCount = 0;
+		for (int split = 0; split < g_SplitBins - 1; split++)
+		{
+			GrowBox(sweepMinimum, sweepMaximum, binMinimum[split], binMaximum[split]);
+			sweepCount += binCounts[split];
+			if ((sweepCount == 0) || (rightCounts[split + 1] == 0))
+				continue;
+
+			float cost = sweepCount * SurfaceArea(sweepMinimum, sweepMaximum) +
+				rightCounts[split + 1] * rightAreas[split + 1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = split;
+			}
+		}
+	}
+
+	uint32_t leftCount = 0;
+	if (bestAxis >= 0)
+	{
+		// the chance of visiting a child is its area over the
+		// area of the node
+		float nodeArea = SurfaceArea(m_nodes[node].minimum, m_nodes[node].maximum);
+		float splitCost = g_TraversalCost + ((nodeArea > 0.0f) ? bestCost / nodeArea : 0.0f);
+		if ((splitCost >= (float)itemCount) && (itemCount <= g_MaxLeafItems))
+		{
+			return(false);
+		}
+
+		float binScale = (float)g_SplitBins / (centroidMaximum[bestAxis] - centroidMinimum[bestAxis]);
+		float axisMinimum = centroidMinimum[bestAxis];
+		BVH_BOX* pSplit = std::partition(
+			m_items.data() + firstItem, m_items.data() + firstItem + itemCount,
+			[bestAxis, binScale, axisMinimum, bestSplit](const BVH_BOX& box)
+			{
+				float centroid = (box.minimum[bestAxis] + box.maximum[bestAxis]) * 0.5f;
+				return(std::min((int)((centroid - axisMinimum) * binScale), g_SplitBins - 1) <= bestSplit);
+			});
+		leftCount = (uint32_t)(pSplit - (m_items.data() + firstItem));
+	}
+	else if (itemCount > g_MaxLeafItems)
+	{
+		// every centroid is in the same place, any split will do
+		leftCount = itemCount / 2;
+	}
+	else
+	{
+		return(false);
+	}
+
+	if ((leftCount == 0) || (leftCount == itemCount))
+	{
+		leftCount = itemCount / 2;
+	}
+
+	BVH_NODE child;
+	child.leftChild = 0;
+	child.parent = node;
+	child.firstItem = firstItem;
+	child.itemCount = leftCount;
+	m_nodes[node].leftChild = (uint32_t)m_nodes.size();
+	m_nodes.push_back(child);
+	child.firstItem = firstItem + leftCount;
+	child.itemCount = itemCount - leftCount;
+	m_nodes.push_back(child);
+
+	return(true);
+}
+
+/***********************************************************
+ *  FitNode()
+ *
+ *  This method is used for setting the box of a leaf to the
+ *  boxes of its items, or of an interior node to the boxes
+ *  of its children.
+ ***********************************************************/
+void SceneBVH::FitNode(uint32_t node)
+{
+	BVH_NODE& fitNode = m_nodes[node];
+	EmptyBox(fitNode.minimum, fitNode.maximum);
+
+	if (fitNode.leftChild != 0)
+	{
+		const BVH_NODE& left = m_nodes[fitNode.leftChild];
+		const BVH_NODE& right = m_nodes[fitNode.leftChild + 1];
+		GrowBox(fitNode.minimum, fitNode.maximum, left.minimum, left.maximum);
+		GrowBox(fitNode.minimum, fitNode.maximum, right.minimum, right.maximum);
+		return;
+	}
+
+	for (uint32_t slot = fitNode.firstItem; slot < fitNode.firstItem + fitNode.itemCount; slot++)
+	{
+		GrowBox(fitNode.minimum, fitNode.maximum, m_items[slot].minimum, m_items[slot].maximum);
+	}
+}
+
+/***********************************************************
+ *  UpdateItem()
+ *
+ *  This method is used for changing the box of an item and
+ *  marking its leaf for the next refit.
+ ***********************************************************/
+void SceneBVH::UpdateItem(uint32_t id, const MESH_BOUNDS& bounds)
+{
+	if (Contains(id) == false)
+	{
+		return;
+	}
+
+	uint32_t slot = m_idSlots[id];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		m_items[slot].minimum[axis] = bounds.center[axis] - bounds.extents[axis];
+		m_items[slot].maximum[axis] = bounds.center[axis] + bounds.extents[axis];
+	}
+
+	uint32_t leaf = m_slotLeaves[slot];
+	if (m_bDirtyLeaf[leaf] == 0)
+	{
+		m_bDirtyLeaf[leaf] = 1;
+		m_dirtyLeaves.push_back(leaf);
+	}
+}
+
+/***********************************************************
+ *  Refit()
+ *
+ *  This method is used for fitting the nodes above the
+ *  changed items to them again.  A few changes walk up from
+ *  their leaves and stop at the first node that keeps its
+ *  box, many changes refit every node from the bottom up.
+ *  The tree keeps its shape, so it gets slower to search
+ *  the further the objects move from where it was built.
+ ***********************************************************/
+uint32_t SceneBVH::Refit()
+{
+	uint32_t refittedNodes = 0;
+
+	if (m_dirtyLeaves.size() * 4 > m_nodes.size())
+	{
+		// children are always after their parents
+		for (size_t node = m_nodes.size(); node-- > 0;)
+		{
+			FitNode((uint32_t)node);
+		}
+		refittedNodes = (uint32_t)m_nodes.size();
+	}
+	else
+	{
+		for (uint32_t leaf : m_dirtyLeaves)
+		{
+			uint32_t node = leaf;
+			while (true)
+			{
+				BVH_NODE previous = m_nodes[node];
+				FitNode(node);
+				refittedNodes++;
+
+				bool bChanged = (memcmp(previous.minimum, m_nodes[node].minimum, sizeof(previous.minimum)) != 0) ||
+					(memcmp(previous.maximum, m_nodes[node].maximum, sizeof(previous.maximum)) != 0);
+				if ((bChanged == false) || (node == 0))
+					break;
+
+				node = m_nodes[node].parent;
+			}
+		}
+	}
+
+	for (uint32_t leaf : m_dirtyLeaves)
+	{
+		m_bDirtyLeaf[leaf] = 0;
+	}
+	m_dirtyLeaves.clear();
+
+	return(refittedNodes);
+}
+
+/***********************************************************
+ *  CullFrustum()
+ *
+ *  This method is used for collecting the items inside the
+ *  frustum.  A node outside of a plane is skipped with all
+ *  of its items, and the planes a node is entirely inside of
+ *  are not tested again below it.  A node inside all of the
+ *  planes adds its items without testing them.
+ ***********************************************************/
+uint32_t SceneBVH::CullFrustum(const FRUSTUM& frustum, std::vector<uint32_t>& visibleIDs) const
+{
+	visibleIDs.clear();
+	if (m_nodes.empty())
+	{
+		return(0);
+	}
+
+	uint32_t visitedNodes = 0;
+	// node index in the low bits and its plane mask above them
+	std::vector<uint64_t> stack;
+	stack.push_back((uint64_t)g_AllPlanes << 32);
+	while (stack.empty() == false)
+	{
+		uint32_t node = (uint32_t)stack.back();
+		uint32_t planeMask = (uint32_t)(stack.back() >> 32);
+		stack.pop_back();
+		visitedNodes++;
+
+		const BVH_NODE& cullNode = m_nodes[node];
+		if (TestPlanes(frustum, cullNode.minimum, cullNode.maximum, planeMask) == false)
+			continue;
+
+		if ((planeMask == 0) || (cullNode.leftChild == 0))
+		{
+			for (uint32_t slot = cullNode.firstItem; slot < cullNode.firstItem + cullNode.itemCount; slot++)
+			{
+				uint32_t itemMask = planeMask;
+				if ((itemMask == 0) || TestPlanes(frustum, m_items[slot].minimum, m_items[slot].maximum, itemMask))
+				{
+					visibleIDs.push_back(m_items[slot].id);
+				}
+			}
+			continue;
+		}
+
+		stack.push_back(((uint64_t)planeMask << 32) | cullNode.leftChild);
+		stack.push_back(((uint64_t)planeMask << 32) | (cullNode.leftChild + 1));
+	}
+
+	return(visitedNodes);
+}
+
+/***********************************************************
+ *  Raycast()
+ *
+ *  This method is used for finding the nearest item box a
+ *  ray enters within the given distance.  The nearer child
+ *  of every node is searched first, so the farther one can
+ *  often be skipped.  A ray starting inside a box hits it at
+ *  distance 0.
+ ***********************************************************/
+bool SceneBVH::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, BVH_HIT& hit) const
+{
+	if (m_nodes.empty())
+	{
+		return(false);
+	}
+
+	float rayOrigin[3] = { origin.x, origin.y, origin.z };
+	float inverseDirection[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		inverseDirection[axis] = (direction[axis] != 0.0f) ?
+			1.0f / direction[axis] : std::numeric_limits<float>::max();
+	}
+
+	bool bHit = false;
+	float nearest = maxDistance;
+	std::vector<uint32_t> stack;
+	if (IntersectBox(m_nodes[0].minimum, m_nodes[0].maximum, rayOrigin, inverseDirection, nearest) >= 0.0f)
+	{
+		stack.push_back(0);
+	}
+	while (stack.empty() == false)
+	{
+		const BVH_NODE& rayNode = m_nodes[stack.back()];
+		stack.pop_back();
+
+		if (rayNode.leftChild == 0)
+		{
+			for (uint32_t slot = rayNode.firstItem; slot < rayNode.firstItem + rayNode.itemCount; slot++)
+			{
+				float distance = IntersectBox(m_items[slot].minimum, m_items[slot].maximum, rayOrigin, inverseDirection, nearest);
+				if ((distance >= 0.0f) && ((bHit == false) || (distance < nearest)))
+				{
+					nearest = distance;
+					hit.id = m_items[slot].id;
+					hit.distance = distance;
+					bHit = true;
+				}
+			}
+			continue;
+		}
+
+		uint32_t nearChild = rayNode.leftChild;
+		uint32_t farChild = rayNode.leftChild + 1;
+		float nearDistance = IntersectBox(m_nodes[nearChild].minimum, m_nodes[nearChild].maximum, rayOrigin, inverseDirection, nearest);
+		float farDistance = IntersectBox(m_nodes[farChild].minimum, m_nodes[farChild].maximum, rayOrigin, inverseDirection, nearest);
+		if ((farDistance >= 0.0f) && ((nearDistance < 0.0f) || (farDistance < nearDistance)))
+		{
+			std::swap(nearChild, farChild);
+			std::swap(nearDistance, farDistance);
+		}
+
+		// the stack is last in first out, so the near child goes last
+		if (farDistance >= 0.0f)
+		{
+			stack.push_back(farChild);
+		}
+		if (nearDistance >= 0.0f)
+		{
+			stack.push_back(nearChild);
+		}
+	}
+
+	return(bHit);
+}
+
+/***********************************************************
+ *  IntersectSegment()
+ *
+ *  This method is used for finding the item box nearest to
+ *  the start of a segment.  The distance of the hit is the
+ *  fraction of the way from the start to the end.
+ ***********************************************************/
+bool SceneBVH::IntersectSegment(const glm::vec3& start, const glm::vec3& end, BVH_HIT& hit) const
+{
+	return(Raycast(start, end - start, 1.0f, hit));
+}
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebvh.h
+// ============
+// bounding volume hierarchy over the world bounds of the scene objects
+//
+// The tree is built top down with binned surface area heuristic splits.
+// Every node keeps the contiguous range of items below it, so a node that
+// is entirely inside the view frustum hands out its items without testing
+// them.  When objects move their boxes are updated and the nodes above them
+// are refitted instead of building the tree again.  Rays and segments find
+// the nearest item box they hit.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FrustumCuller.h"
+#include "MeshGeometry.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  BVH_ITEM
+ *
+ *  Object placed in the tree, by its ID and world bounds.
+ ***********************************************************/
+struct BVH_ITEM
+{
+	uint32_t id;
+	MESH_BOUNDS bounds;
+};
+
+/***********************************************************
+ *  BVH_HIT
+ *
+ *  Nearest item box hit by a ray and the distance to where
+ *  the ray enters it, in units of the ray direction.
+ ***********************************************************/
+struct BVH_HIT
+{
+	uint32_t id;
+	float distance;
+};
+
+/***********************************************************
+ *  SceneBVH
+ *
+ *  This class contains the nodes of the hierarchy and the
+ *  item boxes in the order of its leaves.
+ ***********************************************************/
+class SceneBVH
+{
+public:
+	// constructor
+	SceneBVH();
+	// destructor
+	~SceneBVH();
+
+	// build the tree over the given items
+	void Build(const std::vector<BVH_ITEM>& items);
+	void Clear();
+
+	// change the box of an item, the tree is corrected by the
+	// next Refit()
+	void UpdateItem(uint32_t id, const MESH_BOUNDS& bounds);
+	// grow or shrink the nodes above the changed items, and
+	// return how many nodes were refitted
+	uint32_t Refit();
+
+	// IDs of the items whose boxes are at least partly inside
+	// the frustum, and the number of nodes visited
+	uint32_t CullFrustum(const FRUSTUM& frustum, std::vector<uint32_t>& visibleIDs) const;
+
+	// nearest item hit by a ray within a distance, or by the
+	// segment between two points
+	bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, BVH_HIT& hit) const;
+	bool IntersectSegment(const glm::vec3& start, const glm::vec3& end, BVH_HIT& hit) const;
+
+	// access the tree
+	uint32_t GetItemCount() const { return((uint32_t)m_items.size()); }
+	uint32_t GetNodeCount() const { return((uint32_t)m_nodes.size()); }
+	bool Contains(uint32_t id) const { return((id < m_idSlots.size()) && (m_idSlots[id] != 0xFFFFFFFF)); }
+
+private:
+	/***********************************************************
+	 *  BVH_BOX
+	 *
+	 *  Box of an item, by its corners.
+	 ***********************************************************/
+	struct BVH_BOX
+	{
+		float minimum[3];
+		float maximum[3];
+		uint32_t id;
+	};
+
+	/***********************************************************
+	 *  BVH_NODE
+	 *
+	 *  Box around the items of a node.  The items of every
+	 *  node are a contiguous range, and the children of an
+	 *  interior node are next to each other.
+	 ***********************************************************/
+	struct BVH_NODE
+	{
+		float minimum[3];
+		float maximum[3];
+		uint32_t firstItem;
+		uint32_t itemCount;
+		// first of the two children, 0 for a leaf
+		uint32_t leftChild;
+		uint32_t parent;
+	};
+
+	// nodes, the root first and every parent before its children
+	std::vector<BVH_NODE> m_nodes;
+	// item boxes in the order of the leaves
+	std::vector<BVH_BOX> m_items;
+	// slot of every item ID in m_items, and the leaf of every slot
+	std::vector<uint32_t> m_idSlots;
+	std::vector<uint32_t> m_slotLeaves;
+	// leaves whose items changed since the last refit
+	std::vector<uint32_t> m_dirtyLeaves;
+	std::vector<uint8_t> m_bDirtyLeaf;
+
+	// split a node into two children, false when it stays a leaf
+	bool SplitNode(uint32_t node);
+	// set the box of a node to the boxes of its items or children
+	void FitNode(uint32_t node);
+};
@@ -0,0 +1,1985 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebenchmarks.cpp
+// ============
+// measure the cost of the scene management code paths
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneBenchmarks.h"
+#include "FrustumCuller.h"
+#include "GLStateCache.h"
+#include "ImageKernels.h"
+#include "InstancedMeshes.h"
+#include "MeshCache.h"
+#include "MeshGenerator.h"
+#include "MeshLOD.h"
+#include "MeshOptimizer.h"
+#include "OcclusionCuller.h"
+#include "PackedVertices.h"
+#include "SceneBVH.h"
+#include "SceneFile.h"
+#include "SceneGraph.h"
+#include "SceneManager.h"
+#include "ShaderManager.h"
+#include "ShaderUniforms.h"
+#include "TagRegistry.h"
+#include "TextureCache.h"
+#include "TextureCooker.h"
+#include "TransformStore.h"
+
+#include <GL/glew.h>
+#include "GLFW/glfw3.h"
+#include "stb_image.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	typedef std::chrono::high_resolution_clock BenchmarkClock;
+
+	/***********************************************************
+	 *  ElapsedMilliseconds()
+	 *
+	 *  Returns the milliseconds since the passed in time.
+	 ***********************************************************/
+	double ElapsedMilliseconds(BenchmarkClock::time_point start)
+	{
+		return(std::chrono::duration<double, std::milli>(BenchmarkClock::now() - start).count());
+	}
+
+	// keeps the benchmarked results alive so they are not optimized away
+	volatile float g_BenchmarkSink = 0.0f;
+
+	// texture tags of the desk scene, in load order
+	const char* const g_DeskTextureTags[] =
+	{
+		"floor", "floor2", "plank", "desk", "bDrop", "Book5",
+		"Books", "plastic", "screen", "wood", "KB1", "poster"
+	};
+
+	/***********************************************************
+	 *  CreateHiddenContext()
+	 *
+	 *  Returns a hidden window whose OpenGL context is current,
+	 *  or NULL when no context could be created.
+	 ***********************************************************/
+	GLFWwindow* CreateHiddenContext()
+	{
+		glfwInit();
+#ifdef __APPLE__
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		GLFWwindow* pWindow = glfwCreateWindow(64, 64, "benchmark", NULL, NULL);
+		if (NULL == pWindow)
+		{
+			std::cout << "  could not create an OpenGL context" << std::endl;
+			glfwTerminate();
+			return(NULL);
+		}
+		glfwMakeContextCurrent(pWindow);
+
+		if (GLEW_OK != glewInit())
+		{
+			std::cout << "  could not initialize GLEW" << std::endl;
+			glfwDestroyWindow(pWindow);
+			glfwTerminate();
+			return(NULL);
+		}
+
+		return(pWindow);
+	}
+
+	/***********************************************************
+	 *  DestroyHiddenContext()
+	 *
+	 *  Closes a window made by CreateHiddenContext().
+	 ***********************************************************/
+	void DestroyHiddenContext(GLFWwindow* pWindow)
+	{
+		glfwDestroyWindow(pWindow);
+		glfwTerminate();
+	}
+
+	/***********************************************************
+	 *  RenderDeskFrame()
+	 *
+	 *  Draws one frame of the scene the way the main loop does,
+	 *  seen from the starting camera of the application.
+	 ***********************************************************/
+	void RenderDeskFrame(SceneManager& sceneManager)
+	{
+		glm::vec3 position(0.0f, 5.5f, 8.0f);
+		glm::mat4 view = glm::lookAt(position, glm::vec3(0.0f, 4.5f, 4.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(80.0f), 1000.0f / 800.0f, 0.1f, 100.0f);
+
+		GLStateCache::Enable(GL_DEPTH_TEST);
+		GLStateCache::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		sceneManager.SetViewPosition(position);
+		sceneManager.SetViewProjection(view, projection, 800);
+		sceneManager.RenderScene();
+		glFinish();
+	}
+
+	/***********************************************************
+	 *  WriteTextureCopy()
+	 *
+	 *  Writes a copy of an image file with the copy number
+	 *  appended.  The decoders stop at the end of the image, so
+	 *  the copy shows the same picture, but its contents differ
+	 *  and the texture cache loads it as a texture of its own.
+	 ***********************************************************/
+	bool WriteTextureCopy(const char* sourceFilename, const char* copyFilename, uint32_t copy)
+	{
+		std::vector<unsigned char> contents;
+		if (TextureCache::ReadFile(sourceFilename, contents) == false)
+		{
+			return(false);
+		}
+		contents.insert(contents.end(), (const unsigned char*)&copy, (const unsigned char*)&copy + sizeof(copy));
+
+		FILE* pFile = fopen(copyFilename, "wb");
+		if (NULL == pFile)
+		{
+			return(false);
+		}
+		bool bWritten = (fwrite(contents.data(), 1, contents.size(), pFile) == contents.size());
+		fclose(pFile);
+
+		return(bWritten);
+	}
+
+	// texture images of the desk scene
+	const char* const g_DeskTextureFiles[] =
+	{
+		"../../Utilities/textures/pavers.jpg",
+		"../../Utilities/textures/dirty.jpg",
+		"../../Utilities/textures/rusticwood.jpg",
+		"../../Utilities/textures/stainless.jpg",
+		"../../Utilities/textures/slimBrick.jpg",
+		"../../Utilities/textures/book011.jpg",
+		"../../Utilities/textures/book022.jpg",
+		"../../Utilities/textures/plastic.jpg",
+		"../../Utilities/textures/Mons2.jpg",
+		"../../Utilities/textures/rusticwood.jpg",
+		"../../Utilities/textures/kb1.jpg",
+		"../../Utilities/textures/tuckersoft.jpg"
+	};
+
+	// vertex shader of the vertex format benchmark, which reads
+	// every attribute and decodes packed vertices the way the
+	// scene vertex shader does, with as little other work as
+	// possible so the vertex fetch dominates
+	const char* const g_FetchVertexShader =
+		"#version 330 core\n"
+		"layout (location = 0) in vec3 inVertexPosition;\n"
+		"layout (location = 1) in vec3 inVertexNormal;\n"
+		"layout (location = 2) in vec2 inTextureCoordinate;\n"
+		"layout (location = 10) in uint inVertexMeshBox;\n"
+		"uniform bool bPackedVertices = false;\n"
+		"uniform samplerBuffer meshBoxes;\n"
+		"void main()\n"
+		"{\n"
+		"	vec3 position = inVertexPosition;\n"
+		"	vec3 normal = inVertexNormal;\n"
+		"	if (bPackedVertices)\n"
+		"	{\n"
+		"		int box = int(inVertexMeshBox) * 2;\n"
+		"		position = texelFetch(meshBoxes, box).xyz + position * texelFetch(meshBoxes, box + 1).xyz;\n"
+		"		normal = vec3(normal.xy, 1.0f - abs(normal.x) - abs(normal.y));\n"
+		"		if (normal.z < 0.0f)\n"
+		"			normal.xy = (1.0f - abs(normal.yx)) * vec2((normal.x >= 0.0f) ? 1.0f : -1.0f, (normal.y >= 0.0f) ? 1.0f : -1.0f);\n"
+		"		normal = normalize(normal);\n"
+		"	}\n"
+		"	gl_Position = vec4(position + normal * 0.001f + vec3(inTextureCoordinate, 0.0f) * 0.001f, 1.0f);\n"
+		"}\n";
+	const char* const g_FetchFragmentShader =
+		"#version 330 core\n"
+		"out vec4 outFragmentColor;\n"
+		"void main()\n"
+		"{\n"
+		"	outFragmentColor = vec4(1.0f);\n"
+		"}\n";
+
+	/***********************************************************
+	 *  CompileProgram()
+	 *
+	 *  Returns a program linked from the passed in shader code,
+	 *  or 0 when it does not compile or link.
+	 ***********************************************************/
+	GLuint CompileProgram(const char* vertexSource, const char* fragmentSource)
+	{
+		const char* sources[2] = { vertexSource, fragmentSource };
+		const GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+		GLuint program = glCreateProgram();
+		GLint status = GL_FALSE;
+		char log[512];
+
+		for (int i = 0; i < 2; i++)
+		{
+			GLuint shader = glCreateShader(types[i]);
+			glShaderSource(shader, 1, &sources[i], NULL);
+			glCompileShader(shader);
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+			if (status != GL_TRUE)
+			{
+				glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+				std::cout << "  shader did not compile: " << log << std::endl;
+			}
+			glAttachShader(program, shader);
+			glDeleteShader(shader);
+		}
+
+		glLinkProgram(program);
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		if (status != GL_TRUE)
+		{
+			glGetProgramInfoLog(program, sizeof(log), NULL, log);
+			std::cout << "  program did not link: " << log << std::endl;
+			glDeleteProgram(program);
+			return(0);
+		}
+
+		return(program);
+	}
+
+	/***********************************************************
+	 *  FindTagByCompare()
+	 *
+	 *  Returns the index of a tag the way SceneManager used to,
+	 *  with the tag passed by value and compared one by one.
+	 ***********************************************************/
+	int FindTagByCompare(const std::vector<std::string>& tags, std::string tag)
+	{
+		for (size_t index = 0; index < tags.size(); index++)
+		{
+			if (tags[index].compare(tag) == 0)
+			{
+				return((int)index);
+			}
+		}
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  RunImageKernel()
+	 *
+	 *  Runs one of the benchmarked image kernels once and
+	 *  returns its output bytes, so the output of every path
+	 *  can be compared with the scalar path.
+	 ***********************************************************/
+	std::vector<unsigned char> RunImageKernel(int kernel, const std::vector<unsigned char>& source, const std::vector<float>& linear, int imageSize)
+	{
+		size_t pixelCount = (size_t)imageSize * imageSize;
+		std::vector<unsigned char> output;
+
+		switch (kernel)
+		{
+		case 0:
+			output = source;
+			ImageKernels::FlipRows(output.data(), (size_t)imageSize * 4, imageSize);
+			break;
+		case 1:
+			output.resize(pixelCount * 4);
+			ImageKernels::ExpandRGBToRGBA(source.data(), output.data(), pixelCount);
+			break;
+		case 2:
+			output.resize(pixelCount * 4);
+			ImageKernels::ExpandGrayToRGBA(source.data(), output.data(), pixelCount);
+			break;
+		case 3:
+			output.resize(pixelCount * 4);
+			ImageKernels::ExpandGrayAlphaToRGBA(source.data(), output.data(), pixelCount);
+			break;
+		case 4:
+		{
+			std::vector<float> values(source.size());
+			ImageKernels::SRGBToLinear(source.data(), values.data(), values.size());
+			output.resize(values.size() * sizeof(float));
+			memcpy(output.data(), values.data(), output.size());
+			break;
+		}
+		case 5:
+			output.resize(linear.size());
+			ImageKernels::LinearToSRGB(linear.data(), output.data(), linear.size());
+			break;
+		default:
+			output.resize(pixelCount);
+			ImageKernels::DownsampleBox(source.data(), imageSize, imageSize, output.data());
+			break;
+		}
+
+		return(output);
+	}
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for running a benchmark by name.
+ *  Returns false for an unknown name, or when a benchmark
+ *  that checks its results finds a wrong one.
+ ***********************************************************/
+bool SceneBenchmarks::Run(const char* benchmarkName)
+{
+	bool bAll = (strcmp(benchmarkName, "all") == 0);
+	bool bFound = false;
+	bool bPassed = true;
+
+	if (bAll || (strcmp(benchmarkName, "transforms") == 0))
+	{
+		BenchmarkTransforms();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "scenegraph") == 0))
+	{
+		BenchmarkSceneGraph();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "uniforms") == 0))
+	{
+		BenchmarkUniforms();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "tags") == 0))
+	{
+		BenchmarkTags();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "textures") == 0))
+	{
+		BenchmarkTextureLoading();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "cooked") == 0))
+	{
+		BenchmarkCookedTextures();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "kernels") == 0))
+	{
+		bPassed = BenchmarkImageKernels() && bPassed;
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "culling") == 0))
+	{
+		BenchmarkFrustumCulling();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "bvh") == 0))
+	{
+		BenchmarkSceneBVH();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "occlusion") == 0))
+	{
+		bPassed = BenchmarkOcclusionCulling() && bPassed;
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "lod") == 0))
+	{
+		BenchmarkLevelOfDetail();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "meshes") == 0))
+	{
+		BenchmarkMeshGeneration();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "vertices") == 0))
+	{
+		BenchmarkVertexFormats();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "optimizer") == 0))
+	{
+		BenchmarkMeshOptimizer();
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(benchmarkName, "meshcache") == 0))
+	{
+		BenchmarkMeshCache();
+		bFound = true;
+	}
+
+	if (bFound == false)
+	{
+		std::cout << "Unknown benchmark:" << benchmarkName << std::endl;
+	}
+
+	return(bFound && bPassed);
+}
+
+/***********************************************************
+ *  BenchmarkTransforms()
+ *
+ *  This method is used for measuring the per-frame cost of
+ *  the object transformations.  The legacy path composes
+ *  every model matrix from five matrices each frame, the
+ *  transform store only recomputes the dirty entries.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkTransforms()
+{
+	const uint32_t objectCounts[] = { 10000, 1000000 };
+
+	std::cout << "BENCHMARK: transforms (milliseconds per frame)" << std::endl;
+
+	for (uint32_t objectCount : objectCounts)
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+
+		TransformStore store;
+		store.Reserve(objectCount);
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			store.AddTransform(
+				glm::vec3(1.0f + value(random) * 0.05f),
+				glm::vec3(value(random) * 9.0f, value(random) * 9.0f, 0.0f),
+				glm::vec3(value(random), value(random), value(random)));
+		}
+
+		// legacy path - compose every matrix every frame
+		const int legacyFrames = 5;
+		auto start = BenchmarkClock::now();
+		for (int frame = 0; frame < legacyFrames; frame++)
+		{
+			for (uint32_t i = 0; i < objectCount; i++)
+			{
+				glm::mat4 modelView =
+					glm::translate(store.GetPosition(i)) *
+					glm::rotate(glm::radians(store.GetRotation(i).x), glm::vec3(1.0f, 0.0f, 0.0f)) *
+					glm::rotate(glm::radians(store.GetRotation(i).y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+					glm::rotate(glm::radians(store.GetRotation(i).z), glm::vec3(0.0f, 0.0f, 1.0f)) *
+					glm::scale(store.GetScale(i));
+				g_BenchmarkSink += modelView[3][0];
+			}
+		}
+		double legacyTime = ElapsedMilliseconds(start) / legacyFrames;
+
+		// static scene - nothing is dirty
+		const int frames = 100;
+		start = BenchmarkClock::now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			g_BenchmarkSink += (float)store.UpdateModelMatrices();
+		}
+		double staticTime = ElapsedMilliseconds(start) / frames;
+
+		// one percent of the objects move every frame
+		uint32_t dirtyCount = objectCount / 100;
+		std::uniform_int_distribution<uint32_t> index(0, objectCount - 1);
+		start = BenchmarkClock::now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			for (uint32_t i = 0; i < dirtyCount; i++)
+			{
+				uint32_t dirtyIndex = index(random);
+				store.SetPosition(dirtyIndex, store.GetPosition(dirtyIndex) + glm::vec3(0.0f, 0.01f, 0.0f));
+			}
+			g_BenchmarkSink += (float)store.UpdateModelMatrices();
+		}
+		double dirtyTime = ElapsedMilliseconds(start) / frames;
+
+		std::cout << "  " << objectCount << " objects:"
+			<< " legacy " << legacyTime
+			<< ", static " << staticTime
+			<< ", 1% dirty " << dirtyTime << std::endl;
+	}
+}
+
+/***********************************************************
+ *  BenchmarkSceneGraph()
+ *
+ *  This method is used for measuring world matrix
+ *  propagation.  The scene is made of groups of one parent
+ *  node with 99 children, and moving one group should cost
+ *  the same no matter how many other groups exist.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkSceneGraph()
+{
+	const uint32_t objectCounts[] = { 10000, 1000000 };
+	const uint32_t groupSize = 100;
+
+	std::cout << "BENCHMARK: scenegraph (milliseconds per frame)" << std::endl;
+
+	for (uint32_t objectCount : objectCounts)
+	{
+		// build the records in depth-first order, one parent
+		// followed by its children
+		std::vector<SCENE_RECORD> records(objectCount);
+		memset(records.data(), 0, records.size() * sizeof(SCENE_RECORD));
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			SCENE_RECORD& record = records[i];
+			bool bGroup = (i % groupSize) == 0;
+
+			record.meshType = bGroup ? SCENE_MESH_NONE : SCENE_MESH_BOX;
+			record.parentIndex = bGroup ? -1 : (int32_t)(i - i % groupSize);
+			record.scale[0] = record.scale[1] = record.scale[2] = 1.0f;
+			record.rotation[1] = (float)(i % 360);
+			record.position[0] = (float)(i % groupSize);
+			record.position[2] = -(float)(i / groupSize);
+		}
+
+		SceneGraph sceneGraph;
+		sceneGraph.Build(records.data(), objectCount);
+
+		const int frames = 100;
+		uint32_t groupCount = objectCount / groupSize;
+		uint32_t updatedCount = 0;
+
+		// nothing moves
+		auto start = BenchmarkClock::now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			updatedCount += sceneGraph.UpdateWorldMatrices();
+		}
+		double staticTime = ElapsedMilliseconds(start) / frames;
+
+		// one group moves, like dragging the table
+		updatedCount = 0;
+		start = BenchmarkClock::now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			sceneGraph.SetLocalPosition(0, glm::vec3(0.0f, frame * 0.01f, 0.0f));
+			updatedCount += sceneGraph.UpdateWorldMatrices();
+		}
+		double oneGroupTime = ElapsedMilliseconds(start) / frames;
+		uint32_t oneGroupNodes = updatedCount / frames;
+
+		// one percent of the groups move
+		std::mt19937 random(1234);
+		std::uniform_int_distribution<uint32_t> group(0, groupCount - 1);
+		uint32_t movedGroups = std::max(1u, groupCount / 100);
+		updatedCount = 0;
+		start = BenchmarkClock::now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			for (uint32_t i = 0; i < movedGroups; i++)
+			{
+				sceneGraph.SetLocalPosition(group(random) * groupSize, glm::vec3(0.0f, frame * 0.01f, 0.0f));
+			}
+			updatedCount += sceneGraph.UpdateWorldMatrices();
+		}
+		double someGroupsTime = ElapsedMilliseconds(start) / frames;
+		uint32_t someGroupsNodes = updatedCount / frames;
+
+		std::cout << "  " << objectCount << " objects:"
+			<< " static " << staticTime
+			<< ", one group " << oneGroupTime << " (" << oneGroupNodes << " nodes)"
+			<< ", 1% of groups " << someGroupsTime << " (" << someGroupsNodes << " nodes)" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  BenchmarkUniforms()
+ *
+ *  This method is used for measuring the per-draw uniform
+ *  cost.  ShaderManager queries the location of the uniform
+ *  on every set, the handles were resolved once when the
+ *  program was linked.  Each pass sets the model matrix,
+ *  the color and the material index of a draw.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkUniforms()
+{
+	const uint32_t setCount = 1000000;
+
+	std::cout << "BENCHMARK: uniforms (milliseconds per " << setCount << " sets)" << std::endl;
+
+	GLFWwindow* pWindow = CreateHiddenContext();
+	if (NULL != pWindow)
+	{
+		ShaderManager shaderManager;
+		shaderManager.LoadShaders(
+			"Shaders/vertexShader.glsl",
+			"Shaders/fragmentShader.glsl");
+		shaderManager.use();
+
+		ShaderUniforms shaderUniforms;
+		shaderUniforms.SetCurrentProgram();
+		UNIFORM_HANDLE<glm::mat4> model = shaderUniforms.Find<glm::mat4>("model");
+		UNIFORM_HANDLE<glm::vec4> objectColor = shaderUniforms.Find<glm::vec4>("objectColor");
+		UNIFORM_HANDLE<int> materialIndex = shaderUniforms.Find<int>("materialIndex");
+
+		glm::mat4 modelMatrix(1.0f);
+		glm::vec4 color(1.0f);
+		const uint32_t passCount = setCount / 3;
+
+		// ShaderManager - a location query per set
+		glFinish();
+		auto start = BenchmarkClock::now();
+		for (uint32_t i = 0; i < passCount; i++)
+		{
+			modelMatrix[3][0] = (float)i;
+			shaderManager.setMat4Value("model", modelMatrix);
+			shaderManager.setVec4Value("objectColor", color);
+			shaderManager.setIntValue("materialIndex", (int)(i & 15));
+		}
+		glFinish();
+		double shaderManagerTime = ElapsedMilliseconds(start);
+
+		// name lookup in the cached locations
+		start = BenchmarkClock::now();
+		for (uint32_t i = 0; i < passCount; i++)
+		{
+			modelMatrix[3][0] = (float)i;
+			shaderUniforms.SetByName("model", modelMatrix);
+			shaderUniforms.SetByName("objectColor", color);
+			shaderUniforms.SetByName("materialIndex", (int)(i & 15));
+		}
+		glFinish();
+		double cachedNameTime = ElapsedMilliseconds(start);
+
+		// resolved handles
+		start = BenchmarkClock::now();
+		for (uint32_t i = 0; i < passCount; i++)
+		{
+			modelMatrix[3][0] = (float)i;
+			ShaderUniforms::Set(model, modelMatrix);
+			ShaderUniforms::Set(objectColor, color);
+			ShaderUniforms::Set(materialIndex, (int)(i & 15));
+		}
+		glFinish();
+		double handleTime = ElapsedMilliseconds(start);
+
+		std::cout << "  by name " << shaderManagerTime
+			<< ", by cached name " << cachedNameTime
+			<< ", by handle " << handleTime << std::endl;
+
+		DestroyHiddenContext(pWindow);
+	}
+}
+
+/***********************************************************
+ *  BenchmarkTags()
+ *
+ *  This method is used for measuring the texture tag lookup
+ *  done for a draw.  That the draws do not allocate is
+ *  checked by the allocation test of the test program.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkTags()
+{
+	const uint32_t lookupCount = 1000000;
+	const uint32_t tagCount = sizeof(g_DeskTextureTags) / sizeof(g_DeskTextureTags[0]);
+
+	std::cout << "BENCHMARK: tags (milliseconds per " << lookupCount << " lookups)" << std::endl;
+
+	std::vector<std::string> tagStrings;
+	TagRegistry tagRegistry;
+	for (uint32_t i = 0; i < tagCount; i++)
+	{
+		tagStrings.push_back(g_DeskTextureTags[i]);
+		tagRegistry.Intern(g_DeskTextureTags[i]);
+	}
+
+	// the keys of literals are built by the compiler
+	constexpr TAG_KEY lookupKeys[] = { "floor"_tag, "plank"_tag, "screen"_tag, "poster"_tag };
+	const uint32_t keyCount = sizeof(lookupKeys) / sizeof(lookupKeys[0]);
+
+	// string compare of a tag passed by value
+	auto start = BenchmarkClock::now();
+	for (uint32_t i = 0; i < lookupCount; i++)
+	{
+		g_BenchmarkSink += (float)FindTagByCompare(tagStrings, lookupKeys[i % keyCount].text);
+	}
+	double compareTime = ElapsedMilliseconds(start);
+
+	// hashed lookup of the interned tags
+	start = BenchmarkClock::now();
+	for (uint32_t i = 0; i < lookupCount; i++)
+	{
+		g_BenchmarkSink += (float)tagRegistry.Find(lookupKeys[i % keyCount]);
+	}
+	double internedTime = ElapsedMilliseconds(start);
+
+	std::cout << "  compare " << compareTime
+		<< ", interned " << internedTime << std::endl;
+}
+
+/***********************************************************
+ *  BenchmarkTextureLoading()
+ *
+ *  This method is used for measuring how long the textures
+ *  hold back the first frame.  The synchronous path decodes
+ *  and uploads every image before the first frame.  The
+ *  asynchronous path is the desk scene itself: its first
+ *  frame is timed from preparing the scene through drawing
+ *  it with the objects in their colors, while the workers
+ *  decode, and then the frames are drawn until every texture
+ *  is resident.  The 200 texture case adds copies of the
+ *  desk images to the scene, which are written next to the
+ *  program and deleted again.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkTextureLoading()
+{
+	const uint32_t textureCounts[] = { 12, 200 };
+	const uint32_t fileCount = sizeof(g_DeskTextureFiles) / sizeof(g_DeskTextureFiles[0]);
+	const double residentSeconds = 60.0;
+
+	std::cout << "BENCHMARK: textures (milliseconds)" << std::endl;
+
+	GLFWwindow* pWindow = CreateHiddenContext();
+	if (NULL == pWindow)
+	{
+		return;
+	}
+
+	ShaderManager* pShaderManager = new ShaderManager();
+	pShaderManager->LoadShaders("Shaders/vertexShader.glsl", "Shaders/fragmentShader.glsl");
+
+	for (uint32_t textureCount : textureCounts)
+	{
+		// synchronous path - decode and upload one by one
+		std::vector<GLuint> textures(textureCount, 0);
+		stbi_set_flip_vertically_on_load(true);
+		auto start = BenchmarkClock::now();
+		for (uint32_t i = 0; i < textureCount; i++)
+		{
+			int width = 0;
+			int height = 0;
+			int colorChannels = 0;
+			unsigned char* pPixels = stbi_load(g_DeskTextureFiles[i % fileCount], &width, &height, &colorChannels, STBI_rgb_alpha);
+			if (pPixels == NULL)
+				continue;
+
+			glGenTextures(1, &textures[i]);
+			glBindTexture(GL_TEXTURE_2D, textures[i]);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pPixels);
+			glGenerateMipmap(GL_TEXTURE_2D);
+			stbi_image_free(pPixels);
+		}
+		glFinish();
+		double syncTime = ElapsedMilliseconds(start);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glDeleteTextures(textureCount, textures.data());
+
+		// copies of the desk images beyond its own textures
+		std::vector<std::string> copyFiles;
+		for (uint32_t i = fileCount; i < textureCount; i++)
+		{
+			std::string copyFilename = "BenchmarkTexture" + std::to_string(i) + ".jpg";
+			if (WriteTextureCopy(g_DeskTextureFiles[i % fileCount], copyFilename.c_str(), i))
+			{
+				copyFiles.push_back(copyFilename);
+			}
+		}
+
+		// asynchronous path - the first frame of the scene is
+		// drawn while the workers decode
+		pShaderManager->use();
+		SceneManager* pSceneManager = new SceneManager(pShaderManager);
+		start = BenchmarkClock::now();
+		for (size_t i = 0; i < copyFiles.size(); i++)
+		{
+			std::string tag = "copy" + std::to_string(i);
+			pSceneManager->AddSceneTexture(copyFiles[i].c_str(), tag.c_str());
+		}
+		pSceneManager->PrepareScene();
+		RenderDeskFrame(*pSceneManager);
+		double firstFrameTime = ElapsedMilliseconds(start);
+
+		while ((pSceneManager->IsLoadingTextures() == true) &&
+			(ElapsedMilliseconds(start) < residentSeconds * 1000.0))
+		{
+			RenderDeskFrame(*pSceneManager);
+		}
+		double allTexturesTime = ElapsedMilliseconds(start);
+		bool bResident = (pSceneManager->IsLoadingTextures() == false);
+
+		delete pSceneManager;
+		for (const std::string& copyFilename : copyFiles)
+		{
+			remove(copyFilename.c_str());
+		}
+
+		std::cout << "  " << textureCount << " textures:"
+			<< " synchronous first frame " << syncTime
+			<< ", asynchronous first frame " << firstFrameTime;
+		if (bResident)
+		{
+			std::cout << ", all textures resident " << allTexturesTime << std::endl;
+		}
+		else
+		{
+			std::cout << ", textures still loading after " << allTexturesTime << std::endl;
+		}
+	}
+
+	delete pShaderManager;
+	DestroyHiddenContext(pWindow);
+}
+
+/***********************************************************
+ *  BenchmarkCookedTextures()
+ *
+ *  This method is used for measuring the load time of the
+ *  desk scene textures from their source images, decoded
+ *  and with the mipmaps generated, against cooked files
+ *  that are mapped and uploaded level by level.  The cooked
+ *  files are written next to the program and deleted again.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkCookedTextures()
+{
+	const uint32_t textureCounts[] = { 12, 200 };
+	const uint32_t fileCount = sizeof(g_DeskTextureFiles) / sizeof(g_DeskTextureFiles[0]);
+
+	std::cout << "BENCHMARK: cooked textures (milliseconds)" << std::endl;
+
+	std::vector<std::string> cookedFiles;
+	for (uint32_t i = 0; i < fileCount; i++)
+	{
+		std::string cookedFilename = "BenchmarkCooked" + std::to_string(i) + ".ktx";
+		if (TextureCooker::CookTexture(g_DeskTextureFiles[i], cookedFilename.c_str()) == false)
+		{
+			cookedFilename.clear();
+		}
+		cookedFiles.push_back(cookedFilename);
+	}
+
+	GLFWwindow* pWindow = CreateHiddenContext();
+	if (pWindow != NULL)
+	{
+		for (uint32_t textureCount : textureCounts)
+		{
+			std::vector<GLuint> textures(textureCount, 0);
+			glGenTextures(textureCount, textures.data());
+
+			// source path - decode, upload and generate the mipmaps
+			stbi_set_flip_vertically_on_load(true);
+			auto start = BenchmarkClock::now();
+			for (uint32_t i = 0; i < textureCount; i++)
+			{
+				int width = 0;
+				int height = 0;
+				int colorChannels = 0;
+				unsigned char* pPixels = stbi_load(g_DeskTextureFiles[i % fileCount], &width, &height, &colorChannels, STBI_rgb_alpha);
+				if (pPixels == NULL)
+					continue;
+
+				glBindTexture(GL_TEXTURE_2D, textures[i]);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pPixels);
+				glGenerateMipmap(GL_TEXTURE_2D);
+				stbi_image_free(pPixels);
+			}
+			glFinish();
+			double sourceTime = ElapsedMilliseconds(start);
+			glDeleteTextures(textureCount, textures.data());
+			glGenTextures(textureCount, textures.data());
+
+			// cooked path - map the file and upload every level
+			start = BenchmarkClock::now();
+			for (uint32_t i = 0; i < textureCount; i++)
+			{
+				CookedTexture cookedTexture;
+				if (cookedFiles[i % fileCount].empty() || !cookedTexture.Open(cookedFiles[i % fileCount].c_str()))
+					continue;
+
+				glBindTexture(GL_TEXTURE_2D, textures[i]);
+				if (GLEW_ARB_texture_storage)
+				{
+					glTexStorage2D(GL_TEXTURE_2D, cookedTexture.GetLevelCount(), GL_RGBA8, cookedTexture.GetWidth(), cookedTexture.GetHeight());
+				}
+				for (int level = 0; level < cookedTexture.GetLevelCount(); level++)
+				{
+					int width = 0;
+					int height = 0;
+					const unsigned char* pPixels = cookedTexture.GetLevel(level, width, height);
+					if (GLEW_ARB_texture_storage)
+					{
+						glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pPixels);
+					}
+					else
+					{
+						glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pPixels);
+					}
+				}
+			}
+			glFinish();
+			double cookedTime = ElapsedMilliseconds(start);
+			glBindTexture(GL_TEXTURE_2D, 0);
+			glDeleteTextures(textureCount, textures.data());
+
+			std::cout << "  " << textureCount << " textures:"
+				<< " source images " << sourceTime
+				<< ", cooked files " << cookedTime
+				<< " (" << sourceTime / std::max(cookedTime, 0.001) << "x)" << std::endl;
+		}
+
+		DestroyHiddenContext(pWindow);
+	}
+
+	for (const std::string& cookedFilename : cookedFiles)
+	{
+		if (!cookedFilename.empty())
+		{
+			remove(cookedFilename.c_str());
+		}
+	}
+}
+
+/***********************************************************
+ *  BenchmarkImageKernels()
+ *
+ *  This method is used for measuring the throughput of every
+ *  image kernel on a 2048x2048 image, once per instruction
+ *  set the processor supports.  The rate is counted in
+ *  megabytes of output per second.  Every path has to give
+ *  the same output as the scalar path, including a sweep of
+ *  linear values over and past the 0 to 1 range.
+ ***********************************************************/
+bool SceneBenchmarks::BenchmarkImageKernels()
+{
+	const int imageSize = 2048;
+	const int iterations = 20;
+	const size_t pixelCount = (size_t)imageSize * imageSize;
+
+	std::cout << "BENCHMARK: image kernels (MB/s)" << std::endl;
+
+	std::mt19937 random(7);
+	std::vector<unsigned char> source(pixelCount * 4);
+	for (unsigned char& value : source)
+	{
+		value = (unsigned char)random();
+	}
+	std::vector<unsigned char> rgba(pixelCount * 4);
+	std::vector<unsigned char> level(pixelCount);
+	std::vector<float> linear(pixelCount * 4);
+	ImageKernels::SRGBToLinear(source.data(), linear.data(), linear.size());
+
+	// the checked input stays as it is, the timed kernels
+	// write over theirs; the sweep has an odd length for the
+	// tails, and the exact half steps of the table come first
+	// since that is where rounding differs
+	const std::vector<unsigned char> checkSource = source;
+	std::vector<float> checkLinear(1028665);
+	for (size_t i = 0; i < checkLinear.size(); i++)
+	{
+		checkLinear[i] = (i < 4096) ? ((float)i + 0.5f) / 4095.0f : -0.25f + 1.5f * (float)i / (float)checkLinear.size();
+	}
+	checkLinear[4096] = std::numeric_limits<float>::quiet_NaN();
+	std::vector<std::vector<unsigned char> > scalarOutputs(7);
+	bool bMatched = true;
+
+	IMAGE_KERNEL_PATH bestPath = ImageKernels::GetBestPath();
+	for (int path = IMAGE_KERNEL_SCALAR; path <= (int)bestPath; path++)
+	{
+		ImageKernels::SetPath((IMAGE_KERNEL_PATH)path);
+		std::cout << "  " << ImageKernels::GetPathName((IMAGE_KERNEL_PATH)path) << ":";
+		std::string mismatches;
+
+		for (int kernel = 0; kernel < 7; kernel++)
+		{
+			const char* kernelName = "";
+			size_t outputBytes = 0;
+
+			auto start = BenchmarkClock::now();
+			for (int i = 0; i < iterations; i++)
+			{
+				switch (kernel)
+				{
+				case 0:
+					kernelName = "flip";
+					outputBytes = rgba.size();
+					ImageKernels::FlipRows(rgba.data(), (size_t)imageSize * 4, imageSize);
+					break;
+				case 1:
+					kernelName = "rgb";
+					outputBytes = rgba.size();
+					ImageKernels::ExpandRGBToRGBA(source.data(), rgba.data(), pixelCount);
+					break;
+				case 2:
+					kernelName = "gray";
+					outputBytes = rgba.size();
+					ImageKernels::ExpandGrayToRGBA(source.data(), rgba.data(), pixelCount);
+					break;
+				case 3:
+					kernelName = "grayalpha";
+					outputBytes = rgba.size();
+					ImageKernels::ExpandGrayAlphaToRGBA(source.data(), rgba.data(), pixelCount);
+					break;
+				case 4:
+					kernelName = "tolinear";
+					outputBytes = linear.size() * sizeof(float);
+					ImageKernels::SRGBToLinear(source.data(), linear.data(), linear.size());
+					break;
+				case 5:
+					kernelName = "tosrgb";
+					outputBytes = linear.size();
+					ImageKernels::LinearToSRGB(linear.data(), source.data(), linear.size());
+					break;
+				default:
+					kernelName = "downsample";
+					outputBytes = level.size();
+					ImageKernels::DownsampleBox(rgba.data(), imageSize, imageSize, level.data());
+					break;
+				}
+			}
+			double milliseconds = ElapsedMilliseconds(start);
+			g_BenchmarkSink = g_BenchmarkSink + rgba[(size_t)kernel * 4099] + level[kernel];
+
+			double megabytesPerSecond = (double)outputBytes * iterations / (1024.0 * 1024.0) / (milliseconds / 1000.0);
+			std::cout << " " << kernelName << " " << (int)megabytesPerSecond;
+
+			std::vector<unsigned char> output = RunImageKernel(kernel, checkSource, checkLinear, imageSize);
+			if (path == IMAGE_KERNEL_SCALAR)
+			{
+				scalarOutputs[kernel].swap(output);
+			}
+			else if (output != scalarOutputs[kernel])
+			{
+				mismatches += std::string(" ") + kernelName;
+			}
+		}
+		std::cout << std::endl;
+
+		if (!mismatches.empty())
+		{
+			std::cout << "ERROR: output differs from the scalar path:" << mismatches << std::endl;
+			bMatched = false;
+		}
+	}
+
+	ImageKernels::SetPath(bestPath);
+
+	return(bMatched);
+}
+
+/***********************************************************
+ *  BenchmarkFrustumCulling()
+ *
+ *  This method is used for measuring the culling of one
+ *  million boxes scattered around a camera, once per
+ *  instruction set the processor supports.  Moving the
+ *  bounds of every object is timed as well, and every path
+ *  has to find the same visible boxes.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkFrustumCulling()
+{
+	const uint32_t objectCount = 1000000;
+	const int iterations = 20;
+
+	std::cout << "BENCHMARK: frustum culling (" << objectCount << " objects)" << std::endl;
+
+	MESH_DATA boxMesh;
+	MESH_BOUNDS boxBounds;
+	MeshGeometry::GenerateBox(boxMesh);
+	MeshGeometry::ComputeBounds(boxMesh, boxBounds);
+
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+	std::vector<glm::mat4> worldMatrices(objectCount);
+	for (glm::mat4& world : worldMatrices)
+	{
+		world = glm::translate(glm::vec3(position(random), position(random), position(random))) *
+			glm::rotate(glm::radians(angle(random)), glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+
+	FrustumCuller culler;
+	culler.Resize(objectCount);
+	auto start = BenchmarkClock::now();
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		culler.SetBounds(i, boxBounds, worldMatrices[i]);
+	}
+	std::cout << "  bounds update: " << ElapsedMilliseconds(start) << " ms" << std::endl;
+
+	// the camera of the desk scene, looking into the cloud
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 5.5f, 8.0f), glm::vec3(0.0f, 4.5f, 4.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(80.0f), 1000.0f / 800.0f, 0.1f, 100.0f);
+	FRUSTUM frustum;
+	FrustumCuller::ExtractPlanes(projection * view, frustum);
+
+	std::vector<uint8_t> scalarVisible(objectCount);
+	IMAGE_KERNEL_PATH bestPath = ImageKernels::GetBestPath();
+	for (int path = IMAGE_KERNEL_SCALAR; path <= (int)bestPath; path++)
+	{
+		FrustumCuller::SetPath((IMAGE_KERNEL_PATH)path);
+
+		uint32_t visibleCount = 0;
+		start = BenchmarkClock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			visibleCount = culler.Cull(frustum);
+		}
+		double milliseconds = ElapsedMilliseconds(start) / iterations;
+
+		uint32_t mismatches = 0;
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			uint8_t bVisible = culler.IsVisible(i) ? 1 : 0;
+			if (path == IMAGE_KERNEL_SCALAR)
+			{
+				scalarVisible[i] = bVisible;
+			}
+			else if (scalarVisible[i] != bVisible)
+			{
+				mismatches++;
+			}
+		}
+
+		std::cout << "  " << ImageKernels::GetPathName((IMAGE_KERNEL_PATH)path) << ": "
+			<< milliseconds << " ms, drawn " << visibleCount << ", culled " << objectCount - visibleCount;
+		if (mismatches > 0)
+		{
+			std::cout << ", " << mismatches << " differ from scalar";
+		}
+		std::cout << std::endl;
+	}
+
+	FrustumCuller::SetPath(bestPath);
+}
+
+/***********************************************************
+ *  BenchmarkSceneBVH()
+ *
+ *  This method is used for measuring the scene hierarchy
+ *  over boxes scattered at the same density for each object
+ *  count.  Building it, refitting it after 1% and after all
+ *  of the objects moved, culling with it against testing
+ *  every box, and casting rays through it are timed.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkSceneBVH()
+{
+	const uint32_t objectCounts[] = { 10000, 100000, 1000000 };
+	const int iterations = 20;
+	const int rayCount = 1000;
+
+	MESH_DATA boxMesh;
+	MESH_BOUNDS boxBounds;
+	MeshGeometry::GenerateBox(boxMesh);
+	MeshGeometry::ComputeBounds(boxMesh, boxBounds);
+
+	// the camera of the desk scene, looking into the cloud
+	glm::vec3 cameraPosition(0.0f, 5.5f, 8.0f);
+	glm::mat4 view = glm::lookAt(cameraPosition, glm::vec3(0.0f, 4.5f, 4.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(80.0f), 1000.0f / 800.0f, 0.1f, 100.0f);
+	FRUSTUM frustum;
+	FrustumCuller::ExtractPlanes(projection * view, frustum);
+
+	for (uint32_t objectCount : objectCounts)
+	{
+		std::cout << "BENCHMARK: scene hierarchy (" << objectCount << " objects)" << std::endl;
+
+		// the cloud of the culling benchmark holds a million boxes
+		float size = 100.0f * (float)std::cbrt(objectCount / 1000000.0);
+		std::mt19937 random(13);
+		std::uniform_real_distribution<float> position(-size, size);
+		std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+		std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+		FrustumCuller culler;
+		culler.Resize(objectCount);
+		std::vector<BVH_ITEM> items(objectCount);
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			glm::mat4 world = glm::translate(glm::vec3(position(random), position(random), position(random))) *
+				glm::rotate(glm::radians(angle(random)), glm::vec3(0.0f, 1.0f, 0.0f));
+			culler.SetBounds(i, boxBounds, world);
+			items[i].id = i;
+			culler.GetWorldBounds(i, items[i].bounds);
+		}
+
+		SceneBVH bvh;
+		auto start = BenchmarkClock::now();
+		bvh.Build(items);
+		std::cout << "  build: " << ElapsedMilliseconds(start) << " ms, "
+			<< bvh.GetNodeCount() << " nodes" << std::endl;
+
+		// nudge a few objects, then every object, and refit
+		const uint32_t movedCounts[] = { objectCount / 100, objectCount };
+		for (uint32_t movedCount : movedCounts)
+		{
+			for (uint32_t i = 0; i < movedCount; i++)
+			{
+				BVH_ITEM& item = items[(uint32_t)((uint64_t)i * objectCount / movedCount)];
+				item.bounds.center[0] += offset(random);
+				item.bounds.center[1] += offset(random);
+				item.bounds.center[2] += offset(random);
+				culler.SetWorldBounds(item.id, item.bounds);
+			}
+
+			start = BenchmarkClock::now();
+			for (uint32_t i = 0; i < movedCount; i++)
+			{
+				const BVH_ITEM& item = items[(uint32_t)((uint64_t)i * objectCount / movedCount)];
+				bvh.UpdateItem(item.id, item.bounds);
+			}
+			uint32_t refittedNodes = bvh.Refit();
+			std::cout << "  refit after " << movedCount << " moved: " << ElapsedMilliseconds(start)
+				<< " ms, " << refittedNodes << " nodes" << std::endl;
+		}
+
+		uint32_t flatVisible = 0;
+		start = BenchmarkClock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			flatVisible = culler.Cull(frustum);
+		}
+		double flatMilliseconds = ElapsedMilliseconds(start) / iterations;
+
+		std::vector<uint32_t> visibleIDs;
+		uint32_t visitedNodes = 0;
+		start = BenchmarkClock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			visitedNodes = bvh.CullFrustum(frustum, visibleIDs);
+		}
+		double bvhMilliseconds = ElapsedMilliseconds(start) / iterations;
+
+		uint32_t mismatches = (uint32_t)std::abs((int)visibleIDs.size() - (int)flatVisible);
+		for (uint32_t id : visibleIDs)
+		{
+			if (culler.IsVisible(id) == false)
+			{
+				mismatches++;
+			}
+		}
+
+		std::cout << "  cull every box (" << ImageKernels::GetPathName(FrustumCuller::GetPath()) << "): "
+			<< flatMilliseconds << " ms, drawn " << flatVisible << std::endl;
+		std::cout << "  cull hierarchy: " << bvhMilliseconds << " ms, drawn " << visibleIDs.size()
+			<< ", " << visitedNodes << " nodes visited";
+		if (mismatches > 0)
+		{
+			std::cout << ", " << mismatches << " differ from every box";
+		}
+		std::cout << std::endl;
+
+		// rays from the camera in every direction
+		std::vector<glm::vec3> directions(rayCount);
+		for (glm::vec3& direction : directions)
+		{
+			direction = glm::normalize(glm::vec3(offset(random), offset(random), offset(random)) + glm::vec3(0.0f, 0.0f, -0.01f));
+		}
+
+		uint32_t hits = 0;
+		BVH_HIT hit;
+		start = BenchmarkClock::now();
+		for (const glm::vec3& direction : directions)
+		{
+			if (bvh.Raycast(cameraPosition, direction, 1000.0f, hit))
+			{
+				hits++;
+				g_BenchmarkSink = g_BenchmarkSink + hit.distance;
+			}
+		}
+		std::cout << "  " << rayCount << " raycasts: " << ElapsedMilliseconds(start) << " ms, "
+			<< hits << " hit" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  BenchmarkOcclusionCulling()
+ *
+ *  This method is used for measuring the occlusion culling
+ *  on a field of random occluders with one hundred thousand
+ *  objects between them.  Every instruction set has to
+ *  rasterize the same depth buffer and hide the same objects
+ *  as the scalar path.  The synthetic scenes with known
+ *  results are checked by the occlusion test of the test
+ *  program.
+ ***********************************************************/
+bool SceneBenchmarks::BenchmarkOcclusionCulling()
+{
+	const uint32_t objectCount = 100000;
+	const uint32_t occluderCount = 200;
+	const int iterations = 20;
+
+	std::cout << "BENCHMARK: occlusion culling (" << occluderCount << " occluders, "
+		<< objectCount << " objects)" << std::endl;
+
+	MESH_DATA boxMesh;
+	MESH_BOUNDS boxBounds;
+	MeshGeometry::GenerateBox(boxMesh);
+	MeshGeometry::ComputeBounds(boxMesh, boxBounds);
+
+	// the camera of the desk scene
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 5.5f, 8.0f), glm::vec3(0.0f, 4.5f, 4.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(80.0f), 1000.0f / 800.0f, 0.1f, 100.0f);
+	glm::mat4 viewProjection = projection * view;
+
+	OcclusionCuller culler;
+
+	// random blocks standing on the ground in front of the
+	// camera, and small objects scattered between them
+	std::mt19937 random(17);
+	std::uniform_real_distribution<float> groundX(-40.0f, 40.0f);
+	std::uniform_real_distribution<float> groundZ(-90.0f, 0.0f);
+	std::uniform_real_distribution<float> blockSize(1.0f, 6.0f);
+	std::uniform_real_distribution<float> height(0.0f, 8.0f);
+	std::vector<glm::mat4> occluders(occluderCount);
+	for (glm::mat4& occluder : occluders)
+	{
+		float blockHeight = blockSize(random) * 2.0f;
+		occluder = glm::translate(glm::vec3(groundX(random), blockHeight * 0.5f, groundZ(random))) *
+			glm::scale(glm::vec3(blockSize(random), blockHeight, blockSize(random)));
+	}
+
+	std::vector<MESH_BOUNDS> objects(objectCount);
+	for (MESH_BOUNDS& object : objects)
+	{
+		object.center[0] = groundX(random);
+		object.center[1] = height(random);
+		object.center[2] = groundZ(random);
+		object.extents[0] = object.extents[1] = object.extents[2] = 0.25f;
+		object.radius = 0.433f;
+	}
+
+	std::vector<float> scalarDepth;
+	std::vector<uint8_t> scalarOccluded(objectCount);
+	bool bMatched = true;
+	IMAGE_KERNEL_PATH bestPath = ImageKernels::GetBestPath();
+	for (int path = IMAGE_KERNEL_SCALAR; path <= (int)bestPath; path++)
+	{
+		OcclusionCuller::SetPath((IMAGE_KERNEL_PATH)path);
+
+		auto start = BenchmarkClock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			culler.BeginFrame(viewProjection);
+			for (const glm::mat4& occluder : occluders)
+			{
+				culler.AddOccluder(boxBounds, occluder);
+			}
+		}
+		double rasterMilliseconds = ElapsedMilliseconds(start) / iterations;
+
+		start = BenchmarkClock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			culler.BuildPyramid();
+		}
+		double pyramidMilliseconds = ElapsedMilliseconds(start) / iterations;
+
+		uint32_t occludedCount = 0;
+		uint32_t mismatches = 0;
+		start = BenchmarkClock::now();
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			uint8_t bOccluded = culler.IsOccluded(objects[i]) ? 1 : 0;
+			occludedCount += bOccluded;
+			if (path == IMAGE_KERNEL_SCALAR)
+			{
+				scalarOccluded[i] = bOccluded;
+			}
+			else if (scalarOccluded[i] != bOccluded)
+			{
+				mismatches++;
+			}
+		}
+		double testMilliseconds = ElapsedMilliseconds(start);
+
+		const float* pDepth = culler.GetDepthBuffer();
+		if (path == IMAGE_KERNEL_SCALAR)
+		{
+			scalarDepth.assign(pDepth, pDepth + OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT);
+		}
+		else
+		{
+			for (size_t i = 0; i < scalarDepth.size(); i++)
+			{
+				mismatches += (scalarDepth[i] != pDepth[i]) ? 1 : 0;
+			}
+		}
+
+		std::cout << "  " << ImageKernels::GetPathName((IMAGE_KERNEL_PATH)path) << ": rasterize "
+			<< rasterMilliseconds << " ms (" << culler.GetOccluderTriangles() << " triangles), pyramid "
+			<< pyramidMilliseconds << " ms, test " << testMilliseconds << " ms, draws saved "
+			<< occludedCount << " of " << objectCount;
+		std::cout << std::endl;
+
+		if (mismatches > 0)
+		{
+			std::cout << "ERROR: " << mismatches << " depths and objects differ from the scalar path" << std::endl;
+			bMatched = false;
+		}
+	}
+
+	OcclusionCuller::SetPath(bestPath);
+
+	return(bMatched);
+}
+
+/***********************************************************
+ *  BenchmarkLevelOfDetail()
+ *
+ *  This method is used for counting the triangles of the
+ *  desk scene and of a field of ten thousand tori with and
+ *  without the tessellation levels, seen from the starting
+ *  camera.  The camera then flies through the field, and
+ *  shakes in place, counting how often objects change level.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkLevelOfDetail()
+{
+	const uint32_t torusGrid = 100;
+	const int flightFrames = 120;
+	const int viewportHeight = 800;
+
+	MeshGenerator meshGenerator;
+	MeshLOD meshLOD;
+	MESH_BOUNDS shapeBounds[SCENE_MESH_COUNT];
+	std::vector<uint32_t> levelMeshes[SCENE_MESH_COUNT];
+	for (uint32_t shape = 0; shape < SCENE_MESH_COUNT; shape++)
+	{
+		meshLOD.RequestLevels(shape, meshGenerator, levelMeshes[shape]);
+	}
+	meshGenerator.GenerateMeshes();
+	for (uint32_t shape = 0; shape < SCENE_MESH_COUNT; shape++)
+	{
+		for (uint32_t level = 0; level < levelMeshes[shape].size(); level++)
+		{
+			const MESH_DATA& mesh = meshGenerator.GetMesh(levelMeshes[shape][level]);
+			meshLOD.SetLevelMesh(shape, level, shape, (uint32_t)(mesh.indices.size() / 3));
+		}
+		MeshGeometry::ComputeBounds(meshGenerator.GetMesh(levelMeshes[shape][0]), shapeBounds[shape]);
+	}
+
+	glm::mat4 projection = glm::perspective(glm::radians(80.0f), 1000.0f / 800.0f, 0.1f, 100.0f);
+
+	// the desk scene, and rows of small tori on the floor in
+	// front of the camera
+	std::vector<SCENE_RECORD> deskRecords;
+	SceneFile::ParseTextScene("Scenes/DeskScene.txt", deskRecords);
+
+	std::vector<SCENE_RECORD> torusRecords(torusGrid * torusGrid);
+	for (uint32_t i = 0; i < torusRecords.size(); i++)
+	{
+		SCENE_RECORD& record = torusRecords[i];
+		memset(&record, 0, sizeof(record));
+		record.meshType = SCENE_MESH_TORUS;
+		record.parentIndex = -1;
+		record.scale[0] = record.scale[1] = record.scale[2] = 0.3f;
+		record.rotation[0] = 90.0f;
+		record.position[0] = ((float)(i % torusGrid) - torusGrid * 0.5f) * 1.0f;
+		record.position[1] = 0.3f;
+		record.position[2] = 4.0f - (float)(i / torusGrid) * 1.0f;
+		record.color[0] = record.color[1] = record.color[2] = record.color[3] = 1.0f;
+	}
+
+	struct LOD_SCENE
+	{
+		const char* name;
+		const std::vector<SCENE_RECORD>* pRecords;
+	};
+	const LOD_SCENE scenes[] = { { "desk scene", &deskRecords }, { "torus field", &torusRecords } };
+
+	for (const LOD_SCENE& scene : scenes)
+	{
+		const std::vector<SCENE_RECORD>& records = *scene.pRecords;
+		uint32_t objectCount = (uint32_t)records.size();
+		if (objectCount == 0)
+		{
+			std::cout << "BENCHMARK: level of detail, " << scene.name << " did not load" << std::endl;
+			continue;
+		}
+
+		SceneGraph sceneGraph;
+		sceneGraph.Build(records.data(), objectCount);
+
+		// picks the level of every object for a camera position,
+		// and returns the triangles drawn and the level changes
+		std::vector<uint32_t> levels(objectCount, 0);
+		auto selectLevels = [&](const glm::vec3& cameraPosition, uint64_t& triangles, uint32_t& changes)
+		{
+			triangles = 0;
+			changes = 0;
+			for (uint32_t i = 0; i < objectCount; i++)
+			{
+				uint32_t meshType = records[i].meshType;
+				if (meshType >= SCENE_MESH_COUNT)
+					continue;
+
+				const glm::mat4& world = sceneGraph.GetWorldMatrix(i);
+				const MESH_BOUNDS& bounds = shapeBounds[meshType];
+				glm::vec3 center = glm::vec3(world * glm::vec4(bounds.center[0], bounds.center[1], bounds.center[2], 1.0f));
+				float scale = std::max(glm::length(glm::vec3(world[0])),
+					std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+				float pixels = MeshLOD::GetProjectedSize(
+					bounds.radius * scale, glm::length(center - cameraPosition), projection[1][1], viewportHeight);
+
+				uint32_t level = meshLOD.SelectLevel(meshType, pixels, levels[i]);
+				changes += (level != levels[i]) ? 1 : 0;
+				levels[i] = level;
+				triangles += meshLOD.GetLevel(meshType, level).triangleCount;
+			}
+		};
+
+		uint64_t fullTriangles = 0;
+		for (const SCENE_RECORD& record : records)
+		{
+			if (record.meshType < SCENE_MESH_COUNT)
+				fullTriangles += meshLOD.GetLevel(record.meshType, 0).triangleCount;
+		}
+
+		glm::vec3 startPosition(0.0f, 5.5f, 8.0f);
+		uint64_t triangles = 0;
+		uint32_t changes = 0;
+		auto start = BenchmarkClock::now();
+		selectLevels(startPosition, triangles, changes);
+		double selectMilliseconds = ElapsedMilliseconds(start);
+
+		std::cout << "BENCHMARK: level of detail, " << scene.name << " (" << objectCount << " objects)" << std::endl;
+		std::cout << "  full detail: " << fullTriangles << " triangles" << std::endl;
+		std::cout << "  levels: " << triangles << " triangles, selected in " << selectMilliseconds << " ms" << std::endl;
+
+		// fly forward through the scene and back to the start
+		uint64_t flightTriangles = 0;
+		uint32_t flightChanges = 0;
+		for (int frame = 0; frame < flightFrames; frame++)
+		{
+			float t = (float)frame / (float)(flightFrames / 2);
+			float travel = (t <= 1.0f) ? t : 2.0f - t;
+			selectLevels(startPosition + glm::vec3(0.0f, -4.0f * travel, -40.0f * travel), triangles, changes);
+			flightTriangles += triangles;
+			flightChanges += changes;
+		}
+		std::cout << "  flight: " << flightTriangles / flightFrames << " triangles per frame, "
+			<< flightChanges << " level changes" << std::endl;
+
+		// a shaking camera should not make objects switch back and
+		// forth, the first frame settles the levels
+		selectLevels(startPosition, triangles, changes);
+		uint32_t shakeChanges = 0;
+		for (int frame = 0; frame < flightFrames; frame++)
+		{
+			float offset = (frame % 2 == 0) ? 0.05f : -0.05f;
+			selectLevels(startPosition + glm::vec3(0.0f, 0.0f, offset), triangles, changes);
+			shakeChanges += (frame > 0) ? changes : 0;
+		}
+		std::cout << "  shaking camera: " << shakeChanges << " level changes in " << flightFrames << " frames" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  BenchmarkMeshGeneration()
+ *
+ *  This method is used for generating a few hundred variants
+ *  of the curved shapes on one thread and on the workers,
+ *  checking the meshes match, then requesting them all again
+ *  to count the answers from the cache.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkMeshGeneration()
+{
+	const uint32_t segmentCounts[] = { 6, 8, 12, 16, 24, 32, 48, 64 };
+	const uint32_t ringCounts[] = { 1, 4, 8, 16, 32 };
+	const float radii[] = { 0.0f, 0.05f, 0.1f, 0.5f, 1.0f };
+
+	std::vector<MESH_PARAMS> variants;
+	for (uint32_t segments : segmentCounts)
+	{
+		for (uint32_t rings : ringCounts)
+		{
+			for (float radius : radii)
+			{
+				MESH_PARAMS params = MeshGenerator::GetDefaultParams(MESH_SHAPE_CYLINDER);
+				params.segments = segments;
+				params.rings = rings;
+				params.radius = radius;
+				variants.push_back(params);
+
+				params = MeshGenerator::GetDefaultParams(MESH_SHAPE_TORUS);
+				params.segments = segments * 2;
+				params.rings = segments;
+				params.radius = (radius > 0.0f) ? radius : 0.2f;
+				variants.push_back(params);
+			}
+			MESH_PARAMS params = MeshGenerator::GetDefaultParams(MESH_SHAPE_SPHERE);
+			params.segments = segments * 2;
+			params.rings = std::max(rings, 2u) * 2;
+			variants.push_back(params);
+		}
+	}
+
+	const uint32_t threadCounts[] = { 1, 0 };
+	MeshGenerator generators[2];
+	for (int run = 0; run < 2; run++)
+	{
+		MeshGenerator& meshGenerator = generators[run];
+		for (const MESH_PARAMS& params : variants)
+		{
+			meshGenerator.RequestMesh(params);
+		}
+
+		auto start = BenchmarkClock::now();
+		uint32_t generatedCount = meshGenerator.GenerateMeshes(threadCounts[run]);
+		double milliseconds = ElapsedMilliseconds(start);
+
+		uint64_t triangles = 0;
+		for (uint32_t handle = 0; handle < meshGenerator.GetMeshCount(); handle++)
+		{
+			triangles += meshGenerator.GetMesh(handle).indices.size() / 3;
+		}
+		std::cout << "BENCHMARK: mesh generation, " << generatedCount << " variants, "
+			<< meshGenerator.GetThreadCount() << " threads: " << milliseconds << " ms, "
+			<< triangles << " triangles" << std::endl;
+	}
+
+	uint32_t mismatches = 0;
+	for (uint32_t handle = 0; handle < generators[0].GetMeshCount(); handle++)
+	{
+		const MESH_DATA& single = generators[0].GetMesh(handle);
+		const MESH_DATA& threaded = generators[1].GetMesh(handle);
+		if ((single.indices != threaded.indices) || (single.vertices.size() != threaded.vertices.size()) ||
+			(memcmp(single.vertices.data(), threaded.vertices.data(), single.vertices.size() * sizeof(single.vertices[0])) != 0))
+		{
+			mismatches++;
+		}
+	}
+
+	// the second round of requests is answered from the cache
+	MeshGenerator& meshGenerator = generators[1];
+	uint32_t meshCount = meshGenerator.GetMeshCount();
+	auto start = BenchmarkClock::now();
+	for (const MESH_PARAMS& params : variants)
+	{
+		meshGenerator.RequestMesh(params);
+	}
+	double milliseconds = ElapsedMilliseconds(start);
+	uint32_t generatedCount = meshGenerator.GenerateMeshes();
+
+	std::cout << "BENCHMARK: mesh generation, " << variants.size() << " repeated requests: "
+		<< milliseconds << " ms, " << (meshGenerator.GetMeshCount() - meshCount) << " new meshes, "
+		<< generatedCount << " generated, " << mismatches << " differ between thread counts" << std::endl;
+}
+
+/***********************************************************
+ *  BenchmarkVertexFormats()
+ *
+ *  This method is used for checking the precision of the
+ *  packed vertices on the basic shapes, then drawing a dense
+ *  sphere from the float and packed layouts with rasterizing
+ *  turned off, so the time is spent fetching and decoding
+ *  the vertices.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkVertexFormats()
+{
+	const uint32_t instanceCount = 64;
+	const int passCount = 20;
+
+	std::cout << "BENCHMARK: vertex formats, " << sizeof(MESH_VERTEX) << " bytes per float vertex, "
+		<< sizeof(PACKED_VERTEX) << " bytes per packed vertex" << std::endl;
+
+	// the largest errors of the packed vertices, positions in
+	// fractions of the bounding radius and normals in degrees
+	const char* const shapeNames[MESH_SHAPE_COUNT] = { "plane", "box", "cylinder", "torus", "sphere" };
+	for (uint32_t shape = 0; shape < MESH_SHAPE_COUNT; shape++)
+	{
+		MESH_DATA mesh;
+		MESH_BOUNDS bounds;
+		MeshGenerator::Generate(MeshGenerator::GetDefaultParams(shape), mesh);
+		MeshGeometry::ComputeBounds(mesh, bounds);
+
+		std::vector<PACKED_VERTEX> packed;
+		PackedVertices::PackVertices(mesh.vertices.data(), (uint32_t)mesh.vertices.size(), bounds, 0, packed);
+
+		float positionError = 0.0f;
+		float normalError = 0.0f;
+		float uvError = 0.0f;
+		for (size_t i = 0; i < packed.size(); i++)
+		{
+			const MESH_VERTEX& vertex = mesh.vertices[i];
+			MESH_VERTEX unpacked;
+			PackedVertices::UnpackVertex(packed[i], bounds, unpacked);
+
+			float cosine = 0.0f;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				positionError = std::max(positionError, std::fabs(unpacked.position[axis] - vertex.position[axis]));
+				cosine += unpacked.normal[axis] * vertex.normal[axis];
+			}
+			normalError = std::max(normalError, std::acos(std::min(cosine, 1.0f)) * 57.2957795f);
+			uvError = std::max(uvError, std::max(std::fabs(unpacked.uv[0] - vertex.uv[0]), std::fabs(unpacked.uv[1] - vertex.uv[1])));
+		}
+
+		std::cout << "  " << shapeNames[shape] << ": position error " << positionError / bounds.radius
+			<< ", normal error " << normalError << " degrees, uv error " << uvError << std::endl;
+	}
+
+	GLFWwindow* pWindow = CreateHiddenContext();
+	if (NULL == pWindow)
+	{
+		return;
+	}
+	GLStateCache::Invalidate();
+
+	GLuint program = CompileProgram(g_FetchVertexShader, g_FetchFragmentShader);
+	if (program != 0)
+	{
+		MESH_DATA sphere;
+		MeshGeometry::GenerateSphere(sphere, 256, 128);
+		std::vector<INSTANCE_DATA> instances(instanceCount, INSTANCE_DATA());
+
+		GLStateCache::UseProgram(program);
+		glUniform1i(glGetUniformLocation(program, "meshBoxes"), (GLint)InstancedMeshes::GetMeshBoxUnit());
+		glEnable(GL_RASTERIZER_DISCARD);
+
+		for (int layout = 0; layout < 2; layout++)
+		{
+			bool bPacked = (layout == 1);
+			InstancedMeshes meshes;
+			meshes.SetPackedVertices(bPacked);
+			uint32_t meshType = meshes.AddMesh(sphere);
+			meshes.UploadInstances(instances.data(), instanceCount);
+			glUniform1i(glGetUniformLocation(program, "bPackedVertices"), bPacked ? 1 : 0);
+
+			// the first draw pays for the upload
+			meshes.DrawMeshInstances(meshType, 0, instanceCount);
+			glFinish();
+
+			auto start = BenchmarkClock::now();
+			for (int pass = 0; pass < passCount; pass++)
+			{
+				meshes.DrawMeshInstances(meshType, 0, instanceCount);
+			}
+			glFinish();
+			double milliseconds = ElapsedMilliseconds(start) / passCount;
+			double vertices = (double)sphere.indices.size() * instanceCount;
+
+			std::cout << "  " << (bPacked ? "packed" : "float") << ": "
+				<< meshes.GetVertexBytes() << " vertex bytes, " << meshes.GetIndexBytes() << " index bytes, "
+				<< milliseconds << " ms per pass, " << vertices / (milliseconds * 1000.0) << " million vertices per second" << std::endl;
+		}
+
+		glDisable(GL_RASTERIZER_DISCARD);
+		GLStateCache::UseProgram(0);
+		glDeleteProgram(program);
+	}
+
+	DestroyHiddenContext(pWindow);
+}
+
+/***********************************************************
+ *  BenchmarkMeshOptimizer()
+ *
+ *  This method is used for simulating the vertex cache on
+ *  the generated shapes and a few denser variants before
+ *  and after optimizing them, for the cache size the passes
+ *  target and a larger one, then timing the generation of
+ *  the levels of detail with and without the optimizer.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkMeshOptimizer()
+{
+	const char* shapeNames[] = { "plane", "box", "cylinder", "torus", "sphere" };
+	const uint32_t largeCacheSize = 32;
+
+	std::vector<MESH_PARAMS> variants;
+	std::vector<std::string> variantNames;
+	for (uint32_t shape = 0; shape < MESH_SHAPE_COUNT; shape++)
+	{
+		variants.push_back(MeshGenerator::GetDefaultParams(shape));
+		variantNames.push_back(shapeNames[shape]);
+	}
+	MESH_PARAMS params = MeshGenerator::GetDefaultParams(MESH_SHAPE_CYLINDER);
+	params.rings = 16;
+	variants.push_back(params);
+	variantNames.push_back("cylinder 36x16");
+	params = MeshGenerator::GetDefaultParams(MESH_SHAPE_TORUS);
+	params.segments = 128;
+	params.rings = 64;
+	variants.push_back(params);
+	variantNames.push_back("torus 128x64");
+	params = MeshGenerator::GetDefaultParams(MESH_SHAPE_SPHERE);
+	params.segments = 256;
+	params.rings = 128;
+	variants.push_back(params);
+	variantNames.push_back("sphere 256x128");
+
+	for (size_t i = 0; i < variants.size(); i++)
+	{
+		MESH_DATA mesh;
+		MeshGenerator::Generate(variants[i], mesh);
+		uint32_t vertexCount = (uint32_t)mesh.vertices.size();
+		float largeBefore = MeshOptimizer::SimulateACMR(mesh.indices, vertexCount, largeCacheSize);
+
+		MESH_OPTIMIZE_STATS stats;
+		auto start = BenchmarkClock::now();
+		MeshOptimizer::OptimizeMesh(mesh, &stats);
+		double milliseconds = ElapsedMilliseconds(start);
+		float largeAfter = MeshOptimizer::SimulateACMR(mesh.indices, (uint32_t)mesh.vertices.size(), largeCacheSize);
+
+		std::cout << "BENCHMARK: mesh optimizer, " << variantNames[i] << ", " << mesh.indices.size() / 3
+			<< " triangles: ACMR " << stats.acmrBefore << " -> " << stats.acmrAfter << " with "
+			<< MeshOptimizer::CACHE_SIZE << " entries, " << largeBefore << " -> " << largeAfter << " with "
+			<< largeCacheSize << ", " << stats.clusterCount << " clusters, " << milliseconds << " ms" << std::endl;
+	}
+
+	// the levels of detail as the scene generates them
+	for (int run = 0; run < 2; run++)
+	{
+		bool bOptimize = (run == 1);
+		MeshGenerator meshGenerator;
+		MeshLOD meshLOD;
+		meshGenerator.SetOptimizeMeshes(bOptimize);
+		std::vector<uint32_t> levelMeshes;
+		for (uint32_t shape = 0; shape < SCENE_MESH_COUNT; shape++)
+		{
+			meshLOD.RequestLevels(shape, meshGenerator, levelMeshes);
+		}
+
+		auto start = BenchmarkClock::now();
+		uint32_t generatedCount = meshGenerator.GenerateMeshes();
+		double milliseconds = ElapsedMilliseconds(start);
+
+		double misses = 0.0;
+		uint64_t triangles = 0;
+		for (uint32_t handle = 0; handle < meshGenerator.GetMeshCount(); handle++)
+		{
+			uint64_t meshTriangles = meshGenerator.GetMesh(handle).indices.size() / 3;
+			misses += (double)meshGenerator.GetOptimizeStats(handle).acmrAfter * meshTriangles;
+			triangles += meshTriangles;
+		}
+		std::cout << "BENCHMARK: mesh optimizer, " << generatedCount << " level meshes "
+			<< (bOptimize ? "optimized" : "as generated") << ": " << milliseconds << " ms on "
+			<< meshGenerator.GetThreadCount() << " threads, ACMR " << ((triangles > 0) ? misses / triangles : 0.0)
+			<< " over " << triangles << " triangles" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  BenchmarkMeshCache()
+ *
+ *  This method is used for timing the level meshes of the
+ *  scene from a cold cache, generated, optimized and written
+ *  to a cache file, and from a warm one, mapped from that
+ *  file.  The mapped meshes are checked against the
+ *  generated ones, and both are uploaded into the shared
+ *  buffers when a context can be created.
+ ***********************************************************/
+void SceneBenchmarks::BenchmarkMeshCache()
+{
+	const char* cacheFilename = "MeshCacheBenchmark.bin";
+
+	MeshGenerator generators[2];
+	MeshLOD meshLOD;
+	for (MeshGenerator& meshGenerator : generators)
+	{
+		std::vector<uint32_t> levelMeshes;
+		for (uint32_t shape = 0; shape < SCENE_MESH_COUNT; shape++)
+		{
+			meshLOD.RequestLevels(shape, meshGenerator, levelMeshes);
+		}
+	}
+
+	// cold, the meshes are generated and the cache written
+	MeshGenerator& coldGenerator = generators[0];
+	auto start = BenchmarkClock::now();
+	uint32_t generatedCount = coldGenerator.GenerateMeshes();
+	double generateMilliseconds = ElapsedMilliseconds(start);
+	start = BenchmarkClock::now();
+	bool bWritten = MeshCache::WriteCache(cacheFilename, coldGenerator);
+	double writeMilliseconds = ElapsedMilliseconds(start);
+	if (bWritten == false)
+	{
+		return;
+	}
+
+	// warm, the same requests are answered by the mapped file
+	MeshGenerator& warmGenerator = generators[1];
+	MeshCache meshCache;
+	start = BenchmarkClock::now();
+	bool bOpened = meshCache.Open(cacheFilename, warmGenerator);
+	double openMilliseconds = ElapsedMilliseconds(start);
+
+	uint32_t mismatches = 0;
+	for (uint32_t handle = 0; bOpened && (handle < warmGenerator.GetMeshCount()); handle++)
+	{
+		const MESH_DATA& mesh = coldGenerator.GetMesh(handle);
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+		const MESH_VERTEX* pVertices = meshCache.GetVertices(handle, vertexCount);
+		const uint32_t* pIndices = meshCache.GetIndices(handle, indexCount);
+		if ((vertexCount != mesh.vertices.size()) || (indexCount != mesh.indices.size()) ||
+			(memcmp(pVertices, mesh.vertices.data(), vertexCount * sizeof(MESH_VERTEX)) != 0) ||
+			(memcmp(pIndices, mesh.indices.data(), indexCount * sizeof(uint32_t)) != 0))
+		{
+			mismatches++;
+		}
+	}
+
+	std::cout << "BENCHMARK: mesh cache, cold: " << generatedCount << " meshes generated in "
+		<< generateMilliseconds << " ms on " << coldGenerator.GetThreadCount() << " threads, written in "
+		<< writeMilliseconds << " ms" << std::endl;
+	std::cout << "BENCHMARK: mesh cache, warm: " << (bOpened ? meshCache.GetMeshCount() : 0) << " meshes, "
+		<< meshCache.GetSize() << " bytes mapped in " << openMilliseconds << " ms, "
+		<< mismatches << " differ from the generated meshes" << std::endl;
+
+	// a different request set must not accept the file
+	MeshGenerator otherGenerator;
+	otherGenerator.RequestMesh(MeshGenerator::GetDefaultParams(MESH_SHAPE_SPHERE));
+	MeshCache otherCache;
+	std::cout << "BENCHMARK: mesh cache, other requests " << (otherCache.Open(cacheFilename, otherGenerator) ? "accepted" : "rejected") << std::endl;
+
+	GLFWwindow* pWindow = (bOpened == true) ? CreateHiddenContext() : NULL;
+	if (NULL != pWindow)
+	{
+		GLStateCache::Invalidate();
+		for (int run = 0; run < 2; run++)
+		{
+			bool bWarm = (run == 1);
+			InstancedMeshes meshes;
+			start = BenchmarkClock::now();
+			for (uint32_t handle = 0; handle < warmGenerator.GetMeshCount(); handle++)
+			{
+				if (bWarm == true)
+				{
+					uint32_t vertexCount = 0;
+					uint32_t indexCount = 0;
+					const MESH_VERTEX* pVertices = meshCache.GetVertices(handle, vertexCount);
+					const uint32_t* pIndices = meshCache.GetIndices(handle, indexCount);
+					meshes.AddMesh(pVertices, vertexCount, pIndices, indexCount);
+				}
+				else
+				{
+					meshes.AddMesh(coldGenerator.GetMesh(handle));
+				}
+			}
+			glFinish();
+			double milliseconds = ElapsedMilliseconds(start);
+
+			std::cout << "  upload from " << (bWarm ? "the mapped cache" : "the generated meshes") << ": "
+				<< milliseconds << " ms, " << meshes.GetVertexBytes() << " vertex bytes, "
+				<< meshes.GetIndexBytes() << " index bytes" << std::endl;
+		}
+		DestroyHiddenContext(pWindow);
+	}
+
+	meshCache.Close();
+	remove(cacheFilename);
+}
@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebenchmarks.h
+// ============
+// measure the cost of the scene management code paths
+//
+// The benchmarks are run from the command line with --benchmark <name>
+// and print their results to the console.  The uniforms, textures and
+// cooked benchmarks open a hidden window for their OpenGL context.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  SceneBenchmarks
+ *
+ *  This class contains the benchmarks for the CPU side of
+ *  the scene management code.
+ ***********************************************************/
+class SceneBenchmarks
+{
+public:
+	// run the named benchmark, or every benchmark for "all"
+	static bool Run(const char* benchmarkName);
+
+private:
+	// per-frame transformation cost, static and partly dirty
+	static void BenchmarkTransforms();
+	// world matrix propagation through the scene hierarchy
+	static void BenchmarkSceneGraph();
+	// setting uniforms by name against resolved handles
+	static void BenchmarkUniforms();
+	// tag lookups by string compare against interned tags
+	static void BenchmarkTags();
+	// texture loading on the main thread against the workers
+	static void BenchmarkTextureLoading();
+	// decoding source images against uploading cooked files
+	static void BenchmarkCookedTextures();
+	// throughput of the image kernels on each instruction set,
+	// false when a path does not match the scalar output
+	static bool BenchmarkImageKernels();
+	// frustum culling of many objects on each instruction set
+	static void BenchmarkFrustumCulling();
+	// building, refitting and querying the scene hierarchy
+	static void BenchmarkSceneBVH();
+	// occluder rasterization and occlusion tests, false when
+	// a path does not match the scalar results
+	static bool BenchmarkOcclusionCulling();
+	// triangles drawn with the tessellation levels of the
+	// curved shapes against drawing them at full detail
+	static void BenchmarkLevelOfDetail();
+	// generating many shape variants on one thread against
+	// the workers, and requesting them again from the cache
+	static void BenchmarkMeshGeneration();
+	// precision of the packed vertices, and drawing with the
+	// float and packed layouts while fetching dominates
+	static void BenchmarkVertexFormats();
+	// simulated vertex cache misses of the generated shapes
+	// before and after reordering them, and the time it takes
+	static void BenchmarkMeshOptimizer();
+	// preparing the level meshes with a cold mesh cache, by
+	// generating them, against mapping them from a warm one
+	static void BenchmarkMeshCache();
+};
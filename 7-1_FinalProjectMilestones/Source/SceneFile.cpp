@@ -0,0 +1,566 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// load data-driven scene descriptions for the 3D scene
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	const char g_SceneFileMagic[4] = { 'S', 'C', 'N', 'B' };
+	const uint32_t SCENE_FILE_VERSION = 3;
+
+	// names of the mesh types as written in text scene files
+	const char* g_MeshTypeNames[SCENE_MESH_COUNT] = { "plane", "box", "cylinder", "torus" };
+
+	static_assert(sizeof(SCENE_RECORD) == 108, "SCENE_RECORD layout changed - bump SCENE_FILE_VERSION");
+	static_assert(sizeof(SCENE_FILE_HEADER) == 32, "SCENE_FILE_HEADER layout changed");
+
+	/***********************************************************
+	 *  GetFileStamp()
+	 *
+	 *  Gets the modification time and size of a file.  Returns
+	 *  false when the file does not exist.
+	 ***********************************************************/
+	bool GetFileStamp(const char* filename, int64_t& fileTime, uint64_t& fileSize)
+	{
+#ifdef _WIN32
+		struct _stat64 fileInfo;
+		if (_stat64(filename, &fileInfo) != 0)
+			return(false);
+#else
+		struct stat fileInfo;
+		if (stat(filename, &fileInfo) != 0)
+			return(false);
+#endif
+		fileTime = (int64_t)fileInfo.st_mtime;
+		fileSize = (uint64_t)fileInfo.st_size;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  IsCompiledFrom()
+	 *
+	 *  Returns true when a binary scene file of the current
+	 *  version was compiled from a text file with the given
+	 *  modification time and size.
+	 ***********************************************************/
+	bool IsCompiledFrom(const char* binaryFilename, int64_t sourceTime, uint64_t sourceSize)
+	{
+		std::ifstream binaryFile(binaryFilename, std::ios::binary);
+		SCENE_FILE_HEADER header;
+		if (!binaryFile.read((char*)&header, sizeof(header)))
+			return(false);
+
+		return((memcmp(header.magic, g_SceneFileMagic, sizeof(g_SceneFileMagic)) == 0) &&
+			(header.version == SCENE_FILE_VERSION) &&
+			(header.sourceTime == sourceTime) &&
+			(header.sourceSize == sourceSize));
+	}
+
+	/***********************************************************
+	 *  CopyTag()
+	 *
+	 *  Copies a tag into a fixed size record field.  The "-"
+	 *  placeholder is stored as an empty tag.
+	 ***********************************************************/
+	bool CopyTag(const std::string& tag, char* destination)
+	{
+		memset(destination, 0, SCENE_TAG_LENGTH);
+
+		if (tag.compare("-") == 0)
+			return(true);
+
+		if (tag.size() >= SCENE_TAG_LENGTH)
+			return(false);
+
+		memcpy(destination, tag.c_str(), tag.size());
+		return(true);
+	}
+
+	/***********************************************************
+	 *  AppendSubtree()
+	 *
+	 *  Appends a record and all of its descendants to the
+	 *  ordered list, parents before children.  An explicit
+	 *  stack keeps deep hierarchies off the call stack.
+	 ***********************************************************/
+	void AppendSubtree(
+		uint32_t index,
+		const std::vector<std::vector<uint32_t> >& children,
+		std::vector<uint32_t>& order)
+	{
+		std::vector<uint32_t> pending(1, index);
+		while (pending.empty() == false)
+		{
+			uint32_t current = pending.back();
+			pending.pop_back();
+			order.push_back(current);
+
+			// push in reverse so children keep their file order
+			for (size_t i = children[current].size(); i > 0; i--)
+			{
+				pending.push_back(children[current][i - 1]);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+	m_pMappedData = NULL;
+	m_mappedSize = 0;
+	m_fileHandle = NULL;
+	m_mappingHandle = NULL;
+}
+
+/***********************************************************
+ *  ~SceneFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneFile::~SceneFile()
+{
+	UnmapScene();
+}
+
+/***********************************************************
+ *  LoadScene()
+ *
+ *  This method is used for loading a scene.  The binary twin
+ *  of the text scene file is recompiled unless it was made
+ *  from a text file of the same time and size, and then
+ *  mapped into memory.
+ ***********************************************************/
+bool SceneFile::LoadScene(const char* textFilename, const char* binaryFilename)
+{
+	int64_t textTime = 0;
+	uint64_t textSize = 0;
+
+	if ((GetFileStamp(textFilename, textTime, textSize) == true) &&
+		(IsCompiledFrom(binaryFilename, textTime, textSize) == false))
+	{
+		auto compileStart = std::chrono::high_resolution_clock::now();
+		if (CompileScene(textFilename, binaryFilename) == false)
+		{
+			return(false);
+		}
+		auto compileEnd = std::chrono::high_resolution_clock::now();
+
+		std::cout << "INFO: compiled scene " << textFilename << " in "
+			<< std::chrono::duration<double, std::milli>(compileEnd - compileStart).count()
+			<< " ms" << std::endl;
+	}
+
+	auto mapStart = std::chrono::high_resolution_clock::now();
+	bool bReturn = MapScene(binaryFilename);
+	auto mapEnd = std::chrono::high_resolution_clock::now();
+
+	if (bReturn == true)
+	{
+		std::cout << "INFO: loaded " << GetRecordCount() << " scene objects from "
+			<< binaryFilename << " in "
+			<< std::chrono::duration<double, std::milli>(mapEnd - mapStart).count()
+			<< " ms" << std::endl;
+	}
+
+	return(bReturn);
+}
+
+/***********************************************************
+ *  MapScene()
+ *
+ *  This method is used for mapping a compiled binary scene
+ *  file into memory.  The header is validated, and every
+ *  record for its parent index, mesh type and terminated
+ *  tags, then the records are used in place.
+ ***********************************************************/
+bool SceneFile::MapScene(const char* binaryFilename)
+{
+	UnmapScene();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(
+		binaryFilename,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "Could not open scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize) == FALSE)
+	{
+		CloseHandle(file);
+		std::cout << "Could not open scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		CloseHandle(file);
+		std::cout << "Could not map scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+
+	m_pMappedData = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	m_mappedSize = (size_t)fileSize.QuadPart;
+	m_fileHandle = file;
+	m_mappingHandle = mapping;
+#else
+	int file = open(binaryFilename, O_RDONLY);
+	if (file < 0)
+	{
+		std::cout << "Could not open scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+
+	struct stat fileInfo;
+	if (fstat(file, &fileInfo) != 0)
+	{
+		close(file);
+		std::cout << "Could not open scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+
+	void* pData = mmap(NULL, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+
+	m_pMappedData = (pData == MAP_FAILED) ? NULL : (const unsigned char*)pData;
+	m_mappedSize = (size_t)fileInfo.st_size;
+#endif
+
+	if (m_pMappedData == NULL)
+	{
+		UnmapScene();
+		std::cout << "Could not map scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+
+	// validate the header before handing out the records
+	const SCENE_FILE_HEADER* pHeader = (const SCENE_FILE_HEADER*)m_pMappedData;
+	if ((m_mappedSize < sizeof(SCENE_FILE_HEADER)) ||
+		(memcmp(pHeader->magic, g_SceneFileMagic, sizeof(g_SceneFileMagic)) != 0) ||
+		(pHeader->version != SCENE_FILE_VERSION) ||
+		(pHeader->recordSize != sizeof(SCENE_RECORD)) ||
+		(m_mappedSize < sizeof(SCENE_FILE_HEADER) + (size_t)pHeader->recordCount * sizeof(SCENE_RECORD)))
+	{
+		UnmapScene();
+		std::cout << "Invalid or outdated scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+
+	// records are in depth-first order, so a parent always
+	// comes before its children; the mesh type indexes the
+	// shape tables and the tags are used as C strings
+	const SCENE_RECORD* pRecords = GetRecords();
+	for (uint32_t i = 0; i < pHeader->recordCount; i++)
+	{
+		const SCENE_RECORD& record = pRecords[i];
+		if (((record.parentIndex != SCENE_NO_PARENT) &&
+			((record.parentIndex < 0) || ((uint32_t)record.parentIndex >= i))) ||
+			((record.meshType >= SCENE_MESH_COUNT) && (record.meshType != SCENE_MESH_NONE)) ||
+			(memchr(record.name, 0, SCENE_TAG_LENGTH) == NULL) ||
+			(memchr(record.textureTag, 0, SCENE_TAG_LENGTH) == NULL) ||
+			(memchr(record.materialTag, 0, SCENE_TAG_LENGTH) == NULL))
+		{
+			UnmapScene();
+			std::cout << "Invalid or outdated scene file:" << binaryFilename << std::endl;
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  UnmapScene()
+ *
+ *  This method is used for releasing the mapped scene file.
+ ***********************************************************/
+void SceneFile::UnmapScene()
+{
+#ifdef _WIN32
+	if (m_pMappedData != NULL)
+		UnmapViewOfFile(m_pMappedData);
+	if (m_mappingHandle != NULL)
+		CloseHandle((HANDLE)m_mappingHandle);
+	if (m_fileHandle != NULL)
+		CloseHandle((HANDLE)m_fileHandle);
+#else
+	if (m_pMappedData != NULL)
+		munmap((void*)m_pMappedData, m_mappedSize);
+#endif
+
+	m_pMappedData = NULL;
+	m_mappedSize = 0;
+	m_fileHandle = NULL;
+	m_mappingHandle = NULL;
+}
+
+/***********************************************************
+ *  GetRecords()
+ *
+ *  This method returns the records of the mapped scene.
+ ***********************************************************/
+const SCENE_RECORD* SceneFile::GetRecords() const
+{
+	if (m_pMappedData == NULL)
+		return(NULL);
+
+	return((const SCENE_RECORD*)(m_pMappedData + sizeof(SCENE_FILE_HEADER)));
+}
+
+/***********************************************************
+ *  GetRecordCount()
+ *
+ *  This method returns the number of mapped scene records.
+ ***********************************************************/
+uint32_t SceneFile::GetRecordCount() const
+{
+	if (m_pMappedData == NULL)
+		return(0);
+
+	return(((const SCENE_FILE_HEADER*)m_pMappedData)->recordCount);
+}
+
+/***********************************************************
+ *  ParseTextScene()
+ *
+ *  This method is used for reading a text scene file.  Each
+ *  non-empty line that does not start with '#' describes one
+ *  object:
+ *
+ *    mesh name parent texture material  sx sy sz  rx ry rz  px py pz  [r g b a]
+ *
+ *  A "-" in place of a name or tag leaves it unset.  A parent
+ *  must be named on an earlier line, and the transformation
+ *  of an object is relative to its parent.  The records are
+ *  returned in depth-first order.
+ ***********************************************************/
+bool SceneFile::ParseTextScene(const char* textFilename, std::vector<SCENE_RECORD>& records)
+{
+	std::ifstream textFile(textFilename);
+	if (!textFile.is_open())
+	{
+		std::cout << "Could not open scene file:" << textFilename << std::endl;
+		return(false);
+	}
+
+	std::vector<SCENE_RECORD> fileRecords;
+	std::unordered_map<std::string, int32_t> namedRecords;
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(textFile, line))
+	{
+		lineNumber++;
+
+		std::istringstream tokens(line);
+		std::string meshName;
+		if (!(tokens >> meshName) || (meshName[0] == '#'))
+			continue;
+
+		SCENE_RECORD record;
+		memset(&record, 0, sizeof(record));
+		record.meshType = SCENE_MESH_COUNT;
+		for (uint32_t i = 0; i < SCENE_MESH_COUNT; i++)
+		{
+			if (meshName.compare(g_MeshTypeNames[i]) == 0)
+				record.meshType = i;
+		}
+		if (meshName.compare("node") == 0)
+			record.meshType = SCENE_MESH_NONE;
+
+		std::string objectName;
+		std::string parentName;
+		std::string textureTag;
+		std::string materialTag;
+		tokens >> objectName >> parentName >> textureTag >> materialTag
+			>> record.scale[0] >> record.scale[1] >> record.scale[2]
+			>> record.rotation[0] >> record.rotation[1] >> record.rotation[2]
+			>> record.position[0] >> record.position[1] >> record.position[2];
+
+		if ((tokens.fail()) ||
+			(record.meshType == SCENE_MESH_COUNT) ||
+			(CopyTag(objectName, record.name) == false) ||
+			(CopyTag(textureTag, record.textureTag) == false) ||
+			(CopyTag(materialTag, record.materialTag) == false))
+		{
+			std::cout << "Invalid scene object at " << textFilename << ":" << lineNumber << std::endl;
+			return(false);
+		}
+
+		// the object color is optional and defaults to white
+		if (!(tokens >> record.color[0] >> record.color[1] >> record.color[2] >> record.color[3]))
+		{
+			record.color[0] = record.color[1] = record.color[2] = record.color[3] = 1.0f;
+		}
+
+		// resolve the parent among the previously read objects
+		record.parentIndex = SCENE_NO_PARENT;
+		if (parentName.compare("-") != 0)
+		{
+			auto parent = namedRecords.find(parentName);
+			if (parent == namedRecords.end())
+			{
+				std::cout << "Unknown parent " << parentName << " at " << textFilename << ":" << lineNumber << std::endl;
+				return(false);
+			}
+			record.parentIndex = parent->second;
+		}
+
+		if (record.name[0] != '\0')
+			namedRecords[record.name] = (int32_t)fileRecords.size();
+		fileRecords.push_back(record);
+	}
+
+	// order the records depth-first so that every subtree is a
+	// contiguous range that starts with its root
+	std::vector<std::vector<uint32_t> > children(fileRecords.size());
+	std::vector<uint32_t> order;
+	order.reserve(fileRecords.size());
+	for (uint32_t i = 0; i < fileRecords.size(); i++)
+	{
+		if (fileRecords[i].parentIndex >= 0)
+			children[fileRecords[i].parentIndex].push_back(i);
+	}
+	for (uint32_t i = 0; i < fileRecords.size(); i++)
+	{
+		if (fileRecords[i].parentIndex < 0)
+			AppendSubtree(i, children, order);
+	}
+
+	std::vector<int32_t> orderedIndex(fileRecords.size());
+	for (uint32_t i = 0; i < order.size(); i++)
+	{
+		orderedIndex[order[i]] = (int32_t)i;
+	}
+
+	size_t firstRecord = records.size();
+	records.reserve(firstRecord + order.size());
+	for (uint32_t i = 0; i < order.size(); i++)
+	{
+		SCENE_RECORD record = fileRecords[order[i]];
+		if (record.parentIndex >= 0)
+			record.parentIndex = (int32_t)firstRecord + orderedIndex[record.parentIndex];
+		records.push_back(record);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CompileScene()
+ *
+ *  This method is used for converting a text scene file into
+ *  the binary layout that MapScene() uses in place.
+ ***********************************************************/
+bool SceneFile::CompileScene(const char* textFilename, const char* binaryFilename)
+{
+	std::vector<SCENE_RECORD> records;
+	if (ParseTextScene(textFilename, records) == false)
+	{
+		return(false);
+	}
+
+	SCENE_FILE_HEADER header;
+	memcpy(header.magic, g_SceneFileMagic, sizeof(header.magic));
+	header.version = SCENE_FILE_VERSION;
+	header.recordSize = sizeof(SCENE_RECORD);
+	header.recordCount = (uint32_t)records.size();
+	if (GetFileStamp(textFilename, header.sourceTime, header.sourceSize) == false)
+	{
+		std::cout << "Could not open scene file:" << textFilename << std::endl;
+		return(false);
+	}
+
+	std::ofstream binaryFile(binaryFilename, std::ios::binary | std::ios::trunc);
+	if (!binaryFile.is_open())
+	{
+		std::cout << "Could not write scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+
+	binaryFile.write((const char*)&header, sizeof(header));
+	if (records.size() > 0)
+	{
+		binaryFile.write((const char*)records.data(), records.size() * sizeof(SCENE_RECORD));
+	}
+
+	return(binaryFile.good());
+}
+
+/***********************************************************
+ *  WriteSyntheticScene()
+ *
+ *  This method is used for writing a text scene file with a
+ *  grid of generated objects, for measuring how the scene
+ *  code scales with large object counts.
+ ***********************************************************/
+bool SceneFile::WriteSyntheticScene(const char* textFilename, uint32_t objectCount)
+{
+	std::ofstream textFile(textFilename, std::ios::trunc);
+	if (!textFile.is_open())
+	{
+		std::cout << "Could not write scene file:" << textFilename << std::endl;
+		return(false);
+	}
+
+	const char* textureTags[] = { "wood", "floor", "bDrop", "Books", "plastic", "screen" };
+	const char* materialTags[] = { "wood", "cement", "glass", "clay" };
+
+	textFile << "# synthetic scene with " << objectCount << " objects" << std::endl;
+
+	uint32_t rowLength = 1;
+	while (rowLength * rowLength < objectCount)
+		rowLength++;
+
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		float xPos = (float)(i % rowLength) * 1.5f - rowLength * 0.75f;
+		float zPos = -(float)(i / rowLength) * 1.5f;
+
+		textFile << g_MeshTypeNames[i % SCENE_MESH_COUNT] << " - - "
+			<< textureTags[i % 6] << " "
+			<< materialTags[i % 4] << " "
+			<< "0.5 0.5 0.5 "
+			<< "0 " << (i * 7) % 360 << " 0 "
+			<< xPos << " 0.5 " << zPos << "\n";
+	}
+
+	return(textFile.good());
+}
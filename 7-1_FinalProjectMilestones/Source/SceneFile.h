@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// load data-driven scene descriptions for the 3D scene
+//
+// A scene is authored as a plain text file with one object per line and
+// compiled into a fixed-layout binary twin.  The binary file is memory
+// mapped and its records are used in place, with no parsing at load time.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// maximum tag and name length, including the terminating null character
+const int SCENE_TAG_LENGTH = 16;
+
+// parent index of an object at the root of the scene
+const int32_t SCENE_NO_PARENT = -1;
+
+// basic shape meshes that a scene object can be drawn with; a node
+// without a mesh only groups and positions its child objects
+enum SCENE_MESH_TYPE
+{
+	SCENE_MESH_PLANE = 0,
+	SCENE_MESH_BOX = 1,
+	SCENE_MESH_CYLINDER = 2,
+	SCENE_MESH_TORUS = 3,
+	SCENE_MESH_COUNT,
+	SCENE_MESH_NONE = 0xFF
+};
+
+/***********************************************************
+ *  SCENE_RECORD
+ *
+ *  One object in the scene.  The layout of this structure
+ *  is the on-disk layout of the compiled binary scene file,
+ *  so any change to it must bump SCENE_FILE_VERSION.
+ *
+ *  Records are stored in depth-first order - a parent comes
+ *  before its children and every subtree is contiguous.  The
+ *  transformation is relative to the parent object.
+ ***********************************************************/
+struct SCENE_RECORD
+{
+	uint32_t meshType;
+	int32_t parentIndex;
+	char name[SCENE_TAG_LENGTH];
+	char textureTag[SCENE_TAG_LENGTH];
+	char materialTag[SCENE_TAG_LENGTH];
+	float scale[3];
+	float rotation[3];
+	float position[3];
+	float color[4];
+};
+
+/***********************************************************
+ *  SCENE_FILE_HEADER
+ *
+ *  Header at the start of every compiled binary scene file.
+ *  The modification time and size of the text file it was
+ *  compiled from tell whether the binary file is current.
+ ***********************************************************/
+struct SCENE_FILE_HEADER
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t recordSize;
+	uint32_t recordCount;
+	int64_t sourceTime;
+	uint64_t sourceSize;
+};
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class compiles text scene descriptions into binary
+ *  scene files and maps the binary files into memory.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	// constructor
+	SceneFile();
+	// destructor
+	~SceneFile();
+
+	// map the binary twin of a text scene file, compiling it
+	// first when it is missing or older than the text file
+	bool LoadScene(const char* textFilename, const char* binaryFilename);
+	// map a compiled binary scene file into memory
+	bool MapScene(const char* binaryFilename);
+	// release the mapped scene file
+	void UnmapScene();
+
+	// access the mapped scene records
+	const SCENE_RECORD* GetRecords() const;
+	uint32_t GetRecordCount() const;
+
+	// parse a text scene file into depth-first ordered scene records
+	static bool ParseTextScene(const char* textFilename, std::vector<SCENE_RECORD>& records);
+	// convert a text scene file into a compiled binary scene file
+	static bool CompileScene(const char* textFilename, const char* binaryFilename);
+	// write a text scene file of generated objects for load testing
+	static bool WriteSyntheticScene(const char* textFilename, uint32_t objectCount);
+
+private:
+	// start of the mapped file, or NULL when nothing is mapped
+	const unsigned char* m_pMappedData;
+	// size of the mapped file in bytes
+	size_t m_mappedSize;
+	// platform handles for the mapped file
+	void* m_fileHandle;
+	void* m_mappingHandle;
+};
@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenegraph.cpp
+// ============
+// manage the parent/child hierarchy of the scene objects
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneGraph.h"
+
+#include <algorithm>
+#include <cstring>
+
+/***********************************************************
+ *  SceneGraph()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneGraph::SceneGraph()
+{
+	m_pRecords = NULL;
+}
+
+/***********************************************************
+ *  ~SceneGraph()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneGraph::~SceneGraph()
+{
+	m_pRecords = NULL;
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the hierarchy from the
+ *  scene records.  The records must be in depth-first order,
+ *  which is how SceneFile stores them.
+ ***********************************************************/
+void SceneGraph::Build(const SCENE_RECORD* pRecords, uint32_t recordCount)
+{
+	m_pRecords = pRecords;
+	m_localTransforms.Clear();
+	m_localTransforms.Reserve(recordCount);
+	m_parents.resize(recordCount);
+	m_subtreeSizes.assign(recordCount, 1);
+	m_worldMatrices.resize(recordCount);
+	m_changedNodes.clear();
+
+	for (uint32_t i = 0; i < recordCount; i++)
+	{
+		m_localTransforms.AddTransform(
+			glm::vec3(pRecords[i].scale[0], pRecords[i].scale[1], pRecords[i].scale[2]),
+			glm::vec3(pRecords[i].rotation[0], pRecords[i].rotation[1], pRecords[i].rotation[2]),
+			glm::vec3(pRecords[i].position[0], pRecords[i].position[1], pRecords[i].position[2]));
+		m_parents[i] = pRecords[i].parentIndex;
+	}
+
+	// children follow their parent, so walking backwards
+	// accumulates every subtree size before it is needed
+	for (uint32_t i = recordCount; i > 0; i--)
+	{
+		int32_t parent = m_parents[i - 1];
+		if (parent >= 0)
+			m_subtreeSizes[parent] += m_subtreeSizes[i - 1];
+	}
+
+	// compose every world matrix once, parents first
+	for (uint32_t i = 0; i < recordCount; i++)
+	{
+		if (m_parents[i] < 0)
+			m_worldMatrices[i] = m_localTransforms.GetModelMatrix(i);
+		else
+			m_worldMatrices[i] = m_worldMatrices[m_parents[i]] * m_localTransforms.GetModelMatrix(i);
+	}
+}
+
+/***********************************************************
+ *  FindNode()
+ *
+ *  This method is used for finding a node by its name.
+ ***********************************************************/
+int SceneGraph::FindNode(const char* nodeName) const
+{
+	for (uint32_t i = 0; i < GetNodeCount(); i++)
+	{
+		if (strcmp(m_pRecords[i].name, nodeName) == 0)
+			return((int)i);
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  SetLocalScale()
+ *
+ *  This method is used for changing the scale of a node.
+ ***********************************************************/
+void SceneGraph::SetLocalScale(uint32_t node, const glm::vec3& scaleXYZ)
+{
+	m_localTransforms.SetScale(node, scaleXYZ);
+}
+
+/***********************************************************
+ *  SetLocalRotation()
+ *
+ *  This method is used for changing the rotation of a node.
+ ***********************************************************/
+void SceneGraph::SetLocalRotation(uint32_t node, const glm::vec3& rotationDegreesXYZ)
+{
+	m_localTransforms.SetRotation(node, rotationDegreesXYZ);
+}
+
+/***********************************************************
+ *  SetLocalPosition()
+ *
+ *  This method is used for changing the position of a node.
+ ***********************************************************/
+void SceneGraph::SetLocalPosition(uint32_t node, const glm::vec3& positionXYZ)
+{
+	m_localTransforms.SetPosition(node, positionXYZ);
+}
+
+/***********************************************************
+ *  UpdateWorldMatrices()
+ *
+ *  This method is used for propagating changed local
+ *  transformations to the world matrices.  Only the subtree
+ *  below each changed node is visited, and a changed node
+ *  inside an already visited subtree is skipped, so the cost
+ *  scales with the number of affected nodes.
+ ***********************************************************/
+uint32_t SceneGraph::UpdateWorldMatrices()
+{
+	m_changedNodes.clear();
+	if (m_localTransforms.UpdateModelMatrices(&m_changedNodes) == 0)
+	{
+		return(0);
+	}
+
+	std::sort(m_changedNodes.begin(), m_changedNodes.end());
+
+	uint32_t updatedCount = 0;
+	uint32_t visitedEnd = 0;
+	for (uint32_t changedNode : m_changedNodes)
+	{
+		// already refreshed as part of a changed ancestor
+		if (changedNode < visitedEnd)
+			continue;
+
+		visitedEnd = changedNode + m_subtreeSizes[changedNode];
+		for (uint32_t i = changedNode; i < visitedEnd; i++)
+		{
+			if (m_parents[i] < 0)
+				m_worldMatrices[i] = m_localTransforms.GetModelMatrix(i);
+			else
+				m_worldMatrices[i] = m_worldMatrices[m_parents[i]] * m_localTransforms.GetModelMatrix(i);
+		}
+		updatedCount += visitedEnd - changedNode;
+	}
+
+	return(updatedCount);
+}
@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenegraph.h
+// ============
+// manage the parent/child hierarchy of the scene objects
+//
+// The nodes are kept in a flat array in depth-first order, so a parent is
+// always stored before its children and every subtree is one contiguous
+// range.  World matrices are only propagated down the changed subtrees.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneFile.h"
+#include "TransformStore.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  SceneGraph
+ *
+ *  This class contains the scene object hierarchy and the
+ *  world matrices of its nodes.
+ ***********************************************************/
+class SceneGraph
+{
+public:
+	// constructor
+	SceneGraph();
+	// destructor
+	~SceneGraph();
+
+	// build the hierarchy from depth-first ordered scene records
+	void Build(const SCENE_RECORD* pRecords, uint32_t recordCount);
+
+	// find a node by its name, returning -1 when not found
+	int FindNode(const char* nodeName) const;
+
+	// change the transformation of a node relative to its parent
+	void SetLocalScale(uint32_t node, const glm::vec3& scaleXYZ);
+	void SetLocalRotation(uint32_t node, const glm::vec3& rotationDegreesXYZ);
+	void SetLocalPosition(uint32_t node, const glm::vec3& positionXYZ);
+
+	// propagate the changed local transformations down their
+	// subtrees and return how many world matrices were updated
+	uint32_t UpdateWorldMatrices();
+
+	// access the nodes
+	uint32_t GetNodeCount() const { return((uint32_t)m_parents.size()); }
+	int32_t GetParent(uint32_t node) const { return(m_parents[node]); }
+	uint32_t GetSubtreeSize(uint32_t node) const { return(m_subtreeSizes[node]); }
+	const glm::mat4& GetWorldMatrix(uint32_t node) const { return(m_worldMatrices[node]); }
+	const glm::mat4* GetWorldMatrices() const { return(m_worldMatrices.data()); }
+	const TransformStore& GetLocalTransforms() const { return(m_localTransforms); }
+	// nodes changed in the last update, in ascending order - the
+	// whole subtree of every one of them has moved
+	const std::vector<uint32_t>& GetChangedNodes() const { return(m_changedNodes); }
+
+private:
+	// scene records the hierarchy was built from
+	const SCENE_RECORD* m_pRecords;
+	// transformations relative to the parent node
+	TransformStore m_localTransforms;
+	// parent index of every node, -1 for root nodes
+	std::vector<int32_t> m_parents;
+	// number of nodes in the subtree rooted at every node
+	std::vector<uint32_t> m_subtreeSizes;
+	// composed world matrix of every node
+	std::vector<glm::mat4> m_worldMatrices;
+	// nodes whose local transformation changed since the last update
+	std::vector<uint32_t> m_changedNodes;
+};
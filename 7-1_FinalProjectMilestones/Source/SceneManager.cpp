@@ -1,1133 +1,2355 @@
-///////////////////////////////////////////////////////////////////////////////
-// shadermanager.cpp
-// ============
-// manage the loading and rendering of 3D scenes
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "SceneManager.h"
-
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
-
-#include <glm/gtx/transform.hpp>
-
-// declaration of global variables
-namespace
-{
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
-}
-
-/***********************************************************
- *  SceneManager()
- *
- *  The constructor for the class
- ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
-{
-	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
-}
-
-/***********************************************************
- *  ~SceneManager()
- *
- *  The destructor for the class
- ***********************************************************/
-SceneManager::~SceneManager()
-{
-	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
-}
-
-/***********************************************************
- *  CreateGLTexture()
- *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
- ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
-{
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
-
-		return true;
-	}
-
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
-}
-
-/***********************************************************
- *  BindGLTextures()
- *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
- ***********************************************************/
-void SceneManager::BindGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  DestroyGLTextures()
- *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
- ***********************************************************/
-void SceneManager::DestroyGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  FindTextureID()
- *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
-{
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureID);
-}
-
-/***********************************************************
- *  FindTextureSlot()
- *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
-{
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureSlot);
-}
-
-/***********************************************************
- *  FindMaterial()
- *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
- ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
-{
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
-
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
-	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
-
-	return(true);
-}
-
-/***********************************************************
- *  SetTransformations()
- *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
- ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
-{
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
-}
-
-/***********************************************************
- *  SetShaderColor()
- *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
- ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
-{
-	// variables for this method
-	glm::vec4 currentColor;
-
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
-}
-
-/***********************************************************
- *  SetShaderTexture()
- *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
- ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
-}
-
-/***********************************************************
- *  SetTextureUVScale()
- *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
- ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
-}
-
-/***********************************************************
- *  SetShaderMaterial()
- *
- *  This method is used for passing the material values
- *  into the shader.
- ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
-{
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
-	}
-}
-
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
-	/*** STUDENTS - add the code BELOW for loading the textures that ***/
-	/*** will be used for mapping to objects in the 3D scene. Up to  ***/
-	/*** 16 textures can be loaded per scene. Refer to the code in   ***/
-	/*** the OpenGL Sample for help.                                 ***/
-void SceneManager::LoadSceneTextures()
-{
-	bool bReturn = false;
-	//FLOOR
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/pavers.jpg",
-		"floor"
-	);
-	//FLOOR
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/dirty.jpg",
-		"floor2"
-	);
-	
-	//TableLeg
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/rusticwood.jpg",
-		"plank"
-	);
-	//TableTop
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/stainless.jpg",
-		"desk"
-	);
-	//Backwall
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/slimBrick.jpg",
-		"bDrop"
-		
-  	);
-	//Book5
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/book011.jpg",
-		"Book5"
-		
-	);
-	//Books
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/book022.jpg",
-		"Books"
-
-	);
-	//Monitor Plastic
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/plastic.jpg",
-		"plastic"
-
-	);
-	//Monitor screen
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/Mons2.jpg",
-		"screen"
-
-	);
-	//keyboard Drawer
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/rusticwood.jpg",
-		"wood"
-
-	);
-	//keyboard texture
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/kb1.jpg",
-		"KB1"
-
-	);
-	//poster texture
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/tuckersoft.jpg",
-		"poster"
-
-	);
-
-
-	// after the texture image data is loaded into memory, the
-	// loaded textures need to be bound to texture slots - there
-	// are a total of 16 available slots for scene textures
-	BindGLTextures();
-}
-/***********************************************************
-*DefineObjectMaterials()
-*
-* This method is used for configuring the various material
-* settings for all of the objects within the 3D scene.
-* **********************************************************/
-void SceneManager::DefineObjectMaterials()
-{
-	/*** STUDENTS - add the code BELOW for defining object materials. ***/
-	/*** There is no limit to the number of object materials that can ***/
-	/*** be defined. Refer to the code in the OpenGL Sample for help  ***/
-
-
-	///////////////// GOLD   ////////////////////
-	OBJECT_MATERIAL goldMaterial;
-	goldMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.1f);
-	goldMaterial.ambientStrength = 0.4f;
-	goldMaterial.diffuseColor = glm::vec3(0.3f, 0.3f, 0.2f);
-	goldMaterial.specularColor = glm::vec3(0.6f, 0.5f, 0.4f);
-	goldMaterial.shininess = 22.0;
-	goldMaterial.tag = "gold";
-
-	m_objectMaterials.push_back(goldMaterial);
-
-	/////////////////  CEMENT /////////////////
-	OBJECT_MATERIAL cementMaterial;
-	cementMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
-	cementMaterial.ambientStrength = 0.2f;
-	cementMaterial.diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
-	cementMaterial.specularColor = glm::vec3(0.4f, 0.4f, 0.4f);
-	cementMaterial.shininess = 0.5;
-	cementMaterial.tag = "cement";
-
-	m_objectMaterials.push_back(cementMaterial);
-
-	///////////////// WOOD ////////////////////
-	OBJECT_MATERIAL woodMaterial;
-	woodMaterial.ambientColor = glm::vec3(0.4f, 0.3f, 0.1f);
-	woodMaterial.ambientStrength = 0.2f;
-	woodMaterial.diffuseColor = glm::vec3(0.3f, 0.2f, 0.1f);
-	woodMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
-	woodMaterial.shininess = 0.5;
-	woodMaterial.tag = "wood";
-
-	m_objectMaterials.push_back(woodMaterial);
-	///////////////// TILE ////////////////////
-	OBJECT_MATERIAL tileMaterial;
-	tileMaterial.ambientColor = glm::vec3(0.2f, 0.3f, 0.4f);
-	tileMaterial.ambientStrength = 0.3f;
-	tileMaterial.diffuseColor = glm::vec3(0.3f, 0.2f, 0.1f);
-	tileMaterial.specularColor = glm::vec3(0.4f, 0.5f, 0.6f);
-	tileMaterial.shininess = 25.0;
-	tileMaterial.tag = "tile";
-
-	m_objectMaterials.push_back(tileMaterial);
-
-	///////////////// glass ////////////////////
-	OBJECT_MATERIAL glassMaterial;
-	glassMaterial.ambientColor = glm::vec3(0.4f, 0.4f, 0.4f);
-	glassMaterial.ambientStrength = 0.3f;
-	glassMaterial.diffuseColor = glm::vec3(0.4f, 0.4f, 0.5f);
-	glassMaterial.specularColor = glm::vec3(0.6f, 0.6f, 0.6f);
-	glassMaterial.shininess = 85.0;
-	glassMaterial.tag = "glass";
-
-	m_objectMaterials.push_back(glassMaterial);
-
-	///////////////// CLAY ////////////////////
-	OBJECT_MATERIAL clayMaterial;
-	clayMaterial.ambientColor = glm::vec3(0.4f, 0.3f, 0.1f);
-	clayMaterial.ambientStrength = 0.2f;
-	clayMaterial.diffuseColor = glm::vec3(0.3f, 0.2f, 0.1f);
-	clayMaterial.specularColor = glm::vec3(0.4f, 0.5f, 0.6f);
-	clayMaterial.shininess = 0.5;
-	clayMaterial.tag = "clay";
-
-	m_objectMaterials.push_back(clayMaterial);
-}
-
-/***********************************************************
- *  SetupSceneLights()
- *
- *  This method is called to add and configure the light
- *  sources for the 3D scene.  There are up to 4 light sources.
- ***********************************************************/
-void SceneManager::SetupSceneLights()
-{
-	// this line of code is NEEDED for telling the shaders to render 
-	// the 3D scene with custom lighting, if no light sources have
-	// been added then the display window will be black - to use the 
-	// default OpenGL lighting then comment out the following line
-	//m_pShaderManager->setBoolValue(g_UseLightingName, true);
-
-	/*** STUDENTS - add the code BELOW for setting up light sources ***/
-	/*** Up to four light sources can be defined. Refer to the code ***/
-	/*** in the OpenGL Sample for help                              ***/
-	m_pShaderManager->setBoolValue(g_UseLightingName, true);
-
-	// Light 0: Upper right light
-	m_pShaderManager->setVec3Value("lightSources[0].position", 10.0f, 10.0f, 10.0f);
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.10f, 0.09f, 0.08f);  //  warm tone
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 0.3f, 0.3f, 0.3f);  // Lower  intensity
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 1.0f, 1.0f, 1.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 12.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 0.002f);
-
-	// Light 1: Upper left light
-	m_pShaderManager->setVec3Value("lightSources[1].position", -10.0f, 10.4f, -9.5f);
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 0.12f, 0.09f, 0.08f);
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.35f, 0.33f, 0.30f);
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.3f, 0.3f, 1.0f);
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 2.0f);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 0.02f);
-
-	// Light 2: Center overhead (above the glass table)
-	m_pShaderManager->setVec3Value("lightSources[2].position", 0.0f, 10.0f, 0.0f);
-	m_pShaderManager->setVec3Value("lightSources[2].ambientColor", 0.10f, 0.09f, 0.08f);
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.3f, 0.3f, 0.3f);
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", 0.1f, 1.0f, 1.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 54.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.01f); 
-
-	// Light 3: Fill light
-	m_pShaderManager->setVec3Value("lightSources[3].position", 10.0f, 0.0f, -10.0f);
-	m_pShaderManager->setVec3Value("lightSources[3].ambientColor", 0.10f, 0.09f, 0.08f);
-	m_pShaderManager->setVec3Value("lightSources[3].diffuseColor", 0.35f, 0.33f, 0.30f);
-	m_pShaderManager->setVec3Value("lightSources[3].specularColor", 1.0f, 1.0f, 1.0f);
-	m_pShaderManager->setFloatValue("lightSources[3].focalStrength", 16.0f);
-	m_pShaderManager->setFloatValue("lightSources[3].specularIntensity", 0.015f);
-
-
-}
-
-/***********************************************************
- *  PrepareScene()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void SceneManager::PrepareScene()
-{
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-	// load the textures for the 3D scene
-	// define the materials for objects in the scene
-	DefineObjectMaterials();
-	// add and define the light sources for the scene
-	SetupSceneLights();
-	LoadSceneTextures();
-	// LoadShapes
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadTorusMesh();
-}
-
-/***********************************************************
- *  RenderScene()
- *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
- ***********************************************************/
-void SceneManager::RenderScene()
-{
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-	//FLOOR
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes. Floor					***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(18.0f, 1.0f, 7.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, -0.2f, -2.7f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.1, 0.5, 1, 1);
-	SetShaderTexture("wood");
-	SetShaderMaterial("cement");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-	//FLOOR2
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes. Floor					***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(5.5f, 1.0f, 3.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.5f, 0.0f, -1.5f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.1, 0.5, 1, 1);
-	SetShaderTexture("floor");
-	SetShaderMaterial("cement");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-	/*******************************************************/
-	/***                  backDrop                  	***/
-	/*****************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 10.2f, 8.4f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 7.0f, -10.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2, 1, 1, 1);
-	SetShaderTexture("bDrop");
-	SetShaderMaterial("cement");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-	/*******************************************************/
-	/***                  poster                  	***/
-	/*****************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(5.0f, 6.2f, 0.2f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-10.0f, 6.0f, -10.00f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2, 1, 1, 1);
-	SetShaderTexture("poster");
-	//SetShaderMaterial("wood");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	
-	/*******************************************************************/
-	/***                  TableTop             	                	***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(8.0f, 0.4f, 3.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.5f, 2.5f, -2.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.5, 1, 1, 1);
-	SetShaderTexture("wood");
-	SetShaderMaterial("cement");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-
-	/*******************************************************/
-	/***                  LEG A                     	***/
-	/*****************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.5f, 2.5f, 2.4f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-3.0f, 1.0f, -2.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2, 1, 1, 1);
-	SetShaderTexture("plank");
-	SetShaderMaterial("wood");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-
-	/*******************************************************/
-	/***                  LEG  Detail              	***/
-	/*****************************************************/
-	// set the XYZ scale for the mesh
-	
-	
-		
-	for (int i = 0; i <= 1; i++) {
-		scaleXYZ = glm::vec3(0.5f, 0.5f, 0.8f);
-
-		// set the XYZ rotation for the mesh
-		XrotationDegrees = 0.0f;
-		YrotationDegrees = 90.0f;
-		ZrotationDegrees = 0.0f;
-		if (i == 0) {
-			// set the XYZ position for the mesh
-			positionXYZ = glm::vec3(-3.18f, 1.3f, -2.0f);
-		}
-		else {
-			positionXYZ = glm::vec3(4.18f, 1.3f, -2.0f);
-		}
-		// set the transformations into memory to be used on the drawn meshes
-		SetTransformations(
-			scaleXYZ,
-			XrotationDegrees,
-			YrotationDegrees,
-			ZrotationDegrees,
-			positionXYZ);
-
-		SetShaderColor(0.2, 1, 1, 1);
-		SetShaderTexture("screen");
-		SetShaderMaterial("glass");
-		// draw the mesh with transformation values
-		m_basicMeshes->DrawTorusMesh();
-	}
-	/*******************************************************/
-	/***                  LEG B                     	***/
-	/*****************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.5f, 2.9f, 2.4f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(4.0f, 1.0f, -2.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2, 1, 1, 1);
-	SetShaderTexture("plank");
-	SetShaderMaterial("wood");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/*******************************************************************/
-	/***************************BOOK Generator***************************/
-	/***************************   Eric L Foster ************************/
-	/*                        									       */
-	/*Creating one section of code at a time for each of the books 
-	 would result in over 150 lines of code; using a combination of a 
-	 for loop and ternary operators has reduced the lines of 
-	 code to under 30 lines */
-	/******************************************************************/
-	float yRot = 10.0f, 
-		  yPos = 2.8f,
-	      xPos = -2.5f,
-	      xScale = 0.7f,
-		  zScale = 0.9;
-	for (int i = 0; i <= 4; i++) {
-		
-		// set the XYZ scale for the mesh
-		scaleXYZ = glm::vec3(xScale, 0.1f, zScale);
-
-		// set the XYZ rotation for the mesh
-		XrotationDegrees = 0.0f;
-		YrotationDegrees = yRot;
-		ZrotationDegrees = 0.0f;
-
-		// set the XYZ position for the mesh
-		positionXYZ = glm::vec3(xPos, yPos, -1.2f);
-
-		// set the transformations into memory to be used on the drawn meshes
-		SetTransformations(
-			scaleXYZ,
-			XrotationDegrees,
-			YrotationDegrees,
-			ZrotationDegrees,
-			positionXYZ);
-
-		// Ternary Operators to set the appropriate Tex and Mat
-		(i  == 4) ? SetShaderTexture("Book5") : SetShaderTexture("Books");
-		(i % 2 == 0) ? SetShaderMaterial("wood"): SetShaderMaterial("clay");
-		// draw the mesh with transformation values
-		m_basicMeshes->DrawBoxMesh();
-		//Stack the books
-		yPos += 0.10;
-		//ternary operators to slightly offset and resize all books.
-		//            Even           Odd
-		(i % 2 == 0)? yRot   += 4.23 : yRot -= 1.03;
-		(i % 2 == 0)? xScale += 0.13 : xScale -= .15;
-		(i % 2 == 0)? zScale += 0.12 : zScale -= .10;
-			
-
-	}
-	
-	/*                    MONITOR COMPONETS                            */
-
-
-	/*******************************************************************/
-	/***                  Monitor Base                             	***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.8f, 0.1f, 0.5f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.5f, 2.7f, -2.2f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.5, 1, 1, 1);
-	SetShaderTexture("plastic");
-	SetShaderMaterial("glass");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-	/*******************************************************************/
-	/***                  Monitor ARM                             	***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.3f, 2.5f, 0.1f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.5f, 3.9f, -2.2f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.5, 1, 1, 1);
-	SetShaderTexture("plastic");
-	SetShaderMaterial("glass");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/*******************************************************************/
-	/***                  Monitor BRACKET                          	***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.7f, 0.7f, 0.09f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.5f, 5.0f, -2.09f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.5, 1, 1, 1);
-	SetShaderTexture("plastic");
-	SetShaderMaterial("wood");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/*******************************************************************/
-	/***                  Monitor                                	***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(4.0f, 2.5f, 0.20f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.5f, 5.0f, -2.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.5, 1, 1, 1);
-	SetShaderTexture("plastic");
-	SetShaderMaterial("cement");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/*******************************************************************/
-	/***                  Monitor  Screen                          	***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(3.8f, 2.3f, 0.08f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.5f, 5.0f, -1.9f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.5, 1, 1, 1);
-	SetShaderTexture("screen");
-	SetShaderMaterial("glass");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	
-	/********************************************End of Monitor Componets **************************/
-	/*******************************************************************/
-	/***                  KeyBoard	Drawer                         	***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(4.3f, 0.1f, 1.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 22.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.5f, 2.2f, -0.1f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.5, 1, 1, 1);
-	SetShaderTexture("wood");
-	SetShaderMaterial("wood");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/*******************************************************************/
-	/***                  KeyBoard	                            	***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(3.2f, 0.1f, 0.8f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 22.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.5f, 2.4f, -0.18f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.5, 1, 1, 1);
-	SetShaderTexture("KB1");
-	SetShaderMaterial("glass");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-	/*******************************************************************/
-	/***                  LightFixture                            	***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(1.0f, 0.5f, 0.7f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-10.0f, 10.5f, -9.5f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.5, 1, 1, 1);
-	SetShaderTexture("plastic");
-	SetShaderMaterial("glass");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-}
-
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.cpp
+// ============
+// manage the loading and rendering of 3D scenes
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneManager.h"
+#include "GLStateCache.h"
+#include "MeshCache.h"
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	const char* g_ModelName = "model";
+	const char* g_ColorValueName = "objectColor";
+	const char* g_TextureValueName = "objectTexture";
+	const char* g_UseTextureName = "bUseTexture";
+	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UseInstancingName = "bUseInstancing";
+	const char* g_PackedVerticesName = "bPackedVertices";
+	const char* g_MeshBoxesName = "meshBoxes";
+	const char* g_MaterialIndexName = "materialIndex";
+	const char* g_UVScaleName = "UVscale";
+	const char* g_TextureLayerName = "textureLayer";
+	const char* g_CameraBlockName = "CameraBlock";
+	const char* g_LightBlockName = "LightBlock";
+	const char* g_MaterialBlockName = "MaterialBlock";
+
+	// limits for merging static objects, which keep the baked
+	// vertex data of the batches under 64MB
+	const uint32_t g_MaxStaticBatches = 64;
+	const uint32_t g_MaxStaticBatchVertices = 32768;
+
+	// below this many objects testing every box is faster than
+	// walking the hierarchy
+	const uint32_t g_MinBVHObjects = 1024;
+
+	// objects of the desk scene that hide most of what is behind
+	// them, drawn into the occlusion depth buffer - only boxes
+	// and planes fill their bounds, so other meshes are skipped
+	const char* g_OccluderNames[] = { "backdrop", "tableTop", "body" };
+
+	// model matrix of the batches, which are in world space
+	const glm::mat4 g_IdentityMatrix(1.0f);
+
+	// texture arrays, one per texture size - each is bound to
+	// its own texture unit
+	const uint32_t g_MaxTextureArrays = 16;
+
+	// default scene description loaded by PrepareScene()
+	const char* g_DefaultSceneFilename = "Scenes/DeskScene.txt";
+	// generated meshes kept between launches
+	const char* g_MeshCacheFilename = "MeshCache.bin";
+
+	// seconds between the render counter reports
+	const double g_RenderReportSeconds = 5.0;
+
+	/***********************************************************
+	 *  GetSeconds()
+	 *
+	 *  Returns a monotonic time in seconds.
+	 ***********************************************************/
+	double GetSeconds()
+	{
+		return(std::chrono::duration<double>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+}
+
+/***********************************************************
+ *  SceneManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneManager::SceneManager(ShaderManager *pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_pShaderUniforms = new ShaderUniforms();
+	m_uniforms = SCENE_UNIFORMS();
+	ResolveShaderUniforms();
+	m_basicMeshes = new ShapeMeshes();
+	m_pInstancedMeshes = new InstancedMeshes();
+	m_bUseInstancing = true;
+	m_pStaticBatcher = new StaticBatcher();
+	m_bStaticBatching = true;
+	m_pFrustumCuller = new FrustumCuller();
+	m_bFrustumCulling = true;
+	m_culledObjects = 0;
+	m_culledBatchedObjects = 0;
+	m_pSceneBVH = new SceneBVH();
+	m_pMeshGenerator = new MeshGenerator();
+	m_bMeshCache = true;
+	m_pMeshLOD = new MeshLOD();
+	m_bLevelOfDetail = true;
+	m_pOcclusionCuller = new OcclusionCuller();
+	m_bOcclusionCulling = true;
+	m_occludedObjects = 0;
+	m_occludedDraws = 0;
+	// the generated shapes match the ShapeMeshes primitives
+	MESH_DATA shapeMesh;
+	MeshGeometry::GeneratePlane(shapeMesh);
+	MeshGeometry::ComputeBounds(shapeMesh, m_shapeBounds[SCENE_MESH_PLANE]);
+	MeshGeometry::GenerateBox(shapeMesh);
+	MeshGeometry::ComputeBounds(shapeMesh, m_shapeBounds[SCENE_MESH_BOX]);
+	MeshGeometry::GenerateCylinder(shapeMesh);
+	MeshGeometry::ComputeBounds(shapeMesh, m_shapeBounds[SCENE_MESH_CYLINDER]);
+	MeshGeometry::GenerateTorus(shapeMesh);
+	MeshGeometry::ComputeBounds(shapeMesh, m_shapeBounds[SCENE_MESH_TORUS]);
+	m_pLightBuffer = new UniformBuffer(UNIFORM_BINDING_LIGHTS);
+	m_pMaterialBuffer = new UniformBuffer(UNIFORM_BINDING_MATERIALS);
+	m_lightBlock = LIGHT_BLOCK();
+	m_pSceneFile = new SceneFile();
+	m_pSceneGraph = new SceneGraph();
+	m_pRenderQueue = new RenderQueue();
+	m_bSortRenderQueue = true;
+	m_loadedTextures = 0;
+	m_pTextureArrays = new TextureArrays();
+	m_pTextureCache = new TextureCache();
+	m_pTextureLoader = NULL;
+	m_textureLoadStartTime = 0.0;
+	m_pTextureResidency = new TextureResidency();
+	m_viewPosition = glm::vec3(0.0f);
+	m_view = glm::mat4(1.0f);
+	m_projection = glm::mat4(1.0f);
+	m_viewportHeight = 0;
+	m_renderStats = RENDER_STATS();
+	m_reportStats = RENDER_STATS();
+	m_reportFrames = 0;
+	m_reportStartTime = GetSeconds();
+	SetSceneFile(g_DefaultSceneFilename);
+}
+
+/***********************************************************
+ *  ~SceneManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneManager::~SceneManager()
+{
+	m_pShaderManager = NULL;
+	delete m_pShaderUniforms;
+	m_pShaderUniforms = NULL;
+	delete m_basicMeshes;
+	m_basicMeshes = NULL;
+	delete m_pInstancedMeshes;
+	m_pInstancedMeshes = NULL;
+	delete m_pStaticBatcher;
+	m_pStaticBatcher = NULL;
+	delete m_pFrustumCuller;
+	m_pFrustumCuller = NULL;
+	delete m_pSceneBVH;
+	m_pSceneBVH = NULL;
+	delete m_pMeshGenerator;
+	m_pMeshGenerator = NULL;
+	delete m_pMeshLOD;
+	m_pMeshLOD = NULL;
+	delete m_pOcclusionCuller;
+	m_pOcclusionCuller = NULL;
+	// the workers have to stop before the arrays go away
+	delete m_pTextureLoader;
+	m_pTextureLoader = NULL;
+	delete m_pTextureArrays;
+	m_pTextureArrays = NULL;
+	delete m_pTextureCache;
+	m_pTextureCache = NULL;
+	delete m_pTextureResidency;
+	m_pTextureResidency = NULL;
+	delete m_pLightBuffer;
+	m_pLightBuffer = NULL;
+	delete m_pMaterialBuffer;
+	m_pMaterialBuffer = NULL;
+	delete m_pSceneFile;
+	m_pSceneFile = NULL;
+	delete m_pSceneGraph;
+	m_pSceneGraph = NULL;
+	delete m_pRenderQueue;
+	m_pRenderQueue = NULL;
+}
+
+/***********************************************************
+ *  ResolveShaderUniforms()
+ *
+ *  This method is used for resolving the locations of the
+ *  uniforms set on every draw, and assigning the uniform
+ *  blocks and the fixed sampler units.  The shader program
+ *  has to be linked and in use when the scene manager is
+ *  created.
+ ***********************************************************/
+void SceneManager::ResolveShaderUniforms()
+{
+	m_pShaderUniforms->SetCurrentProgram();
+	// the shader manager made the program current without the
+	// state cache knowing about it
+	GLStateCache::UseProgram(m_pShaderUniforms->GetProgram());
+
+	// the shaders declare no binding points of their own
+	GLuint program = m_pShaderUniforms->GetProgram();
+	UniformBuffer::BindBlock(program, g_CameraBlockName, UNIFORM_BINDING_CAMERA);
+	UniformBuffer::BindBlock(program, g_LightBlockName, UNIFORM_BINDING_LIGHTS);
+	UniformBuffer::BindBlock(program, g_MaterialBlockName, UNIFORM_BINDING_MATERIALS);
+
+	m_uniforms.model = m_pShaderUniforms->Find<glm::mat4>(g_ModelName);
+	m_uniforms.objectColor = m_pShaderUniforms->Find<glm::vec4>(g_ColorValueName);
+	m_uniforms.objectTexture = m_pShaderUniforms->Find<int>(g_TextureValueName);
+	m_uniforms.textureLayer = m_pShaderUniforms->Find<int>(g_TextureLayerName);
+	m_uniforms.bUseTexture = m_pShaderUniforms->Find<bool>(g_UseTextureName);
+	m_uniforms.bUseLighting = m_pShaderUniforms->Find<bool>(g_UseLightingName);
+	m_uniforms.bUseInstancing = m_pShaderUniforms->Find<bool>(g_UseInstancingName);
+	m_uniforms.bPackedVertices = m_pShaderUniforms->Find<bool>(g_PackedVerticesName);
+	m_uniforms.meshBoxes = m_pShaderUniforms->Find<int>(g_MeshBoxesName);
+
+	// samplers of different types may not share a unit, so the
+	// mesh boxes keep theirs even when nothing is packed
+	ShaderUniforms::Set(m_uniforms.meshBoxes, (int)InstancedMeshes::GetMeshBoxUnit());
+	m_uniforms.materialIndex = m_pShaderUniforms->Find<int>(g_MaterialIndexName);
+	m_uniforms.UVscale = m_pShaderUniforms->Find<glm::vec2>(g_UVScaleName);
+}
+
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for adding a texture from an image
+ *  file.  Only the image header is read here, the image is
+ *  decoded in the background once BindGLTextures() has laid
+ *  out the texture arrays.  An image that is already loaded,
+ *  by path or by contents, is not added again - the tag is
+ *  made an alias of the existing texture.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, TAG_KEY tag)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	if (m_textureTags.Find(tag) != TAG_ID_NONE)
+	{
+		std::cout << "Texture tag already loaded:" << tag.text << std::endl;
+		return false;
+	}
+
+	// register the texture and associate it with the special tag string
+	TEXTURE_INFO textureInfo;
+	textureInfo.ID = 0;
+	textureInfo.tag = tag.text;
+	textureInfo.filename = filename;
+
+	// the same file under another tag
+	std::string canonicalPath = TextureCache::CanonicalPath(filename);
+	int texture = m_pTextureCache->FindPath(canonicalPath);
+
+	// the same image in another file, the hash is kept for
+	// remembering a new texture
+	std::vector<unsigned char> contents;
+	uint64_t contentHash = 0;
+	if ((texture < 0) && TextureCache::ReadFile(filename, contents))
+	{
+		contentHash = TextureCache::HashContents(contents);
+		texture = m_pTextureCache->FindContents(contentHash, contents);
+	}
+
+	if (texture >= 0)
+	{
+		std::cout << "Reusing image:" << filename << " for tag " << tag.text << std::endl;
+
+		m_pTextureCache->AddAlias((uint32_t)texture, canonicalPath);
+		textureInfo.texture = (uint32_t)texture;
+		m_textureIDs.push_back(textureInfo);
+		m_textureTags.Intern(tag);
+		m_loadedTextures++;
+
+		return true;
+	}
+
+	// try to read the size of the image from the file contents
+	if (!contents.empty() &&
+		stbi_info_from_memory(contents.data(), (int)contents.size(), &width, &height, &colorChannels))
+	{
+		std::cout << "Queued image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+
+		// the texture index is the layer of the texture arrays
+		textureInfo.texture = m_pTextureArrays->AddTexture(width, height);
+		m_pTextureCache->AddTexture(
+			textureInfo.texture,
+			canonicalPath,
+			contentHash,
+			contents.size(),
+			filename);
+
+		m_textureIDs.push_back(textureInfo);
+		m_textureTags.Intern(tag);
+		m_loadedTextures++;
+
+		return true;
+	}
+
+	std::cout << "Could not load image:" << filename << std::endl;
+
+	// Error loading the image
+	return false;
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the texture arrays to
+ *  OpenGL texture memory slots, one slot per array.  The
+ *  first time, the arrays are laid out for the added
+ *  textures and the images start decoding on the worker
+ *  threads.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	if ((m_pTextureArrays->GetArrayCount() == 0) && (m_loadedTextures > 0))
+	{
+		m_pTextureArrays->Build(g_MaxTextureArrays);
+		StartTextureLoads(std::vector<uint32_t>());
+		ReportTextureCache();
+	}
+
+	m_pTextureArrays->Bind();
+}
+
+/***********************************************************
+ *  StartTextureLoads()
+ *
+ *  This method is used for decoding the textures of the
+ *  given arrays on the worker threads, at the resident size
+ *  of their layers.  The texture IDs follow the arrays,
+ *  which are created again when their levels change.
+ ***********************************************************/
+void SceneManager::StartTextureLoads(const std::vector<uint32_t>& arrays)
+{
+	delete m_pTextureLoader;
+	m_pTextureLoader = new TextureLoader();
+	for (uint32_t texture = 0; texture < m_pTextureArrays->GetTextureCount(); texture++)
+	{
+		uint32_t arrayIndex = (uint32_t)m_pTextureArrays->GetLayer(texture).arrayIndex;
+		if ((arrays.empty() == false) &&
+			(std::find(arrays.begin(), arrays.end(), arrayIndex) == arrays.end()))
+			continue;
+
+		int width = 0;
+		int height = 0;
+		m_pTextureArrays->GetLayerSize(texture, width, height);
+		m_pTextureLoader->AddJob(texture, m_pTextureCache->GetFilename(texture), width, height);
+	}
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		m_textureIDs[i].ID = m_pTextureArrays->GetArrayID(GetTextureLayer(i).arrayIndex);
+	}
+
+	m_textureLoadStartTime = GetSeconds();
+	m_pTextureLoader->Start();
+}
+
+/***********************************************************
+ *  UpdateTextureUploads()
+ *
+ *  This method is used for uploading the images that the
+ *  worker threads decoded since the last frame into their
+ *  texture array layers.
+ ***********************************************************/
+void SceneManager::UpdateTextureUploads()
+{
+	if (NULL == m_pTextureLoader)
+	{
+		return;
+	}
+
+	DECODED_TEXTURE* pDecoded = m_pTextureLoader->TakeDecoded();
+	if (NULL == pDecoded)
+	{
+		return;
+	}
+
+	for (DECODED_TEXTURE* pImage = pDecoded; pImage != NULL; pImage = pImage->pNext)
+	{
+		if (TextureLoader::UploadDecoded(pImage, *m_pTextureArrays) == false)
+		{
+			std::cout << "Could not load image:" << m_pTextureCache->GetFilename(pImage->texture) << std::endl;
+			continue;
+		}
+
+		std::cout << "Successfully loaded image:" << m_pTextureCache->GetFilename(pImage->texture)
+			<< ((pImage->pCooked != NULL) ? " (cooked)" : "") << std::endl;
+	}
+	TextureLoader::FreeDecoded(pDecoded);
+	m_pTextureArrays->FinishUploads();
+
+	if (m_pTextureLoader->IsFinished())
+	{
+		std::cout << "INFO: " << m_pTextureLoader->GetJobCount() << " textures loaded in "
+			<< (GetSeconds() - m_textureLoadStartTime) * 1000.0 << " ms" << std::endl;
+		delete m_pTextureLoader;
+		m_pTextureLoader = NULL;
+	}
+}
+
+/***********************************************************
+ *  UpdateTextureResidency()
+ *
+ *  This method is used for measuring the on screen size of
+ *  every textured object and letting the residency choose
+ *  the mip levels of the arrays.  The size is the diameter
+ *  of the bounding sphere of the object in pixels.  Arrays
+ *  that lose levels keep what they have, arrays that gain
+ *  levels have their images decoded again.  Nothing changes
+ *  while images are still being decoded.
+ ***********************************************************/
+void SceneManager::UpdateTextureResidency()
+{
+	if ((m_pTextureResidency->GetBudget() == 0) || (NULL != m_pTextureLoader) ||
+		(m_pTextureArrays->GetArrayCount() == 0) || (NULL == m_pSceneFile))
+	{
+		return;
+	}
+
+	// pixels covered by one unit at unit distance, an
+	// orthographic projection has the same size at any distance
+	float pixelsPerUnit = m_projection[1][1] * m_viewportHeight * 0.5f;
+	bool bOrthographic = (m_projection[3][3] == 1.0f);
+
+	m_pTextureResidency->BeginFrame(m_pTextureArrays->GetArrayCount());
+	const SCENE_RECORD* pRecords = m_pSceneFile->GetRecords();
+	uint32_t objectCount = m_pSceneFile->GetRecordCount();
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		int textureSlot = m_objectTextureSlots[i];
+		if ((textureSlot < 0) || (textureSlot >= m_loadedTextures) || (pRecords[i].meshType >= SCENE_MESH_COUNT))
+			continue;
+
+		const glm::mat4& world = m_pSceneGraph->GetWorldMatrix(i);
+		float scale = std::max(glm::length(glm::vec3(world[0])),
+			std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+		float screenPixels = 2.0f * m_shapeBounds[pRecords[i].meshType].radius * scale * pixelsPerUnit;
+		if (bOrthographic == false)
+		{
+			// in front of the near plane the object fills the view
+			float distance = -(m_view * world[3]).z;
+			screenPixels = (distance > 0.1f) ? (screenPixels / distance) : (float)m_viewportHeight;
+		}
+
+		m_pTextureResidency->AddCoverage((uint32_t)GetTextureLayer(textureSlot).arrayIndex, screenPixels);
+	}
+
+	std::vector<uint32_t> reloadArrays;
+	m_pTextureResidency->Update(*m_pTextureArrays, reloadArrays);
+	if (reloadArrays.empty() == false)
+	{
+		StartTextureLoads(reloadArrays);
+	}
+	else
+	{
+		// arrays whose levels were copied were still created again
+		for (int i = 0; i < m_loadedTextures; i++)
+		{
+			m_textureIDs[i].ID = m_pTextureArrays->GetArrayID(GetTextureLayer(i).arrayIndex);
+		}
+	}
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	delete m_pTextureLoader;
+	m_pTextureLoader = NULL;
+	m_pTextureArrays->Destroy();
+	m_pTextureCache->Clear();
+	m_textureIDs.clear();
+	m_textureTags.Clear();
+	m_loadedTextures = 0;
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureID(TAG_KEY tag)
+{
+	int textureSlot = FindTextureSlot(tag);
+	if (textureSlot < 0)
+	{
+		return(-1);
+	}
+
+	return(m_textureIDs[textureSlot].ID);
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(TAG_KEY tag)
+{
+	TAG_ID tagID = m_textureTags.Find(tag);
+	if (tagID == TAG_ID_NONE)
+	{
+		return(-1);
+	}
+
+	return((int)tagID);
+}
+
+/***********************************************************
+ *  GetTextureArray()
+ *
+ *  This method is used for getting the texture array that
+ *  holds a loaded texture, or -1 when there is no texture or
+ *  it has not been decoded yet.
+ ***********************************************************/
+int SceneManager::GetTextureArray(int textureSlot) const
+{
+	if ((textureSlot < 0) || (textureSlot >= m_loadedTextures))
+	{
+		return(-1);
+	}
+
+	// drawn with the object color until the texture arrives
+	if (m_pTextureArrays->IsLoaded(m_textureIDs[textureSlot].texture) == false)
+	{
+		return(-1);
+	}
+
+	return(GetTextureLayer(textureSlot).arrayIndex);
+}
+
+/***********************************************************
+ *  GetTextureLayer()
+ *
+ *  This method is used for getting the texture array layer
+ *  of a loaded texture.  Aliased tags share a layer.
+ ***********************************************************/
+const TEXTURE_LAYER& SceneManager::GetTextureLayer(int textureSlot) const
+{
+	return(m_pTextureArrays->GetLayer(m_textureIDs[textureSlot].texture));
+}
+
+/***********************************************************
+ *  ReportTextureCache()
+ *
+ *  This method is used for printing how many texture loads
+ *  the texture cache answered and the GPU memory this saved,
+ *  counting the RGBA layer and its mipmaps.
+ ***********************************************************/
+void SceneManager::ReportTextureCache() const
+{
+	uint64_t savedBytes = 0;
+	for (uint32_t texture = 0; texture < m_pTextureCache->GetTextureCount(); texture++)
+	{
+		int width = 0;
+		int height = 0;
+		m_pTextureArrays->GetLayerSize(texture, width, height);
+
+		uint64_t layerBytes = (uint64_t)width * height * 4;
+		savedBytes += m_pTextureCache->GetAliasCount(texture) * (layerBytes + layerBytes / 3);
+	}
+
+	std::cout << "INFO: texture cache: " << m_pTextureCache->GetRequestCount() << " requests, "
+		<< m_pTextureCache->GetTextureCount() << " textures, "
+		<< savedBytes << " bytes of GPU memory saved" << std::endl;
+}
+
+/***********************************************************
+ *  AddObjectMaterial()
+ *
+ *  This method is used for adding a material to the defined
+ *  materials list.  Its index becomes the ID of its tag, so
+ *  a material with an already defined tag is not added.
+ ***********************************************************/
+bool SceneManager::AddObjectMaterial(const OBJECT_MATERIAL& material)
+{
+	if (m_materialTags.Find(material.tag.c_str()) != TAG_ID_NONE)
+	{
+		std::cout << "Material tag already defined:" << material.tag << std::endl;
+		return(false);
+	}
+
+	m_materialTags.Intern(material.tag.c_str());
+	m_objectMaterials.push_back(material);
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in tag.
+ ***********************************************************/
+const SceneManager::OBJECT_MATERIAL* SceneManager::FindMaterial(TAG_KEY tag) const
+{
+	int materialIndex = FindMaterialIndex(tag);
+	if (materialIndex < 0)
+	{
+		return(NULL);
+	}
+
+	return(&m_objectMaterials[materialIndex]);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of a material
+ *  in the defined materials list, or -1 when the tag is not
+ *  defined.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(TAG_KEY tag) const
+{
+	TAG_ID tagID = m_materialTags.Find(tag);
+	if (tagID == TAG_ID_NONE)
+	{
+		return(-1);
+	}
+
+	return((int)tagID);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// variables for this method
+	glm::mat4 modelView;
+	glm::mat4 scale;
+	glm::mat4 rotationX;
+	glm::mat4 rotationY;
+	glm::mat4 rotationZ;
+	glm::mat4 translation;
+
+	// set the scale value in the transform buffer
+	scale = glm::scale(scaleXYZ);
+	// set the rotation values in the transform buffer
+	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
+	// set the translation value in the transform buffer
+	translation = glm::translate(positionXYZ);
+
+	modelView = translation * rotationX * rotationY * rotationZ * scale;
+
+	if (NULL != m_pShaderManager)
+	{
+		ShaderUniforms::Set(m_uniforms.model, modelView);
+		UniformBuffer::AddBytesUploaded(sizeof(glm::mat4));
+	}
+}
+
+/***********************************************************
+ *  SetModelMatrix()
+ *
+ *  This method is used for setting an already composed
+ *  model matrix into the transform buffer.
+ ***********************************************************/
+void SceneManager::SetModelMatrix(const glm::mat4& modelMatrix)
+{
+	if (NULL != m_pShaderManager)
+	{
+		ShaderUniforms::Set(m_uniforms.model, modelMatrix);
+		UniformBuffer::AddBytesUploaded(sizeof(glm::mat4));
+	}
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	if (NULL != m_pShaderManager)
+	{
+		ShaderUniforms::Set(m_uniforms.bUseTexture, false);
+		ShaderUniforms::Set(m_uniforms.objectColor, currentColor);
+		UniformBuffer::AddBytesUploaded(sizeof(int) + sizeof(glm::vec4));
+	}
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in ID into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	TAG_KEY textureTag)
+{
+	SetShaderTextureSlot(FindTextureSlot(textureTag));
+}
+
+/***********************************************************
+ *  SetShaderTextureSlot()
+ *
+ *  This method is used for setting the texture bound to the
+ *  passed in slot into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTextureSlot(
+	int textureSlot)
+{
+	if (GetTextureArray(textureSlot) < 0)
+	{
+		return;
+	}
+
+	if (NULL != m_pShaderManager)
+	{
+		const TEXTURE_LAYER& layer = GetTextureLayer(textureSlot);
+		ShaderUniforms::Set(m_uniforms.bUseTexture, true);
+		ShaderUniforms::Set(m_uniforms.objectTexture, layer.arrayIndex);
+		ShaderUniforms::Set(m_uniforms.textureLayer, layer.layer);
+		UniformBuffer::AddBytesUploaded(sizeof(int) * 3);
+	}
+}
+
+/***********************************************************
+ *  SetShaderTextureArray()
+ *
+ *  This method is used for setting a texture array into the
+ *  shader for instanced draws, which read the layer of each
+ *  instance from the instance data.
+ ***********************************************************/
+void SceneManager::SetShaderTextureArray(
+	int textureArray)
+{
+	if (NULL != m_pShaderManager)
+	{
+		ShaderUniforms::Set(m_uniforms.bUseTexture, true);
+		ShaderUniforms::Set(m_uniforms.objectTexture, textureArray);
+		UniformBuffer::AddBytesUploaded(sizeof(int) * 2);
+	}
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	if (NULL != m_pShaderManager)
+	{
+		ShaderUniforms::Set(m_uniforms.UVscale, glm::vec2(u, v));
+		UniformBuffer::AddBytesUploaded(sizeof(glm::vec2));
+	}
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values
+ *  into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	TAG_KEY materialTag)
+{
+	int materialIndex = FindMaterialIndex(materialTag);
+	if (materialIndex >= 0)
+	{
+		SetShaderMaterialIndex(materialIndex);
+	}
+}
+
+/***********************************************************
+ *  SetShaderMaterialIndex()
+ *
+ *  This method is used for selecting a material from the
+ *  material uniform block.  Only the index is sent per draw,
+ *  the material values were uploaded with the block.
+ ***********************************************************/
+void SceneManager::SetShaderMaterialIndex(
+	int materialIndex)
+{
+	if (NULL != m_pShaderManager)
+	{
+		ShaderUniforms::Set(m_uniforms.materialIndex, materialIndex);
+		UniformBuffer::AddBytesUploaded(sizeof(int));
+	}
+}
+
+/***********************************************************
+ *  UploadMaterialBlock()
+ *
+ *  This method is used for copying all of the defined
+ *  materials into the material uniform block, so that draws
+ *  only have to select one by its index.
+ ***********************************************************/
+void SceneManager::UploadMaterialBlock()
+{
+	if (m_objectMaterials.size() > UNIFORM_MAX_MATERIALS)
+	{
+		std::cout << "INFO: only the first " << UNIFORM_MAX_MATERIALS << " of "
+			<< m_objectMaterials.size() << " materials fit in the material block" << std::endl;
+	}
+
+	MATERIAL_BLOCK materialBlock = MATERIAL_BLOCK();
+	for (size_t i = 0; (i < m_objectMaterials.size()) && (i < UNIFORM_MAX_MATERIALS); i++)
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[i];
+		MATERIAL_DATA& data = materialBlock.materials[i];
+
+		data.ambientColor = glm::vec4(material.ambientColor, 1.0f);
+		data.diffuseColor = glm::vec4(material.diffuseColor, 1.0f);
+		data.specularColor = glm::vec4(material.specularColor, 1.0f);
+		data.ambientStrength = material.ambientStrength;
+		data.shininess = material.shininess;
+	}
+
+	m_pMaterialBuffer->Upload(&materialBlock, sizeof(materialBlock));
+}
+
+/***********************************************************
+ *  SetLightSource()
+ *
+ *  This method is used for setting the values of one light
+ *  source in the light uniform block.  The block is uploaded
+ *  with UploadLightBlock().
+ ***********************************************************/
+void SceneManager::SetLightSource(
+	int lightIndex,
+	glm::vec3 position,
+	glm::vec3 ambientColor,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float focalStrength,
+	float specularIntensity)
+{
+	if ((lightIndex < 0) || (lightIndex >= (int)UNIFORM_MAX_LIGHTS))
+	{
+		return;
+	}
+
+	LIGHT_SOURCE_DATA& light = m_lightBlock.lightSources[lightIndex];
+	light.position = glm::vec4(position, 1.0f);
+	light.ambientColor = glm::vec4(ambientColor, 1.0f);
+	light.diffuseColor = glm::vec4(diffuseColor, 1.0f);
+	light.specularColor = glm::vec4(specularColor, 1.0f);
+	light.focalStrength = focalStrength;
+	light.specularIntensity = specularIntensity;
+}
+
+/***********************************************************
+ *  UploadLightBlock()
+ *
+ *  This method is used for copying the light sources into
+ *  the light uniform block.
+ ***********************************************************/
+void SceneManager::UploadLightBlock()
+{
+	m_pLightBuffer->Upload(&m_lightBlock, sizeof(m_lightBlock));
+}
+
+/***********************************************************
+ *  DrawSceneMesh()
+ *
+ *  This method is used for drawing the basic mesh that is
+ *  associated with a scene object mesh type.  The basic
+ *  shape meshes bind their own vertex arrays.  ShapeMeshes
+ *  only has the float layout, so with packed vertices the
+ *  shapes are drawn from the shared buffers as well.
+ ***********************************************************/
+void SceneManager::DrawSceneMesh(uint32_t meshType)
+{
+	if (m_pInstancedMeshes->IsPackedVertices() == true)
+	{
+		m_pInstancedMeshes->DrawMesh(meshType);
+		return;
+	}
+
+	switch (meshType)
+	{
+	case SCENE_MESH_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		GLStateCache::InvalidateVertexArray();
+		break;
+	case SCENE_MESH_BOX:
+		m_basicMeshes->DrawBoxMesh();
+		GLStateCache::InvalidateVertexArray();
+		break;
+	case SCENE_MESH_CYLINDER:
+		m_basicMeshes->DrawCylinderMesh();
+		GLStateCache::InvalidateVertexArray();
+		break;
+	case SCENE_MESH_TORUS:
+		m_basicMeshes->DrawTorusMesh();
+		GLStateCache::InvalidateVertexArray();
+		break;
+	default:
+		// merged static batches
+		m_pInstancedMeshes->DrawMesh(meshType);
+		break;
+	}
+}
+
+/***********************************************************
+ *  SetSceneFile()
+ *
+ *  This method is used for selecting the text scene file
+ *  that PrepareScene() loads.  The compiled binary twin is
+ *  kept next to it with a .bin extension.
+ ***********************************************************/
+void SceneManager::SetSceneFile(const char* textFilename)
+{
+	m_sceneTextFilename = textFilename;
+
+	size_t extension = m_sceneTextFilename.find_last_of('.');
+	m_sceneBinaryFilename = m_sceneTextFilename.substr(0, extension) + ".bin";
+}
+
+/***********************************************************
+ *  SetViewPosition()
+ *
+ *  This method is used for setting the camera position that
+ *  the render queue uses for ordering the draws by depth.
+ ***********************************************************/
+void SceneManager::SetViewPosition(const glm::vec3& viewPosition)
+{
+	m_viewPosition = viewPosition;
+}
+
+/***********************************************************
+ *  SetViewProjection()
+ *
+ *  This method is used for setting the camera matrices and
+ *  the viewport height, which give the on screen size of the
+ *  objects for choosing the resident texture levels.
+ ***********************************************************/
+void SceneManager::SetViewProjection(const glm::mat4& view, const glm::mat4& projection, int viewportHeight)
+{
+	m_view = view;
+	m_projection = projection;
+	m_viewportHeight = viewportHeight;
+}
+
+/***********************************************************
+ *  SetTextureBudget()
+ *
+ *  This method is used for limiting the memory the texture
+ *  arrays may use.  Without a budget every mip level stays
+ *  resident.
+ ***********************************************************/
+void SceneManager::SetTextureBudget(uint64_t budgetBytes)
+{
+	m_pTextureResidency->SetBudget(budgetBytes);
+}
+
+/***********************************************************
+ *  AddSceneTexture()
+ *
+ *  This method is used for adding a texture besides the desk
+ *  scene textures.  It has to be called before PrepareScene()
+ *  lays out the texture arrays, and the texture is decoded
+ *  in the background with the others.
+ ***********************************************************/
+bool SceneManager::AddSceneTexture(const char* filename, const char* tag)
+{
+	if (m_pTextureArrays->GetArrayCount() > 0)
+	{
+		std::cout << "Texture arrays already built, could not add image:" << filename << std::endl;
+		return false;
+	}
+
+	return(CreateGLTexture(filename, tag));
+}
+
+/***********************************************************
+ *  SetRenderQueueSorting()
+ *
+ *  This method is used for enabling or disabling sorting of
+ *  the render queue.  Without sorting the objects are drawn
+ *  in scene file order, which is useful for comparing the
+ *  number of state changes.
+ ***********************************************************/
+void SceneManager::SetRenderQueueSorting(bool bSort)
+{
+	m_bSortRenderQueue = bSort;
+}
+
+/***********************************************************
+ *  SetInstancing()
+ *
+ *  This method is used for enabling or disabling the
+ *  instanced drawing of the render queue.  Without it every
+ *  object is drawn with its own draw call.
+ ***********************************************************/
+void SceneManager::SetInstancing(bool bInstancing)
+{
+	m_bUseInstancing = bInstancing;
+}
+
+/***********************************************************
+ *  SetStaticBatching()
+ *
+ *  This method is used for enabling or disabling the merging
+ *  of static objects into batches.  It has to be called
+ *  before PrepareScene() to have an effect.
+ ***********************************************************/
+void SceneManager::SetStaticBatching(bool bBatching)
+{
+	m_bStaticBatching = bBatching;
+}
+
+/***********************************************************
+ *  SetFrustumCulling()
+ *
+ *  This method is used for enabling or disabling skipping
+ *  the objects that are outside of the view frustum.
+ ***********************************************************/
+void SceneManager::SetFrustumCulling(bool bCulling)
+{
+	m_bFrustumCulling = bCulling;
+}
+
+/***********************************************************
+ *  SetOcclusionCulling()
+ *
+ *  This method is used for enabling or disabling the test
+ *  of the objects inside the view against the occluders.
+ ***********************************************************/
+void SceneManager::SetOcclusionCulling(bool bCulling)
+{
+	m_bOcclusionCulling = bCulling;
+}
+
+/***********************************************************
+ *  SetLevelOfDetail()
+ *
+ *  This method is used for enabling or disabling the
+ *  coarser tessellations of the curved objects that are
+ *  small on the screen.
+ ***********************************************************/
+void SceneManager::SetLevelOfDetail(bool bLevelOfDetail)
+{
+	m_bLevelOfDetail = bLevelOfDetail;
+}
+
+/***********************************************************
+ *  SetPackedVertices()
+ *
+ *  This method is used for storing the meshes with packed
+ *  vertices and, where they fit, 16-bit indices.  It has to
+ *  be called before PrepareScene() to have an effect.
+ ***********************************************************/
+void SceneManager::SetPackedVertices(bool bPacked)
+{
+	m_pInstancedMeshes->SetPackedVertices(bPacked);
+}
+
+/***********************************************************
+ *  SetMeshOptimization()
+ *
+ *  This method is used for enabling or disabling reordering
+ *  the generated meshes for the vertex cache, overdraw and
+ *  fetching.  It has to be called before PrepareScene() to
+ *  have an effect.
+ ***********************************************************/
+void SceneManager::SetMeshOptimization(bool bOptimize)
+{
+	m_pMeshGenerator->SetOptimizeMeshes(bOptimize);
+}
+
+/***********************************************************
+ *  SetMeshCache()
+ *
+ *  This method is used for enabling or disabling loading
+ *  the generated meshes from the mesh cache file and
+ *  writing it.  It has to be called before PrepareScene()
+ *  to have an effect.
+ ***********************************************************/
+void SceneManager::SetMeshCache(bool bMeshCache)
+{
+	m_bMeshCache = bMeshCache;
+}
+
+/***********************************************************
+ *  BuildStaticBatches()
+ *
+ *  This method is used for merging the opaque scene objects
+ *  that share a texture, material and color into one world
+ *  space mesh each.  Every batch mesh gets its own mesh type
+ *  so that it fits in the mesh field of the sort keys.
+ ***********************************************************/
+void SceneManager::BuildStaticBatches()
+{
+	const SCENE_RECORD* pObjects = m_pSceneFile->GetRecords();
+	uint32_t objectCount = m_pSceneFile->GetRecordCount();
+
+	uint32_t maxBatches = RENDER_KEY_UNUSED - m_pInstancedMeshes->GetMeshCount() + (uint32_t)m_batchMeshTypes.size();
+	if (maxBatches > g_MaxStaticBatches)
+	{
+		maxBatches = g_MaxStaticBatches;
+	}
+
+	m_pStaticBatcher->Build(
+		pObjects,
+		objectCount,
+		m_objectTextureSlots.data(),
+		m_objectMaterialIndices.data(),
+		maxBatches,
+		g_MaxStaticBatchVertices);
+
+	UpdateStaticBatches();
+
+	std::cout << "INFO: static batching merged " << m_pStaticBatcher->GetBatchedObjectCount()
+		<< " of " << objectCount << " objects into " << m_pStaticBatcher->GetBatchCount()
+		<< " batches" << std::endl;
+}
+
+/***********************************************************
+ *  UpdateStaticBatches()
+ *
+ *  This method is used for taking the objects that moved in
+ *  the last world matrix update out of their batches, and
+ *  for baking every changed batch again.
+ ***********************************************************/
+void SceneManager::UpdateStaticBatches()
+{
+	const SCENE_RECORD* pObjects = m_pSceneFile->GetRecords();
+
+	// a changed node moves every object in its subtree
+	const std::vector<uint32_t>& changedNodes = m_pSceneGraph->GetChangedNodes();
+	for (uint32_t changedNode : changedNodes)
+	{
+		uint32_t subtreeEnd = changedNode + m_pSceneGraph->GetSubtreeSize(changedNode);
+		for (uint32_t i = changedNode; i < subtreeEnd; i++)
+		{
+			m_pStaticBatcher->RemoveObject(i, pObjects[i].meshType);
+		}
+	}
+
+	const std::vector<uint32_t>& dirtyBatches = m_pStaticBatcher->GetDirtyBatches();
+	if (dirtyBatches.empty())
+	{
+		return;
+	}
+
+	// the batches are culled by their baked world space bounds,
+	// after the bounds of the objects
+	uint32_t objectCount = m_pSceneFile->GetRecordCount();
+	if (m_pFrustumCuller->GetCount() < objectCount + m_pStaticBatcher->GetBatchCount())
+	{
+		m_pFrustumCuller->Resize(objectCount + m_pStaticBatcher->GetBatchCount());
+	}
+
+	MESH_DATA batchMesh;
+	MESH_BOUNDS batchBounds;
+	for (uint32_t batch : dirtyBatches)
+	{
+		m_pStaticBatcher->BuildBatchMesh(batch, pObjects, m_pSceneGraph->GetWorldMatrices(), batchMesh);
+		MeshGeometry::ComputeBounds(batchMesh, batchBounds);
+		m_pFrustumCuller->SetWorldBounds(objectCount + batch, batchBounds);
+
+		if (batch < m_batchMeshTypes.size())
+		{
+			m_pInstancedMeshes->ReplaceMesh(m_batchMeshTypes[batch], batchMesh);
+		}
+		else
+		{
+			m_batchMeshTypes.push_back(m_pInstancedMeshes->AddMesh(batchMesh));
+		}
+	}
+	m_pStaticBatcher->ClearDirtyBatches();
+}
+
+/***********************************************************
+ *  UpdateCullingBounds()
+ *
+ *  This method is used for moving the world bounds of the
+ *  objects whose world matrices changed in the last update.
+ ***********************************************************/
+void SceneManager::UpdateCullingBounds()
+{
+	const SCENE_RECORD* pObjects = m_pSceneFile->GetRecords();
+
+	MESH_BOUNDS worldBounds;
+	const std::vector<uint32_t>& changedNodes = m_pSceneGraph->GetChangedNodes();
+	for (uint32_t changedNode : changedNodes)
+	{
+		uint32_t subtreeEnd = changedNode + m_pSceneGraph->GetSubtreeSize(changedNode);
+		for (uint32_t i = changedNode; i < subtreeEnd; i++)
+		{
+			if (pObjects[i].meshType >= SCENE_MESH_COUNT)
+				continue;
+
+			m_pFrustumCuller->SetBounds(i, m_shapeBounds[pObjects[i].meshType], m_pSceneGraph->GetWorldMatrix(i));
+			m_pFrustumCuller->GetWorldBounds(i, worldBounds);
+			m_pSceneBVH->UpdateItem(i, worldBounds);
+		}
+	}
+
+	m_pSceneBVH->Refit();
+}
+
+/***********************************************************
+ *  BuildSceneBVH()
+ *
+ *  This method is used for building the hierarchy over the
+ *  world bounds of every drawable object.  Batched objects
+ *  are in it one by one, so they can still be hit by rays
+ *  and culled with the objects around them.
+ ***********************************************************/
+void SceneManager::BuildSceneBVH()
+{
+	const SCENE_RECORD* pObjects = m_pSceneFile->GetRecords();
+	uint32_t objectCount = m_pSceneFile->GetRecordCount();
+
+	std::vector<BVH_ITEM> items;
+	items.reserve(objectCount);
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		if (pObjects[i].meshType >= SCENE_MESH_COUNT)
+			continue;
+
+		BVH_ITEM item;
+		item.id = i;
+		m_pFrustumCuller->GetWorldBounds(i, item.bounds);
+		items.push_back(item);
+	}
+
+	double startTime = GetSeconds();
+	m_pSceneBVH->Build(items);
+	std::cout << "INFO: Scene hierarchy built over " << m_pSceneBVH->GetItemCount()
+		<< " objects with " << m_pSceneBVH->GetNodeCount() << " nodes in "
+		<< (GetSeconds() - startTime) * 1000.0 << " ms" << std::endl;
+}
+
+/***********************************************************
+ *  CullSceneObjects()
+ *
+ *  This method is used for testing the bounds of the objects
+ *  and batches against the view frustum of the camera, and
+ *  then against the occluders.  Every object is drawn when
+ *  culling is off or the camera has not been set yet.
+ ***********************************************************/
+void SceneManager::CullSceneObjects()
+{
+	if ((m_bFrustumCulling == false) || (m_viewportHeight == 0))
+	{
+		m_pFrustumCuller->SetAllVisible();
+		return;
+	}
+
+	FRUSTUM frustum;
+	FrustumCuller::ExtractPlanes(m_projection * m_view, frustum);
+	if (m_pSceneBVH->GetItemCount() < g_MinBVHObjects)
+	{
+		m_pFrustumCuller->Cull(frustum);
+	}
+	else
+	{
+		// a batch is drawn when any of its objects is visible
+		m_pSceneBVH->CullFrustum(frustum, m_visibleObjects);
+		m_pFrustumCuller->SetNoneVisible();
+		uint32_t objectCount = m_pSceneFile->GetRecordCount();
+		for (uint32_t object : m_visibleObjects)
+		{
+			m_pFrustumCuller->SetVisible(object, true);
+			int batch = m_pStaticBatcher->GetObjectBatch(object);
+			if (batch >= 0)
+			{
+				m_pFrustumCuller->SetVisible(objectCount + (uint32_t)batch, true);
+			}
+		}
+	}
+
+	CullOccludedObjects();
+}
+
+/***********************************************************
+ *  LoadLodMeshes()
+ *
+ *  This method is used for adding the tessellation levels of
+ *  the basic shapes after the shapes themselves.  Every
+ *  level is requested first so the generator can build the
+ *  variants together on its worker threads.  The most
+ *  detailed level of every shape replaces the empty mesh of
+ *  the shape, so the shapes are optimized like the levels.
+ *  When the mesh cache holds the requested meshes they are
+ *  uploaded from the mapped file instead, otherwise the
+ *  generated meshes are written to it for the next launch.
+ ***********************************************************/
+void SceneManager::LoadLodMeshes()
+{
+	std::vector<uint32_t> levelMeshes[SCENE_MESH_COUNT];
+	for (uint32_t shape = 0; shape < SCENE_MESH_COUNT; shape++)
+	{
+		m_pMeshLOD->RequestLevels(shape, *m_pMeshGenerator, levelMeshes[shape]);
+	}
+
+	double startTime = GetSeconds();
+	MeshCache meshCache;
+	bool bCached = (m_bMeshCache == true) && meshCache.Open(g_MeshCacheFilename, *m_pMeshGenerator);
+	uint32_t generatedCount = 0;
+	if (bCached == false)
+	{
+		generatedCount = m_pMeshGenerator->GenerateMeshes();
+	}
+	double generateTime = GetSeconds() - startTime;
+
+	// cache misses of every uploaded triangle, before and after
+	double missesBefore = 0.0;
+	double missesAfter = 0.0;
+	uint32_t triangleCount = 0;
+	for (uint32_t shape = 0; shape < SCENE_MESH_COUNT; shape++)
+	{
+		for (uint32_t level = 0; level < levelMeshes[shape].size(); level++)
+		{
+			uint32_t handle = levelMeshes[shape][level];
+			const MESH_VERTEX* pVertices = NULL;
+			const uint32_t* pIndices = NULL;
+			uint32_t vertexCount = 0;
+			uint32_t indexCount = 0;
+			if (bCached == true)
+			{
+				pVertices = meshCache.GetVertices(handle, vertexCount);
+				pIndices = meshCache.GetIndices(handle, indexCount);
+			}
+			else
+			{
+				const MESH_DATA& mesh = m_pMeshGenerator->GetMesh(handle);
+				pVertices = mesh.vertices.data();
+				pIndices = mesh.indices.data();
+				vertexCount = (uint32_t)mesh.vertices.size();
+				indexCount = (uint32_t)mesh.indices.size();
+			}
+
+			uint32_t meshType = shape;
+			if (level == 0)
+			{
+				m_pInstancedMeshes->ReplaceMesh(shape, pVertices, vertexCount, pIndices, indexCount);
+			}
+			else
+			{
+				meshType = m_pInstancedMeshes->AddMesh(pVertices, vertexCount, pIndices, indexCount);
+			}
+
+			uint32_t meshTriangles = indexCount / 3;
+			m_pMeshLOD->SetLevelMesh(shape, level, meshType, meshTriangles);
+
+			const MESH_OPTIMIZE_STATS& stats = (bCached == true) ?
+				meshCache.GetOptimizeStats(handle) : m_pMeshGenerator->GetOptimizeStats(handle);
+			missesBefore += (double)stats.acmrBefore * meshTriangles;
+			missesAfter += (double)stats.acmrAfter * meshTriangles;
+			triangleCount += meshTriangles;
+		}
+	}
+
+	double uploadTime = GetSeconds() - startTime - generateTime;
+
+	if (bCached == true)
+	{
+		std::cout << "INFO: mapped mesh cache " << g_MeshCacheFilename << ", " << meshCache.GetMeshCount()
+			<< " meshes for " << m_pMeshGenerator->GetRequestCount() << " requests, "
+			<< meshCache.GetSize() << " bytes in " << generateTime * 1000.0 << " ms" << std::endl;
+	}
+	else
+	{
+		std::cout << "INFO: generated " << generatedCount << " meshes for "
+			<< m_pMeshGenerator->GetRequestCount() << " requests in " << generateTime * 1000.0
+			<< " ms on " << m_pMeshGenerator->GetThreadCount() << " threads" << std::endl;
+	}
+	std::cout << "INFO: mesh startup with a " << (bCached ? "warm" : "cold") << " cache: "
+		<< (generateTime + uploadTime) * 1000.0 << " ms, " << uploadTime * 1000.0 << " ms of it uploading" << std::endl;
+
+	// the cache is written after the timing, it is not part
+	// of the startup the next launch saves
+	if ((m_bMeshCache == true) && (bCached == false))
+	{
+		if (MeshCache::WriteCache(g_MeshCacheFilename, *m_pMeshGenerator) == true)
+		{
+			std::cout << "INFO: wrote mesh cache " << g_MeshCacheFilename << std::endl;
+		}
+	}
+
+	if (triangleCount > 0)
+	{
+		std::cout << "INFO: vertex cache ACMR " << missesBefore / triangleCount << " before, "
+			<< missesAfter / triangleCount << " after optimizing " << triangleCount
+			<< " triangles" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  SelectObjectLods()
+ *
+ *  This method is used for picking the tessellation of every
+ *  visible curved object from the size of its bounding
+ *  sphere on the screen.  Batched objects keep the baked
+ *  detailed shape.  In the orthographic view the size does
+ *  not depend on the distance.
+ ***********************************************************/
+void SceneManager::SelectObjectLods()
+{
+	if ((m_bLevelOfDetail == false) || (m_viewportHeight == 0))
+	{
+		std::fill(m_objectLodLevels.begin(), m_objectLodLevels.end(), (uint8_t)0);
+		return;
+	}
+
+	bool bOrthographic = (m_projection[3][3] == 1.0f);
+	const SCENE_RECORD* pObjects = m_pSceneFile->GetRecords();
+	uint32_t objectCount = m_pSceneFile->GetRecordCount();
+
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		uint32_t meshType = pObjects[i].meshType;
+		if ((meshType >= SCENE_MESH_COUNT) || (m_pMeshLOD->GetLevelCount(meshType) < 2) ||
+			(m_pStaticBatcher->IsBatched(i) == true) || (m_pFrustumCuller->IsVisible(i) == false))
+			continue;
+
+		// the sphere grows with the largest scale of the object
+		const glm::mat4& world = m_pSceneGraph->GetWorldMatrix(i);
+		const MESH_BOUNDS& bounds = m_shapeBounds[meshType];
+		glm::vec3 center = glm::vec3(world * glm::vec4(bounds.center[0], bounds.center[1], bounds.center[2], 1.0f));
+		float scale = std::max(glm::length(glm::vec3(world[0])),
+			std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+
+		float pixels = 0.0f;
+		if (bOrthographic)
+		{
+			// the diameter, as GetProjectedSize() measures it
+			pixels = bounds.radius * scale * m_projection[1][1] * (float)m_viewportHeight;
+		}
+		else
+		{
+			pixels = MeshLOD::GetProjectedSize(
+				bounds.radius * scale, glm::length(center - m_viewPosition), m_projection[1][1], m_viewportHeight);
+		}
+		m_objectLodLevels[i] = (uint8_t)m_pMeshLOD->SelectLevel(meshType, pixels, m_objectLodLevels[i]);
+	}
+}
+
+/***********************************************************
+ *  FindOccluders()
+ *
+ *  This method is used for flagging the box and plane
+ *  objects named as occluders.
+ ***********************************************************/
+void SceneManager::FindOccluders()
+{
+	const SCENE_RECORD* pObjects = m_pSceneFile->GetRecords();
+	uint32_t objectCount = m_pSceneFile->GetRecordCount();
+
+	m_occluderObjects.clear();
+	m_objectOccluders.assign(objectCount, 0);
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		if ((pObjects[i].meshType != SCENE_MESH_BOX) && (pObjects[i].meshType != SCENE_MESH_PLANE))
+			continue;
+
+		for (const char* occluderName : g_OccluderNames)
+		{
+			if (strncmp(pObjects[i].name, occluderName, SCENE_TAG_LENGTH) == 0)
+			{
+				m_occluderObjects.push_back(i);
+				m_objectOccluders[i] = 1;
+				break;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  CullOccludedObjects()
+ *
+ *  This method is used for drawing the visible occluders
+ *  into the occlusion depth buffer, and for hiding the
+ *  objects and batches left visible by the frustum culling
+ *  that are entirely behind them.  The occluders are never
+ *  tested themselves, and neither are the batches holding
+ *  one, since an occluder can not hide its own box.
+ ***********************************************************/
+void SceneManager::CullOccludedObjects()
+{
+	m_occludedObjects = 0;
+	m_occludedDraws = 0;
+	if ((m_bOcclusionCulling == false) || (m_occluderObjects.empty() == true))
+	{
+		return;
+	}
+
+	const SCENE_RECORD* pObjects = m_pSceneFile->GetRecords();
+	uint32_t objectCount = m_pSceneFile->GetRecordCount();
+
+	m_pOcclusionCuller->BeginFrame(m_projection * m_view);
+	m_batchOccluders.assign(m_pStaticBatcher->GetBatchCount(), 0);
+	for (uint32_t occluder : m_occluderObjects)
+	{
+		int batch = m_pStaticBatcher->GetObjectBatch(occluder);
+		if (batch >= 0)
+		{
+			m_batchOccluders[batch] = 1;
+		}
+
+		if (m_pFrustumCuller->IsVisible(occluder) == true)
+		{
+			m_pOcclusionCuller->AddOccluder(m_shapeBounds[pObjects[occluder].meshType], m_pSceneGraph->GetWorldMatrix(occluder));
+		}
+	}
+
+	if (m_pOcclusionCuller->GetOccluderTriangles() == 0)
+	{
+		return;
+	}
+	m_pOcclusionCuller->BuildPyramid();
+
+	MESH_BOUNDS worldBounds;
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		if ((pObjects[i].meshType >= SCENE_MESH_COUNT) || (m_objectOccluders[i] != 0) ||
+			(m_pStaticBatcher->IsBatched(i) == true) || (m_pFrustumCuller->IsVisible(i) == false))
+			continue;
+
+		m_pFrustumCuller->GetWorldBounds(i, worldBounds);
+		if (m_pOcclusionCuller->IsOccluded(worldBounds) == true)
+		{
+			m_pFrustumCuller->SetVisible(i, false);
+			m_occludedObjects++;
+			m_occludedDraws++;
+		}
+	}
+
+	for (uint32_t i = 0; i < m_pStaticBatcher->GetBatchCount(); i++)
+	{
+		const STATIC_BATCH& batch = m_pStaticBatcher->GetBatch(i);
+		if ((batch.objects.empty() == true) || (m_batchOccluders[i] != 0) ||
+			(m_pFrustumCuller->IsVisible(objectCount + i) == false))
+			continue;
+
+		m_pFrustumCuller->GetWorldBounds(objectCount + i, worldBounds);
+		if (m_pOcclusionCuller->IsOccluded(worldBounds) == true)
+		{
+			m_pFrustumCuller->SetVisible(objectCount + i, false);
+			m_occludedObjects += (uint32_t)batch.objects.size();
+			m_occludedDraws++;
+		}
+	}
+}
+
+/***********************************************************
+ *  RaycastObject()
+ *
+ *  This method is used for finding the object nearest to
+ *  the origin of a ray whose world bounds the ray hits, for
+ *  picking objects.  Only the boxes around the objects are
+ *  tested, not their triangles.
+ ***********************************************************/
+int SceneManager::RaycastObject(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const
+{
+	BVH_HIT hit;
+	if (m_pSceneBVH->Raycast(origin, direction, maxDistance, hit) == false)
+	{
+		return(-1);
+	}
+
+	return((int)hit.id);
+}
+
+/***********************************************************
+ *  GetDrawItemState()
+ *
+ *  This method is used for looking up the draw state of a
+ *  queued item, which is either a scene object or a batch.
+ ***********************************************************/
+void SceneManager::GetDrawItemState(const RENDER_ITEM& item, DRAW_ITEM_STATE& state) const
+{
+	if (item.itemType == RENDER_ITEM_STATIC_BATCH)
+	{
+		const STATIC_BATCH& batch = m_pStaticBatcher->GetBatch(item.objectIndex);
+
+		// batches are already in world space
+		state.pModel = &g_IdentityMatrix;
+		state.pColor = batch.color;
+		state.meshType = m_batchMeshTypes[item.objectIndex];
+		state.textureSlot = batch.textureSlot;
+		state.materialIndex = batch.materialIndex;
+	}
+	else
+	{
+		const SCENE_RECORD& object = m_pSceneFile->GetRecords()[item.objectIndex];
+
+		state.pModel = &m_pSceneGraph->GetWorldMatrix(item.objectIndex);
+		state.pColor = object.color;
+		state.meshType = m_pMeshLOD->GetLevel(object.meshType, m_objectLodLevels[item.objectIndex]).meshType;
+		state.textureSlot = m_objectTextureSlots[item.objectIndex];
+		state.materialIndex = m_objectMaterialIndices[item.objectIndex];
+	}
+}
+
+/***********************************************************
+ *  BuildRenderQueue()
+ *
+ *  This method is used for submitting every static batch and
+ *  every drawable scene object that is not batched to the
+ *  render queue with a key made from its draw state and its
+ *  distance to the camera.
+ ***********************************************************/
+void SceneManager::BuildRenderQueue()
+{
+	const SCENE_RECORD* pObjects = m_pSceneFile->GetRecords();
+	uint32_t objectCount = m_pSceneFile->GetRecordCount();
+
+	m_pRenderQueue->Clear();
+	m_culledObjects = 0;
+	m_culledBatchedObjects = 0;
+
+	// batches are drawn first, they hold the static opaque objects
+	for (uint32_t i = 0; i < m_pStaticBatcher->GetBatchCount(); i++)
+	{
+		const STATIC_BATCH& batch = m_pStaticBatcher->GetBatch(i);
+		if (batch.objects.empty())
+			continue;
+
+		if (m_pFrustumCuller->IsVisible(objectCount + i) == false)
+		{
+			m_culledObjects += (uint32_t)batch.objects.size();
+			m_culledBatchedObjects += (uint32_t)batch.objects.size();
+			continue;
+		}
+
+		// batches in the same texture array can share a draw
+		int textureArray = GetTextureArray(batch.textureSlot);
+
+		m_pRenderQueue->Submit(
+			RenderQueue::MakeSortKey(
+				RENDER_PASS_OPAQUE,
+				0,
+				(textureArray >= 0) ? (uint32_t)textureArray : RENDER_KEY_UNUSED,
+				(batch.materialIndex >= 0) ? (uint32_t)batch.materialIndex : RENDER_KEY_UNUSED,
+				m_batchMeshTypes[i],
+				0.0f),
+			i,
+			RENDER_ITEM_STATIC_BATCH);
+	}
+
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		const SCENE_RECORD& object = pObjects[i];
+
+		// grouping nodes only position their children
+		if ((object.meshType == SCENE_MESH_NONE) || (m_pStaticBatcher->IsBatched(i) == true))
+			continue;
+
+		if (m_pFrustumCuller->IsVisible(i) == false)
+		{
+			m_culledObjects++;
+			continue;
+		}
+
+		const glm::mat4& world = m_pSceneGraph->GetWorldMatrix(i);
+		float depth = glm::length(glm::vec3(world[3]) - m_viewPosition);
+		uint32_t pass = (object.color[3] < 1.0f) ? RENDER_PASS_TRANSPARENT : RENDER_PASS_OPAQUE;
+		int textureArray = GetTextureArray(m_objectTextureSlots[i]);
+		int materialIndex = m_objectMaterialIndices[i];
+
+		m_pRenderQueue->Submit(
+			RenderQueue::MakeSortKey(
+				pass,
+				0,
+				(textureArray >= 0) ? (uint32_t)textureArray : RENDER_KEY_UNUSED,
+				(materialIndex >= 0) ? (uint32_t)materialIndex : RENDER_KEY_UNUSED,
+				m_pMeshLOD->GetLevel(object.meshType, m_objectLodLevels[i]).meshType,
+				depth),
+			i);
+	}
+
+	if (m_bSortRenderQueue == true)
+	{
+		m_pRenderQueue->Sort();
+	}
+}
+
+/***********************************************************
+ *  DrawRenderQueue()
+ *
+ *  This method is used for drawing the queued items.  The
+ *  texture and material are only set into the shader when
+ *  they differ from the previous item.
+ ***********************************************************/
+void SceneManager::DrawRenderQueue()
+{
+	if (m_bUseInstancing == true)
+	{
+		DrawRenderQueueInstanced();
+		return;
+	}
+
+	auto drawStart = std::chrono::high_resolution_clock::now();
+
+	const RENDER_ITEM* pItems = m_pRenderQueue->GetItems();
+	uint32_t itemCount = m_pRenderQueue->GetItemCount();
+
+	// -2 means nothing has been set yet, -1 means no texture
+	int currentTexture = -2;
+	int currentTextureArray = -2;
+	int currentMaterial = -2;
+	uint32_t currentMesh = SCENE_MESH_NONE;
+
+	m_renderStats = RENDER_STATS();
+	m_renderStats.batchedObjects = m_pStaticBatcher->GetBatchedObjectCount() - m_culledBatchedObjects;
+	m_renderStats.objects = m_renderStats.batchedObjects;
+
+	for (uint32_t i = 0; i < itemCount; i++)
+	{
+		DRAW_ITEM_STATE state;
+		GetDrawItemState(pItems[i], state);
+		if (pItems[i].itemType == RENDER_ITEM_OBJECT)
+		{
+			m_renderStats.objects++;
+		}
+
+		// set the cached transformations into memory to be used on the drawn meshes
+		SetModelMatrix(*state.pModel);
+
+		if (GetTextureArray(state.textureSlot) >= 0)
+		{
+			// a new layer of the same array is only a uniform change
+			if (state.textureSlot != currentTexture)
+			{
+				SetShaderTextureSlot(state.textureSlot);
+				currentTexture = state.textureSlot;
+
+				int textureArray = GetTextureArray(state.textureSlot);
+				if (textureArray != currentTextureArray)
+				{
+					currentTextureArray = textureArray;
+					m_renderStats.textureChanges++;
+				}
+			}
+		}
+		else
+		{
+			SetShaderColor(state.pColor[0], state.pColor[1], state.pColor[2], state.pColor[3]);
+			if (currentTexture != -1)
+			{
+				currentTexture = -1;
+				currentTextureArray = -1;
+				m_renderStats.textureChanges++;
+			}
+		}
+
+		// an object without a material keeps the previous one
+		if ((state.materialIndex >= 0) && (state.materialIndex != currentMaterial))
+		{
+			SetShaderMaterialIndex(state.materialIndex);
+			currentMaterial = state.materialIndex;
+			m_renderStats.materialChanges++;
+		}
+
+		if (state.meshType != currentMesh)
+		{
+			currentMesh = state.meshType;
+			m_renderStats.meshChanges++;
+		}
+
+		// draw the mesh with transformation values
+		DrawSceneMesh(state.meshType);
+		m_renderStats.drawCalls++;
+		m_renderStats.triangles += m_pInstancedMeshes->GetTriangleCount(state.meshType);
+	}
+
+	m_renderStats.drawMilliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::high_resolution_clock::now() - drawStart).count();
+}
+
+/***********************************************************
+ *  DrawRenderQueueInstanced()
+ *
+ *  This method is used for drawing the queued items with
+ *  instanced draw calls.  The model matrix, color, material
+ *  and texture layer of every item are uploaded once per
+ *  frame, and each run of items with the same texture array
+ *  and mesh becomes one indirect draw command.  The commands
+ *  of every texture array are then submitted with a single
+ *  multi-draw call.
+ ***********************************************************/
+void SceneManager::DrawRenderQueueInstanced()
+{
+	auto drawStart = std::chrono::high_resolution_clock::now();
+
+	const RENDER_ITEM* pItems = m_pRenderQueue->GetItems();
+	uint32_t itemCount = m_pRenderQueue->GetItemCount();
+
+	m_renderStats = RENDER_STATS();
+	m_renderStats.batchedObjects = m_pStaticBatcher->GetBatchedObjectCount() - m_culledBatchedObjects;
+	m_renderStats.objects = m_renderStats.batchedObjects;
+
+	// gather the per-instance data in queue order so that every
+	// run of items is a contiguous range of instances
+	m_instanceData.resize(itemCount);
+	for (uint32_t i = 0; i < itemCount; i++)
+	{
+		DRAW_ITEM_STATE state;
+		GetDrawItemState(pItems[i], state);
+		if (pItems[i].itemType == RENDER_ITEM_OBJECT)
+		{
+			m_renderStats.objects++;
+		}
+		m_renderStats.triangles += m_pInstancedMeshes->GetTriangleCount(state.meshType);
+
+		INSTANCE_DATA& instance = m_instanceData[i];
+		instance.model = *state.pModel;
+		instance.color = glm::vec4(state.pColor[0], state.pColor[1], state.pColor[2], state.pColor[3]);
+		// an object without a material uses the first one
+		instance.materialIndex = (state.materialIndex >= 0) ? (uint32_t)state.materialIndex : 0;
+		instance.textureLayer = (GetTextureArray(state.textureSlot) >= 0) ? (uint32_t)GetTextureLayer(state.textureSlot).layer : 0;
+		instance.reserved[0] = instance.reserved[1] = 0;
+	}
+	m_pInstancedMeshes->UploadInstances(m_instanceData.data(), itemCount);
+
+	// one indirect command per run, grouped by texture
+	m_pInstancedMeshes->ClearIndirectDraws();
+	m_textureDrawGroups.clear();
+	uint32_t runStart = 0;
+	while (runStart < itemCount)
+	{
+		uint64_t runKey = pItems[runStart].sortKey & RENDER_KEY_INSTANCE_MASK;
+		uint32_t runEnd = runStart + 1;
+		while ((runEnd < itemCount) && ((pItems[runEnd].sortKey & RENDER_KEY_INSTANCE_MASK) == runKey))
+		{
+			runEnd++;
+		}
+
+		// the run shares the texture array of its first item
+		int textureArray = (int)((runKey >> 48) & 0xFF);
+		if (textureArray == (int)RENDER_KEY_UNUSED)
+		{
+			textureArray = -1;
+		}
+		if ((m_textureDrawGroups.empty()) || (m_textureDrawGroups.back().textureArray != textureArray))
+		{
+			TEXTURE_DRAW_GROUP group;
+			group.textureArray = textureArray;
+			group.firstCommand = m_pInstancedMeshes->AddIndirectDraw(RenderQueue::GetSortKeyMesh(runKey), runStart, runEnd - runStart);
+			group.commandCount = 1;
+			m_textureDrawGroups.push_back(group);
+		}
+		else
+		{
+			m_pInstancedMeshes->AddIndirectDraw(RenderQueue::GetSortKeyMesh(runKey), runStart, runEnd - runStart);
+			m_textureDrawGroups.back().commandCount++;
+		}
+		m_renderStats.meshChanges++;
+
+		runStart = runEnd;
+	}
+	m_pInstancedMeshes->UploadIndirectDraws();
+
+	if (NULL != m_pShaderManager)
+	{
+		ShaderUniforms::Set(m_uniforms.bUseInstancing, true);
+		UniformBuffer::AddBytesUploaded(sizeof(int));
+	}
+
+	for (const TEXTURE_DRAW_GROUP& group : m_textureDrawGroups)
+	{
+		if (group.textureArray >= 0)
+		{
+			SetShaderTextureArray(group.textureArray);
+		}
+		else if (NULL != m_pShaderManager)
+		{
+			ShaderUniforms::Set(m_uniforms.bUseTexture, false);
+			UniformBuffer::AddBytesUploaded(sizeof(int));
+		}
+		m_renderStats.textureChanges++;
+
+		m_renderStats.drawCalls += m_pInstancedMeshes->DrawIndirect(group.firstCommand, group.commandCount);
+	}
+
+	if (NULL != m_pShaderManager)
+	{
+		ShaderUniforms::Set(m_uniforms.bUseInstancing, false);
+		UniformBuffer::AddBytesUploaded(sizeof(int));
+	}
+
+	m_renderStats.drawMilliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::high_resolution_clock::now() - drawStart).count();
+}
+
+/***********************************************************
+ *  ReportRenderStats()
+ *
+ *  This method is used for printing the render counters,
+ *  averaged per frame, every few seconds.
+ ***********************************************************/
+void SceneManager::ReportRenderStats()
+{
+	m_reportStats.objects += m_renderStats.objects;
+	m_reportStats.batchedObjects += m_renderStats.batchedObjects;
+	m_reportStats.culledObjects += m_renderStats.culledObjects;
+	m_reportStats.occludedObjects += m_renderStats.occludedObjects;
+	m_reportStats.occludedDraws += m_renderStats.occludedDraws;
+	m_reportStats.uniformBytes += m_renderStats.uniformBytes;
+	m_reportStats.textureBytes += m_renderStats.textureBytes;
+	m_reportStats.stateCalls += m_renderStats.stateCalls;
+	m_reportStats.elidedStateCalls += m_renderStats.elidedStateCalls;
+	m_reportStats.drawCalls += m_renderStats.drawCalls;
+	m_reportStats.triangles += m_renderStats.triangles;
+	m_reportStats.textureChanges += m_renderStats.textureChanges;
+	m_reportStats.materialChanges += m_renderStats.materialChanges;
+	m_reportStats.meshChanges += m_renderStats.meshChanges;
+	m_reportStats.drawMilliseconds += m_renderStats.drawMilliseconds;
+	m_reportFrames++;
+
+	double currentTime = GetSeconds();
+	if (currentTime - m_reportStartTime < g_RenderReportSeconds)
+	{
+		return;
+	}
+
+	std::cout << "INFO: per frame (" << (m_bSortRenderQueue ? "sorted" : "unsorted")
+		<< (m_bUseInstancing ? ", instanced" : "") << ")"
+		<< " objects:" << m_reportStats.objects / m_reportFrames
+		<< " batched:" << m_reportStats.batchedObjects / m_reportFrames
+		<< " culled:" << m_reportStats.culledObjects / m_reportFrames
+		<< " occluded:" << m_reportStats.occludedObjects / m_reportFrames
+		<< " draws saved:" << m_reportStats.occludedDraws / m_reportFrames
+		<< " draws:" << m_reportStats.drawCalls / m_reportFrames
+		<< " triangles:" << m_reportStats.triangles / m_reportFrames
+		<< " texture changes:" << m_reportStats.textureChanges / m_reportFrames
+		<< " material changes:" << m_reportStats.materialChanges / m_reportFrames
+		<< " mesh changes:" << m_reportStats.meshChanges / m_reportFrames
+		<< " uniform bytes:" << m_reportStats.uniformBytes / m_reportFrames
+		<< " state calls:" << m_reportStats.stateCalls / m_reportFrames
+		<< " elided:" << m_reportStats.elidedStateCalls / m_reportFrames
+		<< " draw time:" << m_reportStats.drawMilliseconds / m_reportFrames << " ms"
+		<< std::endl;
+
+	std::cout << "INFO: texture memory: "
+		<< (m_reportStats.textureBytes / m_reportFrames) / (1024.0 * 1024.0) << " MB of ";
+	if (m_pTextureResidency->GetBudget() > 0)
+	{
+		std::cout << m_pTextureResidency->GetBudget() / (1024.0 * 1024.0) << " MB budget" << std::endl;
+	}
+	else
+	{
+		std::cout << "unlimited budget" << std::endl;
+	}
+
+	m_reportStats = RENDER_STATS();
+	m_reportFrames = 0;
+	m_reportStartTime = currentTime;
+}
+
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+
+	/*** STUDENTS - add the code BELOW for loading the textures that ***/
+	/*** will be used for mapping to objects in the 3D scene. They  ***/
+	/*** are packed into texture arrays, so the number of textures   ***/
+	/*** is not limited by the texture slots. Refer to the code in   ***/
+	/*** the OpenGL Sample for help.                                 ***/
+void SceneManager::LoadSceneTextures()
+{
+	bool bReturn = false;
+	//FLOOR
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/pavers.jpg",
+		"floor"
+	);
+	//FLOOR
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/dirty.jpg",
+		"floor2"
+	);
+	
+	//TableLeg
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/rusticwood.jpg",
+		"plank"
+	);
+	//TableTop
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/stainless.jpg",
+		"desk"
+	);
+	//Backwall
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/slimBrick.jpg",
+		"bDrop"
+		
+  	);
+	//Book5
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/book011.jpg",
+		"Book5"
+		
+	);
+	//Books
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/book022.jpg",
+		"Books"
+
+	);
+	//Monitor Plastic
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/plastic.jpg",
+		"plastic"
+
+	);
+	//Monitor screen
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/Mons2.jpg",
+		"screen"
+
+	);
+	//keyboard Drawer
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/rusticwood.jpg",
+		"wood"
+
+	);
+	//keyboard texture
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/kb1.jpg",
+		"KB1"
+
+	);
+	//poster texture
+	bReturn = CreateGLTexture(
+		"../../Utilities/textures/tuckersoft.jpg",
+		"poster"
+
+	);
+
+
+	// after the texture image data is loaded into memory, the
+	// loaded textures are packed into texture arrays and every
+	// array is bound to its own texture slot
+	BindGLTextures();
+}
+/***********************************************************
+*DefineObjectMaterials()
+*
+* This method is used for configuring the various material
+* settings for all of the objects within the 3D scene.
+* **********************************************************/
+void SceneManager::DefineObjectMaterials()
+{
+	/*** STUDENTS - add the code BELOW for defining object materials. ***/
+	/*** There is no limit to the number of object materials that can ***/
+	/*** be defined. Refer to the code in the OpenGL Sample for help  ***/
+
+
+	///////////////// GOLD   ////////////////////
+	OBJECT_MATERIAL goldMaterial;
+	goldMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.1f);
+	goldMaterial.ambientStrength = 0.4f;
+	goldMaterial.diffuseColor = glm::vec3(0.3f, 0.3f, 0.2f);
+	goldMaterial.specularColor = glm::vec3(0.6f, 0.5f, 0.4f);
+	goldMaterial.shininess = 22.0;
+	goldMaterial.tag = "gold";
+
+	AddObjectMaterial(goldMaterial);
+
+	/////////////////  CEMENT /////////////////
+	OBJECT_MATERIAL cementMaterial;
+	cementMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	cementMaterial.ambientStrength = 0.2f;
+	cementMaterial.diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
+	cementMaterial.specularColor = glm::vec3(0.4f, 0.4f, 0.4f);
+	cementMaterial.shininess = 0.5;
+	cementMaterial.tag = "cement";
+
+	AddObjectMaterial(cementMaterial);
+
+	///////////////// WOOD ////////////////////
+	OBJECT_MATERIAL woodMaterial;
+	woodMaterial.ambientColor = glm::vec3(0.4f, 0.3f, 0.1f);
+	woodMaterial.ambientStrength = 0.2f;
+	woodMaterial.diffuseColor = glm::vec3(0.3f, 0.2f, 0.1f);
+	woodMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	woodMaterial.shininess = 0.5;
+	woodMaterial.tag = "wood";
+
+	AddObjectMaterial(woodMaterial);
+	///////////////// TILE ////////////////////
+	OBJECT_MATERIAL tileMaterial;
+	tileMaterial.ambientColor = glm::vec3(0.2f, 0.3f, 0.4f);
+	tileMaterial.ambientStrength = 0.3f;
+	tileMaterial.diffuseColor = glm::vec3(0.3f, 0.2f, 0.1f);
+	tileMaterial.specularColor = glm::vec3(0.4f, 0.5f, 0.6f);
+	tileMaterial.shininess = 25.0;
+	tileMaterial.tag = "tile";
+
+	AddObjectMaterial(tileMaterial);
+
+	///////////////// glass ////////////////////
+	OBJECT_MATERIAL glassMaterial;
+	glassMaterial.ambientColor = glm::vec3(0.4f, 0.4f, 0.4f);
+	glassMaterial.ambientStrength = 0.3f;
+	glassMaterial.diffuseColor = glm::vec3(0.4f, 0.4f, 0.5f);
+	glassMaterial.specularColor = glm::vec3(0.6f, 0.6f, 0.6f);
+	glassMaterial.shininess = 85.0;
+	glassMaterial.tag = "glass";
+
+	AddObjectMaterial(glassMaterial);
+
+	///////////////// CLAY ////////////////////
+	OBJECT_MATERIAL clayMaterial;
+	clayMaterial.ambientColor = glm::vec3(0.4f, 0.3f, 0.1f);
+	clayMaterial.ambientStrength = 0.2f;
+	clayMaterial.diffuseColor = glm::vec3(0.3f, 0.2f, 0.1f);
+	clayMaterial.specularColor = glm::vec3(0.4f, 0.5f, 0.6f);
+	clayMaterial.shininess = 0.5;
+	clayMaterial.tag = "clay";
+
+	AddObjectMaterial(clayMaterial);
+}
+
+/***********************************************************
+ *  SetupSceneLights()
+ *
+ *  This method is called to add and configure the light
+ *  sources for the 3D scene.  There are up to 4 light sources.
+ ***********************************************************/
+void SceneManager::SetupSceneLights()
+{
+	// this line of code is NEEDED for telling the shaders to render 
+	// the 3D scene with custom lighting, if no light sources have
+	// been added then the display window will be black - to use the 
+	// default OpenGL lighting then comment out the following line
+	//m_pShaderManager->setBoolValue(g_UseLightingName, true);
+
+	/*** STUDENTS - add the code BELOW for setting up light sources ***/
+	/*** Up to four light sources can be defined. Refer to the code ***/
+	/*** in the OpenGL Sample for help                              ***/
+	ShaderUniforms::Set(m_uniforms.bUseLighting, true);
+
+	// Light 0: Upper right light
+	SetLightSource(
+		0,
+		glm::vec3(10.0f, 10.0f, 10.0f),
+		glm::vec3(0.10f, 0.09f, 0.08f),	// warm tone
+		glm::vec3(0.3f, 0.3f, 0.3f),	// lower intensity
+		glm::vec3(1.0f, 1.0f, 1.0f),
+		12.0f,
+		0.002f);
+
+	// Light 1: Upper left light
+	SetLightSource(
+		1,
+		glm::vec3(-10.0f, 10.4f, -9.5f),
+		glm::vec3(0.12f, 0.09f, 0.08f),
+		glm::vec3(0.35f, 0.33f, 0.30f),
+		glm::vec3(0.3f, 0.3f, 1.0f),
+		2.0f,
+		0.02f);
+
+	// Light 2: Center overhead (above the glass table)
+	SetLightSource(
+		2,
+		glm::vec3(0.0f, 10.0f, 0.0f),
+		glm::vec3(0.10f, 0.09f, 0.08f),
+		glm::vec3(0.3f, 0.3f, 0.3f),
+		glm::vec3(0.1f, 1.0f, 1.0f),
+		54.0f,
+		0.01f);
+
+	// Light 3: Fill light
+	SetLightSource(
+		3,
+		glm::vec3(10.0f, 0.0f, -10.0f),
+		glm::vec3(0.10f, 0.09f, 0.08f),
+		glm::vec3(0.35f, 0.33f, 0.30f),
+		glm::vec3(1.0f, 1.0f, 1.0f),
+		16.0f,
+		0.015f);
+
+	// the lights are sent to the shaders once, through the uniform block
+	UploadLightBlock();
+}
+
+/***********************************************************
+ *  LoadSceneObjects()
+ *
+ *  This method is used for loading the objects of the 3D
+ *  scene from the scene file.  The text description is only
+ *  parsed when its compiled binary twin is out of date.
+ ***********************************************************/
+bool SceneManager::LoadSceneObjects()
+{
+	bool bReturn = m_pSceneFile->LoadScene(
+		m_sceneTextFilename.c_str(),
+		m_sceneBinaryFilename.c_str());
+
+	// compose the world matrix of every object once - they are
+	// only propagated again below objects that were moved
+	m_pSceneGraph->Build(
+		m_pSceneFile->GetRecords(),
+		m_pSceneFile->GetRecordCount());
+
+	// resolve the texture and material tags once instead of
+	// searching for them by name on every draw
+	const SCENE_RECORD* pObjects = m_pSceneFile->GetRecords();
+	uint32_t objectCount = m_pSceneFile->GetRecordCount();
+
+	m_objectTextureSlots.assign(objectCount, -1);
+	m_objectMaterialIndices.assign(objectCount, -1);
+	m_objectLodLevels.assign(objectCount, 0);
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		if (pObjects[i].textureTag[0] != '\0')
+			m_objectTextureSlots[i] = FindTextureSlot(pObjects[i].textureTag);
+		if (pObjects[i].materialTag[0] != '\0')
+			m_objectMaterialIndices[i] = FindMaterialIndex(pObjects[i].materialTag);
+	}
+
+	// world bounds of every object, grouping nodes keep an
+	// empty box since they are never drawn
+	m_pFrustumCuller->Resize(0);
+	m_pFrustumCuller->Resize(objectCount);
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		if (pObjects[i].meshType < SCENE_MESH_COUNT)
+			m_pFrustumCuller->SetBounds(i, m_shapeBounds[pObjects[i].meshType], m_pSceneGraph->GetWorldMatrix(i));
+	}
+
+	// bake the objects that share a draw state into batches
+	if (m_bStaticBatching == true)
+	{
+		BuildStaticBatches();
+	}
+
+	BuildSceneBVH();
+	FindOccluders();
+
+	return(bReturn);
+}
+
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	// only one instance of a particular mesh needs to be
+	// loaded in memory no matter how many times it is drawn
+	// in the rendered 3D scene
+	// load the textures for the 3D scene
+	// define the materials for objects in the scene
+	DefineObjectMaterials();
+	// add and define the light sources for the scene
+	SetupSceneLights();
+	LoadSceneTextures();
+	// LoadShapes
+	m_basicMeshes->LoadPlaneMesh();
+	m_basicMeshes->LoadBoxMesh();
+	m_basicMeshes->LoadCylinderMesh();
+	m_basicMeshes->LoadTorusMesh();
+	LoadLodMeshes();
+	// draws select their material from the uniform block by index
+	UploadMaterialBlock();
+	// load the objects that make up the scene
+	LoadSceneObjects();
+
+	// the shader decodes packed vertices with the mesh boxes
+	ShaderUniforms::Set(m_uniforms.bPackedVertices, m_pInstancedMeshes->IsPackedVertices());
+	std::cout << "INFO: mesh buffers: " << m_pInstancedMeshes->GetVertexCount() << " vertices of "
+		<< m_pInstancedMeshes->GetVertexSize() << " bytes, " << m_pInstancedMeshes->GetVertexBytes()
+		<< " vertex bytes, " << m_pInstancedMeshes->GetIndexBytes() << " index bytes" << std::endl;
+}
+
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by 
+ *  transforming and drawing the basic 3D shapes
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	// textures that finished decoding replace their placeholder
+	UpdateTextureUploads();
+
+	// propagate the transformations of objects that moved, and
+	// take them out of the static batches
+	if (m_pSceneGraph->UpdateWorldMatrices() > 0)
+	{
+		UpdateStaticBatches();
+		UpdateCullingBounds();
+	}
+
+	// drop or stream in texture levels for the current view
+	UpdateTextureResidency();
+
+	// queue the objects inside the view ordered by their draw state
+	CullSceneObjects();
+	SelectObjectLods();
+	BuildRenderQueue();
+	DrawRenderQueue();
+
+	// includes the camera block uploaded by the view manager
+	m_renderStats.uniformBytes = UniformBuffer::TakeBytesUploaded();
+	m_renderStats.textureBytes = m_pTextureArrays->GetResidentBytes();
+	m_renderStats.culledObjects = m_culledObjects;
+	m_renderStats.occludedObjects = m_occludedObjects;
+	m_renderStats.occludedDraws = m_occludedDraws;
+	// includes the state set by the main loop and the view manager
+	m_renderStats.stateCalls = GLStateCache::TakeIssuedCalls();
+	m_renderStats.elidedStateCalls = GLStateCache::TakeElidedCalls();
+	ReportRenderStats();
+}
@@ -1,112 +1,372 @@
-///////////////////////////////////////////////////////////////////////////////
-// shadermanager.h
-// ============
-// manage the loading and rendering of 3D scenes
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "ShapeMeshes.h"
-
-#include <string>
-#include <vector>
-
-/***********************************************************
- *  SceneManager
- *
- *  This class contains the code for preparing and rendering
- *  3D scenes, including the shader settings.
- ***********************************************************/
-class SceneManager
-{
-public:
-	// constructor
-	SceneManager(ShaderManager *pShaderManager);
-	// destructor
-	~SceneManager();
-
-	struct TEXTURE_INFO
-	{
-		std::string tag;
-		uint32_t ID;
-	};
-
-	struct OBJECT_MATERIAL
-	{
-		float ambientStrength;
-		glm::vec3 ambientColor;
-		glm::vec3 diffuseColor;
-		glm::vec3 specularColor;
-		float shininess;
-		std::string tag;
-	};
-
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
-	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
-
-	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
-	void BindGLTextures();
-	// free the loaded OpenGL textures
-	void DestroyGLTextures();
-	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
-	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
-
-	// set the transformation values 
-	// into the transform buffer
-	void SetTransformations(
-		glm::vec3 scaleXYZ,
-		float XrotationDegrees,
-		float YrotationDegrees,
-		float ZrotationDegrees,
-		glm::vec3 positionXYZ);
-
-	// set the color values into the shader
-	void SetShaderColor(
-		float redColorValue,
-		float greenColorValue,
-		float blueColorValue,
-		float alphaValue);
-
-	// set the texture data into the shader
-	void SetShaderTexture(
-		std::string textureTag);
-
-	// set the UV scale for the texture mapping
-	void SetTextureUVScale(
-		float u, float v);
-
-	// set the object material into the shader
-	void SetShaderMaterial(
-		std::string materialTag);
-
-public:
-
-	// The following methods are for the students to 
-	// customize for their own 3D scene
-	void PrepareScene();
-	void RenderScene();
-	// loads textures from image files
-	void LoadSceneTextures();
-	// pre-set light sources for 3D scene
-	void SetupSceneLights();
-	// pre-define the object materials for lighting
-	void DefineObjectMaterials();
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.h
+// ============
+// manage the loading and rendering of 3D scenes
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+#include "SceneFile.h"
+#include "SceneGraph.h"
+#include "RenderQueue.h"
+#include "InstancedMeshes.h"
+#include "FrustumCuller.h"
+#include "MeshGenerator.h"
+#include "MeshLOD.h"
+#include "OcclusionCuller.h"
+#include "SceneBVH.h"
+#include "StaticBatcher.h"
+#include "UniformBuffer.h"
+#include "ShaderUniforms.h"
+#include "TagRegistry.h"
+#include "TextureArrays.h"
+#include "TextureCache.h"
+#include "TextureLoader.h"
+#include "TextureResidency.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneManager
+ *
+ *  This class contains the code for preparing and rendering
+ *  3D scenes, including the shader settings.
+ ***********************************************************/
+class SceneManager
+{
+public:
+	// constructor
+	SceneManager(ShaderManager *pShaderManager);
+	// destructor
+	~SceneManager();
+
+	struct TEXTURE_INFO
+	{
+		std::string tag;
+		uint32_t ID;
+		std::string filename;
+		// texture in the texture arrays, shared by the tags
+		// of identical images
+		uint32_t texture;
+	};
+
+	struct OBJECT_MATERIAL
+	{
+		float ambientStrength;
+		glm::vec3 ambientColor;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+		std::string tag;
+	};
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// uniform locations of the shader program, resolved once
+	// so that the per-draw setters skip the name lookups
+	ShaderUniforms* m_pShaderUniforms;
+	struct SCENE_UNIFORMS
+	{
+		UNIFORM_HANDLE<glm::mat4> model;
+		UNIFORM_HANDLE<glm::vec4> objectColor;
+		UNIFORM_HANDLE<int> objectTexture;
+		UNIFORM_HANDLE<int> textureLayer;
+		UNIFORM_HANDLE<bool> bUseTexture;
+		UNIFORM_HANDLE<bool> bUseLighting;
+		UNIFORM_HANDLE<bool> bUseInstancing;
+		UNIFORM_HANDLE<bool> bPackedVertices;
+		UNIFORM_HANDLE<int> meshBoxes;
+		UNIFORM_HANDLE<int> materialIndex;
+		UNIFORM_HANDLE<glm::vec2> UVscale;
+	};
+	SCENE_UNIFORMS m_uniforms;
+	// pointer to basic shapes object
+	ShapeMeshes* m_basicMeshes;
+	// instanced versions of the basic shapes
+	InstancedMeshes* m_pInstancedMeshes;
+	// whether queued items that share a texture and mesh are
+	// drawn together with one instanced draw call
+	bool m_bUseInstancing;
+	// per-instance data of the current frame, in queue order
+	std::vector<INSTANCE_DATA> m_instanceData;
+	// indirect draw commands of the current frame that share
+	// a texture array, drawn with one multi-draw call each
+	struct TEXTURE_DRAW_GROUP
+	{
+		int textureArray;
+		uint32_t firstCommand;
+		uint32_t commandCount;
+	};
+	std::vector<TEXTURE_DRAW_GROUP> m_textureDrawGroups;
+	// merged static objects and the mesh type of every batch
+	StaticBatcher* m_pStaticBatcher;
+	bool m_bStaticBatching;
+	std::vector<uint32_t> m_batchMeshTypes;
+	// local bounds of the basic shapes
+	MESH_BOUNDS m_shapeBounds[SCENE_MESH_COUNT];
+	// generated tessellations of the shapes, their levels and
+	// the level every object was last drawn with
+	MeshGenerator* m_pMeshGenerator;
+	MeshLOD* m_pMeshLOD;
+	bool m_bLevelOfDetail;
+	std::vector<uint8_t> m_objectLodLevels;
+	// whether the generated meshes are kept in the mesh cache
+	bool m_bMeshCache;
+	// world bounds of the scene objects followed by the
+	// batches, and the objects culled from the last frame
+	FrustumCuller* m_pFrustumCuller;
+	bool m_bFrustumCulling;
+	uint32_t m_culledObjects;
+	uint32_t m_culledBatchedObjects;
+	// hierarchy over the world bounds of the drawable objects,
+	// for culling large scenes and for ray queries
+	SceneBVH* m_pSceneBVH;
+	std::vector<uint32_t> m_visibleObjects;
+	// objects drawn into the occlusion depth buffer, flagged
+	// per object and per batch, and what they hid last frame
+	OcclusionCuller* m_pOcclusionCuller;
+	bool m_bOcclusionCulling;
+	std::vector<uint32_t> m_occluderObjects;
+	std::vector<uint8_t> m_objectOccluders;
+	std::vector<uint8_t> m_batchOccluders;
+	uint32_t m_occludedObjects;
+	uint32_t m_occludedDraws;
+	// light sources and materials shared with the shaders
+	UniformBuffer* m_pLightBuffer;
+	UniformBuffer* m_pMaterialBuffer;
+	LIGHT_BLOCK m_lightBlock;
+	// total number of loaded textures
+	int m_loadedTextures;
+	// loaded textures info
+	std::vector<TEXTURE_INFO> m_textureIDs;
+	// texture arrays holding the loaded textures as layers
+	TextureArrays* m_pTextureArrays;
+	// loaded images by path and contents, so a duplicate
+	// image is only decoded and uploaded once
+	TextureCache* m_pTextureCache;
+	// decodes the texture images in the background, objects
+	// are drawn with their color until their texture arrives
+	TextureLoader* m_pTextureLoader;
+	double m_textureLoadStartTime;
+	// mip levels of the arrays kept within the texture budget
+	TextureResidency* m_pTextureResidency;
+	// defined object materials
+	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// interned texture and material tags, the ID of a tag is
+	// its texture slot or material index
+	TagRegistry m_textureTags;
+	TagRegistry m_materialTags;
+	// text scene description and its compiled binary twin
+	std::string m_sceneTextFilename;
+	std::string m_sceneBinaryFilename;
+	// mapped scene objects
+	SceneFile* m_pSceneFile;
+	// hierarchy and cached world matrices of the scene objects
+	SceneGraph* m_pSceneGraph;
+	// texture slot and material index of every scene object,
+	// resolved once when the scene is loaded (-1 when unset)
+	std::vector<int> m_objectTextureSlots;
+	std::vector<int> m_objectMaterialIndices;
+	// sort-keyed draw items of the current frame
+	RenderQueue* m_pRenderQueue;
+	// whether the render queue is sorted before drawing
+	bool m_bSortRenderQueue;
+	// camera position used for the depth part of the sort keys
+	glm::vec3 m_viewPosition;
+	// camera matrices and viewport height used for the screen
+	// size of the objects
+	glm::mat4 m_view;
+	glm::mat4 m_projection;
+	int m_viewportHeight;
+	// counters for the last drawn frame and for the periodic report
+	RENDER_STATS m_renderStats;
+	RENDER_STATS m_reportStats;
+	uint32_t m_reportFrames;
+	double m_reportStartTime;
+
+	// resolve the uniform handles of the shader program in use
+	void ResolveShaderUniforms();
+	// load texture images and convert to OpenGL texture data
+	bool CreateGLTexture(const char* filename, TAG_KEY tag);
+	// bind loaded OpenGL textures to slots in memory
+	void BindGLTextures();
+	// start decoding the textures of the given arrays, or of
+	// every array when none are given
+	void StartTextureLoads(const std::vector<uint32_t>& arrays);
+	// upload the textures decoded since the last frame
+	void UpdateTextureUploads();
+	// fit the resident mip levels to the screen size of the
+	// objects and to the texture budget
+	void UpdateTextureResidency();
+	// free the loaded OpenGL textures
+	void DestroyGLTextures();
+	// find a loaded texture by tag
+	int FindTextureID(TAG_KEY tag);
+	int FindTextureSlot(TAG_KEY tag);
+	// texture array of a loaded texture, -1 for no texture
+	int GetTextureArray(int textureSlot) const;
+	// array layer of a loaded texture
+	const TEXTURE_LAYER& GetTextureLayer(int textureSlot) const;
+	// print the memory the texture cache saved
+	void ReportTextureCache() const;
+	// add a material, unless its tag is already defined
+	bool AddObjectMaterial(const OBJECT_MATERIAL& material);
+	// find a defined material by tag, NULL when not defined
+	const OBJECT_MATERIAL* FindMaterial(TAG_KEY tag) const;
+	int FindMaterialIndex(TAG_KEY tag) const;
+
+	// set the transformation values 
+	// into the transform buffer
+	void SetTransformations(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// set a precomputed model matrix into the transform buffer
+	void SetModelMatrix(const glm::mat4& modelMatrix);
+
+	// set the color values into the shader
+	void SetShaderColor(
+		float redColorValue,
+		float greenColorValue,
+		float blueColorValue,
+		float alphaValue);
+
+	// set the texture data into the shader
+	void SetShaderTexture(
+		TAG_KEY textureTag);
+	void SetShaderTextureSlot(
+		int textureSlot);
+	// set a texture array for instanced draws, which select
+	// the layer per instance
+	void SetShaderTextureArray(
+		int textureArray);
+
+	// set the UV scale for the texture mapping
+	void SetTextureUVScale(
+		float u, float v);
+
+	// set the object material into the shader
+	void SetShaderMaterial(
+		TAG_KEY materialTag);
+	void SetShaderMaterialIndex(
+		int materialIndex);
+
+	// fill the light and material uniform blocks
+	void SetLightSource(
+		int lightIndex,
+		glm::vec3 position,
+		glm::vec3 ambientColor,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float focalStrength,
+		float specularIntensity);
+	void UploadLightBlock();
+	void UploadMaterialBlock();
+
+	// draw the basic mesh for a scene object mesh type
+	void DrawSceneMesh(uint32_t meshType);
+
+	// draw state of a queued scene object or static batch
+	struct DRAW_ITEM_STATE
+	{
+		const glm::mat4* pModel;
+		const float* pColor;
+		uint32_t meshType;
+		int textureSlot;
+		int materialIndex;
+	};
+
+	// merge the static objects into batches
+	void BuildStaticBatches();
+	// take moved objects out of their batches and bake the
+	// changed batches again
+	void UpdateStaticBatches();
+	// move the world bounds of the objects that moved
+	void UpdateCullingBounds();
+	// build the hierarchy over the drawable objects
+	void BuildSceneBVH();
+	// add the coarser tessellations of the curved shapes
+	void LoadLodMeshes();
+	// pick the tessellation of the visible curved objects
+	void SelectObjectLods();
+	// pick the objects that are drawn as occluders
+	void FindOccluders();
+	// find the objects and batches inside the view frustum
+	void CullSceneObjects();
+	// hide the visible objects and batches behind the occluders
+	void CullOccludedObjects();
+	// look up the draw state of a queued item
+	void GetDrawItemState(const RENDER_ITEM& item, DRAW_ITEM_STATE& state) const;
+
+	// submit the scene objects to the render queue
+	void BuildRenderQueue();
+	// draw the queued items, skipping redundant state changes
+	void DrawRenderQueue();
+	// draw runs of queued items that share a texture and mesh
+	// with one instanced draw call each
+	void DrawRenderQueueInstanced();
+	// print the averaged render counters every few seconds
+	void ReportRenderStats();
+
+public:
+
+	// select the text scene file to load in PrepareScene()
+	void SetSceneFile(const char* textFilename);
+	// set the camera position for ordering the draws by depth
+	void SetViewPosition(const glm::vec3& viewPosition);
+	// set the camera matrices for the screen size of objects
+	void SetViewProjection(const glm::mat4& view, const glm::mat4& projection, int viewportHeight);
+	// limit the memory of the texture arrays, 0 for no limit
+	void SetTextureBudget(uint64_t budgetBytes);
+	// add a texture before PrepareScene() lays out the arrays
+	bool AddSceneTexture(const char* filename, const char* tag);
+	// enable or disable sorting of the render queue
+	void SetRenderQueueSorting(bool bSort);
+	// enable or disable the instanced drawing of the queue
+	void SetInstancing(bool bInstancing);
+	// enable or disable the merging of static objects
+	void SetStaticBatching(bool bBatching);
+	// enable or disable skipping the objects outside the view
+	void SetFrustumCulling(bool bCulling);
+	// enable or disable skipping the objects behind occluders
+	void SetOcclusionCulling(bool bCulling);
+	// enable or disable the coarser tessellations of small objects
+	void SetLevelOfDetail(bool bLevelOfDetail);
+	// store the meshes in the packed vertex layout
+	void SetPackedVertices(bool bPacked);
+	// enable or disable reordering the generated meshes
+	void SetMeshOptimization(bool bOptimize);
+	// enable or disable keeping the generated meshes in a file
+	void SetMeshCache(bool bMeshCache);
+	// index of the nearest object whose bounds a ray hits
+	// within a distance, -1 when it hits none
+	int RaycastObject(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+	// counters for the last drawn frame
+	const RENDER_STATS& GetRenderStats() const { return(m_renderStats); }
+	// whether texture images are still being decoded and
+	// uploaded by the frames
+	bool IsLoadingTextures() const { return(m_pTextureLoader != NULL); }
+
+	// The following methods are for the students to 
+	// customize for their own 3D scene
+	void PrepareScene();
+	void RenderScene();
+	// loads textures from image files
+	void LoadSceneTextures();
+	// pre-set light sources for 3D scene
+	void SetupSceneLights();
+	// pre-define the object materials for lighting
+	void DefineObjectMaterials();
+	// load the scene objects from the scene file
+	bool LoadSceneObjects();
 };
\ No newline at end of file
@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderuniforms.cpp
+// ============
+// resolve the uniform locations of a linked shader program once
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderUniforms.h"
+#include "GLStateCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  ShaderUniforms()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderUniforms::ShaderUniforms()
+{
+	m_program = 0;
+}
+
+/***********************************************************
+ *  ~ShaderUniforms()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderUniforms::~ShaderUniforms()
+{
+}
+
+/***********************************************************
+ *  SetProgram()
+ *
+ *  This method is used for reading the locations of all of
+ *  the active uniforms of a linked program.  Array uniforms
+ *  are stored under both "name" and "name[0]".
+ ***********************************************************/
+void ShaderUniforms::SetProgram(GLuint program)
+{
+	m_program = program;
+	m_locations.clear();
+
+	if (0 == program)
+	{
+		return;
+	}
+
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	std::vector<GLchar> nameBuffer((size_t)maxNameLength + 1);
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLsizei nameLength = 0;
+		glGetActiveUniformName(program, (GLuint)i, (GLsizei)nameBuffer.size(), &nameLength, nameBuffer.data());
+		std::string uniformName(nameBuffer.data(), (size_t)nameLength);
+
+		// uniforms inside blocks have no location
+		GLint location = glGetUniformLocation(program, uniformName.c_str());
+		if (location < 0)
+		{
+			continue;
+		}
+
+		m_locations[uniformName] = location;
+		size_t arraySuffix = uniformName.rfind("[0]");
+		if ((arraySuffix != std::string::npos) && (arraySuffix + 3 == uniformName.size()))
+		{
+			m_locations[uniformName.substr(0, arraySuffix)] = location;
+		}
+	}
+}
+
+/***********************************************************
+ *  SetCurrentProgram()
+ *
+ *  This method is used for reading the uniform locations of
+ *  the program that is currently in use.
+ ***********************************************************/
+void ShaderUniforms::SetCurrentProgram()
+{
+	GLint program = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	SetProgram((GLuint)program);
+}
+
+/***********************************************************
+ *  FindLocation()
+ *
+ *  This method is used for looking up the location of a
+ *  uniform by name.
+ ***********************************************************/
+GLint ShaderUniforms::FindLocation(const char* uniformName) const
+{
+	std::unordered_map<std::string, GLint>::const_iterator found = m_locations.find(uniformName);
+	if (found == m_locations.end())
+	{
+		return(-1);
+	}
+	return(found->second);
+}
+
+/***********************************************************
+ *  Set()
+ *
+ *  These methods are used for setting a uniform of the
+ *  program in use through its resolved handle.  A value the
+ *  uniform already has is not sent again.
+ ***********************************************************/
+void ShaderUniforms::Set(UNIFORM_HANDLE<bool> handle, bool value)
+{
+	GLint intValue = value ? 1 : 0;
+	if (GLStateCache::UniformChanged(handle.location, &intValue, sizeof(intValue)))
+	{
+		glUniform1i(handle.location, intValue);
+	}
+}
+
+void ShaderUniforms::Set(UNIFORM_HANDLE<int> handle, int value)
+{
+	if (GLStateCache::UniformChanged(handle.location, &value, sizeof(value)))
+	{
+		glUniform1i(handle.location, value);
+	}
+}
+
+void ShaderUniforms::Set(UNIFORM_HANDLE<float> handle, float value)
+{
+	if (GLStateCache::UniformChanged(handle.location, &value, sizeof(value)))
+	{
+		glUniform1f(handle.location, value);
+	}
+}
+
+void ShaderUniforms::Set(UNIFORM_HANDLE<glm::vec2> handle, const glm::vec2& value)
+{
+	if (GLStateCache::UniformChanged(handle.location, &value, sizeof(value)))
+	{
+		glUniform2fv(handle.location, 1, glm::value_ptr(value));
+	}
+}
+
+void ShaderUniforms::Set(UNIFORM_HANDLE<glm::vec3> handle, const glm::vec3& value)
+{
+	if (GLStateCache::UniformChanged(handle.location, &value, sizeof(value)))
+	{
+		glUniform3fv(handle.location, 1, glm::value_ptr(value));
+	}
+}
+
+void ShaderUniforms::Set(UNIFORM_HANDLE<glm::vec4> handle, const glm::vec4& value)
+{
+	if (GLStateCache::UniformChanged(handle.location, &value, sizeof(value)))
+	{
+		glUniform4fv(handle.location, 1, glm::value_ptr(value));
+	}
+}
+
+void ShaderUniforms::Set(UNIFORM_HANDLE<glm::mat4> handle, const glm::mat4& value)
+{
+	if (GLStateCache::UniformChanged(handle.location, &value, sizeof(value)))
+	{
+		glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+	}
+}
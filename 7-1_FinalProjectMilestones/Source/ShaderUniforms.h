@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderuniforms.h
+// ============
+// resolve the uniform locations of a linked shader program once
+//
+// ShaderManager looks every uniform up by name on each set call.  This class
+// reads all of the active uniforms of the program when it is linked and hands
+// out typed handles, so the per-draw setters go straight to glUniform*().
+// Setting a uniform by name is kept as the slow path for one-off values.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <unordered_map>
+
+/***********************************************************
+ *  UNIFORM_HANDLE
+ *
+ *  Resolved location of a uniform of the given value type.
+ *  The location is -1 when the program has no such uniform,
+ *  which makes the set calls do nothing.
+ ***********************************************************/
+template <typename T>
+struct UNIFORM_HANDLE
+{
+	GLint location;
+
+	UNIFORM_HANDLE() : location(-1) {}
+	bool IsValid() const { return(location >= 0); }
+};
+
+/***********************************************************
+ *  ShaderUniforms
+ *
+ *  This class contains the uniform locations of one shader
+ *  program and the typed setters for them.
+ ***********************************************************/
+class ShaderUniforms
+{
+public:
+	// constructor
+	ShaderUniforms();
+	// destructor
+	~ShaderUniforms();
+
+	// read the active uniforms of a linked program, or of the
+	// program that is currently in use
+	void SetProgram(GLuint program);
+	void SetCurrentProgram();
+	GLuint GetProgram() const { return(m_program); }
+
+	// resolve a uniform by name into a typed handle
+	template <typename T>
+	UNIFORM_HANDLE<T> Find(const char* uniformName) const
+	{
+		UNIFORM_HANDLE<T> handle;
+		handle.location = FindLocation(uniformName);
+		return(handle);
+	}
+
+	// set a uniform of the program in use through its handle
+	static void Set(UNIFORM_HANDLE<bool> handle, bool value);
+	static void Set(UNIFORM_HANDLE<int> handle, int value);
+	static void Set(UNIFORM_HANDLE<float> handle, float value);
+	static void Set(UNIFORM_HANDLE<glm::vec2> handle, const glm::vec2& value);
+	static void Set(UNIFORM_HANDLE<glm::vec3> handle, const glm::vec3& value);
+	static void Set(UNIFORM_HANDLE<glm::vec4> handle, const glm::vec4& value);
+	static void Set(UNIFORM_HANDLE<glm::mat4> handle, const glm::mat4& value);
+
+	// slow path - look the uniform up by name on every call
+	template <typename T>
+	void SetByName(const char* uniformName, const T& value) const
+	{
+		Set(Find<T>(uniformName), value);
+	}
+
+private:
+	// program the locations belong to
+	GLuint m_program;
+	// location of every active uniform by name
+	std::unordered_map<std::string, GLint> m_locations;
+
+	// location of a uniform, -1 when it is not active
+	GLint FindLocation(const char* uniformName) const;
+};
@@ -0,0 +1,212 @@
+///////////////////////////////////////////////////////////////////////////////
+// staticbatcher.cpp
+// ============
+// merge the static scene objects into pre-transformed batches
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StaticBatcher.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  CanShareBatch()
+	 *
+	 *  Returns whether an object can be drawn with the state of
+	 *  a batch.  The color only matters without a texture.
+	 ***********************************************************/
+	bool CanShareBatch(const STATIC_BATCH& batch, int textureSlot, int materialIndex, const float* color)
+	{
+		if ((batch.textureSlot != textureSlot) || (batch.materialIndex != materialIndex))
+			return(false);
+		if (textureSlot >= 0)
+			return(true);
+		return(memcmp(batch.color, color, sizeof(batch.color)) == 0);
+	}
+}
+
+/***********************************************************
+ *  StaticBatcher()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StaticBatcher::StaticBatcher()
+{
+	m_batchedObjectCount = 0;
+
+	MeshGeometry::GeneratePlane(m_shapes[SCENE_MESH_PLANE]);
+	MeshGeometry::GenerateBox(m_shapes[SCENE_MESH_BOX]);
+	MeshGeometry::GenerateCylinder(m_shapes[SCENE_MESH_CYLINDER]);
+	MeshGeometry::GenerateTorus(m_shapes[SCENE_MESH_TORUS]);
+
+	// the batches keep the triangle order of their shapes
+	for (uint32_t shape = 0; shape < SCENE_MESH_COUNT; shape++)
+	{
+		MeshOptimizer::OptimizeMesh(m_shapes[shape]);
+	}
+}
+
+/***********************************************************
+ *  ~StaticBatcher()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StaticBatcher::~StaticBatcher()
+{
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for grouping the opaque scene objects
+ *  by their texture, material and color.  An object is added
+ *  to the first batch with the same state that still has
+ *  room for its vertices.  Transparent objects, and objects
+ *  that do not fit once the batch limit is reached, are left
+ *  to be drawn on their own.
+ ***********************************************************/
+void StaticBatcher::Build(
+	const SCENE_RECORD* pRecords,
+	uint32_t recordCount,
+	const int* pTextureSlots,
+	const int* pMaterialIndices,
+	uint32_t maxBatches,
+	uint32_t maxBatchVertices)
+{
+	m_batches.clear();
+	m_objectBatches.assign(recordCount, -1);
+	m_dirtyBatches.clear();
+	m_batchedObjectCount = 0;
+
+	for (uint32_t i = 0; i < recordCount; i++)
+	{
+		const SCENE_RECORD& record = pRecords[i];
+
+		// grouping nodes have nothing to draw, and transparent
+		// objects have to stay sorted back to front
+		if ((record.meshType >= SCENE_MESH_COUNT) || (record.color[3] < 1.0f))
+			continue;
+
+		uint32_t vertexCount = (uint32_t)m_shapes[record.meshType].vertices.size();
+		int batchIndex = -1;
+		for (size_t batch = 0; batch < m_batches.size(); batch++)
+		{
+			if ((m_batches[batch].vertexCount + vertexCount <= maxBatchVertices) &&
+				CanShareBatch(m_batches[batch], pTextureSlots[i], pMaterialIndices[i], record.color))
+			{
+				batchIndex = (int)batch;
+				break;
+			}
+		}
+
+		if (batchIndex < 0)
+		{
+			if ((m_batches.size() >= maxBatches) || (vertexCount > maxBatchVertices))
+				continue;
+
+			STATIC_BATCH batch;
+			batch.textureSlot = pTextureSlots[i];
+			batch.materialIndex = pMaterialIndices[i];
+			memcpy(batch.color, record.color, sizeof(batch.color));
+			batch.vertexCount = 0;
+
+			batchIndex = (int)m_batches.size();
+			m_batches.push_back(batch);
+			m_dirtyBatches.push_back((uint32_t)batchIndex);
+		}
+
+		m_batches[batchIndex].objects.push_back(i);
+		m_batches[batchIndex].vertexCount += vertexCount;
+		m_objectBatches[i] = batchIndex;
+		m_batchedObjectCount++;
+	}
+}
+
+/***********************************************************
+ *  BuildBatchMesh()
+ *
+ *  This method is used for baking the objects of a batch into
+ *  one mesh.  The positions and normals are transformed into
+ *  world space, so the batch is drawn with no model matrix.
+ ***********************************************************/
+void StaticBatcher::BuildBatchMesh(
+	uint32_t batch,
+	const SCENE_RECORD* pRecords,
+	const glm::mat4* pWorldMatrices,
+	MESH_DATA& batchMesh) const
+{
+	const STATIC_BATCH& staticBatch = m_batches[batch];
+
+	batchMesh.vertices.clear();
+	batchMesh.indices.clear();
+	batchMesh.vertices.reserve(staticBatch.vertexCount);
+
+	for (uint32_t object : staticBatch.objects)
+	{
+		const MESH_DATA& shape = m_shapes[pRecords[object].meshType];
+		const glm::mat4& world = pWorldMatrices[object];
+		glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+		uint32_t baseVertex = (uint32_t)batchMesh.vertices.size();
+
+		for (const MESH_VERTEX& vertex : shape.vertices)
+		{
+			glm::vec3 position = glm::vec3(world * glm::vec4(vertex.position[0], vertex.position[1], vertex.position[2], 1.0f));
+			glm::vec3 normal = glm::normalize(normalMatrix * glm::vec3(vertex.normal[0], vertex.normal[1], vertex.normal[2]));
+			MESH_VERTEX baked =
+			{
+				{ position.x, position.y, position.z },
+				{ normal.x, normal.y, normal.z },
+				{ vertex.uv[0], vertex.uv[1] }
+			};
+			batchMesh.vertices.push_back(baked);
+		}
+
+		for (uint32_t index : shape.indices)
+		{
+			batchMesh.indices.push_back(baseVertex + index);
+		}
+	}
+}
+
+/***********************************************************
+ *  RemoveObject()
+ *
+ *  This method is used for taking an object that started
+ *  moving out of its batch.  The batch is marked to be baked
+ *  again without it.
+ ***********************************************************/
+void StaticBatcher::RemoveObject(uint32_t object, uint32_t meshType)
+{
+	if (IsBatched(object) == false)
+	{
+		return;
+	}
+
+	uint32_t batch = (uint32_t)m_objectBatches[object];
+	STATIC_BATCH& staticBatch = m_batches[batch];
+	std::vector<uint32_t>::iterator found = std::find(staticBatch.objects.begin(), staticBatch.objects.end(), object);
+
+	staticBatch.objects.erase(found);
+	staticBatch.vertexCount -= (uint32_t)m_shapes[meshType].vertices.size();
+	m_objectBatches[object] = -1;
+	m_batchedObjectCount--;
+
+	if (std::find(m_dirtyBatches.begin(), m_dirtyBatches.end(), batch) == m_dirtyBatches.end())
+	{
+		m_dirtyBatches.push_back(batch);
+	}
+}
+
+/***********************************************************
+ *  ClearDirtyBatches()
+ *
+ *  This method is used for marking every batch as baked.
+ ***********************************************************/
+void StaticBatcher::ClearDirtyBatches()
+{
+	m_dirtyBatches.clear();
+}
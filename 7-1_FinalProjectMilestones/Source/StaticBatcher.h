@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+// staticbatcher.h
+// ============
+// merge the static scene objects into pre-transformed batches
+//
+// Opaque objects that share a texture, material and color are baked into
+// one mesh in world space when the scene is loaded, so they are drawn with
+// a single call.  An object that moves afterwards is taken out of its batch
+// and drawn on its own from then on.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshGeometry.h"
+#include "SceneFile.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  STATIC_BATCH
+ *
+ *  Draw state and objects of one merged batch.
+ ***********************************************************/
+struct STATIC_BATCH
+{
+	int textureSlot;
+	int materialIndex;
+	float color[4];
+	uint32_t vertexCount;
+	std::vector<uint32_t> objects;
+};
+
+/***********************************************************
+ *  StaticBatcher
+ *
+ *  This class contains the grouping of the static scene
+ *  objects into batches and builds their merged meshes.
+ ***********************************************************/
+class StaticBatcher
+{
+public:
+	// constructor
+	StaticBatcher();
+	// destructor
+	~StaticBatcher();
+
+	// group the opaque scene objects into at most maxBatches
+	// batches of at most maxBatchVertices vertices each
+	void Build(
+		const SCENE_RECORD* pRecords,
+		uint32_t recordCount,
+		const int* pTextureSlots,
+		const int* pMaterialIndices,
+		uint32_t maxBatches,
+		uint32_t maxBatchVertices);
+
+	// bake the objects of a batch into one world space mesh
+	void BuildBatchMesh(
+		uint32_t batch,
+		const SCENE_RECORD* pRecords,
+		const glm::mat4* pWorldMatrices,
+		MESH_DATA& batchMesh) const;
+
+	// take an object that started moving out of its batch
+	void RemoveObject(uint32_t object, uint32_t meshType);
+
+	// batches whose objects changed since they were last baked
+	const std::vector<uint32_t>& GetDirtyBatches() const { return(m_dirtyBatches); }
+	void ClearDirtyBatches();
+
+	// access the batches
+	bool IsBatched(uint32_t object) const { return((object < m_objectBatches.size()) && (m_objectBatches[object] >= 0)); }
+	int GetObjectBatch(uint32_t object) const { return((object < m_objectBatches.size()) ? m_objectBatches[object] : -1); }
+	uint32_t GetBatchCount() const { return((uint32_t)m_batches.size()); }
+	const STATIC_BATCH& GetBatch(uint32_t batch) const { return(m_batches[batch]); }
+	uint32_t GetBatchedObjectCount() const { return(m_batchedObjectCount); }
+
+private:
+	// source geometry of the basic shapes
+	MESH_DATA m_shapes[SCENE_MESH_COUNT];
+	// merged batches
+	std::vector<STATIC_BATCH> m_batches;
+	// batch of every scene object, -1 when drawn on its own
+	std::vector<int> m_objectBatches;
+	// batches that need to be baked again
+	std::vector<uint32_t> m_dirtyBatches;
+	// number of objects in all of the batches
+	uint32_t m_batchedObjectCount;
+};
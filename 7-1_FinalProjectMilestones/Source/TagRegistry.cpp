@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+// tagregistry.cpp
+// ============
+// intern the texture and material tags into small integer IDs
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TagRegistry.h"
+
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// table size before the first tag is interned
+	const uint32_t g_InitialTableSize = 32;
+}
+
+/***********************************************************
+ *  TagRegistry()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TagRegistry::TagRegistry()
+{
+	m_table.assign(g_InitialTableSize, TAG_ID_NONE);
+}
+
+/***********************************************************
+ *  ~TagRegistry()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TagRegistry::~TagRegistry()
+{
+}
+
+/***********************************************************
+ *  Intern()
+ *
+ *  This method is used for getting the ID of a tag.  A new
+ *  tag is copied and given the next ID.
+ ***********************************************************/
+TAG_ID TagRegistry::Intern(TAG_KEY key)
+{
+	TAG_ID tagID = Find(key);
+	if (tagID != TAG_ID_NONE)
+	{
+		return(tagID);
+	}
+
+	if ((m_texts.size() + 1) * 2 > m_table.size())
+	{
+		GrowTable();
+	}
+
+	tagID = (TAG_ID)m_texts.size();
+	m_texts.push_back(key.text);
+	m_hashes.push_back(key.hash);
+
+	uint32_t mask = (uint32_t)m_table.size() - 1;
+	uint32_t slot = key.hash & mask;
+	while (m_table[slot] != TAG_ID_NONE)
+	{
+		slot = (slot + 1) & mask;
+	}
+	m_table[slot] = tagID;
+
+	return(tagID);
+}
+
+/***********************************************************
+ *  Find()
+ *
+ *  This method is used for looking up the ID of a tag.  The
+ *  text is only compared when the hashes match.
+ ***********************************************************/
+TAG_ID TagRegistry::Find(TAG_KEY key) const
+{
+	uint32_t mask = (uint32_t)m_table.size() - 1;
+	uint32_t slot = key.hash & mask;
+
+	while (m_table[slot] != TAG_ID_NONE)
+	{
+		TAG_ID tagID = m_table[slot];
+		if ((m_hashes[tagID] == key.hash) && (strcmp(m_texts[tagID].c_str(), key.text) == 0))
+		{
+			return(tagID);
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	return(TAG_ID_NONE);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all of the tags.
+ ***********************************************************/
+void TagRegistry::Clear()
+{
+	m_texts.clear();
+	m_hashes.clear();
+	m_table.assign(g_InitialTableSize, TAG_ID_NONE);
+}
+
+/***********************************************************
+ *  GrowTable()
+ *
+ *  This method is used for doubling the hash table and
+ *  inserting the interned tags into it again.
+ ***********************************************************/
+void TagRegistry::GrowTable()
+{
+	m_table.assign(m_table.size() * 2, TAG_ID_NONE);
+
+	uint32_t mask = (uint32_t)m_table.size() - 1;
+	for (TAG_ID tagID = 0; tagID < (TAG_ID)m_hashes.size(); tagID++)
+	{
+		uint32_t slot = m_hashes[tagID] & mask;
+		while (m_table[slot] != TAG_ID_NONE)
+		{
+			slot = (slot + 1) & mask;
+		}
+		m_table[slot] = tagID;
+	}
+}
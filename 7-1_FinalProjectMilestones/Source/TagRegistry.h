@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+// tagregistry.h
+// ============
+// intern the texture and material tags into small integer IDs
+//
+// Every tag is stored once and given the next ID, which is also the index
+// of the texture slot or material it names.  Lookups hash the tag into an
+// open addressed table instead of comparing strings one by one, and the
+// hash of a string literal is computed by the compiler with the _tag suffix.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef uint32_t TAG_ID;
+
+// returned when a tag has not been interned
+const TAG_ID TAG_ID_NONE = 0xFFFFFFFF;
+
+/***********************************************************
+ *  HashTag()
+ *
+ *  Returns the 32-bit FNV-1a hash of a tag.  It can be
+ *  evaluated at compile time.
+ ***********************************************************/
+constexpr uint32_t HashTag(const char* text)
+{
+	uint32_t hash = 2166136261u;
+	while (*text != '\0')
+	{
+		hash = (hash ^ (uint8_t)*text) * 16777619u;
+		text++;
+	}
+	return(hash);
+}
+
+/***********************************************************
+ *  TAG_KEY
+ *
+ *  A tag together with its hash.  The text is not copied,
+ *  so it has to outlive the lookup.
+ ***********************************************************/
+struct TAG_KEY
+{
+	const char* text;
+	uint32_t hash;
+
+	constexpr TAG_KEY(const char* tagText) : text(tagText), hash(HashTag(tagText)) {}
+};
+
+/***********************************************************
+ *  operator"" _tag
+ *
+ *  Builds the key of a string literal at compile time, as
+ *  in SetShaderTexture("wood"_tag).
+ ***********************************************************/
+constexpr TAG_KEY operator"" _tag(const char* text, size_t)
+{
+	return(TAG_KEY(text));
+}
+
+/***********************************************************
+ *  TagRegistry
+ *
+ *  This class contains a set of interned tags and the hash
+ *  table for finding their IDs.
+ ***********************************************************/
+class TagRegistry
+{
+public:
+	// constructor
+	TagRegistry();
+	// destructor
+	~TagRegistry();
+
+	// return the ID of a tag, adding it when it is new
+	TAG_ID Intern(TAG_KEY key);
+	// return the ID of a tag, or TAG_ID_NONE
+	TAG_ID Find(TAG_KEY key) const;
+	// text of an interned tag
+	const char* GetText(TAG_ID tagID) const { return(m_texts[tagID].c_str()); }
+	// number of interned tags
+	uint32_t GetCount() const { return((uint32_t)m_texts.size()); }
+	// remove all of the tags
+	void Clear();
+
+private:
+	// text and hash of every tag by ID
+	std::vector<std::string> m_texts;
+	std::vector<uint32_t> m_hashes;
+	// open addressed table of tag IDs, a power of two in size
+	// and never more than half full
+	std::vector<TAG_ID> m_table;
+
+	// double the size of the table and insert the tags again
+	void GrowTable();
+};
@@ -0,0 +1,602 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearrays.cpp
+// ============
+// pack the scene textures into layers of 2D texture arrays
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureArrays.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// bytes per RGBA pixel
+	const int g_PixelSize = 4;
+
+	/***********************************************************
+	 *  ARRAY_SIZE
+	 *
+	 *  A texture size and the textures that use it.
+	 ***********************************************************/
+	struct ARRAY_SIZE
+	{
+		int width;
+		int height;
+		uint32_t textureCount;
+	};
+}
+
+/***********************************************************
+ *  TextureArrays()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureArrays::TextureArrays()
+{
+	m_uploadBuffer = 0;
+}
+
+/***********************************************************
+ *  ~TextureArrays()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureArrays::~TextureArrays()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for adding a texture by the size of
+ *  its image.  The pixels are uploaded later.
+ ***********************************************************/
+uint32_t TextureArrays::AddTexture(int width, int height)
+{
+	TEXTURE_LAYER layer = { -1, -1 };
+
+	m_widths.push_back(width);
+	m_heights.push_back(height);
+	m_layers.push_back(layer);
+	m_loaded.push_back(false);
+	m_pending.push_back(false);
+
+	return((uint32_t)m_layers.size() - 1);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for creating one texture array per
+ *  image size and giving every added texture a layer.  The
+ *  sizes used by the most textures get their own array, the
+ *  textures of the remaining sizes are resized to the kept
+ *  size with the closest area.
+ ***********************************************************/
+void TextureArrays::Build(uint32_t maxArrays)
+{
+	// count the textures of every size
+	std::vector<ARRAY_SIZE> sizes;
+	for (size_t i = 0; i < m_layers.size(); i++)
+	{
+		bool bFound = false;
+		for (ARRAY_SIZE& size : sizes)
+		{
+			if ((size.width == m_widths[i]) && (size.height == m_heights[i]))
+			{
+				size.textureCount++;
+				bFound = true;
+				break;
+			}
+		}
+		if (bFound == false)
+		{
+			ARRAY_SIZE size = { m_widths[i], m_heights[i], 1 };
+			sizes.push_back(size);
+		}
+	}
+
+	if (sizes.empty())
+	{
+		return;
+	}
+
+	// keep the most used sizes, the larger one on a tie
+	std::stable_sort(sizes.begin(), sizes.end(), [](const ARRAY_SIZE& a, const ARRAY_SIZE& b)
+	{
+		if (a.textureCount != b.textureCount)
+			return(a.textureCount > b.textureCount);
+		return(a.width * a.height > b.width * b.height);
+	});
+	if (sizes.size() > maxArrays)
+	{
+		sizes.resize(std::max(maxArrays, 1u));
+	}
+
+	// pick the array of every texture
+	std::vector<int> arrayLayers(sizes.size(), 0);
+	for (size_t i = 0; i < m_layers.size(); i++)
+	{
+		int arrayIndex = 0;
+		long long bestDifference = -1;
+		for (size_t size = 0; size < sizes.size(); size++)
+		{
+			if ((sizes[size].width == m_widths[i]) && (sizes[size].height == m_heights[i]))
+			{
+				arrayIndex = (int)size;
+				break;
+			}
+
+			long long difference = std::llabs(
+				(long long)sizes[size].width * sizes[size].height -
+				(long long)m_widths[i] * m_heights[i]);
+			if ((bestDifference < 0) || (difference < bestDifference))
+			{
+				arrayIndex = (int)size;
+				bestDifference = difference;
+			}
+		}
+
+		if ((sizes[arrayIndex].width != m_widths[i]) || (sizes[arrayIndex].height != m_heights[i]))
+		{
+			std::cout << "INFO: resizing texture " << i << " from " << m_widths[i] << "x" << m_heights[i]
+				<< " to " << sizes[arrayIndex].width << "x" << sizes[arrayIndex].height << std::endl;
+		}
+
+		m_layers[i].arrayIndex = arrayIndex;
+		m_layers[i].layer = arrayLayers[arrayIndex]++;
+	}
+
+	GLint maxLayers = 0;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+	// create the arrays, the layers are filled as they arrive
+	m_arrays.assign(sizes.size(), 0);
+	m_arrayWidths.assign(sizes.size(), 0);
+	m_arrayHeights.assign(sizes.size(), 0);
+	m_arrayLayerCounts.assign(sizes.size(), 0);
+	m_residentLevels.assign(sizes.size(), 0);
+	m_pendingLayers.assign(sizes.size(), 0);
+	m_baseLevels.assign(sizes.size(), 0);
+	m_changedArrays.assign(sizes.size(), false);
+	for (size_t arrayIndex = 0; arrayIndex < m_arrays.size(); arrayIndex++)
+	{
+		if (arrayLayers[arrayIndex] > maxLayers)
+		{
+			std::cout << "Texture array " << arrayIndex << " needs " << arrayLayers[arrayIndex]
+				<< " layers, only " << maxLayers << " are supported" << std::endl;
+		}
+
+		m_arrayWidths[arrayIndex] = sizes[arrayIndex].width;
+		m_arrayHeights[arrayIndex] = sizes[arrayIndex].height;
+		m_arrayLayerCounts[arrayIndex] = (uint32_t)arrayLayers[arrayIndex];
+		m_arrays[arrayIndex] = CreateArray((uint32_t)arrayIndex, 0);
+
+		std::cout << "INFO: texture array " << arrayIndex << ": " << sizes[arrayIndex].width << "x"
+			<< sizes[arrayIndex].height << ", " << arrayLayers[arrayIndex] << " layers" << std::endl;
+	}
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	glGenBuffers(1, &m_uploadBuffer);
+}
+
+/***********************************************************
+ *  CreateArray()
+ *
+ *  This method is used for creating the storage of an array
+ *  with its mip levels from the given level down to 1x1.
+ *  Every level is allocated up front, so the levels of
+ *  cooked textures can be uploaded directly.
+ ***********************************************************/
+GLuint TextureArrays::CreateArray(uint32_t arrayIndex, int level) const
+{
+	int width = std::max(m_arrayWidths[arrayIndex] >> level, 1);
+	int height = std::max(m_arrayHeights[arrayIndex] >> level, 1);
+	int levelCount = GetMipLevelCount(width, height);
+	GLsizei layerCount = (GLsizei)m_arrayLayerCounts[arrayIndex];
+
+	GLuint arrayID = 0;
+	glGenTextures(1, &arrayID);
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, arrayID);
+	if (GLEW_ARB_texture_storage)
+	{
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, levelCount, GL_RGBA8, width, height, layerCount);
+	}
+	else
+	{
+		for (int arrayLevel = 0; arrayLevel < levelCount; arrayLevel++)
+		{
+			glTexImage3D(
+				GL_TEXTURE_2D_ARRAY, arrayLevel, GL_RGBA8,
+				std::max(width >> arrayLevel, 1), std::max(height >> arrayLevel, 1), layerCount,
+				0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		}
+	}
+
+	// set the texture wrapping and filtering parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	return(arrayID);
+}
+
+/***********************************************************
+ *  GetLayerSize()
+ *
+ *  This method is used for getting the resident size of the
+ *  layer of a texture.
+ ***********************************************************/
+void TextureArrays::GetLayerSize(uint32_t texture, int& width, int& height) const
+{
+	int arrayIndex = m_layers[texture].arrayIndex;
+	int level = m_residentLevels[arrayIndex];
+
+	width = std::max(m_arrayWidths[arrayIndex] >> level, 1);
+	height = std::max(m_arrayHeights[arrayIndex] >> level, 1);
+}
+
+/***********************************************************
+ *  SetResidentLevel()
+ *
+ *  This method is used for changing the first resident mip
+ *  level of an array.  The array is created again at the
+ *  size of that level, and the levels both versions have in
+ *  common are copied over on the GPU.  When finer levels are
+ *  added, the copied level is sampled until every layer has
+ *  been uploaded again.  Without glCopyImageSubData nothing
+ *  is copied and the textures are drawn without their image
+ *  until they are uploaded again.
+ ***********************************************************/
+bool TextureArrays::SetResidentLevel(uint32_t arrayIndex, int level)
+{
+	int fullLevelCount = GetLevelCount(arrayIndex);
+	int oldLevel = m_residentLevels[arrayIndex];
+	level = std::min(std::max(level, 0), fullLevelCount - 1);
+	if (level == oldLevel)
+	{
+		return(false);
+	}
+
+	GLuint oldArray = m_arrays[arrayIndex];
+	GLuint newArray = CreateArray(arrayIndex, level);
+	bool bCopied = false;
+	if (GLEW_ARB_copy_image)
+	{
+		// level n of the new array is level n + level - oldLevel of the old one
+		for (int newLevel = std::max(oldLevel - level, 0); newLevel < fullLevelCount - level; newLevel++)
+		{
+			glCopyImageSubData(
+				oldArray, GL_TEXTURE_2D_ARRAY, newLevel + level - oldLevel, 0, 0, 0,
+				newArray, GL_TEXTURE_2D_ARRAY, newLevel, 0, 0, 0,
+				std::max(m_arrayWidths[arrayIndex] >> (newLevel + level), 1),
+				std::max(m_arrayHeights[arrayIndex] >> (newLevel + level), 1),
+				(GLsizei)m_arrayLayerCounts[arrayIndex]);
+		}
+		bCopied = true;
+	}
+	GLStateCache::DeleteTextures(1, &oldArray);
+	m_arrays[arrayIndex] = newArray;
+	m_residentLevels[arrayIndex] = level;
+	m_baseLevels[arrayIndex] = 0;
+	m_pendingLayers[arrayIndex] = 0;
+
+	bool bReload = (bCopied == false) || (level < oldLevel);
+	if (bReload)
+	{
+		for (size_t texture = 0; texture < m_layers.size(); texture++)
+		{
+			if (m_layers[texture].arrayIndex != (int)arrayIndex)
+				continue;
+
+			if (bCopied == false)
+			{
+				m_loaded[texture] = false;
+			}
+			m_pending[texture] = true;
+			m_pendingLayers[arrayIndex]++;
+		}
+
+		if (bCopied)
+		{
+			m_baseLevels[arrayIndex] = oldLevel - level;
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, m_baseLevels[arrayIndex]);
+		}
+	}
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// the new array takes the place of the old one on its unit
+	Bind();
+
+	return(bReload);
+}
+
+/***********************************************************
+ *  GetArrayBytes()
+ *
+ *  This method is used for getting the memory of an array
+ *  with its mip levels from the given level on.
+ ***********************************************************/
+uint64_t TextureArrays::GetArrayBytes(uint32_t arrayIndex, int level) const
+{
+	uint64_t layerBytes = 0;
+	for (int arrayLevel = level; arrayLevel < GetLevelCount(arrayIndex); arrayLevel++)
+	{
+		layerBytes += (uint64_t)std::max(m_arrayWidths[arrayIndex] >> arrayLevel, 1) *
+			std::max(m_arrayHeights[arrayIndex] >> arrayLevel, 1) * g_PixelSize;
+	}
+
+	return(layerBytes * m_arrayLayerCounts[arrayIndex]);
+}
+
+/***********************************************************
+ *  GetResidentBytes()
+ *
+ *  This method is used for getting the memory of all of the
+ *  arrays at their resident levels.
+ ***********************************************************/
+uint64_t TextureArrays::GetResidentBytes() const
+{
+	uint64_t residentBytes = 0;
+	for (uint32_t arrayIndex = 0; arrayIndex < GetArrayCount(); arrayIndex++)
+	{
+		residentBytes += GetArrayBytes(arrayIndex, m_residentLevels[arrayIndex]);
+	}
+
+	return(residentBytes);
+}
+
+/***********************************************************
+ *  UploadLayer()
+ *
+ *  This method is used for copying the pixels of a texture
+ *  into its layer.  The mipmaps of its array are generated
+ *  by the next FinishUploads().
+ ***********************************************************/
+bool TextureArrays::UploadLayer(uint32_t texture, const unsigned char* pPixels, int width, int height)
+{
+	if (CopyToLayer(texture, 0, pPixels, width, height) == false)
+	{
+		return(false);
+	}
+
+	m_loaded[texture] = true;
+	m_changedArrays[m_layers[texture].arrayIndex] = true;
+	MarkUploaded(texture);
+	return(true);
+}
+
+/***********************************************************
+ *  UploadLayerLevel()
+ *
+ *  This method is used for copying one mip level of a cooked
+ *  texture into its layer.  The texture counts as loaded once
+ *  its first level is in.
+ ***********************************************************/
+bool TextureArrays::UploadLayerLevel(uint32_t texture, int level, const unsigned char* pPixels, int width, int height)
+{
+	if (CopyToLayer(texture, level, pPixels, width, height) == false)
+	{
+		return(false);
+	}
+
+	if (level == 0)
+	{
+		m_loaded[texture] = true;
+		MarkUploaded(texture);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  MarkUploaded()
+ *
+ *  This method is used for counting down the layers of an
+ *  array that are being streamed in.
+ ***********************************************************/
+void TextureArrays::MarkUploaded(uint32_t texture)
+{
+	if (m_pending[texture])
+	{
+		m_pending[texture] = false;
+		m_pendingLayers[m_layers[texture].arrayIndex]--;
+	}
+}
+
+/***********************************************************
+ *  CopyToLayer()
+ *
+ *  This method is used for copying the pixels of a mip level
+ *  into the layer of a texture.  The pixels are written into
+ *  a freshly orphaned pixel buffer, so the copy to the
+ *  texture can run on the GPU while the next one is written.
+ *  The level counts from the first resident level of the
+ *  array, and pixels of another size, like an image decoded
+ *  before the array was resized, are not copied.
+ ***********************************************************/
+bool TextureArrays::CopyToLayer(uint32_t texture, int level, const unsigned char* pPixels, int width, int height)
+{
+	const TEXTURE_LAYER& layer = m_layers[texture];
+	int arrayLevel = m_residentLevels[layer.arrayIndex] + level;
+	int levelWidth = std::max(m_arrayWidths[layer.arrayIndex] >> arrayLevel, 1);
+	int levelHeight = std::max(m_arrayHeights[layer.arrayIndex] >> arrayLevel, 1);
+	if ((pPixels == NULL) || (width != levelWidth) || (height != levelHeight))
+	{
+		return(false);
+	}
+
+	GLsizeiptr layerBytes = (GLsizeiptr)width * height * g_PixelSize;
+	bool bCopied = false;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_uploadBuffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, layerBytes, NULL, GL_STREAM_DRAW);
+	void* pMapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, layerBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (pMapped != NULL)
+	{
+		memcpy(pMapped, pPixels, (size_t)layerBytes);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+		// with a pixel buffer bound the data pointer is an offset
+		GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, m_arrays[layer.arrayIndex]);
+		glTexSubImage3D(
+			GL_TEXTURE_2D_ARRAY, level, 0, 0, layer.layer,
+			width, height, 1,
+			GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+		bCopied = true;
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	return(bCopied);
+}
+
+/***********************************************************
+ *  FinishUploads()
+ *
+ *  This method is used for generating the mipmaps of every
+ *  array that had layers uploaded, once per frame.  An array
+ *  that is being streamed in waits for all of its layers,
+ *  then samples its new first level.
+ ***********************************************************/
+void TextureArrays::FinishUploads()
+{
+	for (size_t arrayIndex = 0; arrayIndex < m_arrays.size(); arrayIndex++)
+	{
+		if (m_pendingLayers[arrayIndex] > 0)
+			continue;
+
+		GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, m_arrays[arrayIndex]);
+		if (m_baseLevels[arrayIndex] != 0)
+		{
+			m_baseLevels[arrayIndex] = 0;
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+		}
+		if (m_changedArrays[arrayIndex])
+		{
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+			m_changedArrays[arrayIndex] = false;
+		}
+	}
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// the arrays stay bound to their texture units
+	Bind();
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for binding every texture array to
+ *  the texture unit of the same index.
+ ***********************************************************/
+void TextureArrays::Bind() const
+{
+	for (size_t arrayIndex = 0; arrayIndex < m_arrays.size(); arrayIndex++)
+	{
+		GLStateCache::BindTextureUnit((GLuint)arrayIndex, GL_TEXTURE_2D_ARRAY, m_arrays[arrayIndex]);
+	}
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the texture arrays and
+ *  forgetting the added textures.
+ ***********************************************************/
+void TextureArrays::Destroy()
+{
+	if (!m_arrays.empty())
+	{
+		GLStateCache::DeleteTextures((GLsizei)m_arrays.size(), m_arrays.data());
+		m_arrays.clear();
+	}
+	if (m_uploadBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_uploadBuffer);
+		m_uploadBuffer = 0;
+	}
+	m_widths.clear();
+	m_heights.clear();
+	m_layers.clear();
+	m_loaded.clear();
+	m_pending.clear();
+	m_arrayWidths.clear();
+	m_arrayHeights.clear();
+	m_arrayLayerCounts.clear();
+	m_residentLevels.clear();
+	m_pendingLayers.clear();
+	m_baseLevels.clear();
+	m_changedArrays.clear();
+}
+
+/***********************************************************
+ *  GetMipLevelCount()
+ *
+ *  This method is used for counting the mip levels of an
+ *  image, halving the larger side until it reaches 1.
+ ***********************************************************/
+int TextureArrays::GetMipLevelCount(int width, int height)
+{
+	int levelCount = 1;
+	for (int size = std::max(width, height); size > 1; size /= 2)
+	{
+		levelCount++;
+	}
+
+	return(levelCount);
+}
+
+/***********************************************************
+ *  ResizeImage()
+ *
+ *  This method is used for resampling RGBA pixels to a new
+ *  size with bilinear filtering.  The texture wraps, so the
+ *  samples wrap around the edges too.
+ ***********************************************************/
+void TextureArrays::ResizeImage(std::vector<unsigned char>& pixels, int width, int height, int newWidth, int newHeight)
+{
+	std::vector<unsigned char> resized((size_t)newWidth * newHeight * g_PixelSize);
+
+	float scaleX = (float)width / (float)newWidth;
+	float scaleY = (float)height / (float)newHeight;
+
+	for (int y = 0; y < newHeight; y++)
+	{
+		float sourceY = ((float)y + 0.5f) * scaleY - 0.5f;
+		int y0 = (int)std::floor(sourceY);
+		float fy = sourceY - (float)y0;
+		int row0 = (y0 + height) % height;
+		int row1 = (y0 + 1 + height) % height;
+
+		for (int x = 0; x < newWidth; x++)
+		{
+			float sourceX = ((float)x + 0.5f) * scaleX - 0.5f;
+			int x0 = (int)std::floor(sourceX);
+			float fx = sourceX - (float)x0;
+			int column0 = (x0 + width) % width;
+			int column1 = (x0 + 1 + width) % width;
+
+			const unsigned char* p00 = &pixels[((size_t)row0 * width + column0) * g_PixelSize];
+			const unsigned char* p10 = &pixels[((size_t)row0 * width + column1) * g_PixelSize];
+			const unsigned char* p01 = &pixels[((size_t)row1 * width + column0) * g_PixelSize];
+			const unsigned char* p11 = &pixels[((size_t)row1 * width + column1) * g_PixelSize];
+			unsigned char* pOut = &resized[((size_t)y * newWidth + x) * g_PixelSize];
+
+			for (int channel = 0; channel < g_PixelSize; channel++)
+			{
+				float top = p00[channel] + (p10[channel] - p00[channel]) * fx;
+				float bottom = p01[channel] + (p11[channel] - p01[channel]) * fx;
+				pOut[channel] = (unsigned char)(top + (bottom - top) * fy + 0.5f);
+			}
+		}
+	}
+
+	pixels.swap(resized);
+}
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearrays.h
+// ============
+// pack the scene textures into layers of 2D texture arrays
+//
+// Textures of the same size share one GL_TEXTURE_2D_ARRAY, and every array
+// stays bound to its own texture unit.  A draw selects its texture with the
+// array and a layer index, so the number of textures is not limited by the
+// texture units and objects in the same array can be drawn together.
+//
+// The arrays are laid out from the image sizes alone, and the pixels of
+// every layer are streamed in afterwards through a pixel buffer object as
+// the images finish decoding.  A cooked texture brings its own mip levels,
+// which are uploaded as they are instead of being generated.
+//
+// To save memory an array can keep only its coarser mip levels resident.
+// The array is then allocated at the size of the first resident level, and
+// the finer levels are streamed back in by uploading its layers again.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  TEXTURE_LAYER
+ *
+ *  Location of a texture - the array, which is also its
+ *  texture unit, and the layer inside the array.
+ ***********************************************************/
+struct TEXTURE_LAYER
+{
+	int arrayIndex;
+	int layer;
+};
+
+/***********************************************************
+ *  TextureArrays
+ *
+ *  This class contains the texture arrays of the scene and
+ *  the layer of every loaded texture.
+ ***********************************************************/
+class TextureArrays
+{
+public:
+	// constructor
+	TextureArrays();
+	// destructor
+	~TextureArrays();
+
+	// add a texture of the given image size and return its index
+	uint32_t AddTexture(int width, int height);
+
+	// create the arrays for the added textures.  When there are
+	// more image sizes than maxArrays the least used sizes are
+	// resized to the closest kept size
+	void Build(uint32_t maxArrays);
+	// resident size of the layer of a texture, which its image
+	// has to be resized to
+	void GetLayerSize(uint32_t texture, int& width, int& height) const;
+
+	// keep the mip levels of an array from the given level on
+	// resident.  The kept levels are copied, true when the
+	// layers have to be uploaded again at the new size
+	bool SetResidentLevel(uint32_t arrayIndex, int level);
+	int GetResidentLevel(uint32_t arrayIndex) const { return(m_residentLevels[arrayIndex]); }
+	// mip levels of an array at full size
+	int GetLevelCount(uint32_t arrayIndex) const { return(GetMipLevelCount(m_arrayWidths[arrayIndex], m_arrayHeights[arrayIndex])); }
+	// memory of an array with the given first resident level,
+	// and of all of the arrays as they are
+	uint64_t GetArrayBytes(uint32_t arrayIndex, int level) const;
+	uint64_t GetResidentBytes() const;
+
+	// copy the RGBA pixels of a texture into its layer through
+	// the pixel buffer, then regenerate the mipmaps of the
+	// changed arrays once all of the frame's uploads are done.
+	// Pixels of another size than the resident layer are
+	// rejected, which returns false.
+	bool UploadLayer(uint32_t texture, const unsigned char* pPixels, int width, int height);
+	void FinishUploads();
+	// copy the RGBA pixels of one mip level of a texture into
+	// its layer, the mipmaps are not generated for it.  The
+	// level counts from the resident level.
+	bool UploadLayerLevel(uint32_t texture, int level, const unsigned char* pPixels, int width, int height);
+	// whether the pixels of a texture have been uploaded
+	bool IsLoaded(uint32_t texture) const { return(m_loaded[texture]); }
+
+	// number of mip levels down to 1x1 for an image size
+	static int GetMipLevelCount(int width, int height);
+	// resample RGBA pixels to a new size with bilinear filtering
+	static void ResizeImage(std::vector<unsigned char>& pixels, int width, int height, int newWidth, int newHeight);
+	// bind every array to the texture unit of the same index
+	void Bind() const;
+	// free the arrays and the added images
+	void Destroy();
+
+	// access the textures and arrays
+	uint32_t GetTextureCount() const { return((uint32_t)m_layers.size()); }
+	const TEXTURE_LAYER& GetLayer(uint32_t texture) const { return(m_layers[texture]); }
+	uint32_t GetArrayCount() const { return((uint32_t)m_arrays.size()); }
+	GLuint GetArrayID(uint32_t arrayIndex) const { return(m_arrays[arrayIndex]); }
+	uint32_t GetArrayLayerCount(uint32_t arrayIndex) const { return(m_arrayLayerCounts[arrayIndex]); }
+
+private:
+	// image size and layer of every texture
+	std::vector<int> m_widths;
+	std::vector<int> m_heights;
+	std::vector<TEXTURE_LAYER> m_layers;
+	std::vector<bool> m_loaded;
+	// textures waiting to be uploaded at a finer level
+	std::vector<bool> m_pending;
+	// texture array names and full sizes, bound to units 0 and up
+	std::vector<GLuint> m_arrays;
+	std::vector<int> m_arrayWidths;
+	std::vector<int> m_arrayHeights;
+	std::vector<uint32_t> m_arrayLayerCounts;
+	// first resident mip level of every array, the number of
+	// its layers still to be streamed in and the level that
+	// is sampled until they are
+	std::vector<int> m_residentLevels;
+	std::vector<uint32_t> m_pendingLayers;
+	std::vector<int> m_baseLevels;
+	// arrays with layers uploaded since the last FinishUploads()
+	std::vector<bool> m_changedArrays;
+	// pixel buffer the layers are streamed through
+	GLuint m_uploadBuffer;
+
+	// create the storage of an array from the given mip level
+	GLuint CreateArray(uint32_t arrayIndex, int level) const;
+	// stream the pixels of a mip level into the layer of a texture
+	bool CopyToLayer(uint32_t texture, int level, const unsigned char* pPixels, int width, int height);
+	// count a streamed in texture as uploaded
+	void MarkUploaded(uint32_t texture);
+};
@@ -0,0 +1,199 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.cpp
+// ============
+// share one texture between requests for the same image
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+/***********************************************************
+ *  TextureCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureCache::TextureCache()
+{
+	m_requestCount = 0;
+}
+
+/***********************************************************
+ *  ~TextureCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureCache::~TextureCache()
+{
+}
+
+/***********************************************************
+ *  CanonicalPath()
+ *
+ *  This method is used for turning a relative image path
+ *  into an absolute one.  On Windows the separators are
+ *  unified and the case is folded, since the file system
+ *  ignores case.
+ ***********************************************************/
+std::string TextureCache::CanonicalPath(const char* filename)
+{
+	std::string canonicalPath = filename;
+
+#ifdef _WIN32
+	char fullPath[_MAX_PATH];
+	if (_fullpath(fullPath, filename, _MAX_PATH) != NULL)
+	{
+		canonicalPath = fullPath;
+	}
+	std::replace(canonicalPath.begin(), canonicalPath.end(), '/', '\\');
+	std::transform(canonicalPath.begin(), canonicalPath.end(), canonicalPath.begin(),
+		[](char c) { return((char)tolower((unsigned char)c)); });
+#else
+	char fullPath[PATH_MAX];
+	if (realpath(filename, fullPath) != NULL)
+	{
+		canonicalPath = fullPath;
+	}
+#endif
+
+	return(canonicalPath);
+}
+
+/***********************************************************
+ *  ReadFile()
+ *
+ *  This method is used for reading the whole contents of a
+ *  file.
+ ***********************************************************/
+bool TextureCache::ReadFile(const char* filename, std::vector<unsigned char>& contents)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file)
+	{
+		return(false);
+	}
+
+	file.seekg(0, std::ios::end);
+	std::streamoff fileSize = file.tellg();
+	file.seekg(0, std::ios::beg);
+	if (fileSize <= 0)
+	{
+		return(false);
+	}
+
+	contents.resize((size_t)fileSize);
+	file.read((char*)contents.data(), fileSize);
+
+	return(file.gcount() == fileSize);
+}
+
+/***********************************************************
+ *  HashContents()
+ *
+ *  This method is used for hashing the contents of a file.
+ ***********************************************************/
+uint64_t TextureCache::HashContents(const std::vector<unsigned char>& contents)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (unsigned char byte : contents)
+	{
+		hash = (hash ^ byte) * 1099511628211ull;
+	}
+	return(hash);
+}
+
+/***********************************************************
+ *  FindPath()
+ *
+ *  This method is used for finding the texture loaded from
+ *  a canonical path.
+ ***********************************************************/
+int TextureCache::FindPath(const std::string& canonicalPath) const
+{
+	std::unordered_map<std::string, uint32_t>::const_iterator found = m_paths.find(canonicalPath);
+	if (found == m_paths.end())
+	{
+		return(-1);
+	}
+	return((int)found->second);
+}
+
+/***********************************************************
+ *  FindContents()
+ *
+ *  This method is used for finding a texture loaded from a
+ *  file with the same contents.  The hash only picks the
+ *  candidate, its file is read again and compared byte for
+ *  byte so a collision cannot share the wrong image.
+ ***********************************************************/
+int TextureCache::FindContents(uint64_t contentHash, const std::vector<unsigned char>& contents) const
+{
+	CONTENT_KEY key = { contentHash, (uint64_t)contents.size() };
+	std::unordered_map<CONTENT_KEY, uint32_t, CONTENT_KEY_HASH>::const_iterator found = m_contents.find(key);
+	if (found == m_contents.end())
+	{
+		return(-1);
+	}
+
+	std::vector<unsigned char> loadedContents;
+	if ((ReadFile(m_filenames[found->second].c_str(), loadedContents) == false) ||
+		(loadedContents.size() != contents.size()) ||
+		(memcmp(loadedContents.data(), contents.data(), contents.size()) != 0))
+	{
+		return(-1);
+	}
+	return((int)found->second);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for remembering a newly loaded
+ *  texture by its path and its contents.
+ ***********************************************************/
+void TextureCache::AddTexture(uint32_t texture, const std::string& canonicalPath, uint64_t contentHash, size_t contentSize, const char* filename)
+{
+	CONTENT_KEY key = { contentHash, (uint64_t)contentSize };
+
+	if (texture >= m_filenames.size())
+	{
+		m_filenames.resize(texture + 1);
+		m_aliasCounts.resize(texture + 1, 0);
+	}
+	m_filenames[texture] = filename;
+	m_paths[canonicalPath] = texture;
+	m_contents[key] = texture;
+	m_requestCount++;
+}
+
+/***********************************************************
+ *  AddAlias()
+ *
+ *  This method is used for counting a request answered with
+ *  an already loaded texture and remembering its path.
+ ***********************************************************/
+void TextureCache::AddAlias(uint32_t texture, const std::string& canonicalPath)
+{
+	m_paths[canonicalPath] = texture;
+	m_aliasCounts[texture]++;
+	m_requestCount++;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for forgetting every texture.
+ ***********************************************************/
+void TextureCache::Clear()
+{
+	m_paths.clear();
+	m_contents.clear();
+	m_filenames.clear();
+	m_aliasCounts.clear();
+	m_requestCount = 0;
+}
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.h
+// ============
+// share one texture between requests for the same image
+//
+// Loaded images are remembered by their canonical path and by a hash of the
+// file contents.  A request for an image that is already loaded, under any
+// path, returns the existing texture so the new tag becomes an alias of it
+// instead of decoding and uploading the image again.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  TextureCache
+ *
+ *  This class contains the loaded texture images by path
+ *  and by content.
+ ***********************************************************/
+class TextureCache
+{
+public:
+	// constructor
+	TextureCache();
+	// destructor
+	~TextureCache();
+
+	// absolute, normalized path of an image file
+	static std::string CanonicalPath(const char* filename);
+	// read a whole file, false when it cannot be read
+	static bool ReadFile(const char* filename, std::vector<unsigned char>& contents);
+	// 64-bit FNV-1a hash of the file contents
+	static uint64_t HashContents(const std::vector<unsigned char>& contents);
+
+	// texture of an already loaded path or contents, or -1.
+	// A texture with the same hash is only returned when its
+	// file holds the same bytes.
+	int FindPath(const std::string& canonicalPath) const;
+	int FindContents(uint64_t contentHash, const std::vector<unsigned char>& contents) const;
+
+	// remember a newly loaded texture
+	void AddTexture(uint32_t texture, const std::string& canonicalPath, uint64_t contentHash, size_t contentSize, const char* filename);
+	// remember another path of a loaded texture and count the
+	// request that was answered from the cache
+	void AddAlias(uint32_t texture, const std::string& canonicalPath);
+
+	// file an added texture is loaded from
+	const char* GetFilename(uint32_t texture) const { return(m_filenames[texture].c_str()); }
+	// number of requests answered from the cache for a texture
+	uint32_t GetAliasCount(uint32_t texture) const { return(m_aliasCounts[texture]); }
+	// number of requests and of distinct textures
+	uint32_t GetRequestCount() const { return(m_requestCount); }
+	uint32_t GetTextureCount() const { return((uint32_t)m_filenames.size()); }
+
+	// forget every texture
+	void Clear();
+
+private:
+	// key of the contents map - the hash and the file size
+	struct CONTENT_KEY
+	{
+		uint64_t hash;
+		uint64_t size;
+
+		bool operator==(const CONTENT_KEY& other) const { return((hash == other.hash) && (size == other.size)); }
+	};
+	struct CONTENT_KEY_HASH
+	{
+		size_t operator()(const CONTENT_KEY& key) const { return((size_t)(key.hash ^ (key.size * 0x9E3779B97F4A7C15ull))); }
+	};
+
+	// texture of every canonical path and of every content
+	std::unordered_map<std::string, uint32_t> m_paths;
+	std::unordered_map<CONTENT_KEY, uint32_t, CONTENT_KEY_HASH> m_contents;
+	// file and alias count of every texture
+	std::vector<std::string> m_filenames;
+	std::vector<uint32_t> m_aliasCounts;
+	// number of load requests
+	uint32_t m_requestCount;
+};
@@ -0,0 +1,404 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecooker.cpp
+// ============
+// convert texture images offline into GPU-ready files with mipmaps
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCooker.h"
+#include "ImageKernels.h"
+#include "TextureArrays.h"
+#include "TextureLoader.h"
+
+#include <GL/glew.h>
+#include "stb_image.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// bytes per RGBA pixel
+	const int g_PixelSize = 4;
+
+	// first bytes of every KTX 1.1 file
+	const unsigned char g_KTXIdentifier[12] =
+	{
+		0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+	};
+	// written as 0x04030201 by a file of the same byte order
+	const uint32_t g_KTXEndianness = 0x04030201;
+
+	/***********************************************************
+	 *  KTX_HEADER
+	 *
+	 *  Header of a KTX 1.1 file.  The image data follows the
+	 *  key and value data, one level after the other, each
+	 *  starting with its size in bytes.
+	 ***********************************************************/
+	struct KTX_HEADER
+	{
+		unsigned char identifier[12];
+		uint32_t endianness;
+		uint32_t glType;
+		uint32_t glTypeSize;
+		uint32_t glFormat;
+		uint32_t glInternalFormat;
+		uint32_t glBaseInternalFormat;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t numberOfArrayElements;
+		uint32_t numberOfFaces;
+		uint32_t numberOfMipmapLevels;
+		uint32_t bytesOfKeyValueData;
+	};
+
+	/***********************************************************
+	 *  GetModifiedTime()
+	 *
+	 *  Returns the time a file was last written, or -1 when it
+	 *  does not exist.
+	 ***********************************************************/
+	long long GetModifiedTime(const char* filename)
+	{
+#ifdef _WIN32
+		struct _stat64 status;
+		if (_stat64(filename, &status) != 0)
+			return(-1);
+#else
+		struct stat status;
+		if (stat(filename, &status) != 0)
+			return(-1);
+#endif
+		return((long long)status.st_mtime);
+	}
+}
+
+/***********************************************************
+ *  CookTexture()
+ *
+ *  This method is used for converting a source image into a
+ *  cooked texture file.  The image is flipped like the rest
+ *  of the loaded textures and every mip level down to 1x1 is
+ *  written after it.
+ ***********************************************************/
+bool TextureCooker::CookTexture(const char* sourceFilename, const char* cookedFilename)
+{
+	int width = 0;
+	int height = 0;
+	std::vector<unsigned char> level;
+
+	stbi_set_flip_vertically_on_load(false);
+	if (TextureLoader::DecodeImage(sourceFilename, level, width, height) == false)
+	{
+		std::cout << "Could not load image:" << sourceFilename << std::endl;
+		return(false);
+	}
+
+	int levelCount = TextureArrays::GetMipLevelCount(width, height);
+
+	KTX_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.identifier, g_KTXIdentifier, sizeof(g_KTXIdentifier));
+	header.endianness = g_KTXEndianness;
+	header.glType = GL_UNSIGNED_BYTE;
+	header.glTypeSize = 1;
+	header.glFormat = GL_RGBA;
+	header.glInternalFormat = GL_RGBA8;
+	header.glBaseInternalFormat = GL_RGBA;
+	header.pixelWidth = (uint32_t)width;
+	header.pixelHeight = (uint32_t)height;
+	header.numberOfFaces = 1;
+	header.numberOfMipmapLevels = (uint32_t)levelCount;
+
+	std::ofstream file(cookedFilename, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "Could not write cooked texture:" << cookedFilename << std::endl;
+		return(false);
+	}
+	file.write((const char*)&header, sizeof(header));
+
+	// RGBA rows are always a multiple of four bytes, so the
+	// levels need no padding
+	int levelWidth = width;
+	int levelHeight = height;
+	std::vector<unsigned char> nextLevel;
+	for (int levelIndex = 0; levelIndex < levelCount; levelIndex++)
+	{
+		uint32_t imageSize = (uint32_t)level.size();
+		file.write((const char*)&imageSize, sizeof(imageSize));
+		file.write((const char*)level.data(), (std::streamsize)level.size());
+
+		if (levelIndex + 1 < levelCount)
+		{
+			int nextWidth = (levelWidth > 1) ? levelWidth / 2 : 1;
+			int nextHeight = (levelHeight > 1) ? levelHeight / 2 : 1;
+			nextLevel.resize((size_t)nextWidth * nextHeight * g_PixelSize);
+			ImageKernels::DownsampleBox(level.data(), levelWidth, levelHeight, nextLevel.data());
+			level.swap(nextLevel);
+			levelWidth = nextWidth;
+			levelHeight = nextHeight;
+		}
+	}
+
+	if (!file)
+	{
+		std::cout << "Could not write cooked texture:" << cookedFilename << std::endl;
+		return(false);
+	}
+
+	std::cout << "INFO: cooked " << sourceFilename << " into " << cookedFilename << ", "
+		<< width << "x" << height << ", " << levelCount << " levels, "
+		<< (long long)file.tellp() << " bytes" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetCookedPath()
+ *
+ *  This method is used for getting the name of the cooked
+ *  file of a source image.
+ ***********************************************************/
+std::string TextureCooker::GetCookedPath(const char* sourceFilename)
+{
+	std::string cookedPath = sourceFilename;
+
+	size_t extension = cookedPath.find_last_of('.');
+	size_t separator = cookedPath.find_last_of("/\\");
+	if ((extension != std::string::npos) &&
+		((separator == std::string::npos) || (extension > separator)))
+	{
+		cookedPath.erase(extension);
+	}
+
+	return(cookedPath + ".ktx");
+}
+
+/***********************************************************
+ *  IsCookedCurrent()
+ *
+ *  This method is used for checking whether a cooked file can
+ *  be used in place of its source image.
+ ***********************************************************/
+bool TextureCooker::IsCookedCurrent(const char* sourceFilename, const char* cookedFilename)
+{
+	long long cookedTime = GetModifiedTime(cookedFilename);
+	if (cookedTime < 0)
+	{
+		return(false);
+	}
+
+	return(cookedTime >= GetModifiedTime(sourceFilename));
+}
+
+/***********************************************************
+ *  CookedTexture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CookedTexture::CookedTexture()
+{
+	m_pData = NULL;
+	m_size = 0;
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  ~CookedTexture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CookedTexture::~CookedTexture()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a cooked texture file into
+ *  memory.  Only uncompressed RGBA 2D textures are accepted,
+ *  and every level has to fit in the file.
+ ***********************************************************/
+bool CookedTexture::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return(false);
+	}
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart >= (LONGLONG)sizeof(KTX_HEADER)))
+	{
+		// the view keeps the file mapped once the handles are closed
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping != NULL)
+		{
+			m_pData = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			m_size = (m_pData != NULL) ? (size_t)fileSize.QuadPart : 0;
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#else
+	int file = open(filename, O_RDONLY);
+	if (file < 0)
+	{
+		return(false);
+	}
+	struct stat status;
+	if ((fstat(file, &status) == 0) && (status.st_size >= (off_t)sizeof(KTX_HEADER)))
+	{
+		void* pMapped = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (pMapped != MAP_FAILED)
+		{
+			m_pData = (const unsigned char*)pMapped;
+			m_size = (size_t)status.st_size;
+		}
+	}
+	close(file);
+#endif
+
+	if (NULL == m_pData)
+	{
+		return(false);
+	}
+
+	KTX_HEADER header;
+	memcpy(&header, m_pData, sizeof(header));
+	if ((memcmp(header.identifier, g_KTXIdentifier, sizeof(g_KTXIdentifier)) != 0) ||
+		(header.endianness != g_KTXEndianness) ||
+		(header.glType != GL_UNSIGNED_BYTE) ||
+		(header.glFormat != GL_RGBA) ||
+		(header.glInternalFormat != GL_RGBA8) ||
+		(header.pixelWidth == 0) || (header.pixelHeight == 0) ||
+		(header.pixelDepth != 0) ||
+		(header.numberOfArrayElements != 0) ||
+		(header.numberOfFaces != 1) ||
+		(header.numberOfMipmapLevels > (uint32_t)TextureArrays::GetMipLevelCount((int)header.pixelWidth, (int)header.pixelHeight)))
+	{
+		std::cout << "Not a cooked RGBA texture:" << filename << std::endl;
+		Close();
+		return(false);
+	}
+
+	m_width = (int)header.pixelWidth;
+	m_height = (int)header.pixelHeight;
+
+	// a level count of zero asks for the mipmaps to be
+	// generated, so only the first level is stored
+	uint32_t levelCount = (header.numberOfMipmapLevels > 0) ? header.numberOfMipmapLevels : 1;
+	size_t offset = sizeof(KTX_HEADER) + header.bytesOfKeyValueData;
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		int levelWidth = 0;
+		int levelHeight = 0;
+		m_levels.push_back(NULL);
+		GetLevel((int)level, levelWidth, levelHeight);
+
+		uint32_t imageSize = 0;
+		if (offset + sizeof(imageSize) > m_size)
+			break;
+		memcpy(&imageSize, m_pData + offset, sizeof(imageSize));
+		offset += sizeof(imageSize);
+
+		if ((imageSize != (uint32_t)levelWidth * levelHeight * g_PixelSize) ||
+			(offset + imageSize > m_size))
+			break;
+
+		m_levels[level] = m_pData + offset;
+		offset += imageSize;
+	}
+
+	if (m_levels.back() == NULL)
+	{
+		std::cout << "Cooked texture is truncated:" << filename << std::endl;
+		Close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the cooked file.
+ ***********************************************************/
+void CookedTexture::Close()
+{
+	if (m_pData != NULL)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_pData);
+#else
+		munmap((void*)m_pData, m_size);
+#endif
+	}
+	m_pData = NULL;
+	m_size = 0;
+	m_width = 0;
+	m_height = 0;
+	m_levels.clear();
+}
+
+/***********************************************************
+ *  FindLevel()
+ *
+ *  This method is used for finding the mip level of a given
+ *  size, so a texture can be uploaded into a smaller layer
+ *  without being resized.
+ ***********************************************************/
+int CookedTexture::FindLevel(int width, int height) const
+{
+	for (int level = 0; level < GetLevelCount(); level++)
+	{
+		int levelWidth = 0;
+		int levelHeight = 0;
+		GetLevel(level, levelWidth, levelHeight);
+		if ((levelWidth == width) && (levelHeight == height))
+		{
+			return(level);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  GetLevel()
+ *
+ *  This method is used for getting the pixels and the size
+ *  of a mip level.  The pixels point into the mapped file.
+ ***********************************************************/
+const unsigned char* CookedTexture::GetLevel(int level, int& width, int& height) const
+{
+	width = (m_width >> level > 1) ? m_width >> level : 1;
+	height = (m_height >> level > 1) ? m_height >> level : 1;
+
+	return(m_levels[level]);
+}
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecooker.h
+// ============
+// convert texture images offline into GPU-ready files with mipmaps
+//
+// The cooker decodes a source image once and writes it as a KTX 1.1 file
+// holding the RGBA pixels of every mip level, with the rows bottom first
+// the way OpenGL expects them.  At run time the cooked file is mapped into
+// memory and its levels are uploaded as they are, so the image is neither
+// decoded nor has its mipmaps generated on every launch.
+//
+// Images are cooked from the command line with --cook <image> ..., and a
+// cooked file is used in place of its source image while it is newer.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TextureCooker
+ *
+ *  This class contains the conversion of source images into
+ *  cooked texture files.
+ ***********************************************************/
+class TextureCooker
+{
+public:
+	// decode a source image and write it with its mipmaps
+	static bool CookTexture(const char* sourceFilename, const char* cookedFilename);
+	// cooked file of a source image - the same name with a
+	// .ktx extension
+	static std::string GetCookedPath(const char* sourceFilename);
+	// whether the cooked file exists and is not older than
+	// its source image
+	static bool IsCookedCurrent(const char* sourceFilename, const char* cookedFilename);
+};
+
+/***********************************************************
+ *  CookedTexture
+ *
+ *  This class contains a cooked texture file mapped into
+ *  memory and the location of each of its mip levels.
+ ***********************************************************/
+class CookedTexture
+{
+public:
+	// constructor
+	CookedTexture();
+	// destructor
+	~CookedTexture();
+
+	// map a cooked file and check its header and levels
+	bool Open(const char* filename);
+	// unmap the file
+	void Close();
+
+	// level whose size matches, -1 when there is none
+	int FindLevel(int width, int height) const;
+	// RGBA pixels and size of a mip level
+	const unsigned char* GetLevel(int level, int& width, int& height) const;
+
+	// access the image
+	int GetWidth() const { return(m_width); }
+	int GetHeight() const { return(m_height); }
+	int GetLevelCount() const { return((int)m_levels.size()); }
+
+private:
+	// mapped file contents
+	const unsigned char* m_pData;
+	size_t m_size;
+	// size of the largest level and the start of every level
+	int m_width;
+	int m_height;
+	std::vector<const unsigned char*> m_levels;
+};
@@ -0,0 +1,285 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.cpp
+// ============
+// decode the texture images on worker threads
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureLoader.h"
+#include "ImageKernels.h"
+#include "TextureArrays.h"
+#include "TextureCooker.h"
+
+#include "stb_image.h"
+
+/***********************************************************
+ *  TextureLoader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureLoader::TextureLoader()
+	: m_nextJob(0), m_takenCount(0), m_pDecoded(nullptr)
+{
+}
+
+/***********************************************************
+ *  ~TextureLoader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureLoader::~TextureLoader()
+{
+	// stop the workers from claiming the remaining jobs
+	m_nextJob = (uint32_t)m_jobs.size();
+	JoinWorkers();
+	FreeDecoded(m_pDecoded.exchange(nullptr));
+}
+
+/***********************************************************
+ *  AddJob()
+ *
+ *  This method is used for adding an image to decode.  The
+ *  image is resized to the given size when it differs.
+ ***********************************************************/
+void TextureLoader::AddJob(uint32_t texture, const char* filename, int width, int height)
+{
+	DECODE_JOB job;
+	job.texture = texture;
+	job.filename = filename;
+	job.width = width;
+	job.height = height;
+	m_jobs.push_back(job);
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting the worker threads.
+ *  The images are flipped by DecodeImage(), so stb_image is
+ *  told not to flip them as well.
+ ***********************************************************/
+void TextureLoader::Start(uint32_t threadCount)
+{
+	if (threadCount == 0)
+	{
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+	}
+	if (threadCount > m_jobs.size())
+	{
+		threadCount = (uint32_t)m_jobs.size();
+	}
+
+	stbi_set_flip_vertically_on_load(false);
+
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		m_workers.push_back(std::thread(&TextureLoader::WorkerMain, this));
+	}
+}
+
+/***********************************************************
+ *  TakeDecoded()
+ *
+ *  This method is used for taking every image that was
+ *  decoded since the last call.
+ ***********************************************************/
+DECODED_TEXTURE* TextureLoader::TakeDecoded()
+{
+	DECODED_TEXTURE* pDecoded = m_pDecoded.exchange(nullptr, std::memory_order_acquire);
+
+	for (DECODED_TEXTURE* pImage = pDecoded; pImage != nullptr; pImage = pImage->pNext)
+	{
+		m_takenCount++;
+	}
+
+	// every job is done, the workers have exited
+	if ((pDecoded != nullptr) && IsFinished())
+	{
+		JoinWorkers();
+	}
+
+	return(pDecoded);
+}
+
+/***********************************************************
+ *  FreeDecoded()
+ *
+ *  This method is used for deleting a list of taken images.
+ ***********************************************************/
+void TextureLoader::FreeDecoded(DECODED_TEXTURE* pDecoded)
+{
+	while (pDecoded != nullptr)
+	{
+		DECODED_TEXTURE* pNext = pDecoded->pNext;
+		delete pDecoded->pCooked;
+		delete pDecoded;
+		pDecoded = pNext;
+	}
+}
+
+/***********************************************************
+ *  UploadDecoded()
+ *
+ *  This method is used for uploading a taken image into its
+ *  layer.  A cooked image has every one of its mip levels
+ *  uploaded, a decoded one has its mipmaps generated.  An
+ *  image that no longer matches the size of its layer is
+ *  not uploaded.
+ ***********************************************************/
+bool TextureLoader::UploadDecoded(const DECODED_TEXTURE* pImage, TextureArrays& textureArrays)
+{
+	if (pImage->pCooked != nullptr)
+	{
+		for (int level = pImage->firstLevel; level < pImage->pCooked->GetLevelCount(); level++)
+		{
+			int width = 0;
+			int height = 0;
+			const unsigned char* pPixels = pImage->pCooked->GetLevel(level, width, height);
+			if (textureArrays.UploadLayerLevel(pImage->texture, level - pImage->firstLevel, pPixels, width, height) == false)
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+
+	if (pImage->pixels.empty())
+	{
+		return(false);
+	}
+
+	return(textureArrays.UploadLayer(pImage->texture, pImage->pixels.data(), pImage->width, pImage->height));
+}
+
+/***********************************************************
+ *  DecodeImage()
+ *
+ *  This method is used for decoding an image in the channel
+ *  count it was saved with, then expanding it to RGBA and
+ *  flipping it with the vectorized kernels.  Grayscale and
+ *  gray with alpha images take the same path as RGB.
+ ***********************************************************/
+bool TextureLoader::DecodeImage(const char* filename, std::vector<unsigned char>& pixels, int& width, int& height)
+{
+	int colorChannels = 0;
+	unsigned char* pPixels = stbi_load(filename, &width, &height, &colorChannels, 0);
+	if (NULL == pPixels)
+	{
+		return(false);
+	}
+
+	size_t pixelCount = (size_t)width * height;
+	pixels.resize(pixelCount * 4);
+	bool bConverted = ImageKernels::ConvertToRGBA(pPixels, colorChannels, pixels.data(), pixelCount);
+	stbi_image_free(pPixels);
+
+	if (bConverted == false)
+	{
+		pixels.clear();
+		return(false);
+	}
+
+	ImageKernels::FlipRows(pixels.data(), (size_t)width * 4, height);
+	return(true);
+}
+
+/***********************************************************
+ *  IsFinished()
+ *
+ *  This method is used for checking whether every image has
+ *  been decoded and taken.
+ ***********************************************************/
+bool TextureLoader::IsFinished() const
+{
+	return(m_takenCount == (uint32_t)m_jobs.size());
+}
+
+/***********************************************************
+ *  WorkerMain()
+ *
+ *  This method is used for claiming jobs and decoding them
+ *  until none are left.  Each decoded image is pushed onto
+ *  the lock-free list with a compare and swap.
+ ***********************************************************/
+void TextureLoader::WorkerMain()
+{
+	uint32_t jobIndex = m_nextJob++;
+	while (jobIndex < (uint32_t)m_jobs.size())
+	{
+		const DECODE_JOB& job = m_jobs[jobIndex];
+		DECODED_TEXTURE* pImage = new DECODED_TEXTURE();
+		pImage->texture = job.texture;
+		pImage->width = job.width;
+		pImage->height = job.height;
+		pImage->pCooked = OpenCooked(job, pImage->firstLevel);
+
+		int width = 0;
+		int height = 0;
+		if ((pImage->pCooked == nullptr) && DecodeImage(job.filename.c_str(), pImage->pixels, width, height))
+		{
+			if ((width != job.width) || (height != job.height))
+			{
+				TextureArrays::ResizeImage(pImage->pixels, width, height, job.width, job.height);
+			}
+		}
+
+		pImage->pNext = m_pDecoded.load(std::memory_order_relaxed);
+		while (!m_pDecoded.compare_exchange_weak(pImage->pNext, pImage, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+
+		jobIndex = m_nextJob++;
+	}
+}
+
+/***********************************************************
+ *  OpenCooked()
+ *
+ *  This method is used for mapping the cooked file of a job.
+ *  The file is only used when it is newer than the image and
+ *  has a level of the layer size followed by every smaller
+ *  level, otherwise the image is decoded.
+ ***********************************************************/
+CookedTexture* TextureLoader::OpenCooked(const DECODE_JOB& job, int& firstLevel)
+{
+	firstLevel = 0;
+
+	std::string cookedPath = TextureCooker::GetCookedPath(job.filename.c_str());
+	if (TextureCooker::IsCookedCurrent(job.filename.c_str(), cookedPath.c_str()) == false)
+	{
+		return(nullptr);
+	}
+
+	CookedTexture* pCooked = new CookedTexture();
+	if (pCooked->Open(cookedPath.c_str()))
+	{
+		int level = pCooked->FindLevel(job.width, job.height);
+		if ((level >= 0) &&
+			(pCooked->GetLevelCount() - level == TextureArrays::GetMipLevelCount(job.width, job.height)))
+		{
+			firstLevel = level;
+			return(pCooked);
+		}
+	}
+
+	delete pCooked;
+	return(nullptr);
+}
+
+/***********************************************************
+ *  JoinWorkers()
+ *
+ *  This method is used for waiting for the worker threads
+ *  to exit.
+ ***********************************************************/
+void TextureLoader::JoinWorkers()
+{
+	for (std::thread& worker : m_workers)
+	{
+		if (worker.joinable())
+		{
+			worker.join();
+		}
+	}
+	m_workers.clear();
+}
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.h
+// ============
+// decode the texture images on worker threads
+//
+// The images are decoded and resized to their texture array layer on a pool
+// of worker threads.  Finished images are pushed onto a lock-free list that
+// the OpenGL thread takes from once per frame, so the scene starts drawing
+// before the textures are ready and each texture appears as it arrives.
+//
+// An image with a current cooked file is not decoded at all - the worker
+// maps the cooked file and its mip levels are uploaded straight from it.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CookedTexture;
+class TextureArrays;
+
+/***********************************************************
+ *  DECODED_TEXTURE
+ *
+ *  RGBA pixels of a decoded image at the size of its layer,
+ *  or the cooked file of the image from the level that has
+ *  the size of its layer.  The pixels are empty and there
+ *  is no cooked file when the image could not be read.
+ ***********************************************************/
+struct DECODED_TEXTURE
+{
+	uint32_t texture;
+	int width;
+	int height;
+	std::vector<unsigned char> pixels;
+	CookedTexture* pCooked;
+	int firstLevel;
+	DECODED_TEXTURE* pNext;
+};
+
+/***********************************************************
+ *  TextureLoader
+ *
+ *  This class contains the worker threads that decode the
+ *  texture images and the list of the decoded images.
+ ***********************************************************/
+class TextureLoader
+{
+public:
+	// constructor
+	TextureLoader();
+	// destructor - waits for the workers to finish
+	~TextureLoader();
+
+	// add an image to decode at the given size, before Start()
+	void AddJob(uint32_t texture, const char* filename, int width, int height);
+	// start decoding on threadCount workers, 0 picks one less
+	// than the number of hardware threads
+	void Start(uint32_t threadCount = 0);
+
+	// take the images decoded since the last call, oldest last.
+	// The caller deletes them with FreeDecoded()
+	DECODED_TEXTURE* TakeDecoded();
+	static void FreeDecoded(DECODED_TEXTURE* pDecoded);
+	// upload a taken image into its texture array layer,
+	// false when the image could not be read
+	static bool UploadDecoded(const DECODED_TEXTURE* pImage, TextureArrays& textureArrays);
+	// decode an image of any channel count into RGBA pixels,
+	// bottom row first
+	static bool DecodeImage(const char* filename, std::vector<unsigned char>& pixels, int& width, int& height);
+
+	// whether every job has been decoded and taken
+	bool IsFinished() const;
+	// number of jobs
+	uint32_t GetJobCount() const { return((uint32_t)m_jobs.size()); }
+
+private:
+	// an image to decode and the size of its layer
+	struct DECODE_JOB
+	{
+		uint32_t texture;
+		std::string filename;
+		int width;
+		int height;
+	};
+
+	// jobs, fixed once the workers are started
+	std::vector<DECODE_JOB> m_jobs;
+	// next job to claim and the number of taken images
+	std::atomic<uint32_t> m_nextJob;
+	std::atomic<uint32_t> m_takenCount;
+	// lock-free list of decoded images, pushed by the workers
+	std::atomic<DECODED_TEXTURE*> m_pDecoded;
+	// worker threads
+	std::vector<std::thread> m_workers;
+
+	// claim and decode jobs until there are none left
+	void WorkerMain();
+	// map the cooked file of a job when it can be uploaded as is
+	static CookedTexture* OpenCooked(const DECODE_JOB& job, int& firstLevel);
+	// wait for the worker threads to exit
+	void JoinWorkers();
+};
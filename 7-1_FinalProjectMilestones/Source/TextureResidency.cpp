@@ -0,0 +1,181 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureresidency.cpp
+// ============
+// keep the texture arrays within a GPU memory budget
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// frames a finer level has to be wanted before it is
+	// streamed in, so a passing glance does not reload an array
+	const uint32_t g_StreamInFrames = 30;
+}
+
+/***********************************************************
+ *  TextureResidency()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureResidency::TextureResidency()
+{
+	m_budgetBytes = 0;
+}
+
+/***********************************************************
+ *  ~TextureResidency()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureResidency::~TextureResidency()
+{
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for clearing the coverage before the
+ *  objects of a frame are counted.
+ ***********************************************************/
+void TextureResidency::BeginFrame(uint32_t arrayCount)
+{
+	m_coverage.assign(arrayCount, 0.0f);
+	if (m_targetLevels.size() != arrayCount)
+	{
+		m_targetLevels.assign(arrayCount, -1);
+		m_stableFrames.assign(arrayCount, 0);
+	}
+}
+
+/***********************************************************
+ *  AddCoverage()
+ *
+ *  This method is used for counting the on screen size of an
+ *  object.  The largest object decides the level of an array.
+ ***********************************************************/
+void TextureResidency::AddCoverage(uint32_t arrayIndex, float screenPixels)
+{
+	if (arrayIndex < m_coverage.size())
+	{
+		m_coverage[arrayIndex] = std::max(m_coverage[arrayIndex], screenPixels);
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for choosing the resident level of
+ *  every array.  An array wants the level whose size is
+ *  closest to its on screen size, and while the wanted
+ *  levels do not fit in the budget the array that saves the
+ *  most memory by dropping one more level does so.  Levels
+ *  are evicted right away, while at most one array a frame
+ *  streams finer levels back in.
+ ***********************************************************/
+void TextureResidency::Update(TextureArrays& textureArrays, std::vector<uint32_t>& reloadArrays)
+{
+	reloadArrays.clear();
+
+	uint32_t arrayCount = std::min(textureArrays.GetArrayCount(), (uint32_t)m_coverage.size());
+	if ((m_budgetBytes == 0) || (arrayCount == 0))
+	{
+		return;
+	}
+
+	// finest level worth keeping for the on screen size, arrays
+	// that are not visible keep only their smallest levels
+	std::vector<int> levels(arrayCount, 0);
+	uint64_t totalBytes = 0;
+	for (uint32_t arrayIndex = 0; arrayIndex < arrayCount; arrayIndex++)
+	{
+		int lastLevel = textureArrays.GetLevelCount(arrayIndex) - 1;
+		if (m_coverage[arrayIndex] > 0.0f)
+		{
+			int coveredLevels = (int)std::ceil(std::log2(std::max(m_coverage[arrayIndex], 1.0f)));
+			levels[arrayIndex] = std::max(lastLevel - coveredLevels, 0);
+		}
+		else
+		{
+			levels[arrayIndex] = lastLevel;
+		}
+		totalBytes += textureArrays.GetArrayBytes(arrayIndex, levels[arrayIndex]);
+	}
+
+	// drop the levels that save the most memory until the
+	// arrays fit in the budget
+	while (totalBytes > m_budgetBytes)
+	{
+		int bestArray = -1;
+		uint64_t bestSaving = 0;
+		for (uint32_t arrayIndex = 0; arrayIndex < arrayCount; arrayIndex++)
+		{
+			if (levels[arrayIndex] + 1 >= textureArrays.GetLevelCount(arrayIndex))
+				continue;
+
+			uint64_t saving = textureArrays.GetArrayBytes(arrayIndex, levels[arrayIndex]) -
+				textureArrays.GetArrayBytes(arrayIndex, levels[arrayIndex] + 1);
+			if (saving > bestSaving)
+			{
+				bestArray = (int)arrayIndex;
+				bestSaving = saving;
+			}
+		}
+		if (bestArray < 0)
+		{
+			break;
+		}
+
+		levels[bestArray]++;
+		totalBytes -= bestSaving;
+	}
+
+	int streamArray = -1;
+	for (uint32_t arrayIndex = 0; arrayIndex < arrayCount; arrayIndex++)
+	{
+		int residentLevel = textureArrays.GetResidentLevel(arrayIndex);
+
+		if (levels[arrayIndex] != m_targetLevels[arrayIndex])
+		{
+			m_targetLevels[arrayIndex] = levels[arrayIndex];
+			m_stableFrames[arrayIndex] = 0;
+		}
+		else
+		{
+			m_stableFrames[arrayIndex]++;
+		}
+
+		if (levels[arrayIndex] > residentLevel)
+		{
+			// evicting never has to wait, it makes room for the rest
+			std::cout << "INFO: texture array " << arrayIndex << " evicted to mip level "
+				<< levels[arrayIndex] << std::endl;
+			if (textureArrays.SetResidentLevel(arrayIndex, levels[arrayIndex]))
+			{
+				reloadArrays.push_back(arrayIndex);
+			}
+		}
+		else if ((levels[arrayIndex] < residentLevel) && (streamArray < 0) &&
+			(m_stableFrames[arrayIndex] >= g_StreamInFrames))
+		{
+			streamArray = (int)arrayIndex;
+		}
+	}
+
+	// the resident levels are now at or above the wanted
+	// ones, so streaming one array in stays within the budget
+	if (streamArray >= 0)
+	{
+		std::cout << "INFO: texture array " << streamArray << " streaming in mip level "
+			<< levels[streamArray] << std::endl;
+		if (textureArrays.SetResidentLevel((uint32_t)streamArray, levels[streamArray]))
+		{
+			reloadArrays.push_back((uint32_t)streamArray);
+		}
+	}
+}
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureresidency.h
+// ============
+// keep the texture arrays within a GPU memory budget
+//
+// Every frame the scene reports how many pixels each texture array covers on
+// screen.  From that the finest mip level worth keeping is worked out per
+// array, and when the arrays do not fit in the budget the arrays that save
+// the most memory lose their finest level first.  Levels are dropped at once
+// and streamed back in one array at a time once they are wanted again.
+//
+// The budget is set with --texture-budget <MB>, and no budget keeps every
+// level resident.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureArrays.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  TextureResidency
+ *
+ *  This class contains the screen coverage of the texture
+ *  arrays and decides which of their mip levels are kept.
+ ***********************************************************/
+class TextureResidency
+{
+public:
+	// constructor
+	TextureResidency();
+	// destructor
+	~TextureResidency();
+
+	// memory the arrays may use, 0 for no limit
+	void SetBudget(uint64_t budgetBytes) { m_budgetBytes = budgetBytes; }
+	uint64_t GetBudget() const { return(m_budgetBytes); }
+
+	// start gathering the coverage of a frame
+	void BeginFrame(uint32_t arrayCount);
+	// count the on screen size in pixels of an object that
+	// samples an array
+	void AddCoverage(uint32_t arrayIndex, float screenPixels);
+
+	// change the resident levels of the arrays to match the
+	// coverage and the budget, and list the arrays whose
+	// layers have to be uploaded again
+	void Update(TextureArrays& textureArrays, std::vector<uint32_t>& reloadArrays);
+
+private:
+	// memory the arrays may use
+	uint64_t m_budgetBytes;
+	// largest on screen size of each array this frame
+	std::vector<float> m_coverage;
+	// level each array moves to and for how many frames it
+	// has been wanted
+	std::vector<int> m_targetLevels;
+	std::vector<uint32_t> m_stableFrames;
+};
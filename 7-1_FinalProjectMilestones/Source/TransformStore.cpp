@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformstore.cpp
+// ============
+// store the transformations of the scene objects
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformStore.h"
+
+#include <cmath>
+
+/***********************************************************
+ *  TransformStore()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformStore::TransformStore()
+{
+}
+
+/***********************************************************
+ *  ~TransformStore()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TransformStore::~TransformStore()
+{
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all of the stored
+ *  transformations.
+ ***********************************************************/
+void TransformStore::Clear()
+{
+	m_scales.clear();
+	m_rotations.clear();
+	m_positions.clear();
+	m_modelMatrices.clear();
+	m_dirtyFlags.clear();
+	m_dirtyList.clear();
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method is used for reserving memory in every array
+ *  for the given number of transformations.
+ ***********************************************************/
+void TransformStore::Reserve(uint32_t count)
+{
+	m_scales.reserve(count);
+	m_rotations.reserve(count);
+	m_positions.reserve(count);
+	m_modelMatrices.reserve(count);
+	m_dirtyFlags.reserve(count);
+	m_dirtyList.reserve(count);
+}
+
+/***********************************************************
+ *  AddTransform()
+ *
+ *  This method is used for adding a transformation.  The
+ *  model matrix is composed right away so a static object
+ *  never needs to be updated again.
+ ***********************************************************/
+uint32_t TransformStore::AddTransform(
+	const glm::vec3& scaleXYZ,
+	const glm::vec3& rotationDegreesXYZ,
+	const glm::vec3& positionXYZ)
+{
+	uint32_t index = (uint32_t)m_positions.size();
+
+	m_scales.push_back(scaleXYZ);
+	m_rotations.push_back(rotationDegreesXYZ);
+	m_positions.push_back(positionXYZ);
+	m_modelMatrices.push_back(ComposeModelMatrix(scaleXYZ, rotationDegreesXYZ, positionXYZ));
+	m_dirtyFlags.push_back(0);
+
+	return(index);
+}
+
+/***********************************************************
+ *  SetScale()
+ *
+ *  This method is used for changing the scale of a stored
+ *  transformation.
+ ***********************************************************/
+void TransformStore::SetScale(uint32_t index, const glm::vec3& scaleXYZ)
+{
+	m_scales[index] = scaleXYZ;
+	MarkDirty(index);
+}
+
+/***********************************************************
+ *  SetRotation()
+ *
+ *  This method is used for changing the rotation of a stored
+ *  transformation.
+ ***********************************************************/
+void TransformStore::SetRotation(uint32_t index, const glm::vec3& rotationDegreesXYZ)
+{
+	m_rotations[index] = rotationDegreesXYZ;
+	MarkDirty(index);
+}
+
+/***********************************************************
+ *  SetPosition()
+ *
+ *  This method is used for changing the position of a stored
+ *  transformation.
+ ***********************************************************/
+void TransformStore::SetPosition(uint32_t index, const glm::vec3& positionXYZ)
+{
+	m_positions[index] = positionXYZ;
+	MarkDirty(index);
+}
+
+/***********************************************************
+ *  MarkDirty()
+ *
+ *  This method is used for flagging a transformation so its
+ *  model matrix is recomputed on the next update.  Each
+ *  index is only listed once no matter how often it changes.
+ ***********************************************************/
+void TransformStore::MarkDirty(uint32_t index)
+{
+	if (m_dirtyFlags[index] == 0)
+	{
+		m_dirtyFlags[index] = 1;
+		m_dirtyList.push_back(index);
+	}
+}
+
+/***********************************************************
+ *  UpdateModelMatrices()
+ *
+ *  This method is used for recomputing the model matrices
+ *  of the dirty transformations.  The cost only depends on
+ *  the number of changed objects, not on the scene size.
+ ***********************************************************/
+uint32_t TransformStore::UpdateModelMatrices(std::vector<uint32_t>* pUpdatedIndices)
+{
+	uint32_t updatedCount = (uint32_t)m_dirtyList.size();
+
+	if (pUpdatedIndices != NULL)
+	{
+		pUpdatedIndices->insert(pUpdatedIndices->end(), m_dirtyList.begin(), m_dirtyList.end());
+	}
+
+	for (uint32_t i = 0; i < updatedCount; i++)
+	{
+		uint32_t index = m_dirtyList[i];
+
+		m_modelMatrices[index] = ComposeModelMatrix(
+			m_scales[index],
+			m_rotations[index],
+			m_positions[index]);
+		m_dirtyFlags[index] = 0;
+	}
+	m_dirtyList.clear();
+
+	return(updatedCount);
+}
+
+/***********************************************************
+ *  ComposeModelMatrix()
+ *
+ *  This method is used for composing a model matrix.  The
+ *  result equals translation * rotationX * rotationY *
+ *  rotationZ * scale, the order SetTransformations() uses,
+ *  but is written out directly instead of through four
+ *  full matrix multiplies.
+ ***********************************************************/
+glm::mat4 TransformStore::ComposeModelMatrix(
+	const glm::vec3& scaleXYZ,
+	const glm::vec3& rotationDegreesXYZ,
+	const glm::vec3& positionXYZ)
+{
+	float sx = std::sin(glm::radians(rotationDegreesXYZ.x));
+	float cx = std::cos(glm::radians(rotationDegreesXYZ.x));
+	float sy = std::sin(glm::radians(rotationDegreesXYZ.y));
+	float cy = std::cos(glm::radians(rotationDegreesXYZ.y));
+	float sz = std::sin(glm::radians(rotationDegreesXYZ.z));
+	float cz = std::cos(glm::radians(rotationDegreesXYZ.z));
+
+	glm::mat4 model;
+	model[0] = glm::vec4(
+		cy * cz,
+		sx * sy * cz + cx * sz,
+		-cx * sy * cz + sx * sz,
+		0.0f) * scaleXYZ.x;
+	model[1] = glm::vec4(
+		-cy * sz,
+		-sx * sy * sz + cx * cz,
+		cx * sy * sz + sx * cz,
+		0.0f) * scaleXYZ.y;
+	model[2] = glm::vec4(
+		sy,
+		-sx * cy,
+		cx * cy,
+		0.0f) * scaleXYZ.z;
+	model[3] = glm::vec4(positionXYZ, 1.0f);
+
+	return(model);
+}
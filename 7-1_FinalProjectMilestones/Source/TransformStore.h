@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformstore.h
+// ============
+// store the transformations of the scene objects
+//
+// Positions, rotations and scales are kept in separate arrays together with
+// the composed model matrix of every object.  Only the matrices of objects
+// that were changed since the last update are recomputed.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  TransformStore
+ *
+ *  This class contains the structure-of-arrays storage for
+ *  the scene object transformations and their cached model
+ *  matrices.
+ ***********************************************************/
+class TransformStore
+{
+public:
+	// constructor
+	TransformStore();
+	// destructor
+	~TransformStore();
+
+	// remove all of the stored transformations
+	void Clear();
+	// reserve memory for the given number of transformations
+	void Reserve(uint32_t count);
+
+	// add a transformation and return its index
+	uint32_t AddTransform(
+		const glm::vec3& scaleXYZ,
+		const glm::vec3& rotationDegreesXYZ,
+		const glm::vec3& positionXYZ);
+
+	// change a stored transformation and flag it as dirty
+	void SetScale(uint32_t index, const glm::vec3& scaleXYZ);
+	void SetRotation(uint32_t index, const glm::vec3& rotationDegreesXYZ);
+	void SetPosition(uint32_t index, const glm::vec3& positionXYZ);
+	void MarkDirty(uint32_t index);
+
+	// recompute the model matrices of the dirty transformations
+	// and return how many were recomputed; the recomputed indices
+	// are appended to the optional list
+	uint32_t UpdateModelMatrices(std::vector<uint32_t>* pUpdatedIndices = NULL);
+
+	// access the stored values
+	const glm::vec3& GetScale(uint32_t index) const { return(m_scales[index]); }
+	const glm::vec3& GetRotation(uint32_t index) const { return(m_rotations[index]); }
+	const glm::vec3& GetPosition(uint32_t index) const { return(m_positions[index]); }
+	const glm::mat4& GetModelMatrix(uint32_t index) const { return(m_modelMatrices[index]); }
+	const glm::mat4* GetModelMatrices() const { return(m_modelMatrices.data()); }
+	uint32_t GetCount() const { return((uint32_t)m_positions.size()); }
+
+	// compose translation * rotationX * rotationY * rotationZ * scale
+	static glm::mat4 ComposeModelMatrix(
+		const glm::vec3& scaleXYZ,
+		const glm::vec3& rotationDegreesXYZ,
+		const glm::vec3& positionXYZ);
+
+private:
+	// transformation components, one entry per object
+	std::vector<glm::vec3> m_scales;
+	std::vector<glm::vec3> m_rotations;
+	std::vector<glm::vec3> m_positions;
+	// cached model matrices, one entry per object
+	std::vector<glm::mat4> m_modelMatrices;
+	// dirty flags and the list of dirty indices
+	std::vector<uint8_t> m_dirtyFlags;
+	std::vector<uint32_t> m_dirtyList;
+};
@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformbuffer.cpp
+// ============
+// share blocks of shader uniforms through uniform buffer objects
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UniformBuffer.h"
+
+uint64_t UniformBuffer::s_bytesUploaded = 0;
+
+/***********************************************************
+ *  UniformBuffer()
+ *
+ *  The constructor for the class.  The OpenGL buffer is not
+ *  created until the first upload, so the object can exist
+ *  before the OpenGL context does.
+ ***********************************************************/
+UniformBuffer::UniformBuffer(GLuint bindingIndex)
+{
+	m_bindingIndex = bindingIndex;
+	m_buffer = 0;
+	m_size = 0;
+}
+
+/***********************************************************
+ *  ~UniformBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+UniformBuffer::~UniformBuffer()
+{
+	if (m_buffer != 0)
+	{
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+	}
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method is used for copying data into the buffer.  The
+ *  first upload sizes the buffer and binds it to its binding
+ *  point, where it stays for every shader that declares the
+ *  matching uniform block.  An upload past the end replaces
+ *  the buffer with a larger one, keeping its contents, and
+ *  binds that to the binding point instead.
+ ***********************************************************/
+void UniformBuffer::Upload(const void* pData, size_t size, size_t offset)
+{
+	if (m_buffer == 0)
+	{
+		m_size = offset + size;
+		glGenBuffers(1, &m_buffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+		glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)m_size, NULL, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, m_bindingIndex, m_buffer);
+	}
+	else if (offset + size > m_size)
+	{
+		GLuint buffer = 0;
+
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(offset + size), NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_COPY_READ_BUFFER, m_buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)m_size);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = buffer;
+		m_size = offset + size;
+		glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+		glBindBufferBase(GL_UNIFORM_BUFFER, m_bindingIndex, m_buffer);
+	}
+	else
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+	}
+
+	glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr)offset, (GLsizeiptr)size, pData);
+	s_bytesUploaded += size;
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  BindBlock()
+ *
+ *  This method is used for assigning a uniform block of a
+ *  linked program to a binding point.  The assignment is
+ *  part of the program, so it is made once after linking.
+ ***********************************************************/
+bool UniformBuffer::BindBlock(GLuint program, const char* blockName, GLuint bindingIndex)
+{
+	GLuint blockIndex = glGetUniformBlockIndex(program, blockName);
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		return(false);
+	}
+
+	glUniformBlockBinding(program, blockIndex, bindingIndex);
+	return(true);
+}
+
+/***********************************************************
+ *  TakeBytesUploaded()
+ *
+ *  This method is used for reading the number of bytes sent
+ *  to the shaders since the last call and starting the count
+ *  again.
+ ***********************************************************/
+uint64_t UniformBuffer::TakeBytesUploaded()
+{
+	uint64_t bytes = s_bytesUploaded;
+	s_bytesUploaded = 0;
+	return(bytes);
+}
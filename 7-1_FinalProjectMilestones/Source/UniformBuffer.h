@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformbuffer.h
+// ============
+// share blocks of shader uniforms through uniform buffer objects
+//
+// The camera, light and material values are written into std140 uniform
+// blocks that stay bound to fixed binding points, so they are uploaded when
+// they change instead of being set by name for every draw.  The structures
+// below match the uniform blocks declared in the shaders.  The shaders
+// target OpenGL 3.3, which cannot declare a binding point, so every program
+// has its blocks assigned to them with BindBlock().
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+// binding points of the uniform blocks
+enum UNIFORM_BLOCK_BINDING
+{
+	UNIFORM_BINDING_CAMERA = 0,
+	UNIFORM_BINDING_LIGHTS = 1,
+	UNIFORM_BINDING_MATERIALS = 2
+};
+
+// array sizes of the uniform blocks, matching the shaders
+const uint32_t UNIFORM_MAX_LIGHTS = 4;
+const uint32_t UNIFORM_MAX_MATERIALS = 16;
+
+/***********************************************************
+ *  CAMERA_BLOCK
+ *
+ *  std140 layout of the CameraBlock uniform block.
+ ***********************************************************/
+struct CAMERA_BLOCK
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec4 viewPosition;
+};
+
+/***********************************************************
+ *  LIGHT_BLOCK
+ *
+ *  std140 layout of the LightBlock uniform block.  The colors
+ *  are vec4 so that no member straddles a 16 byte boundary.
+ ***********************************************************/
+struct LIGHT_SOURCE_DATA
+{
+	glm::vec4 position;
+	glm::vec4 ambientColor;
+	glm::vec4 diffuseColor;
+	glm::vec4 specularColor;
+	float focalStrength;
+	float specularIntensity;
+	float reserved[2];
+};
+
+struct LIGHT_BLOCK
+{
+	LIGHT_SOURCE_DATA lightSources[UNIFORM_MAX_LIGHTS];
+};
+
+/***********************************************************
+ *  MATERIAL_BLOCK
+ *
+ *  std140 layout of the MaterialBlock uniform block.
+ ***********************************************************/
+struct MATERIAL_DATA
+{
+	glm::vec4 ambientColor;
+	glm::vec4 diffuseColor;
+	glm::vec4 specularColor;
+	float ambientStrength;
+	float shininess;
+	float reserved[2];
+};
+
+struct MATERIAL_BLOCK
+{
+	MATERIAL_DATA materials[UNIFORM_MAX_MATERIALS];
+};
+
+static_assert(sizeof(CAMERA_BLOCK) == 144, "CAMERA_BLOCK must match the std140 layout");
+static_assert(sizeof(LIGHT_SOURCE_DATA) == 80, "LIGHT_SOURCE_DATA must match the std140 layout");
+static_assert(sizeof(MATERIAL_DATA) == 64, "MATERIAL_DATA must match the std140 layout");
+
+/***********************************************************
+ *  UniformBuffer
+ *
+ *  This class contains one uniform buffer object bound to a
+ *  uniform block binding point.
+ ***********************************************************/
+class UniformBuffer
+{
+public:
+	// constructor
+	UniformBuffer(GLuint bindingIndex);
+	// destructor
+	~UniformBuffer();
+
+	// assign a uniform block of a program to a binding point,
+	// false when the program has no such block
+	static bool BindBlock(GLuint program, const char* blockName, GLuint bindingIndex);
+
+	// copy data into the buffer, creating it on the first upload
+	void Upload(const void* pData, size_t size, size_t offset = 0);
+
+	// count bytes sent to the shaders, through buffers or by name
+	static void AddBytesUploaded(size_t bytes) { s_bytesUploaded += bytes; }
+	// return the bytes counted since the last call and restart
+	static uint64_t TakeBytesUploaded();
+
+private:
+	// uniform block binding point
+	GLuint m_bindingIndex;
+	// OpenGL buffer and its size
+	GLuint m_buffer;
+	size_t m_size;
+
+	// bytes sent to the shaders since the last TakeBytesUploaded()
+	static uint64_t s_bytesUploaded;
+};
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.cpp
+// ============
+// count the heap allocations of a stretch of code in the test program
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+// declaration of global variables
+namespace
+{
+	// counted per thread, so the worker threads do not add to
+	// the allocations of the code under test
+	thread_local bool t_bCounting = false;
+	thread_local uint64_t t_allocationCount = 0;
+}
+
+/***********************************************************
+ *  Begin()
+ *
+ *  This method is used for starting to count the heap
+ *  allocations of the calling thread.
+ ***********************************************************/
+void AllocationCounter::Begin()
+{
+	t_allocationCount = 0;
+	t_bCounting = true;
+}
+
+/***********************************************************
+ *  End()
+ *
+ *  This method is used for stopping the counting and
+ *  returning the allocations made since Begin().
+ ***********************************************************/
+uint64_t AllocationCounter::End()
+{
+	t_bCounting = false;
+
+	return(t_allocationCount);
+}
+
+// every allocation of the test program goes through these, the
+// sized and unsized deletes all free what malloc() returned
+void* operator new(size_t size)
+{
+	if (t_bCounting)
+	{
+		t_allocationCount++;
+	}
+	void* pMemory = malloc((size > 0) ? size : 1);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+	return(pMemory);
+}
+
+void* operator new[](size_t size)
+{
+	return(operator new(size));
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
@@ -0,0 +1,31 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.h
+// ============
+// count the heap allocations of a stretch of code in the test program
+//
+// The test program replaces the global operator new and delete, so every
+// allocation of the calling thread can be counted while the counting is
+// enabled.  The replacements are only linked into the test program, the
+// application keeps the allocator of the runtime library.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+/***********************************************************
+ *  AllocationCounter
+ *
+ *  This class counts the heap allocations that the calling
+ *  thread makes between Begin() and End().  Allocations of
+ *  other threads, like the texture decoding workers, are
+ *  not counted.
+ ***********************************************************/
+class AllocationCounter
+{
+public:
+	// start counting the allocations of the calling thread
+	static void Begin();
+	// stop counting and return the allocations since Begin()
+	static uint64_t End();
+};
@@ -0,0 +1,405 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenetests.cpp
+// ============
+// check the scene management code paths for correct results
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneTests.h"
+#include "AllocationCounter.h"
+#include "GLStateCache.h"
+#include "ImageKernels.h"
+#include "MeshGeometry.h"
+#include "OcclusionCuller.h"
+#include "SceneManager.h"
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+#include "GLFW/glfw3.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	typedef std::chrono::steady_clock TestClock;
+
+	// longest wait for the desk scene textures to load
+	const double g_TextureLoadSeconds = 30.0;
+
+	/***********************************************************
+	 *  CreateHiddenContext()
+	 *
+	 *  Returns a hidden window whose OpenGL context is current,
+	 *  or NULL when no context could be created.
+	 ***********************************************************/
+	GLFWwindow* CreateHiddenContext()
+	{
+		glfwInit();
+#ifdef __APPLE__
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		GLFWwindow* pWindow = glfwCreateWindow(64, 64, "test", NULL, NULL);
+		if (NULL == pWindow)
+		{
+			std::cout << "  could not create an OpenGL context" << std::endl;
+			glfwTerminate();
+			return(NULL);
+		}
+		glfwMakeContextCurrent(pWindow);
+
+		if (GLEW_OK != glewInit())
+		{
+			std::cout << "  could not initialize GLEW" << std::endl;
+			glfwDestroyWindow(pWindow);
+			glfwTerminate();
+			return(NULL);
+		}
+
+		return(pWindow);
+	}
+
+	/***********************************************************
+	 *  DestroyHiddenContext()
+	 *
+	 *  Closes a window made by CreateHiddenContext().
+	 ***********************************************************/
+	void DestroyHiddenContext(GLFWwindow* pWindow)
+	{
+		glfwDestroyWindow(pWindow);
+		glfwTerminate();
+	}
+
+	/***********************************************************
+	 *  RenderOrbitFrame()
+	 *
+	 *  Draws one frame of the scene the way the main loop does,
+	 *  with the camera of the application moved around the
+	 *  desk by the passed in frame of a full circle.
+	 ***********************************************************/
+	void RenderOrbitFrame(SceneManager& sceneManager, int frame, int frameCount)
+	{
+		float angle = 6.2831853f * (float)frame / (float)frameCount;
+		glm::vec3 position(8.0f * std::sin(angle), 5.5f, 8.0f * std::cos(angle));
+		glm::mat4 view = glm::lookAt(position, glm::vec3(0.0f, 1.5f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(80.0f), 1000.0f / 800.0f, 0.1f, 100.0f);
+
+		GLStateCache::Enable(GL_DEPTH_TEST);
+		GLStateCache::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		sceneManager.SetViewPosition(position);
+		sceneManager.SetViewProjection(view, projection, 800);
+		sceneManager.RenderScene();
+		glFinish();
+	}
+
+	/***********************************************************
+	 *  Check()
+	 *
+	 *  Prints the result of one check and returns it.
+	 ***********************************************************/
+	bool Check(const std::string& name, bool bPassed)
+	{
+		std::cout << "  " << name << ": " << (bPassed ? "passed" : "FAILED") << std::endl;
+		return(bPassed);
+	}
+
+	/***********************************************************
+	 *  CountOccluded()
+	 *
+	 *  Returns how many boxes of half size 0.25 at the passed
+	 *  in positions the culler hides.
+	 ***********************************************************/
+	size_t CountOccluded(const OcclusionCuller& culler, const std::vector<glm::vec3>& positions)
+	{
+		size_t occluded = 0;
+		for (const glm::vec3& position : positions)
+		{
+			MESH_BOUNDS bounds = { { position.x, position.y, position.z }, { 0.25f, 0.25f, 0.25f }, 0.433f };
+			occluded += culler.IsOccluded(bounds) ? 1 : 0;
+		}
+		return(occluded);
+	}
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for running a test by name.  Every
+ *  test runs to the end, so one failure does not hide the
+ *  others.
+ ***********************************************************/
+bool SceneTests::Run(const char* testName)
+{
+	bool bAll = (strcmp(testName, "all") == 0);
+	bool bFound = false;
+	bool bPassed = true;
+
+	if (bAll || (strcmp(testName, "allocations") == 0))
+	{
+		bPassed = TestDrawAllocations() && bPassed;
+		bFound = true;
+	}
+
+	if (bAll || (strcmp(testName, "occlusion") == 0))
+	{
+		bPassed = TestOcclusionCulling() && bPassed;
+		bFound = true;
+	}
+
+	if (bFound == false)
+	{
+		std::cout << "Unknown test:" << testName << std::endl;
+		return(false);
+	}
+
+	std::cout << (bPassed ? "TESTS: passed" : "TESTS: FAILED") << std::endl;
+
+	return(bPassed);
+}
+
+/***********************************************************
+ *  TestDrawAllocations()
+ *
+ *  This method is used for checking that the frames of the
+ *  desk scene make no heap allocations on the main thread.
+ *  The scene is drawn with the application's shaders, once
+ *  with instanced draws and once object by object, which
+ *  sets the texture and material of every draw.  The camera
+ *  circles the desk once to grow the per-frame buffers to
+ *  their largest view, then the same circle is counted.
+ ***********************************************************/
+bool SceneTests::TestDrawAllocations()
+{
+	const int orbitFrames = 120;
+	bool bPassed = true;
+
+	std::cout << "TEST: draw allocations" << std::endl;
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		bool bInstancing = (pass == 0);
+		const char* passName = bInstancing ? "instanced" : "one by one";
+
+		GLFWwindow* pWindow = CreateHiddenContext();
+		if (NULL == pWindow)
+		{
+			std::cout << "FAILED: " << passName << ": no OpenGL context" << std::endl;
+			return(false);
+		}
+
+		ShaderManager* pShaderManager = new ShaderManager();
+		pShaderManager->LoadShaders("Shaders/vertexShader.glsl", "Shaders/fragmentShader.glsl");
+		pShaderManager->use();
+
+		SceneManager* pSceneManager = new SceneManager(pShaderManager);
+		pSceneManager->SetInstancing(bInstancing);
+		pSceneManager->PrepareScene();
+
+		// the uploads of the streamed textures may allocate
+		auto start = TestClock::now();
+		while ((pSceneManager->IsLoadingTextures() == true) &&
+			(std::chrono::duration<double>(TestClock::now() - start).count() < g_TextureLoadSeconds))
+		{
+			RenderOrbitFrame(*pSceneManager, 0, orbitFrames);
+		}
+		bool bLoaded = (pSceneManager->IsLoadingTextures() == false);
+
+		for (int frame = 0; frame < orbitFrames; frame++)
+		{
+			RenderOrbitFrame(*pSceneManager, frame, orbitFrames);
+		}
+
+		AllocationCounter::Begin();
+		for (int frame = 0; frame < orbitFrames; frame++)
+		{
+			RenderOrbitFrame(*pSceneManager, frame, orbitFrames);
+		}
+		uint64_t allocations = AllocationCounter::End();
+		uint32_t drawCalls = pSceneManager->GetRenderStats().drawCalls;
+
+		std::cout << "  " << passName << ": " << allocations << " allocations in "
+			<< orbitFrames << " frames of " << drawCalls << " draws" << std::endl;
+
+		if (bLoaded == false)
+		{
+			std::cout << "FAILED: " << passName << ": the textures did not finish loading" << std::endl;
+			bPassed = false;
+		}
+		if (drawCalls == 0)
+		{
+			std::cout << "FAILED: " << passName << ": nothing was drawn" << std::endl;
+			bPassed = false;
+		}
+		if (allocations != 0)
+		{
+			std::cout << "FAILED: " << passName << ": the frames allocated memory" << std::endl;
+			bPassed = false;
+		}
+
+		delete pSceneManager;
+		delete pShaderManager;
+		DestroyHiddenContext(pWindow);
+	}
+
+	return(bPassed);
+}
+
+/***********************************************************
+ *  TestOcclusionCulling()
+ *
+ *  This method is used for checking the occlusion culling
+ *  on synthetic scenes whose hidden objects are known, seen
+ *  by the camera of the desk scene, on every instruction set
+ *  the processor supports.  A field of random occluders with
+ *  objects between them then has to give the scalar path's
+ *  depth buffer and hidden objects on every other path.
+ ***********************************************************/
+bool SceneTests::TestOcclusionCulling()
+{
+	const uint32_t objectCount = 10000;
+	const uint32_t occluderCount = 200;
+	bool bPassed = true;
+
+	std::cout << "TEST: occlusion culling" << std::endl;
+
+	MESH_DATA boxMesh;
+	MESH_BOUNDS boxBounds;
+	MeshGeometry::GenerateBox(boxMesh);
+	MeshGeometry::ComputeBounds(boxMesh, boxBounds);
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 5.5f, 8.0f), glm::vec3(0.0f, 4.5f, 4.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(80.0f), 1000.0f / 800.0f, 0.1f, 100.0f);
+	glm::mat4 viewProjection = projection * view;
+
+	std::vector<glm::vec3> behind;
+	std::vector<glm::vec3> inFront;
+	std::vector<glm::vec3> leftBehind;
+	std::vector<glm::vec3> edgeBehind;
+	std::vector<glm::vec3> rightBehind;
+	for (int i = 0; i < 5; i++)
+	{
+		behind.push_back(glm::vec3(-4.0f + 2.0f * i, 4.5f, -2.0f - 10.0f * i));
+		inFront.push_back(glm::vec3(-1.0f + 0.5f * i, 4.5f, 2.0f + 0.5f * i));
+		leftBehind.push_back(glm::vec3(-10.0f + 1.5f * i, 3.0f + 0.5f * i, -5.0f));
+		edgeBehind.push_back(glm::vec3(0.0f, 3.0f + 0.5f * i, -5.0f));
+		rightBehind.push_back(glm::vec3(2.0f + 1.5f * i, 3.0f + 0.5f * i, -5.0f));
+	}
+	std::vector<glm::vec3> belowFloor(1, glm::vec3(0.0f, -2.0f, -10.0f));
+	std::vector<glm::vec3> onFloor(1, glm::vec3(0.0f, 0.5f, -10.0f));
+
+	// random blocks standing on the ground in front of the
+	// camera, and small objects scattered between them
+	std::mt19937 random(17);
+	std::uniform_real_distribution<float> groundX(-40.0f, 40.0f);
+	std::uniform_real_distribution<float> groundZ(-90.0f, 0.0f);
+	std::uniform_real_distribution<float> blockSize(1.0f, 6.0f);
+	std::uniform_real_distribution<float> height(0.0f, 8.0f);
+	std::vector<glm::mat4> occluders(occluderCount);
+	for (glm::mat4& occluder : occluders)
+	{
+		float blockHeight = blockSize(random) * 2.0f;
+		occluder = glm::translate(glm::vec3(groundX(random), blockHeight * 0.5f, groundZ(random))) *
+			glm::scale(glm::vec3(blockSize(random), blockHeight, blockSize(random)));
+	}
+	std::vector<glm::vec3> objects(objectCount);
+	for (glm::vec3& object : objects)
+	{
+		object = glm::vec3(groundX(random), height(random), groundZ(random));
+	}
+
+	std::vector<float> scalarDepth;
+	std::vector<uint8_t> scalarOccluded(objectCount);
+	OcclusionCuller culler;
+	IMAGE_KERNEL_PATH bestPath = ImageKernels::GetBestPath();
+	for (int path = IMAGE_KERNEL_SCALAR; path <= (int)bestPath; path++)
+	{
+		OcclusionCuller::SetPath((IMAGE_KERNEL_PATH)path);
+		std::string pathName = ImageKernels::GetPathName((IMAGE_KERNEL_PATH)path);
+
+		// a wall filling the view hides everything behind it
+		// and nothing in front of it
+		culler.BeginFrame(viewProjection);
+		culler.AddOccluder(boxBounds, glm::translate(glm::vec3(0.0f, 4.5f, 0.0f)) * glm::scale(glm::vec3(30.0f, 20.0f, 0.5f)));
+		culler.BuildPyramid();
+		bPassed = Check(pathName + " wall hides the objects behind it", CountOccluded(culler, behind) == behind.size()) && bPassed;
+		bPassed = Check(pathName + " wall keeps the objects in front of it", CountOccluded(culler, inFront) == 0) && bPassed;
+
+		// a wall over the left half of the view only hides what
+		// is entirely behind its left side
+		culler.BeginFrame(viewProjection);
+		culler.AddOccluder(boxBounds, glm::translate(glm::vec3(-8.0f, 4.5f, 0.0f)) * glm::scale(glm::vec3(16.0f, 20.0f, 0.5f)));
+		culler.BuildPyramid();
+		bPassed = Check(pathName + " half wall hides the objects behind it", CountOccluded(culler, leftBehind) == leftBehind.size()) && bPassed;
+		bPassed = Check(pathName + " half wall keeps the objects across its edge", CountOccluded(culler, edgeBehind) == 0) && bPassed;
+		bPassed = Check(pathName + " half wall keeps the objects beside it", CountOccluded(culler, rightBehind) == 0) && bPassed;
+
+		// a floor crossing the near plane hides what is below it
+		culler.BeginFrame(viewProjection);
+		culler.AddOccluder(boxBounds, glm::scale(glm::vec3(100.0f, 0.1f, 100.0f)));
+		culler.BuildPyramid();
+		bPassed = Check(pathName + " floor hides the objects below it", CountOccluded(culler, belowFloor) == 1) && bPassed;
+		bPassed = Check(pathName + " floor keeps the objects on it", CountOccluded(culler, onFloor) == 0) && bPassed;
+
+		// the random field against the scalar path
+		culler.BeginFrame(viewProjection);
+		for (const glm::mat4& occluder : occluders)
+		{
+			culler.AddOccluder(boxBounds, occluder);
+		}
+		culler.BuildPyramid();
+
+		const float* pDepth = culler.GetDepthBuffer();
+		size_t occludedCount = 0;
+		size_t depthMismatches = 0;
+		size_t occludedMismatches = 0;
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			MESH_BOUNDS bounds = { { objects[i].x, objects[i].y, objects[i].z }, { 0.25f, 0.25f, 0.25f }, 0.433f };
+			uint8_t bOccluded = culler.IsOccluded(bounds) ? 1 : 0;
+			occludedCount += bOccluded;
+			if (path == IMAGE_KERNEL_SCALAR)
+			{
+				scalarOccluded[i] = bOccluded;
+			}
+			else if (scalarOccluded[i] != bOccluded)
+			{
+				occludedMismatches++;
+			}
+		}
+		if (path == IMAGE_KERNEL_SCALAR)
+		{
+			scalarDepth.assign(pDepth, pDepth + OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT);
+			bPassed = Check(pathName + " random field hides some of the objects", (occludedCount > 0) && (occludedCount < objectCount)) && bPassed;
+		}
+		else
+		{
+			for (size_t i = 0; i < scalarDepth.size(); i++)
+			{
+				depthMismatches += (scalarDepth[i] != pDepth[i]) ? 1 : 0;
+			}
+			bPassed = Check(pathName + " random field depth matches scalar", depthMismatches == 0) && bPassed;
+			bPassed = Check(pathName + " random field hidden objects match scalar", occludedMismatches == 0) && bPassed;
+		}
+	}
+
+	OcclusionCuller::SetPath(bestPath);
+
+	return(bPassed);
+}
@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenetests.h
+// ============
+// check the scene management code paths for correct results
+//
+// The tests are built into their own test program, which runs every test
+// or the one named on the command line and exits with a failure when any
+// check fails.  The draw tests open a hidden window for their OpenGL
+// context and load the desk scene, so the program is started from the
+// project directory like the application.  The other tests need neither.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  SceneTests
+ *
+ *  This class contains the tests of the scene management
+ *  code.
+ ***********************************************************/
+class SceneTests
+{
+public:
+	// run the named test, or every test for "all"; false when
+	// the name is unknown or a test fails
+	static bool Run(const char* testName);
+
+private:
+	// drawing the frames of the loaded desk scene makes no
+	// heap allocations, drawn instanced and one by one
+	static bool TestDrawAllocations();
+	// the occlusion culler hides exactly the known objects of
+	// synthetic occluder scenes, and every instruction set
+	// rasterizes the same depth buffer as the scalar path
+	static bool TestOcclusionCulling();
+};
@@ -0,0 +1,25 @@
+///////////////////////////////////////////////////////////////////////////////
+// testmain.cpp
+// ============
+// entry point of the test program
+//
+// Runs every test, or the test named as the first argument, and exits
+// with EXIT_FAILURE when any of them fails.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneTests.h"
+
+#include <cstdlib>
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the test program has
+ *  been launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	const char* testName = (argc > 1) ? argv[1] : "all";
+
+	return(SceneTests::Run(testName) ? EXIT_SUCCESS : EXIT_FAILURE);
+}